@@ -0,0 +1,297 @@
+/*
+ * infoutils-bench - Benchmarks of the collector hot paths
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include <cerrno>
+ #include <cstdlib>
+ #include <cstring>
+ #include <filesystem>
+ #include <fstream>
+ #include <iostream>
+ #include <map>
+ #include <sstream>
+ #include <string>
+ #include <vector>
+ #include <unistd.h>
+ #include <fcntl.h>
+ 
+ #include <benchmark/benchmark.h>
+ 
+ #include "procfs.hpp"
+ #include "cpu.hpp"
+ #include "mem.hpp"
+ #include "disk.hpp"
+ #include "os.hpp"
+ #include "process.hpp"
+ #include "fixtures.hpp"
+ 
+ // Parsing all of /proc/cpuinfo
+ static void BM_CpuInfo(benchmark::State& state) {
+     for (auto _ : state) {
+         CpuInfo info = readCpuInfo();
+         benchmark::DoNotOptimize(info);
+         state.counters["cpus"] = info.logical_cores;
+     }
+ }
+ BENCHMARK(BM_CpuInfo);
+ 
+ // The istringstream and std::map parser that readCpuInfo replaced, kept
+ // as the baseline BM_CpuInfo is compared against
+ struct LegacyCpuInfo {
+     std::string model_name;
+     std::string vendor_id;
+     std::string cpu_family;
+     std::string model;
+     std::string stepping;
+     std::string microcode;
+     std::string cache_size;
+     std::vector<std::string> flags;
+     double cpu_mhz = 0.0;
+     int physical_cores = 0;
+     int logical_cores = 0;
+     int siblings = 0;
+ };
+ 
+ static LegacyCpuInfo readCpuInfoLegacy() {
+     LegacyCpuInfo info;
+     std::ifstream file(systemPath("/proc/cpuinfo"));
+     std::string line;
+     std::map<std::string, int> core_count;
+     
+     while (std::getline(file, line)) {
+         size_t colon = line.find(':');
+         if (colon == std::string::npos) continue;
+         
+         std::string key = line.substr(0, colon);
+         std::string value = line.substr(colon + 1);
+         
+         // Trim whitespace
+         key.erase(key.find_last_not_of(" \t") + 1);
+         value.erase(0, value.find_first_not_of(" \t"));
+         
+         if (key == "model name" && info.model_name.empty()) {
+             info.model_name = value;
+         } else if (key == "vendor_id" && info.vendor_id.empty()) {
+             info.vendor_id = value;
+         } else if (key == "cpu family" && info.cpu_family.empty()) {
+             info.cpu_family = value;
+         } else if (key == "model" && info.model.empty()) {
+             info.model = value;
+         } else if (key == "stepping" && info.stepping.empty()) {
+             info.stepping = value;
+         } else if (key == "microcode" && info.microcode.empty()) {
+             info.microcode = value;
+         } else if (key == "cache size" && info.cache_size.empty()) {
+             info.cache_size = value;
+         } else if (key == "cpu MHz" && info.cpu_mhz == 0.0) {
+             info.cpu_mhz = std::stod(value);
+         } else if (key == "siblings") {
+             info.siblings = std::stoi(value);
+         } else if (key == "core id") {
+             core_count[value]++;
+         } else if (key == "processor") {
+             info.logical_cores++;
+         } else if (key == "flags" && info.flags.empty()) {
+             std::istringstream iss(value);
+             std::string flag;
+             while (iss >> flag) {
+                 info.flags.push_back(flag);
+             }
+         }
+     }
+     
+     info.physical_cores = core_count.size();
+     if (info.physical_cores == 0) {
+         info.physical_cores = info.logical_cores;
+     }
+     
+     return info;
+ }
+ 
+ static void BM_CpuInfoLegacy(benchmark::State& state) {
+     for (auto _ : state) {
+         LegacyCpuInfo info = readCpuInfoLegacy();
+         benchmark::DoNotOptimize(info);
+         state.counters["cpus"] = info.logical_cores;
+     }
+ }
+ BENCHMARK(BM_CpuInfoLegacy);
+ 
+ // One watch sample of /proc/stat and /proc/loadavg with per-CPU rows
+ static void BM_CpuLoad(benchmark::State& state) {
+     CpuSampler sampler;
+     CpuStatTable per_cpu;
+     for (auto _ : state) {
+         CpuLoad load = sampler.load(&per_cpu);
+         benchmark::DoNotOptimize(load);
+     }
+     state.counters["cpus"] = per_cpu.size();
+ }
+ BENCHMARK(BM_CpuLoad);
+ 
+ // One watch sample of /proc/meminfo, /proc/vmstat and memory pressure
+ static void BM_MemoryInfo(benchmark::State& state) {
+     MemSampler sampler;
+     for (auto _ : state) {
+         MemoryInfo info = sampler.memoryInfo();
+         VmStatCounters vmstat = sampler.vmStat();
+         MemoryPressure pressure = sampler.pressure();
+         benchmark::DoNotOptimize(info);
+         benchmark::DoNotOptimize(vmstat);
+         benchmark::DoNotOptimize(pressure);
+     }
+ }
+ BENCHMARK(BM_MemoryInfo);
+ 
+ // meminfo -p: rank every process by the resident size in its statm and
+ // read the names and command lines of the top 15, on one thread
+ static void BM_TopProcesses(benchmark::State& state) {
+     std::vector<ProcessMemory> processes;
+     for (auto _ : state) {
+         if (!readTopProcesses(MEM_SORT_RSS, 15, 1, false, processes)) {
+             state.SkipWithError("cannot list /proc");
+             return;
+         }
+         benchmark::DoNotOptimize(processes.data());
+     }
+     
+     int proc_fd = openSystemFile("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+     if (proc_fd >= 0) {
+         std::vector<int> pids;
+         listPids(proc_fd, pids);
+         close(proc_fd);
+         state.counters["processes"] = pids.size();
+     }
+ }
+ BENCHMARK(BM_TopProcesses);
+ 
+ // cpuinfo -p and diskls -p: one steady-state sample of stat, schedstat
+ // and io of every process. The fixtures never change, so no process is
+ // ranked and this times the scan and the table updates.
+ static void BM_ProcessActivity(benchmark::State& state) {
+     ProcessSampler sampler(PROCESS_FILE_SCHEDSTAT | PROCESS_FILE_IO);
+     std::vector<ProcessActivity> top;
+     if (!sampler.sample(PROCESS_CPU, 15, top)) {
+         state.SkipWithError("cannot list /proc");
+         return;
+     }
+     for (auto _ : state) {
+         sampler.sample(PROCESS_CPU, 15, top);
+         benchmark::DoNotOptimize(top);
+     }
+     state.counters["processes"] = sampler.processCount();
+ }
+ BENCHMARK(BM_ProcessActivity);
+ 
+ // diskls: every attribute of every /sys/block device, on one thread
+ static void BM_DiskInfo(benchmark::State& state) {
+     std::vector<DiskInfo> disks;
+     for (auto _ : state) {
+         disks.clear();
+         readDisks(disks, 1, false);
+         benchmark::DoNotOptimize(disks.data());
+     }
+     state.counters["disks"] = disks.size();
+ }
+ BENCHMARK(BM_DiskInfo);
+ 
+ // diskls -u: list the mounts of mountinfo that pass the default filter
+ static void BM_PartitionInfo(benchmark::State& state) {
+     DiskSampler sampler;
+     MountFilter filter;
+     std::vector<PartitionInfo> partitions;
+     for (auto _ : state) {
+         const char* mountinfo = sampler.mountInfo();
+         if (!mountinfo) {
+             state.SkipWithError("cannot read /proc/self/mountinfo");
+             return;
+         }
+         partitions.clear();
+         readPartitions(mountinfo, filter, partitions);
+         benchmark::DoNotOptimize(partitions.data());
+     }
+     state.counters["partitions"] = partitions.size();
+ }
+ BENCHMARK(BM_PartitionInfo);
+ 
+ // One watch sample of /proc/diskstats
+ static void BM_DiskStats(benchmark::State& state) {
+     DiskSampler sampler;
+     DiskStatsTable table;
+     for (auto _ : state) {
+         sampler.diskStats(table);
+         benchmark::DoNotOptimize(table.rows.data());
+     }
+     state.counters["devices"] = table.rows.size();
+ }
+ BENCHMARK(BM_DiskStats);
+ 
+ static void BM_DistroInfo(benchmark::State& state) {
+     for (auto _ : state) {
+         DistroInfo info = readDistroInfo();
+         benchmark::DoNotOptimize(info);
+     }
+ }
+ BENCHMARK(BM_DistroInfo);
+ 
+ // Google Benchmark takes its own --benchmark_* options first. With
+ // --root DIR the collectors read DIR, such as / for this machine;
+ // otherwise a synthetic large machine is written to a temporary
+ // directory and removed afterwards.
+ int main(int argc, char* argv[]) {
+     benchmark::Initialize(&argc, argv);
+     
+     std::string root;
+     std::string fixtures;
+     for (int i = 1; i < argc; ++i) {
+         std::string arg = argv[i];
+         if (arg == "--root" && i + 1 < argc) {
+             root = argv[++i];
+         } else if (arg.rfind("--root=", 0) == 0) {
+             root = arg.substr(7);
+         } else {
+             std::cerr << "infoutils-bench: invalid option -- '" << arg << "'" << '\n';
+             std::cerr << "Usage: infoutils-bench [--benchmark_OPTION]... [--root DIR]" << '\n';
+             return 1;
+         }
+     }
+     
+     if (root.empty()) {
+         const char* tmp = getenv("TMPDIR");
+         std::string pattern = std::string(tmp && *tmp ? tmp : "/tmp") + "/infoutils-bench.XXXXXX";
+         std::vector<char> dir(pattern.begin(), pattern.end());
+         dir.push_back('\0');
+         if (!mkdtemp(dir.data())) {
+             std::cerr << "infoutils-bench: cannot create " << pattern << ": " << std::strerror(errno) << '\n';
+             return 4;
+         }
+         fixtures = dir.data();
+         root = fixtures;
+         
+         FixtureSize size;
+         std::cerr << "infoutils-bench: writing a " << size.cpus << "-CPU, " << size.processes << "-process, "
+                   << size.mounts << "-mount machine to " << fixtures << '\n';
+         if (!writeFixtures(fixtures, size)) {
+             std::cerr << "infoutils-bench: cannot write fixtures: " << std::strerror(errno) << '\n';
+             std::filesystem::remove_all(fixtures);
+             return 4;
+         }
+     }
+     
+     if (!setSystemRoot(root)) {
+         std::cerr << "infoutils-bench: invalid root directory -- '" << root << "'" << '\n';
+         return 1;
+     }
+     
+     benchmark::RunSpecifiedBenchmarks();
+     benchmark::Shutdown();
+     
+     if (!fixtures.empty()) {
+         std::error_code error;
+         std::filesystem::remove_all(fixtures, error);
+     }
+     return 0;
+ }
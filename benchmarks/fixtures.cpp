@@ -0,0 +1,437 @@
+/*
+ * fixtures - Synthetic /proc, /sys and /etc trees of a large machine
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "fixtures.hpp"
+ 
+ #include <cerrno>
+ #include <cstdarg>
+ #include <cstdio>
+ #include <string>
+ #include <system_error>
+ #include <filesystem>
+ #include <unistd.h>
+ #include <fcntl.h>
+ 
+ namespace {
+ 
+ // Fixed-seed linear congruential generator, so trees are reproducible
+ struct Random {
+     unsigned long long state = 0x2545f4914f6cdd1dULL;
+     
+     unsigned long long next(unsigned long long limit) {
+         state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+         return (state >> 33) % limit;
+     }
+ };
+ 
+ bool makeDirs(const std::string& path) {
+     std::error_code error;
+     std::filesystem::create_directories(path, error);
+     if (error) {
+         errno = error.value();
+         return false;
+     }
+     return true;
+ }
+ 
+ bool writeFile(const std::string& path, const std::string& text) {
+     int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+     if (fd < 0) return false;
+     
+     size_t done = 0;
+     while (done < text.size()) {
+         ssize_t n = write(fd, text.data() + done, text.size() - done);
+         if (n < 0) {
+             if (errno == EINTR) continue;
+             close(fd);
+             return false;
+         }
+         done += n;
+     }
+     return close(fd) == 0;
+ }
+ 
+ void appendf(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+ 
+ void appendf(std::string& out, const char* format, ...) {
+     char buf[1024];
+     va_list args;
+     va_start(args, format);
+     int n = vsnprintf(buf, sizeof(buf), format, args);
+     va_end(args);
+     if (n > 0) out.append(buf, n < static_cast<int>(sizeof(buf)) ? n : sizeof(buf) - 1);
+ }
+ 
+ // Flags of a Sapphire Rapids part; the long flags line dominates parsing
+ const char* const cpu_flags =
+     "fpu vme de pse tsc msr pae mce cx8 apic sep mtrr pge mca cmov pat pse36 clflush dts acpi mmx "
+     "fxsr sse sse2 ss ht tm pbe syscall nx pdpe1gb rdtscp lm constant_tsc art arch_perfmon pebs bts "
+     "rep_good nopl xtopology nonstop_tsc cpuid aperfmperf tsc_known_freq pni pclmulqdq dtes64 monitor "
+     "ds_cpl vmx smx est tm2 ssse3 sdbg fma cx16 xtpr pdcm pcid dca sse4_1 sse4_2 x2apic movbe popcnt "
+     "tsc_deadline_timer aes xsave avx f16c rdrand lahf_lm abm 3dnowprefetch cpuid_fault epb cat_l3 "
+     "cat_l2 cdp_l3 invpcid_single intel_ppin cdp_l2 ssbd mba ibrs ibpb stibp ibrs_enhanced "
+     "tpr_shadow flexpriority ept vpid ept_ad fsgsbase tsc_adjust bmi1 hle avx2 smep bmi2 erms invpcid "
+     "rtm cqm rdt_a avx512f avx512dq rdseed adx smap avx512ifma clflushopt clwb intel_pt avx512cd "
+     "sha_ni avx512bw avx512vl xsaveopt xsavec xgetbv1 xsaves cqm_llc cqm_occup_llc cqm_mbm_total "
+     "cqm_mbm_local split_lock_detect avx_vnni avx512_bf16 wbnoinvd dtherm ida arat pln pts hfi "
+     "avx512vbmi umip pku ospke waitpkg avx512_vbmi2 gfni vaes vpclmulqdq avx512_vnni avx512_bitalg "
+     "tme avx512_vpopcntdq la57 rdpid bus_lock_detect cldemote movdiri movdir64b enqcmd fsrm md_clear "
+     "serialize tsxldtrk pconfig arch_lbr ibt amx_bf16 avx512_fp16 amx_tile amx_int8 flush_l1d "
+     "arch_capabilities";
+ 
+ bool writeCpu(const std::string& proc, const FixtureSize& size, Random& random) {
+     int per_socket = size.cpus > 1 ? size.cpus / 2 : 1;
+     int cores = per_socket > 1 ? per_socket / 2 : 1;
+     
+     std::string cpuinfo;
+     for (int cpu = 0; cpu < size.cpus; ++cpu) {
+         int socket = cpu / per_socket;
+         int core = (cpu % per_socket) % cores;
+         appendf(cpuinfo,
+                 "processor\t: %d\nvendor_id\t: GenuineIntel\ncpu family\t: 6\nmodel\t\t: 143\n"
+                 "model name\t: Intel(R) Xeon(R) Platinum 8490H\nstepping\t: 8\nmicrocode\t: 0x2b000461\n"
+                 "cpu MHz\t\t: %d.%03d\ncache size\t: 115200 KB\nphysical id\t: %d\nsiblings\t: %d\n"
+                 "core id\t\t: %d\ncpu cores\t: %d\napicid\t\t: %d\ninitial apicid\t: %d\nfpu\t\t: yes\n"
+                 "fpu_exception\t: yes\ncpuid level\t: 32\nwp\t\t: yes\n",
+                 cpu, 1900 + static_cast<int>(random.next(1600)), static_cast<int>(random.next(1000)),
+                 socket, per_socket, core, cores, cpu * 2, cpu * 2);
+         cpuinfo += "flags\t\t: ";
+         cpuinfo += cpu_flags;
+         cpuinfo += "\nbugs\t\t: spectre_v1 spectre_v2 spec_store_bypass swapgs eibrs_pbrsb\n"
+                    "bogomips\t: 3800.00\nclflush size\t: 64\ncache_alignment\t: 64\n"
+                    "address sizes\t: 46 bits physical, 57 bits virtual\npower management:\n\n";
+     }
+     if (!writeFile(proc + "/cpuinfo", cpuinfo)) return false;
+     
+     // Aggregate line, one line per CPU, then the interrupt and softirq
+     // counters, which on a large machine are most of the file
+     std::string stat;
+     std::string lines;
+     unsigned long long total[10] = {};
+     for (int cpu = 0; cpu < size.cpus; ++cpu) {
+         unsigned long long values[10];
+         for (int i = 0; i < 10; ++i) {
+             values[i] = i == 3 ? 90000000 + random.next(10000000) : random.next(i < 3 ? 9000000 : 90000);
+             total[i] += values[i];
+         }
+         appendf(lines, "cpu%d %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu\n", cpu,
+                 values[0], values[1], values[2], values[3], values[4],
+                 values[5], values[6], values[7], values[8], values[9]);
+     }
+     appendf(stat, "cpu  %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu\n",
+             total[0], total[1], total[2], total[3], total[4],
+             total[5], total[6], total[7], total[8], total[9]);
+     stat += lines;
+     stat += "intr 98765432109";
+     for (int irq = 0; irq < 1024 + size.cpus * 4; ++irq) {
+         appendf(stat, " %llu", irq % 7 == 0 ? random.next(100000000) : 0ULL);
+     }
+     appendf(stat, "\nctxt 987654321098\nbtime 1790000000\nprocesses %d\nprocs_running %d\nprocs_blocked 3\n",
+             size.processes * 40, size.cpus / 4);
+     stat += "softirq 123456789012";
+     for (int i = 0; i < 10; ++i) appendf(stat, " %llu", random.next(10000000000ULL));
+     stat += '\n';
+     if (!writeFile(proc + "/stat", stat)) return false;
+     
+     std::string loadavg;
+     appendf(loadavg, "%d.%02d 58.17 49.90 %d/%d 4194303\n", size.cpus / 4, 42, size.cpus / 4, size.processes * 3);
+     return writeFile(proc + "/loadavg", loadavg);
+ }
+ 
+ bool writeMemory(const std::string& proc, Random& random) {
+     // 2 TiB of memory, in kB
+     static const char* const meminfo =
+         "MemTotal:       2113214976 kB\n"
+         "MemFree:        183655104 kB\n"
+         "MemAvailable:   1208271524 kB\n"
+         "Buffers:         6238912 kB\n"
+         "Cached:         1021437216 kB\n"
+         "SwapCached:        81920 kB\n"
+         "Active:         742161408 kB\n"
+         "Inactive:       1043842392 kB\n"
+         "Active(anon):   612332604 kB\n"
+         "Inactive(anon): 140383012 kB\n"
+         "Active(file):   129828804 kB\n"
+         "Inactive(file): 903459380 kB\n"
+         "Unevictable:      901236 kB\n"
+         "Mlocked:          893348 kB\n"
+         "SwapTotal:      67108860 kB\n"
+         "SwapFree:       66012412 kB\n"
+         "Zswap:                 0 kB\n"
+         "Zswapped:              0 kB\n"
+         "Dirty:            931220 kB\n"
+         "Writeback:          4112 kB\n"
+         "AnonPages:      748311760 kB\n"
+         "Mapped:          9312408 kB\n"
+         "Shmem:           4273128 kB\n"
+         "KReclaimable:   63120412 kB\n"
+         "Slab:           89347128 kB\n"
+         "SReclaimable:   63120412 kB\n"
+         "SUnreclaim:     26226716 kB\n"
+         "KernelStack:      961184 kB\n"
+         "PageTables:      3019392 kB\n"
+         "SecPageTables:         0 kB\n"
+         "NFS_Unstable:          0 kB\n"
+         "Bounce:                0 kB\n"
+         "WritebackTmp:          0 kB\n"
+         "CommitLimit:    1123716348 kB\n"
+         "Committed_AS:   1673120584 kB\n"
+         "VmallocTotal:   13743895347199 kB\n"
+         "VmallocUsed:     2104712 kB\n"
+         "VmallocChunk:          0 kB\n"
+         "Percpu:          1746944 kB\n"
+         "HardwareCorrupted:     0 kB\n"
+         "AnonHugePages:  201326592 kB\n"
+         "ShmemHugePages:        0 kB\n"
+         "ShmemPmdMapped:        0 kB\n"
+         "FileHugePages:         0 kB\n"
+         "FilePmdMapped:         0 kB\n"
+         "Unaccepted:            0 kB\n"
+         "HugePages_Total:    1024\n"
+         "HugePages_Free:      512\n"
+         "HugePages_Rsvd:       12\n"
+         "HugePages_Surp:        0\n"
+         "Hugepagesize:       2048 kB\n"
+         "Hugetlb:         2097152 kB\n"
+         "DirectMap4k:     9022164 kB\n"
+         "DirectMap2M:    885428224 kB\n"
+         "DirectMap1G:    1254096896 kB\n";
+     if (!writeFile(proc + "/meminfo", meminfo)) return false;
+     
+     // The counters the collectors read, among the many they skip
+     static const char* const names[] = {
+         "nr_free_pages", "nr_zone_inactive_anon", "nr_zone_active_anon", "nr_zone_inactive_file",
+         "nr_zone_active_file", "nr_zone_unevictable", "nr_zone_write_pending", "nr_mlock",
+         "nr_bounce", "nr_zspages", "nr_free_cma", "numa_hit", "numa_miss", "numa_foreign",
+         "numa_interleave", "numa_local", "numa_other", "nr_inactive_anon", "nr_active_anon",
+         "nr_inactive_file", "nr_active_file", "nr_unevictable", "nr_slab_reclaimable",
+         "nr_slab_unreclaimable", "nr_isolated_anon", "nr_isolated_file", "workingset_nodes",
+         "workingset_refault_anon", "workingset_refault_file", "workingset_activate_anon",
+         "workingset_activate_file", "workingset_restore_anon", "workingset_restore_file",
+         "workingset_nodereclaim", "nr_anon_pages", "nr_mapped", "nr_file_pages", "nr_dirty",
+         "nr_writeback", "nr_writeback_temp", "nr_shmem", "nr_shmem_hugepages", "nr_shmem_pmdmapped",
+         "nr_file_hugepages", "nr_file_pmdmapped", "nr_anon_transparent_hugepages", "nr_vmscan_write",
+         "nr_vmscan_immediate_reclaim", "nr_dirtied", "nr_written", "nr_throttled_written",
+         "nr_kernel_misc_reclaimable", "nr_foll_pin_acquired", "nr_foll_pin_released",
+         "nr_kernel_stack", "nr_page_table_pages", "nr_sec_page_table_pages", "nr_swapcached",
+         "nr_dirty_threshold", "nr_dirty_background_threshold", "pgpgin", "pgpgout", "pswpin",
+         "pswpout", "pgalloc_dma", "pgalloc_dma32", "pgalloc_normal", "pgalloc_movable",
+         "allocstall_dma", "allocstall_dma32", "allocstall_normal", "allocstall_movable",
+         "pgskip_dma", "pgskip_dma32", "pgskip_normal", "pgskip_movable", "pgfree", "pgactivate",
+         "pgdeactivate", "pglazyfree", "pgfault", "pgmajfault", "pglazyfreed", "pgrefill",
+         "pgreuse", "pgsteal_kswapd", "pgsteal_direct", "pgsteal_khugepaged", "pgdemote_kswapd",
+         "pgdemote_direct", "pgdemote_khugepaged", "pgscan_kswapd", "pgscan_direct",
+         "pgscan_khugepaged", "pgscan_direct_throttle", "pgscan_anon", "pgscan_file",
+         "pgsteal_anon", "pgsteal_file", "zone_reclaim_failed", "pginodesteal", "slabs_scanned",
+         "kswapd_inodesteal", "kswapd_low_wmark_hit_quickly", "kswapd_high_wmark_hit_quickly",
+         "pageoutrun", "pgrotated", "drop_pagecache", "drop_slab", "oom_kill", "numa_pte_updates",
+         "numa_huge_pte_updates", "numa_hint_faults", "numa_hint_faults_local", "numa_pages_migrated",
+         "pgmigrate_success", "pgmigrate_fail", "thp_migration_success", "thp_migration_fail",
+         "thp_migration_split", "compact_migrate_scanned", "compact_free_scanned", "compact_isolated",
+         "compact_stall", "compact_fail", "compact_success", "compact_daemon_wake",
+         "compact_daemon_migrate_scanned", "compact_daemon_free_scanned", "htlb_buddy_alloc_success",
+         "htlb_buddy_alloc_fail", "unevictable_pgs_culled", "unevictable_pgs_scanned",
+         "unevictable_pgs_rescued", "unevictable_pgs_mlocked", "unevictable_pgs_munlocked",
+         "unevictable_pgs_cleared", "unevictable_pgs_stranded", "thp_fault_alloc",
+         "thp_fault_fallback", "thp_fault_fallback_charge", "thp_collapse_alloc",
+         "thp_collapse_alloc_failed", "thp_file_alloc", "thp_file_fallback",
+         "thp_file_fallback_charge", "thp_file_mapped", "thp_split_page", "thp_split_page_failed",
+         "thp_deferred_split_page", "thp_split_pmd", "thp_scan_exceed_none_pte",
+         "thp_scan_exceed_swap_pte", "thp_scan_exceed_share_pte", "thp_zero_page_alloc",
+         "thp_zero_page_alloc_failed", "thp_swpout", "thp_swpout_fallback", "balloon_inflate",
+         "balloon_deflate", "balloon_migrate", "swap_ra", "swap_ra_hit", "ksm_swpin_copy",
+         "cow_ksm", "zswpin", "zswpout", "direct_map_level2_splits", "direct_map_level3_splits",
+         "nr_unstable"
+     };
+     std::string vmstat;
+     for (const char* name : names) {
+         appendf(vmstat, "%s %llu\n", name, random.next(1ULL << 40));
+     }
+     if (!writeFile(proc + "/vmstat", vmstat)) return false;
+     
+     return makeDirs(proc + "/pressure") &&
+            writeFile(proc + "/pressure/memory",
+                      "some avg10=1.52 avg60=0.87 avg300=0.31 total=918273645\n"
+                      "full avg10=0.40 avg60=0.22 avg300=0.08 total=192837465\n");
+ }
+ 
+ // Container workloads: short names, long command lines and a wide spread
+ // of resident sizes
+ bool writeProcesses(const std::string& proc, const FixtureSize& size, Random& random) {
+     static const char* const commands[] = {
+         "java", "python3", "node", "postgres", "nginx", "envoy", "containerd-shim", "pause",
+         "bash", "sshd", "kworker/u513:2", "ksoftirqd/17", "redis-server", "gunicorn", "grpc_server"
+     };
+     const size_t command_count = sizeof(commands) / sizeof(commands[0]);
+     
+     char name[32];
+     std::string text;
+     for (int pid = 1; pid <= size.processes; ++pid) {
+         snprintf(name, sizeof(name), "/%d", pid);
+         std::string dir = proc + name;
+         if (!makeDirs(dir)) return false;
+         
+         const char* command = commands[random.next(command_count)];
+         bool kernel_thread = command[0] == 'k';
+         unsigned long long resident = kernel_thread ? 0 : random.next(random.next(8) == 0 ? 4000000 : 40000);
+         unsigned long long total = resident * 3 + random.next(100000);
+         
+         text.clear();
+         appendf(text, "%llu %llu %llu %llu 0 %llu 0\n", total, resident, resident / 4,
+                 random.next(2000), resident / 2);
+         if (!writeFile(dir + "/statm", text)) return false;
+         
+         text = command;
+         text += '\n';
+         if (!writeFile(dir + "/comm", text)) return false;
+         
+         // Fields 3 to 22 of stat, up to starttime; the rest are not read
+         text.clear();
+         appendf(text, "%d (%s) S 1 %d %d 0 -1 4194560 %llu 0 0 0 %llu %llu 0 0 20 0 1 0 %llu\n",
+                 pid, command, pid, pid, random.next(100000), random.next(500000), random.next(100000),
+                 static_cast<unsigned long long>(pid) * 10);
+         if (!writeFile(dir + "/stat", text)) return false;
+         
+         text.clear();
+         appendf(text, "%llu %llu %llu\n", random.next(1000000000), random.next(100000000), random.next(100000));
+         if (!writeFile(dir + "/schedstat", text)) return false;
+         
+         text.clear();
+         appendf(text, "rchar: %llu\nwchar: %llu\nsyscr: %llu\nsyscw: %llu\nread_bytes: %llu\n"
+                 "write_bytes: %llu\ncancelled_write_bytes: 0\n",
+                 random.next(100000000), random.next(100000000), random.next(100000), random.next(100000),
+                 random.next(10000000), random.next(10000000));
+         if (!writeFile(dir + "/io", text)) return false;
+         
+         text.clear();
+         if (!kernel_thread) {
+             appendf(text, "/usr/bin/%s", command);
+             text += '\0';
+             appendf(text, "--config=/etc/%s/%d.conf", command, pid);
+             text += '\0';
+             appendf(text, "--listen=0.0.0.0:%d", 1024 + pid % 60000);
+             text += '\0';
+         }
+         if (!writeFile(dir + "/cmdline", text)) return false;
+     }
+     return true;
+ }
+ 
+ // Kubelet-style mounts: a few disks, then secrets, projected volumes and
+ // overlays of every pod
+ bool writeMounts(const std::string& proc, const FixtureSize& size, Random& random) {
+     if (!makeDirs(proc + "/1")) return false;
+     
+     std::string text =
+         "1 0 259:2 / / rw,relatime shared:1 - ext4 /dev/nvme0n1p2 rw,errors=remount-ro\n"
+         "2 1 0:22 / /sys rw,nosuid,nodev,noexec,relatime shared:2 - sysfs sysfs rw\n"
+         "3 1 0:23 / /proc rw,nosuid,nodev,noexec,relatime shared:3 - proc proc rw\n"
+         "4 1 0:5 / /dev rw,nosuid,relatime shared:4 - devtmpfs udev rw,size=1056579488k,mode=755\n"
+         "5 2 0:27 / /sys/fs/cgroup rw,nosuid,nodev,noexec,relatime shared:5 - cgroup2 cgroup2 rw\n"
+         "6 1 259:1 / /boot/efi rw,relatime shared:6 - vfat /dev/nvme0n1p1 rw,fmask=0077,dmask=0077\n";
+     for (int disk = 1; disk < size.disks && disk < 64; ++disk) {
+         appendf(text, "%d 1 259:%d / /data/%02d rw,noatime shared:%d - xfs /dev/nvme%dn1p1 rw,attr2,inode64\n",
+                 6 + disk, disk * (size.partitions + 1) + 1, disk, 6 + disk, disk);
+     }
+     
+     for (int id = 70; id < size.mounts + 6; ++id) {
+         unsigned long long pod = random.next(1ULL << 48);
+         switch (random.next(4)) {
+         case 0:
+             appendf(text, "%d 1 0:%d / /var/lib/kubelet/pods/%012llx-5c1f-4e2a-9d3b-%012llx/volumes/"
+                     "kubernetes.io~projected/kube-api-access-%05llx rw,relatime shared:%d - tmpfs tmpfs "
+                     "rw,size=1048576k,inode64\n", id, 100 + id, pod, pod ^ 0xabcdef, pod % 100000, id);
+             break;
+         case 1:
+             appendf(text, "%d 1 0:%d / /run/containerd/io.containerd.runtime.v2.task/k8s.io/%016llx/rootfs "
+                     "rw,relatime shared:%d - overlay overlay rw,lowerdir=/var/lib/containerd/snapshots/%llu/fs,"
+                     "upperdir=/var/lib/containerd/snapshots/%llu/fs,workdir=/var/lib/containerd/snapshots/%llu/work\n",
+                     id, 100 + id, pod, id, pod % 100000, pod % 100000 + 1, pod % 100000 + 1);
+             break;
+         case 2:
+             appendf(text, "%d 1 0:%d / /run/netns/cni-%08llx-%04llx rw shared:%d - nsfs nsfs rw\n",
+                     id, 4, pod & 0xffffffff, pod >> 32, id);
+             break;
+         default:
+             appendf(text, "%d 1 259:%d /volumes/pvc-%012llx /var/lib/kubelet/pods/%012llx/volumes/"
+                     "kubernetes.io~csi/pvc\\040data/mount rw,noatime shared:%d - xfs /dev/nvme%llun1p1 rw,attr2\n",
+                     id, 6, pod, pod ^ 0x5a5a5a, id, size.disks > 1 ? 1 + pod % (size.disks - 1) : 0ULL);
+             break;
+         }
+     }
+     return writeFile(proc + "/1/mountinfo", text);
+ }
+ 
+ bool writeDisks(const std::string& root, const FixtureSize& size, Random& random) {
+     std::string diskstats;
+     std::string block = root + "/sys/block";
+     char name[32];
+     char part[48];
+     std::string text;
+     
+     for (int disk = 0; disk < size.disks; ++disk) {
+         snprintf(name, sizeof(name), "nvme%dn1", disk);
+         std::string dev = block + "/" + name;
+         if (!makeDirs(dev + "/queue") || !makeDirs(dev + "/device")) return false;
+         for (int queue = 0; queue < 16; ++queue) {
+             if (!makeDirs(dev + "/mq/" + std::to_string(queue))) return false;
+         }
+         
+         bool ok = writeFile(dev + "/size", "7501476528\n") &&
+                   writeFile(dev + "/removable", "0\n") &&
+                   writeFile(dev + "/device/model", "SAMSUNG MZQL23T8HCLS-00A07\n") &&
+                   writeFile(dev + "/queue/rotational", "0\n") &&
+                   writeFile(dev + "/queue/scheduler", "[none] mq-deadline kyber\n") &&
+                   writeFile(dev + "/queue/nr_requests", "1023\n") &&
+                   writeFile(dev + "/queue/logical_block_size", "4096\n") &&
+                   writeFile(dev + "/queue/physical_block_size", "4096\n") &&
+                   writeFile(dev + "/queue/optimal_io_size", "131072\n") &&
+                   writeFile(dev + "/queue/discard_max_bytes", "2199023255040\n") &&
+                   writeFile(dev + "/queue/write_cache", "write back\n") &&
+                   writeFile(dev + "/queue/io_poll", "0\n") &&
+                   writeFile(dev + "/queue/zoned", "none\n");
+         if (!ok) return false;
+         
+         int minor = disk * (size.partitions + 1);
+         text.clear();
+         appendf(text, "259 %d %s", minor, name);
+         for (int field = 0; field < 17; ++field) appendf(text, " %llu", random.next(1ULL << 36));
+         diskstats += text + "\n";
+         
+         for (int p = 1; p <= size.partitions; ++p) {
+             snprintf(part, sizeof(part), "%sp%d", name, p);
+             if (!makeDirs(dev + "/" + part) || !writeFile(dev + "/" + part + "/partition", std::to_string(p) + "\n")) {
+                 return false;
+             }
+             text.clear();
+             appendf(text, "259 %d %s", minor + p, part);
+             for (int field = 0; field < 17; ++field) appendf(text, " %llu", random.next(1ULL << 34));
+             diskstats += text + "\n";
+         }
+     }
+     return writeFile(root + "/proc/diskstats", diskstats);
+ }
+ 
+ }
+ 
+ bool writeFixtures(const std::string& root, const FixtureSize& size) {
+     Random random;
+     std::string proc = root + "/proc";
+     if (!makeDirs(proc) || !makeDirs(root + "/etc")) return false;
+     
+     return writeCpu(proc, size, random) &&
+            writeMemory(proc, random) &&
+            writeMounts(proc, size, random) &&
+            writeDisks(root, size, random) &&
+            writeProcesses(proc, size, random) &&
+            writeFile(root + "/etc/os-release",
+                      "PRETTY_NAME=\"Ubuntu 24.04.1 LTS\"\nNAME=\"Ubuntu\"\nVERSION_ID=\"24.04\"\n"
+                      "VERSION=\"24.04.1 LTS (Noble Numbat)\"\nVERSION_CODENAME=noble\nID=ubuntu\n"
+                      "ID_LIKE=debian\nHOME_URL=\"https://www.ubuntu.com/\"\n"
+                      "SUPPORT_URL=\"https://help.ubuntu.com/\"\n"
+                      "BUG_REPORT_URL=\"https://bugs.launchpad.net/ubuntu/\"\nUBUNTU_CODENAME=noble\n");
+ }
@@ -0,0 +1,36 @@
+/*
+ * fixtures - Synthetic /proc, /sys and /etc trees of a large machine
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef FIXTURES_HPP
+ #define FIXTURES_HPP
+ 
+ #include <string>
+ 
+ /**
+  * Size of the machine a fixture tree describes
+  */
+ struct FixtureSize {
+     int cpus;                // Logical CPUs in /proc/cpuinfo and /proc/stat
+     int processes;           // /proc/PID directories
+     int mounts;              // Lines of /proc/1/mountinfo
+     int disks;               // NVMe namespaces in /sys/block and /proc/diskstats
+     int partitions;          // Partitions of each disk
+     
+     FixtureSize() : cpus(256), processes(50000), mounts(5000), disks(64), partitions(4) {}
+ };
+ 
+ /**
+  * Write a tree to point setSystemRoot at. The files follow the kernel's
+  * formats for a dual-socket x86 server running many containers; values
+  * come from a fixed-seed generator, so every run reads the same tree.
+  * @param root Existing empty directory
+  * @param size Machine to describe
+  * @return false with errno set if a file could not be written
+  */
+ bool writeFixtures(const std::string& root, const FixtureSize& size);
+ 
+ #endif // FIXTURES_HPP
@@ -0,0 +1,154 @@
+/*
+ * cgroup - Shared cgroup v2 reader
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "cgroup.hpp"
+ #include "stats.hpp"
+ #include "procfs.hpp"
+ 
+ #include <algorithm>
+ #include <cstdlib>
+ #include <cstring>
+ #include <fstream>
+ #include <stdexcept>
+ #include <unistd.h>
+ #include <sys/stat.h>
+ 
+ namespace {
+ 
+ // --stats timing of the collectors in this file
+ StatSection resolve_section("resolveCgroup");
+ StatSection top_cgroups_section("topCgroups");
+ 
+ bool usageGreater(const CgroupUsage& a, const CgroupUsage& b) {
+     return a.value > b.value;
+ }
+ 
+ // Depth-first walk keeping a min-heap of the best entries, so a cgroup is
+ // only copied into the result when it beats the current limit-th value
+ void walkCgroups(const SysfsDir& dir, std::string& path, size_t limit, CgroupMetric metric,
+                  std::vector<CgroupUsage>& heap) {
+     std::vector<std::string> children;
+     if (!dir.listDirectories(children)) return;
+ 
+     SysfsDir child;
+     for (const auto& name : children) {
+         if (!child.open(dir, name.c_str())) continue;
+ 
+         size_t length = path.size();
+         if (!path.empty()) path += '/';
+         path += name;
+ 
+         unsigned long long value;
+         if (metric(child, value) && (heap.size() < limit || value > heap.front().value)) {
+             if (heap.size() >= limit) {
+                 std::pop_heap(heap.begin(), heap.end(), usageGreater);
+                 heap.pop_back();
+             }
+             CgroupUsage usage;
+             usage.path = path;
+             usage.value = value;
+             heap.push_back(std::move(usage));
+             std::push_heap(heap.begin(), heap.end(), usageGreater);
+         }
+ 
+         walkCgroups(child, path, limit, metric, heap);
+         path.resize(length);
+     }
+ }
+ 
+ }
+ 
+ std::string findCgroupMount() {
+     int fd = -1;
+     std::vector<char> buf;
+     if (openProcFile(fd, "/proc/self/mountinfo") < 0) return "";
+     ssize_t len = readProcFile(fd, buf);
+     close(fd);
+     if (len < 0) return "";
+     
+     const char* p = buf.data();
+     MountEntry entry;
+     while (nextMountEntry(p, entry)) {
+         if (entry.filesystem == "cgroup2") return unescapeMountField(entry.mountpoint);
+     }
+     return "";
+ }
+ 
+ std::string resolveCgroup(const std::string& spec) {
+     StatTimer timer(resolve_section);
+     // A directory path of the cgroup2 filesystem is used as given
+     struct stat st;
+     if (!spec.empty() && spec[0] == '/' && stat(systemPath((spec + "/cgroup.controllers").c_str()).c_str(), &st) == 0) {
+         return spec;
+     }
+ 
+     std::string mount = findCgroupMount();
+     if (mount.empty()) {
+         throw std::runtime_error("cgroup v2 hierarchy is not mounted");
+     }
+     if (!spec.empty()) {
+         size_t start = spec.find_first_not_of('/');
+         return start == std::string::npos ? mount : mount + "/" + spec.substr(start);
+     }
+ 
+     // The unified hierarchy is the "0::" line of /proc/self/cgroup
+     std::ifstream file(systemPath("/proc/self/cgroup"));
+     std::string line;
+     while (std::getline(file, line)) {
+         if (line.compare(0, 3, "0::") == 0) {
+             std::string path = line.substr(3);
+             return path == "/" ? mount : mount + path;
+         }
+     }
+     throw std::runtime_error("cannot find own cgroup in /proc/self/cgroup");
+ }
+ 
+ bool cgroupStatValue(const char* text, const char* key, unsigned long long& value) {
+     size_t key_len = std::strlen(key);
+     for (const char* line = text; *line; ) {
+         if (std::strncmp(line, key, key_len) == 0 && line[key_len] == ' ') {
+             return parseUnsigned(line + key_len + 1, value);
+         }
+         line = std::strchr(line, '\n');
+         if (!line) break;
+         ++line;
+     }
+     return false;
+ }
+ 
+ bool readCgroupLimit(const SysfsDir& dir, const char* name, unsigned long long& value) {
+     char buf[64];
+     if (dir.read(name, buf, sizeof(buf)) <= 0) return false;
+ 
+     if (std::strcmp(buf, "max") == 0) {
+         value = CGROUP_UNLIMITED;
+         return true;
+     }
+     return parseUnsigned(buf, value);
+ }
+ 
+ bool parsePressure(const char* text, double& some, double& full) {
+     const char* some_line = std::strstr(text, "some avg10=");
+     const char* full_line = std::strstr(text, "full avg10=");
+     some = some_line ? std::strtod(some_line + 11, nullptr) : 0.0;
+     full = full_line ? std::strtod(full_line + 11, nullptr) : 0.0;
+     return some_line != nullptr;
+ }
+ 
+ std::vector<CgroupUsage> topCgroups(const std::string& root, size_t limit, CgroupMetric metric) {
+     StatTimer timer(top_cgroups_section);
+     std::vector<CgroupUsage> heap;
+     SysfsDir dir;
+     if (limit == 0 || !dir.open(root.c_str())) return heap;
+ 
+     heap.reserve(limit);
+     std::string path;
+     walkCgroups(dir, path, limit, metric, heap);
+ 
+     std::sort_heap(heap.begin(), heap.end(), usageGreater);
+     return heap;
+ }
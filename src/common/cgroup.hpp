@@ -0,0 +1,91 @@
+/*
+ * cgroup - Shared cgroup v2 reader
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef CGROUP_HPP
+ #define CGROUP_HPP
+ 
+ #include <string>
+ #include <vector>
+ 
+ #include "sysfs.hpp"
+ 
+ // Value stored for "max" in cgroup limit files
+ const unsigned long long CGROUP_UNLIMITED = ~0ULL;
+ 
+ /**
+  * cgroup below the walk root with the value it was ranked by
+  */
+ struct CgroupUsage {
+     std::string path;        // Relative to the walk root
+     unsigned long long value;
+     
+     CgroupUsage() : value(0) {}
+ };
+ 
+ /**
+  * Read the ranking value of one cgroup directory
+  * @param dir Open cgroup directory
+  * @param value Where to store the value
+  * @return false to leave the cgroup out of the ranking
+  */
+ typedef bool (*CgroupMetric)(const SysfsDir& dir, unsigned long long& value);
+ 
+ /**
+  * Find the cgroup2 mount point in /proc/self/mountinfo
+  * @return Mount point, empty if no cgroup2 filesystem is mounted
+  */
+ std::string findCgroupMount();
+ 
+ /**
+  * Resolve a --cgroup argument to a cgroup directory
+  * @param spec Empty for the cgroup of this process, a directory of the
+  *             cgroup2 filesystem, or a path below the cgroup2 mount
+  * @return Directory path
+  * @throws std::runtime_error if cgroup v2 is not available
+  */
+ std::string resolveCgroup(const std::string& spec);
+ 
+ /**
+  * Look up a key in flat keyed text such as memory.stat or cpu.stat
+  * @param text NUL-terminated "key value" lines
+  * @param key Key to find
+  * @param value Where to store the value
+  * @return true if the key was found
+  */
+ bool cgroupStatValue(const char* text, const char* key, unsigned long long& value);
+ 
+ /**
+  * Read a single-value limit file such as memory.max
+  * @param dir Open cgroup directory
+  * @param name File name
+  * @param value Where to store the value, CGROUP_UNLIMITED for "max"
+  * @return true if the file was read
+  */
+ bool readCgroupLimit(const SysfsDir& dir, const char* name, unsigned long long& value);
+ 
+ /**
+  * Parse the avg10 fields of PSI text from /proc/pressure or *.pressure
+  * @param text NUL-terminated "some ..." and "full ..." lines
+  * @param some Where to store the "some" stall percentage
+  * @param full Where to store the "full" stall percentage
+  * @return true if a "some" line was found
+  */
+ bool parsePressure(const char* text, double& some, double& full);
+ 
+ /**
+  * Rank the cgroups below a root by a metric. The tree is walked with
+  * openat relative to each parent and only the best limit entries are
+  * kept, so the cost is one directory listing and one metric read per
+  * cgroup however large the tree is.
+  * @param root Directory to walk; the root itself is not ranked
+  * @param limit Number of cgroups to return
+  * @param metric Function reading the value of a cgroup
+  * @return Cgroups sorted by decreasing value
+  */
+ std::vector<CgroupUsage> topCgroups(const std::string& root, size_t limit, CgroupMetric metric);
+ 
+ #endif // CGROUP_HPP
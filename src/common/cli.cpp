@@ -0,0 +1,45 @@
+/*
+ * cli - Shared command line and watch interval helpers of the tools
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "cli.hpp"
+ #include "output.hpp"
+ 
+ #include <cerrno>
+ #include <cstdlib>
+ #include <iostream>
+ 
+ std::string optionValue(const char* program, int argc, char* argv[], int& i, const std::string& arg,
+                         const std::string& name, bool colors) {
+     size_t equals = arg.find('=');
+     if (equals != std::string::npos) {
+         return arg.substr(equals + 1);
+     }
+     if (i + 1 >= argc) {
+         std::cerr << colorize(std::string(program) + ": option requires an argument -- '" + name + "'",
+                               Colors::RED, colors) << '\n';
+         std::cerr << "Try '" << program << " --help' for more information." << '\n';
+         exit(1);
+     }
+     return argv[++i];
+ }
+ 
+ void invalidValue(const char* program, const std::string& name, const std::string& value, bool colors) {
+     std::cerr << colorize(std::string(program) + ": invalid " + name + " -- '" + value + "'", Colors::RED, colors) << '\n';
+     std::cerr << "Try '" << program << " --help' for more information." << '\n';
+     exit(1);
+ }
+ 
+ void waitForNextTick(struct timespec& deadline, double interval) {
+     long interval_ns = static_cast<long>(interval * 1e9);
+     deadline.tv_sec += interval_ns / 1000000000L;
+     deadline.tv_nsec += interval_ns % 1000000000L;
+     if (deadline.tv_nsec >= 1000000000L) {
+         deadline.tv_sec++;
+         deadline.tv_nsec -= 1000000000L;
+     }
+     while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+ }
@@ -0,0 +1,49 @@
+/*
+ * cli - Shared command line and watch interval helpers of the tools
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef CLI_HPP
+ #define CLI_HPP
+ 
+ #include <string>
+ #include <ctime>
+ 
+ /**
+  * Get the value of an option given as "--option=value" or "--option value";
+  * a missing value is reported as "PROGRAM: option requires an argument"
+  * and exits with status 1
+  * @param program Program name for the error message
+  * @param argc Argument count
+  * @param argv Argument values
+  * @param i Index of the option, advanced past a separate value
+  * @param arg The option argument itself
+  * @param name Option name for error messages
+  * @param colors Whether the error may be printed in red
+  * @return Option value
+  */
+ std::string optionValue(const char* program, int argc, char* argv[], int& i, const std::string& arg,
+                         const std::string& name, bool colors);
+ 
+ /**
+  * Report an invalid option value and exit with status 1
+  * @param program Program name for the error message
+  * @param name Option name
+  * @param value Rejected value
+  * @param colors Whether the error may be printed in red
+  */
+ [[noreturn]] void invalidValue(const char* program, const std::string& name, const std::string& value,
+                                bool colors);
+ 
+ /**
+  * Sleep until the next tick of a watch interval. Ticks follow an absolute
+  * CLOCK_MONOTONIC deadline, so time spent sampling does not make the
+  * interval drift.
+  * @param deadline Absolute CLOCK_MONOTONIC deadline, advanced by one interval
+  * @param interval Interval in seconds
+  */
+ void waitForNextTick(struct timespec& deadline, double interval);
+ 
+ #endif // CLI_HPP
@@ -0,0 +1,487 @@
+/*
+ * cpu - Shared CPU collectors for /proc/cpuinfo, /proc/stat and cpufreq
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "cpu.hpp"
+ #include "stats.hpp"
+ #include "procfs.hpp"
+ #include "cgroup.hpp"
+ 
+ #include <algorithm>
+ #include <cctype>
+ #include <cstdlib>
+ #include <cstring>
+ #include <string_view>
+ #include <unistd.h>
+ #include <fcntl.h>
+ 
+ namespace {
+ 
+ // --stats timing of the collectors in this file
+ StatSection cpu_info_section("readCpuInfo");
+ StatSection cpu_load_section("CpuSampler::load");
+ StatSection cpu_frequency_section("CpuSampler::frequencies");
+ 
+ // Keys of /proc/cpuinfo that parseCpuInfo() uses
+ enum CpuInfoKey {
+     KEY_OTHER, KEY_PROCESSOR, KEY_VENDOR_ID, KEY_CPU_FAMILY, KEY_MODEL,
+     KEY_MODEL_NAME, KEY_STEPPING, KEY_MICROCODE, KEY_CPU_MHZ, KEY_CACHE_SIZE,
+     KEY_PHYSICAL_ID, KEY_SIBLINGS, KEY_CORE_ID, KEY_FLAGS
+ };
+ 
+ // Key length and first character identify every known key, so at most
+ // one string comparison is needed per line
+ CpuInfoKey classifyCpuInfoKey(std::string_view key) {
+     switch (key.size()) {
+         case 5:
+             if (key == "model") return KEY_MODEL;
+             if (key == "flags") return KEY_FLAGS;
+             break;
+         case 7:
+             if (key[0] == 'c' && key[1] == 'p' && key == "cpu MHz") return KEY_CPU_MHZ;
+             if (key[0] == 'c' && key[1] == 'o' && key == "core id") return KEY_CORE_ID;
+             break;
+         case 8:
+             if (key[1] == 't' && key == "stepping") return KEY_STEPPING;
+             if (key[1] == 'i' && key == "siblings") return KEY_SIBLINGS;
+             break;
+         case 9:
+             if (key[0] == 'p' && key == "processor") return KEY_PROCESSOR;
+             if (key[0] == 'v' && key == "vendor_id") return KEY_VENDOR_ID;
+             if (key[0] == 'm' && key == "microcode") return KEY_MICROCODE;
+             break;
+         case 10:
+             if (key[1] == 'p' && key == "cpu family") return KEY_CPU_FAMILY;
+             if (key[0] == 'm' && key == "model name") return KEY_MODEL_NAME;
+             if (key[1] == 'a' && key == "cache size") return KEY_CACHE_SIZE;
+             break;
+         case 11:
+             if (key == "physical id") return KEY_PHYSICAL_ID;
+             break;
+     }
+     return KEY_OTHER;
+ }
+ 
+ unsigned int parseUnsignedField(std::string_view value) {
+     unsigned int result = 0;
+     for (char c : value) {
+         if (c < '0' || c > '9') break;
+         result = result * 10 + (c - '0');
+     }
+     return result;
+ }
+ 
+ // Parse up to max unsigned counters from p to the end of the line and
+ // leave p at the start of the next line. Returns the number stored.
+ int parseCounters(const char*& p, const char* end, unsigned long long* out, int max) {
+     int n = 0;
+     while (p < end && *p != '\n') {
+         if (*p >= '0' && *p <= '9') {
+             unsigned long long value = 0;
+             while (p < end && *p >= '0' && *p <= '9') {
+                 value = value * 10 + (*p - '0');
+                 ++p;
+             }
+             if (n < max) out[n++] = value;
+         } else {
+             ++p;
+         }
+     }
+     if (p < end) ++p;
+     return n;
+ }
+ 
+ // Match "key value" at the start of line and store value
+ bool counterLine(const char* line, const char* key, size_t key_len, unsigned long long& value) {
+     if (std::strncmp(line, key, key_len) != 0) return false;
+     const char* p = line + key_len;
+     value = parseNumber(p);
+     return true;
+ }
+ 
+ }
+ 
+ void SamplerPool::chunk(size_t slot, size_t& begin, size_t& end) const {
+     size_t slots = workers.size() + 1;
+     begin = job_size * slot / slots;
+     end = job_size * (slot + 1) / slots;
+ }
+ 
+ void SamplerPool::workerLoop(size_t slot) {
+     unsigned long seen = 0;
+     for (;;) {
+         size_t begin, end;
+         {
+             std::unique_lock<std::mutex> lock(mutex);
+             wake.wait(lock, [&] { return stopping || generation != seen; });
+             if (stopping) return;
+             seen = generation;
+             chunk(slot, begin, end);
+         }
+ 
+         if (begin < end) job(begin, end);
+ 
+         std::lock_guard<std::mutex> lock(mutex);
+         if (--busy == 0) finished.notify_one();
+     }
+ }
+ 
+ SamplerPool::SamplerPool(unsigned threads) : job_size(0), generation(0), busy(0), stopping(false) {
+     for (unsigned i = 0; i < threads; ++i) {
+         workers.emplace_back(&SamplerPool::workerLoop, this, i + 1);
+     }
+ }
+ 
+ SamplerPool::~SamplerPool() {
+     {
+         std::lock_guard<std::mutex> lock(mutex);
+         stopping = true;
+     }
+     wake.notify_all();
+     for (auto& worker : workers) worker.join();
+ }
+ 
+ void SamplerPool::run(size_t size, const std::function<void(size_t, size_t)>& fn) {
+     {
+         std::lock_guard<std::mutex> lock(mutex);
+         job = fn;
+         job_size = size;
+         busy = workers.size();
+         generation++;
+     }
+     wake.notify_all();
+ 
+     size_t begin, end;
+     chunk(0, begin, end);
+     if (begin < end) fn(begin, end);
+ 
+     std::unique_lock<std::mutex> lock(mutex);
+     finished.wait(lock, [&] { return busy == 0; });
+ }
+ 
+ CpuInfo parseCpuInfo(const char* data, size_t len) {
+     CpuInfo info;
+ 
+     // Distinct cores are (physical id << 32 | core id) keys, sorted at the end
+     std::vector<unsigned long long> cores;
+     unsigned long long physical_id = 0;
+ 
+     std::string_view text(data, len);
+     while (!text.empty()) {
+         size_t eol = text.find('\n');
+         std::string_view line = text.substr(0, eol);
+         text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+ 
+         size_t colon = line.find(':');
+         if (colon == std::string_view::npos) continue;
+ 
+         std::string_view key = line.substr(0, colon);
+         while (!key.empty() && (key.back() == ' ' || key.back() == '\t')) key.remove_suffix(1);
+         std::string_view value = line.substr(colon + 1);
+         while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+ 
+         CpuInfoKey id = classifyCpuInfoKey(key);
+         if (id == KEY_PROCESSOR) {
+             info.logical_cores++;
+             continue;
+         }
+         if (id == KEY_PHYSICAL_ID) {
+             physical_id = parseUnsignedField(value);
+             continue;
+         }
+         if (id == KEY_CORE_ID) {
+             cores.push_back(physical_id << 32 | parseUnsignedField(value));
+             continue;
+         }
+ 
+         // Everything else describes the first processor
+         if (info.logical_cores > 1) continue;
+ 
+         switch (id) {
+             case KEY_VENDOR_ID: info.vendor_id = value; break;
+             case KEY_CPU_FAMILY: info.cpu_family = value; break;
+             case KEY_MODEL: info.model = value; break;
+             case KEY_MODEL_NAME: info.model_name = value; break;
+             case KEY_STEPPING: info.stepping = value; break;
+             case KEY_MICROCODE: info.microcode = value; break;
+             case KEY_CACHE_SIZE: info.cache_size = value; break;
+             case KEY_CPU_MHZ: info.cpu_mhz = std::strtod(value.data(), nullptr); break;
+             case KEY_SIBLINGS: info.siblings = parseUnsignedField(value); break;
+             case KEY_FLAGS:
+                 // Kept as one string; callers that ask about a feature use
+                 // hostCpuFeatures() instead of searching it
+                 while (!value.empty()) {
+                     size_t space = value.find(' ');
+                     if (space != 0) {
+                         if (!info.flags.empty()) info.flags += ' ';
+                         info.flags.append(value.substr(0, space));
+                     }
+                     value.remove_prefix(space == std::string_view::npos ? value.size() : space + 1);
+                 }
+                 break;
+             default:
+                 break;
+         }
+     }
+ 
+     std::sort(cores.begin(), cores.end());
+     info.physical_cores = std::unique(cores.begin(), cores.end()) - cores.begin();
+     if (info.physical_cores == 0) {
+         info.physical_cores = info.logical_cores;
+     }
+ 
+     return info;
+ }
+ 
+ CpuInfo readCpuInfo() {
+     StatTimer timer(cpu_info_section);
+     int fd = openSystemFile("/proc/cpuinfo", O_RDONLY | O_CLOEXEC);
+     if (fd < 0) return CpuInfo();
+ 
+     // Roughly 1.5 KB per processor on x86, so size the buffer up front
+     long cpus = sysconf(_SC_NPROCESSORS_CONF);
+     std::vector<char> buf(cpus > 0 ? cpus * 2048 + 4096 : 65536);
+     ssize_t len = readProcFile(fd, buf);
+     close(fd);
+     if (len <= 0) return CpuInfo();
+ 
+     return parseCpuInfo(buf.data(), len);
+ }
+ 
+ bool parseProcStat(const char* text, size_t len, CpuLoad& load,
+                    CpuStatTable* per_cpu, ProcStatCounters* counters) {
+     if (std::strncmp(text, "cpu ", 4) != 0) return false;
+ 
+     const char* p = text + 4;
+     const char* end = text + len;
+     unsigned long long aggregate[CPU_COUNTER_COUNT] = {};
+     parseCounters(p, end, aggregate, CPU_COUNTER_COUNT);
+ 
+     load.user = aggregate[CPU_USER];
+     load.nice = aggregate[CPU_NICE];
+     load.system = aggregate[CPU_SYSTEM];
+     load.idle = aggregate[CPU_IDLE];
+     load.iowait = aggregate[CPU_IOWAIT];
+     load.irq = aggregate[CPU_IRQ];
+     load.softirq = aggregate[CPU_SOFTIRQ];
+     load.steal = aggregate[CPU_STEAL];
+     load.guest = aggregate[CPU_GUEST];
+     load.guest_nice = aggregate[CPU_GUEST_NICE];
+ 
+     unsigned long long total = totalJiffies(load);
+     if (total > 0) {
+         load.cpu_usage = (double)(total - idleJiffies(load)) / total * 100.0;
+     }
+ 
+     if (per_cpu) {
+         size_t rows = 0;
+         while (end - p > 3 && std::strncmp(p, "cpu", 3) == 0 &&
+                p[3] >= '0' && p[3] <= '9') {
+             int cpu = 0;
+             for (p += 3; p < end && *p >= '0' && *p <= '9'; ++p) {
+                 cpu = cpu * 10 + (*p - '0');
+             }
+ 
+             unsigned long long row[CPU_COUNTER_COUNT] = {};
+             parseCounters(p, end, row, CPU_COUNTER_COUNT);
+ 
+             if (rows == per_cpu->size()) per_cpu->resize(rows + 1);
+             per_cpu->cpu[rows] = cpu;
+             for (int counter = 0; counter < CPU_COUNTER_COUNT; ++counter) {
+                 per_cpu->counters[counter][rows] = row[counter];
+             }
+             rows++;
+         }
+         if (rows != per_cpu->size()) per_cpu->resize(rows);
+     }
+ 
+     // The remaining lines are "key value"; the long intr and softirq
+     // lines are skipped with memchr
+     if (counters) {
+         while (p < end) {
+             switch (*p) {
+                 case 'b': counterLine(p, "btime ", 6, counters->boot_time); break;
+                 case 'c': counterLine(p, "ctxt ", 5, counters->context_switches); break;
+                 case 'p':
+                     counterLine(p, "processes ", 10, counters->processes) ||
+                     counterLine(p, "procs_running ", 14, counters->procs_running) ||
+                     counterLine(p, "procs_blocked ", 14, counters->procs_blocked);
+                     break;
+             }
+             const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+             p = eol ? eol + 1 : end;
+         }
+     }
+ 
+     return true;
+ }
+ 
+ void parseLoadAvg(const char* text, CpuLoad& load) {
+     char* p = const_cast<char*>(text);
+     load.load1 = std::strtod(p, &p);
+     load.load5 = std::strtod(p, &p);
+     load.load15 = std::strtod(p, &p);
+ }
+ 
+ unsigned long long totalJiffies(const CpuLoad& load) {
+     return load.user + load.nice + load.system + load.idle +
+            load.iowait + load.irq + load.softirq + load.steal;
+ }
+ 
+ unsigned long long rowJiffies(const CpuStatTable& table, size_t row) {
+     unsigned long long total = 0;
+     for (int counter = CPU_USER; counter <= CPU_STEAL; ++counter) {
+         total += table.counters[counter][row];
+     }
+     return total;
+ }
+ 
+ unsigned long long idleJiffies(const CpuLoad& load) {
+     return load.idle + load.iowait;
+ }
+ 
+ double deltaPercent(unsigned long long prev, unsigned long long cur, unsigned long long elapsed) {
+     if (elapsed == 0 || cur < prev) return 0.0;
+     return (double)(cur - prev) / elapsed * 100.0;
+ }
+ 
+ CgroupCpuStat parseCgroupCpuStat(const char* text) {
+     CgroupCpuStat stat;
+     cgroupStatValue(text, "usage_usec", stat.usage_usec);
+     cgroupStatValue(text, "user_usec", stat.user_usec);
+     cgroupStatValue(text, "system_usec", stat.system_usec);
+     cgroupStatValue(text, "nr_periods", stat.nr_periods);
+     cgroupStatValue(text, "nr_throttled", stat.nr_throttled);
+     cgroupStatValue(text, "throttled_usec", stat.throttled_usec);
+     return stat;
+ }
+ 
+ // cpu.max is "QUOTA PERIOD" in microseconds, QUOTA being "max" when the
+ // cgroup is not limited
+ double readCgroupCpuLimit(const SysfsDir& dir) {
+     char buf[64];
+     if (dir.read("cpu.max", buf, sizeof(buf)) <= 0 || std::strncmp(buf, "max", 3) == 0) {
+         return 0.0;
+     }
+     
+     char* end = nullptr;
+     double quota = std::strtod(buf, &end);
+     double period = std::strtod(end, nullptr);
+     return period > 0.0 ? quota / period : 0.0;
+ }
+ 
+ bool cgroupCpuMetric(const SysfsDir& dir, unsigned long long& value) {
+     char buf[1024];
+     return dir.read("cpu.stat", buf, sizeof(buf)) > 0 && cgroupStatValue(buf, "usage_usec", value);
+ }
+ 
+ CpuSampler::CpuSampler() : sample_jobs(1), stat_fd(-1), loadavg_fd(-1), freq_files_opened(false) {}
+ 
+ CpuSampler::~CpuSampler() {
+     if (stat_fd >= 0) close(stat_fd);
+     if (loadavg_fd >= 0) close(loadavg_fd);
+     for (const auto& files : freq_files) {
+         if (files.cur_fd >= 0) close(files.cur_fd);
+         if (files.min_fd >= 0) close(files.min_fd);
+         if (files.max_fd >= 0) close(files.max_fd);
+     }
+ }
+ 
+ bool CpuSampler::openStat() {
+     return openProcFile(stat_fd, "/proc/stat") >= 0;
+ }
+ 
+ CpuLoad CpuSampler::load(CpuStatTable* per_cpu, ProcStatCounters* counters) {
+     StatTimer timer(cpu_load_section);
+     CpuLoad load;
+     
+     if (openProcFile(loadavg_fd, "/proc/loadavg") >= 0 &&
+         readProcFile(loadavg_fd, loadavg_buf) > 0) {
+         parseLoadAvg(loadavg_buf.data(), load);
+     }
+     
+     ssize_t len;
+     if (openProcFile(stat_fd, "/proc/stat") >= 0 &&
+         (len = readProcFile(stat_fd, stat_buf)) > 0) {
+         parseProcStat(stat_buf.data(), len, load, per_cpu, counters);
+     }
+     
+     return load;
+ }
+ 
+ void CpuSampler::openFrequencyFiles() {
+     if (freq_files_opened) return;
+     freq_files_opened = true;
+ 
+     SysfsDir cpu_dir;
+     std::vector<std::string> names;
+     if (!cpu_dir.open("/sys/devices/system/cpu") || !cpu_dir.list(names)) return;
+ 
+     SysfsDir freq_dir;
+     for (const auto& entry : names) {
+         const char* name = entry.c_str();
+         if (std::strncmp(name, "cpu", 3) != 0 || !std::isdigit(name[3])) continue;
+ 
+         std::string path = entry + "/cpufreq";
+         if (!freq_dir.open(cpu_dir, path.c_str())) continue;
+ 
+         CpuFreqFiles files;
+         files.cpu = std::atoi(name + 3);
+         files.cur_fd = freq_dir.openFile("scaling_cur_freq");
+         files.min_fd = freq_dir.openFile("scaling_min_freq");
+         files.max_fd = freq_dir.openFile("scaling_max_freq");
+         freq_dir.readString("scaling_governor", files.governor);
+         freq_dir.readString("scaling_driver", files.driver);
+ 
+         freq_files.push_back(std::move(files));
+     }
+ 
+     std::sort(freq_files.begin(), freq_files.end(),
+               [](const CpuFreqFiles& a, const CpuFreqFiles& b) {
+                   return a.cpu < b.cpu;
+               });
+ 
+     if (sample_jobs > 1 && freq_files.size() > 1) {
+         sampler_pool = std::make_unique<SamplerPool>(sample_jobs - 1);
+     }
+ }
+ 
+ void CpuSampler::sampleFrequencies(std::vector<CpuFrequency>& samples) {
+     StatTimer timer(cpu_frequency_section);
+     openFrequencyFiles();
+     samples.resize(freq_files.size());
+ 
+     auto sample = [&](size_t begin, size_t end) {
+         for (size_t i = begin; i < end; ++i) {
+             const CpuFreqFiles& files = freq_files[i];
+             CpuFrequency& freq = samples[i];
+             unsigned long long khz;
+ 
+             freq.cpu = files.cpu;
+             freq.current_mhz = SysfsDir::rereadUnsigned(files.cur_fd, khz) ? khz / 1000.0 : 0.0;
+             freq.min_mhz = SysfsDir::rereadUnsigned(files.min_fd, khz) ? khz / 1000.0 : 0.0;
+             freq.max_mhz = SysfsDir::rereadUnsigned(files.max_fd, khz) ? khz / 1000.0 : 0.0;
+         }
+     };
+ 
+     if (sampler_pool) {
+         sampler_pool->run(samples.size(), sample);
+     } else {
+         sample(0, samples.size());
+     }
+ }
+ 
+ std::vector<CpuFrequency> CpuSampler::frequencies() {
+     std::vector<CpuFrequency> frequencies;
+     sampleFrequencies(frequencies);
+ 
+     for (size_t i = 0; i < frequencies.size(); ++i) {
+         frequencies[i].governor = freq_files[i].governor;
+         frequencies[i].driver = freq_files[i].driver;
+     }
+ 
+     return frequencies;
+ }
@@ -0,0 +1,359 @@
+/*
+ * cpu - Shared CPU collectors for /proc/cpuinfo, /proc/stat and cpufreq
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef CPU_HPP
+ #define CPU_HPP
+ 
+ #include <string>
+ #include <vector>
+ #include <memory>
+ #include <functional>
+ #include <thread>
+ #include <mutex>
+ #include <condition_variable>
+ #include <sys/types.h>
+ 
+ #include "sysfs.hpp"
+ 
+ /**
+  * Structure to hold CPU information from /proc/cpuinfo
+  */
+ struct CpuInfo {
+     std::string model_name;
+     std::string vendor_id;
+     std::string cpu_family;
+     std::string model;
+     std::string stepping;
+     std::string microcode;
+     std::string cache_size;
+     std::string flags;           // Flags line, one space between flags
+     double cpu_mhz;
+     int physical_cores;
+     int logical_cores;
+     int siblings;
+     int core_id;
+     std::string architecture;
+     std::string byte_order;
+     std::string virtualization;
+ 
+     CpuInfo() : cpu_mhz(0.0), physical_cores(0), logical_cores(0), 
+                 siblings(0), core_id(0) {}
+ };
+ 
+ /**
+  * Structure to hold CPU load information
+  */
+ struct CpuLoad {
+     double load1;
+     double load5;
+     double load15;
+     double cpu_usage;
+     unsigned long long user;
+     unsigned long long nice;
+     unsigned long long system;
+     unsigned long long idle;
+     unsigned long long iowait;
+     unsigned long long irq;
+     unsigned long long softirq;
+     unsigned long long steal;
+     unsigned long long guest;
+     unsigned long long guest_nice;
+ 
+     CpuLoad() : load1(0.0), load5(0.0), load15(0.0), cpu_usage(0.0),
+                 user(0), nice(0), system(0), idle(0), iowait(0), irq(0), softirq(0),
+                 steal(0), guest(0), guest_nice(0) {}
+ };
+ 
+ /**
+  * Jiffy counters of a /proc/stat cpu line, in file order
+  */
+ enum CpuCounter {
+     CPU_USER, CPU_NICE, CPU_SYSTEM, CPU_IDLE, CPU_IOWAIT, CPU_IRQ,
+     CPU_SOFTIRQ, CPU_STEAL, CPU_GUEST, CPU_GUEST_NICE, CPU_COUNTER_COUNT
+ };
+ 
+ /**
+  * Per-CPU counters from the cpuN lines of /proc/stat, stored as one array
+  * per counter so a sample of hundreds of CPUs fills a few flat vectors
+  */
+ struct CpuStatTable {
+     std::vector<int> cpu;
+     std::vector<unsigned long long> counters[CPU_COUNTER_COUNT];
+ 
+     size_t size() const { return cpu.size(); }
+ 
+     void resize(size_t rows) {
+         cpu.resize(rows);
+         for (auto& column : counters) column.resize(rows);
+     }
+ };
+ 
+ /**
+  * System-wide counters from the lines of /proc/stat after the cpu lines
+  */
+ struct ProcStatCounters {
+     unsigned long long boot_time;        // btime, seconds since the epoch
+     unsigned long long context_switches; // ctxt
+     unsigned long long processes;        // Forks since boot
+     unsigned long long procs_running;
+     unsigned long long procs_blocked;
+ 
+     ProcStatCounters() : boot_time(0), context_switches(0), processes(0),
+                          procs_running(0), procs_blocked(0) {}
+ };
+ 
+ /**
+  * Structure to hold CPU frequency information
+  */
+ struct CpuFrequency {
+     int cpu;
+     double current_mhz;
+     double min_mhz;
+     double max_mhz;
+     std::string governor;
+     std::string driver;
+ 
+     CpuFrequency() : cpu(0), current_mhz(0.0), min_mhz(0.0), max_mhz(0.0) {}
+ };
+ 
+ /**
+  * Counters of a cgroup cpu.stat; the nr_* fields need the cpu controller
+  */
+ struct CgroupCpuStat {
+     unsigned long long usage_usec;
+     unsigned long long user_usec;
+     unsigned long long system_usec;
+     unsigned long long nr_periods;      // Enforcement periods elapsed
+     unsigned long long nr_throttled;    // Periods in which the quota ran out
+     unsigned long long throttled_usec;
+ 
+     CgroupCpuStat() : usage_usec(0), user_usec(0), system_usec(0), nr_periods(0),
+                       nr_throttled(0), throttled_usec(0) {}
+ };
+ 
+ /**
+  * Structure to hold the cpufreq attribute files of one CPU
+  */
+ struct CpuFreqFiles {
+     int cpu;
+     int cur_fd;
+     int min_fd;
+     int max_fd;
+     std::string governor;
+     std::string driver;
+ 
+     CpuFreqFiles() : cpu(0), cur_fd(-1), min_fd(-1), max_fd(-1) {}
+ };
+ 
+ /**
+  * Small persistent worker pool that splits an index range between its
+  * threads and the caller. Workers sleep between rounds, so watch mode does
+  * not pay for thread creation on every tick.
+  */
+ class SamplerPool {
+ private:
+     std::vector<std::thread> workers;
+     std::mutex mutex;
+     std::condition_variable wake;
+     std::condition_variable finished;
+     std::function<void(size_t, size_t)> job;
+     size_t job_size;
+     unsigned long generation;
+     unsigned busy;
+     bool stopping;
+ 
+     /**
+      * Compute the part of the current job handled by one slot
+      * @param slot Slot index, 0 being the calling thread
+      * @param begin Reference to store the first index
+      * @param end Reference to store the end index
+      */
+     void chunk(size_t slot, size_t& begin, size_t& end) const;
+ 
+     /**
+      * Worker thread body
+      * @param slot Slot index of this worker
+      */
+     void workerLoop(size_t slot);
+ 
+ public:
+     /**
+      * Constructor - starts the worker threads
+      * @param threads Number of threads besides the caller
+      */
+     explicit SamplerPool(unsigned threads);
+ 
+     /**
+      * Destructor - stops and joins the worker threads
+      */
+     ~SamplerPool();
+ 
+     SamplerPool(const SamplerPool&) = delete;
+     SamplerPool& operator=(const SamplerPool&) = delete;
+ 
+     /**
+      * Run fn on disjoint chunks covering [0, size) and wait for completion
+      * @param size Number of items
+      * @param fn Function called with a [begin, end) chunk
+      */
+     void run(size_t size, const std::function<void(size_t, size_t)>& fn);
+ };
+ 
+ /**
+  * Parse /proc/cpuinfo in a single pass. Descriptive fields come from the
+  * first processor; later ones only add to the processor and core counts.
+  * @param text NUL-terminated file content
+  * @param len Length of text
+  * @return Parsed CPU information
+  */
+ CpuInfo parseCpuInfo(const char* text, size_t len);
+ 
+ /**
+  * Read and parse /proc/cpuinfo with one read into a presized buffer
+  * @return CPU information, empty if the file cannot be read
+  */
+ CpuInfo readCpuInfo();
+ 
+ /**
+  * Parse /proc/stat. The aggregate cpu line fills load; per_cpu and
+  * counters are only parsed when given.
+  * @param text NUL-terminated file content
+  * @param len Length of text
+  * @param load Where to store the aggregate counters and cpu_usage
+  * @param per_cpu Optional table for the cpuN lines, resized only when
+  *                CPUs come and go
+  * @param counters Optional system-wide counters (btime, ctxt, ...)
+  * @return false if the text does not start with a cpu line
+  */
+ bool parseProcStat(const char* text, size_t len, CpuLoad& load,
+                    CpuStatTable* per_cpu = nullptr, ProcStatCounters* counters = nullptr);
+ 
+ /**
+  * Parse the three load averages of /proc/loadavg into load
+  * @param text File content
+  * @param load Where to store load1, load5 and load15
+  */
+ void parseLoadAvg(const char* text, CpuLoad& load);
+ 
+ /**
+  * Sum the jiffies of the aggregate line; guest time is already in user
+  * @param load Counters
+  * @return Total jiffies
+  */
+ unsigned long long totalJiffies(const CpuLoad& load);
+ 
+ /**
+  * Sum the jiffies of one per-CPU row
+  * @param table Per-CPU counters
+  * @param row Row index
+  * @return Total jiffies
+  */
+ unsigned long long rowJiffies(const CpuStatTable& table, size_t row);
+ 
+ /**
+  * Idle plus iowait jiffies of the aggregate line
+  * @param load Counters
+  * @return Idle jiffies
+  */
+ unsigned long long idleJiffies(const CpuLoad& load);
+ 
+ /**
+  * Percentage of the elapsed jiffies spent in one counter between samples
+  * @param prev Counter value in the previous sample
+  * @param cur Counter value in the current sample
+  * @param elapsed Total jiffies elapsed
+  * @return Percentage, 0 if nothing elapsed or the counter went back
+  */
+ double deltaPercent(unsigned long long prev, unsigned long long cur, unsigned long long elapsed);
+ 
+ /**
+  * Parse the counters of a cgroup cpu.stat
+  * @param text File content
+  * @return Parsed counters, zero where a key is missing
+  */
+ CgroupCpuStat parseCgroupCpuStat(const char* text);
+ 
+ /**
+  * Read the cpu.max quota of a cgroup
+  * @param dir Open cgroup directory
+  * @return Limit in CPUs, 0 if the cgroup is not limited
+  */
+ double readCgroupCpuLimit(const SysfsDir& dir);
+ 
+ /**
+  * Ranking metric for topCgroups: usage_usec of cpu.stat
+  * @param dir Open cgroup directory
+  * @param value CPU time in microseconds
+  * @return false if the cgroup has no cpu.stat
+  */
+ bool cgroupCpuMetric(const SysfsDir& dir, unsigned long long& value);
+ 
+ /**
+  * CPU collector that keeps /proc/stat, /proc/loadavg and the cpufreq
+  * attributes of every CPU open between samples and re-reads them with
+  * pread(), so a long-running caller pays no open() per sample
+  */
+ class CpuSampler {
+ public:
+     CpuSampler();
+     ~CpuSampler();
+ 
+     CpuSampler(const CpuSampler&) = delete;
+     CpuSampler& operator=(const CpuSampler&) = delete;
+ 
+     /**
+      * Set how many threads sample frequencies; takes effect before the
+      * first frequency sample
+      * @param jobs Thread count including the caller
+      */
+     void setJobs(unsigned jobs) { sample_jobs = jobs; }
+ 
+     /**
+      * Open /proc/stat ahead of the first sample
+      * @return true if the file could be opened
+      */
+     bool openStat();
+ 
+     /**
+      * Sample load averages and /proc/stat counters
+      * @param per_cpu Optional table for the per-CPU counters
+      * @param counters Optional system-wide counters
+      * @return Aggregate counters with load averages and cpu_usage since boot
+      */
+     CpuLoad load(CpuStatTable* per_cpu = nullptr, ProcStatCounters* counters = nullptr);
+ 
+     /**
+      * Re-read current/min/max frequency of every CPU, split across the
+      * sampler pool when several jobs are set
+      * @param samples Reused output vector, one entry per CPU
+      */
+     void sampleFrequencies(std::vector<CpuFrequency>& samples);
+ 
+     /**
+      * Sample every CPU's frequency along with its governor and driver
+      * @return One entry per CPU with cpufreq support, sorted by CPU
+      */
+     std::vector<CpuFrequency> frequencies();
+ 
+ private:
+     unsigned sample_jobs;
+     int stat_fd;
+     int loadavg_fd;
+     std::vector<char> stat_buf;
+     std::vector<char> loadavg_buf;
+     std::vector<CpuFreqFiles> freq_files;
+     bool freq_files_opened;
+     std::unique_ptr<SamplerPool> sampler_pool;
+ 
+     /**
+      * Open the cpufreq attributes of every CPU once; governor and driver
+      * rarely change, so they are read here rather than per sample
+      */
+     void openFrequencyFiles();
+ };
+ 
+ #endif // CPU_HPP
@@ -0,0 +1,703 @@
+/*
+ * disk - Shared block device, mount and I/O statistics collectors
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "disk.hpp"
+ #include "procfs.hpp"
+ #include "stats.hpp"
+ 
+ #include <algorithm>
+ #include <atomic>
+ #include <cerrno>
+ #include <cstdlib>
+ #include <cstring>
+ #include <thread>
+ #include <unistd.h>
+ #include <fcntl.h>
+ #include <sys/stat.h>
+ #include <sys/ioctl.h>
+ #include <linux/nvme_ioctl.h>
+ 
+ namespace {
+ 
+ // --stats timing of the collectors in this file
+ StatSection nvme_section("readNvmeHealth");
+ StatSection disks_section("readDisks");
+ StatSection block_graph_section("readBlockGraph");
+ StatSection statvfs_section("statvfsAll");
+ StatSection partitions_section("readPartitions");
+ StatSection diskstats_section("DiskSampler::diskStats");
+ StatSection mountinfo_section("DiskSampler::mountInfo");
+ StatSection cgroup_io_section("DiskSampler::cgroupIoStat");
+ 
+ unsigned long long le64(const unsigned char* p) {
+     unsigned long long value = 0;
+     for (int i = 7; i >= 0; --i) value = (value << 8) | p[i];
+     return value;
+ }
+ 
+ unsigned long long readHexAttr(const SysfsDir& dir, const char* name, bool& ok) {
+     char buf[32];
+     if (dir.read(name, buf, sizeof(buf)) <= 0) {
+         ok = false;
+         return 0;
+     }
+     return std::strtoull(buf, nullptr, 16);
+ }
+ 
+ int addBlockNode(BlockGraph& graph, const SysfsDir& dir, const std::string& name, int parent) {
+     BlockNode node;
+     node.name = name;
+     node.parent = parent;
+     
+     char dev[32];
+     if (dir.read("dev", dev, sizeof(dev)) > 0) {
+         const char* p = dev;
+         node.major = parseNumber(p);
+         if (*p == ':') ++p;
+         node.minor = parseNumber(p);
+     }
+     
+     unsigned long long sectors;
+     if (dir.readUnsigned("size", sectors)) {
+         node.size_bytes = sectors * 512;
+     }
+     
+     int index = graph.nodes.size();
+     graph.by_name.emplace(name, index);
+     graph.nodes.push_back(std::move(node));
+     return index;
+ }
+ 
+ // seen marks visited nodes, so a disk reached through several paths is
+ // listed once
+ void collectBackingDisks(const BlockGraph& graph, int index, std::vector<int>& disks,
+                          std::vector<char>& seen) {
+     if (seen[index]) return;
+     seen[index] = 1;
+     
+     const BlockNode& node = graph.nodes[index];
+     if (node.parent >= 0) {
+         collectBackingDisks(graph, node.parent, disks, seen);
+     } else if (node.slaves.empty()) {
+         disks.push_back(index);
+     } else {
+         for (int slave : node.slaves) collectBackingDisks(graph, slave, disks, seen);
+     }
+ }
+ 
+ // Run stat/statvfs jobs until the batch is drained. Workers hold a
+ // reference to the batch, so one stuck on a hung mount can be abandoned.
+ void statvfsWorker(std::shared_ptr<StatvfsBatch> batch) {
+     std::unique_lock<std::mutex> guard(batch->lock);
+     
+     while (batch->next < batch->jobs.size()) {
+         size_t i = batch->next++;
+         StatvfsJob& job = batch->jobs[i];
+         job.state = StatvfsJob::RUNNING;
+         job.started = std::chrono::steady_clock::now();
+         std::string path = systemPath(job.path.c_str());
+         guard.unlock();
+         
+         struct stat st;
+         bool have_dev = stat(path.c_str(), &st) == 0;
+         
+         guard.lock();
+         if (job.state == StatvfsJob::STALE) {
+             // Given up on while stat hung; the mount is not worth a statvfs
+             job.stuck = false;
+             continue;
+         }
+         if (have_dev) {
+             // Bind mounts of one superblock share st_dev; stat it only once
+             auto owner = batch->owners.find(st.st_dev);
+             if (owner != batch->owners.end()) {
+                 job.alias = owner->second;
+                 job.state = StatvfsJob::DONE;
+                 batch->finished++;
+                 batch->changed.notify_all();
+                 continue;
+             }
+             batch->owners[st.st_dev] = i;
+         }
+         guard.unlock();
+         
+         struct statvfs result;
+         countStat(STAT_STATVFS);
+         bool ok = statvfs(path.c_str(), &result) == 0;
+         
+         guard.lock();
+         job.stuck = false;
+         if (job.state == StatvfsJob::RUNNING) {
+             job.ok = ok;
+             job.result = result;
+             job.state = StatvfsJob::DONE;
+             batch->finished++;
+             batch->changed.notify_all();
+         }
+     }
+ }
+ 
+ }
+ 
+ // 128-bit counters are truncated to their low 64 bits
+ void readNvmeHealth(const std::string& device, NvmeHealth& health) {
+     StatTimer timer(nvme_section);
+     int fd = openSystemFile(device.c_str(), O_RDONLY | O_CLOEXEC);
+     if (fd < 0) {
+         health.error = std::strerror(errno);
+         return;
+     }
+     
+     unsigned char log[512] = {};
+     struct nvme_admin_cmd cmd = {};
+     cmd.opcode = 0x02;                   // Get Log Page
+     cmd.nsid = 0xffffffff;               // Controller-wide
+     cmd.addr = reinterpret_cast<uintptr_t>(log);
+     cmd.data_len = sizeof(log);
+     cmd.cdw10 = 0x02 | ((sizeof(log) / 4 - 1) << 16);
+     
+     int status = ioctl(fd, NVME_IOCTL_ADMIN_CMD, &cmd);
+     int saved_errno = errno;
+     close(fd);
+     
+     if (status != 0) {
+         health.error = status < 0 ? std::strerror(saved_errno) : "NVMe status " + std::to_string(status);
+         return;
+     }
+     
+     health.valid = true;
+     health.critical_warning = log[0];
+     health.temperature_c = (log[1] | (log[2] << 8)) - 273;
+     health.available_spare = log[3];
+     health.percentage_used = log[5];
+     health.data_units_read = le64(log + 32);
+     health.data_units_written = le64(log + 48);
+     health.power_on_hours = le64(log + 128);
+     health.unsafe_shutdowns = le64(log + 144);
+     health.media_errors = le64(log + 160);
+ }
+ 
+ // Thread safe because SysfsDir only reads through openat on the shared
+ // block fd
+ bool readDiskInfo(const SysfsDir& block, const std::string& device_name, DiskInfo& disk, bool smart) {
+     SysfsDir dev;
+     if (!dev.open(block, device_name.c_str())) return false;
+     
+     std::vector<std::string> entries;
+     unsigned long long value;
+     disk.device = "/dev/" + device_name;
+     
+     // Read size. sysfs counts 512-byte sectors whatever the logical
+     // block size, which is reported separately.
+     if (dev.readUnsigned("size", value)) {
+         disk.size_bytes = value * 512;
+     }
+     
+     dev.readString("device/model", disk.model);
+     dev.readString("device/vendor", disk.vendor);
+     dev.readString("dm/name", disk.label);
+     
+     // Check if removable
+     if (dev.readUnsigned("removable", value)) {
+         disk.removable = (value == 1);
+     }
+     
+     // Check if rotational (SSD vs HDD)
+     if (dev.readUnsigned("queue/rotational", value)) {
+         disk.rotational = (value == 1);
+     }
+     
+     // Determine disk type
+     if (device_name.find("nvme") == 0) {
+         disk.type = "NVMe";
+     } else if (device_name.find("dm-") == 0) {
+         disk.type = "DM";
+     } else if (device_name.find("md") == 0) {
+         disk.type = "MD";
+     } else if (!disk.rotational) {
+         disk.type = "SSD";
+     } else {
+         disk.type = "HDD";
+     }
+     
+     // Read scheduler
+     char scheduler_line[256];
+     if (dev.read("queue/scheduler", scheduler_line, sizeof(scheduler_line)) > 0) {
+         // Extract current scheduler (between square brackets)
+         const char* start = std::strchr(scheduler_line, '[');
+         const char* end = start ? std::strchr(start, ']') : nullptr;
+         if (start && end) {
+             disk.scheduler.assign(start + 1, end - start - 1);
+         }
+     }
+     
+     // Read queue depth and I/O limits
+     if (dev.readUnsigned("queue/nr_requests", value)) {
+         disk.queue_depth = value;
+     }
+     if (dev.readUnsigned("queue/logical_block_size", value)) {
+         disk.logical_block_size = value;
+     }
+     if (dev.readUnsigned("queue/physical_block_size", value)) {
+         disk.physical_block_size = value;
+     }
+     if (dev.readUnsigned("queue/optimal_io_size", value)) {
+         disk.optimal_io_size = value;
+     }
+     dev.readUnsigned("queue/discard_max_bytes", disk.discard_max_bytes);
+     
+     // Device-side queueing: hardware queues, cache mode, polling, zones
+     SysfsDir mq;
+     if (mq.open(dev, "mq") && mq.list(entries)) {
+         disk.hw_queues = entries.size();
+     }
+     dev.readString("queue/write_cache", disk.write_cache);
+     if (dev.readUnsigned("queue/io_poll", value)) {
+         disk.io_poll = (value == 1);
+     }
+     dev.readString("queue/zoned", disk.zoned);
+     if (dev.readUnsigned("queue/nr_zones", value)) {
+         disk.nr_zones = value;
+     }
+     
+     // SCSI midlayer counters, printed by the kernel in hex
+     bool ok = true;
+     disk.io_requests = readHexAttr(dev, "device/iorequest_cnt", ok);
+     disk.io_done = readHexAttr(dev, "device/iodone_cnt", ok);
+     disk.io_errors = readHexAttr(dev, "device/ioerr_cnt", ok);
+     disk.has_scsi_counters = ok;
+     if (dev.readUnsigned("device/timeout", value)) {
+         disk.command_timeout = value;
+     }
+     
+     if (smart && device_name.find("nvme") == 0) {
+         readNvmeHealth(disk.device, disk.health);
+     }
+     
+     // Find partitions
+     if (dev.list(entries)) {
+         for (const auto& part_name : entries) {
+             if (part_name.find(device_name) == 0 && part_name != device_name) {
+                 disk.partitions.push_back("/dev/" + part_name);
+             }
+         }
+     }
+     
+     return true;
+ }
+ 
+ // Devices are split across threads, since the SMART ioctl can take tens
+ // of milliseconds per drive
+ bool readDisks(std::vector<DiskInfo>& disks, int jobs, bool smart) {
+     StatTimer timer(disks_section);
+     SysfsDir block;
+     std::vector<std::string> names;
+     if (!block.open("/sys/block") || !block.list(names)) {
+         return false;
+     }
+     
+     // Skip loop devices and ram disks by default
+     names.erase(std::remove_if(names.begin(), names.end(), [](const std::string& name) {
+                     return name.find("loop") == 0 || name.find("ram") == 0;
+                 }), names.end());
+     
+     std::vector<DiskInfo> results(names.size());
+     std::vector<char> found(names.size(), 0);
+     std::atomic<size_t> next(0);
+     auto worker = [&]() {
+         for (size_t i = next++; i < names.size(); i = next++) {
+             found[i] = readDiskInfo(block, names[i], results[i], smart);
+         }
+     };
+     
+     size_t threads = std::min<size_t>(jobs, names.size());
+     std::vector<std::thread> pool;
+     for (size_t i = 1; i < threads; ++i) pool.emplace_back(worker);
+     worker();
+     for (auto& thread : pool) thread.join();
+     
+     for (size_t i = 0; i < names.size(); ++i) {
+         if (found[i]) disks.push_back(std::move(results[i]));
+     }
+     return true;
+ }
+ 
+ // Every device and partition becomes a node, and each device's slaves
+ // directory gives its edges. holders is the kernel's mirror of slaves, so
+ // it is filled from the same edges instead of being read for every
+ // partition.
+ BlockGraph readBlockGraph() {
+     StatTimer timer(block_graph_section);
+     BlockGraph graph;
+     
+     SysfsDir block;
+     std::vector<std::string> names;
+     if (!block.open("/sys/block") || !block.list(names)) {
+         return graph;
+     }
+     
+     std::vector<std::pair<int, std::string>> edges;
+     std::vector<std::string> entries;
+     unsigned long long value;
+     for (const auto& device_name : names) {
+         if (device_name.find("ram") == 0) continue;
+         
+         SysfsDir dev;
+         if (!dev.open(block, device_name.c_str())) continue;
+         
+         int disk = addBlockNode(graph, dev, device_name, -1);
+         dev.readString("dm/name", graph.nodes[disk].label);
+         
+         // Partitions are subdirectories with a "partition" attribute
+         if (dev.list(entries)) {
+             for (const auto& entry : entries) {
+                 if (entry.find(device_name) != 0 || entry == device_name) continue;
+                 
+                 SysfsDir part;
+                 if (!part.open(dev, entry.c_str()) || !part.readUnsigned("partition", value)) continue;
+                 
+                 int index = addBlockNode(graph, part, entry, disk);
+                 graph.nodes[disk].partitions.push_back(index);
+             }
+         }
+         
+         SysfsDir slaves;
+         if (slaves.open(dev, "slaves") && slaves.list(entries)) {
+             for (auto& entry : entries) edges.emplace_back(disk, std::move(entry));
+         }
+     }
+     
+     // Slaves may be partitions of disks listed later, so edges are
+     // resolved once every node exists
+     for (const auto& edge : edges) {
+         int slave = graph.find(edge.second);
+         if (slave < 0) continue;
+         graph.nodes[edge.first].slaves.push_back(slave);
+         graph.nodes[slave].holders.push_back(edge.first);
+     }
+     
+     return graph;
+ }
+ 
+ std::vector<int> backingDisks(const BlockGraph& graph, int index) {
+     std::vector<int> disks;
+     std::vector<char> seen(graph.nodes.size(), 0);
+     collectBackingDisks(graph, index, disks, seen);
+     return disks;
+ }
+ 
+ bool graphRoot(const BlockGraph& graph, const BlockNode& node) {
+     if (node.parent >= 0 || !node.slaves.empty()) return false;
+     if (node.name.find("loop") != 0 || !node.holders.empty()) return true;
+     
+     for (int part : node.partitions) {
+         if (!graph.nodes[part].holders.empty()) return true;
+     }
+     return false;
+ }
+ 
+ std::shared_ptr<StatvfsBatch> statvfsAll(const std::vector<std::string>& paths, int jobs, double timeout) {
+     StatTimer timer(statvfs_section);
+     auto batch = std::make_shared<StatvfsBatch>();
+     batch->jobs.resize(paths.size());
+     for (size_t i = 0; i < paths.size(); ++i) {
+         batch->jobs[i].path = paths[i];
+     }
+     
+     size_t workers = std::min<size_t>(jobs, paths.size());
+     for (size_t w = 0; w < workers; ++w) {
+         std::thread(statvfsWorker, batch).detach();
+     }
+     
+     auto limit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+         std::chrono::duration<double>(timeout));
+     
+     std::unique_lock<std::mutex> guard(batch->lock);
+     size_t stale = 0;
+     while (batch->finished + stale < batch->jobs.size()) {
+         auto now = std::chrono::steady_clock::now();
+         auto wake = now + limit;
+         
+         for (auto& job : batch->jobs) {
+             if (job.state != StatvfsJob::RUNNING) continue;
+             if (now - job.started >= limit) {
+                 job.state = StatvfsJob::STALE;
+                 job.stuck = true;
+                 stale++;
+                 if (batch->next < batch->jobs.size()) {
+                     std::thread(statvfsWorker, batch).detach();
+                 }
+             } else {
+                 wake = std::min(wake, job.started + limit);
+             }
+         }
+         
+         if (batch->finished + stale < batch->jobs.size()) {
+             batch->changed.wait_until(guard, wake);
+         }
+     }
+     
+     // Aliases take the result of the mount that was actually stat'ed
+     for (auto& job : batch->jobs) {
+         if (job.alias < 0) continue;
+         const StatvfsJob& owner = batch->jobs[job.alias];
+         job.state = owner.state == StatvfsJob::DONE ? StatvfsJob::DONE : StatvfsJob::STALE;
+         job.ok = owner.ok;
+         job.result = owner.result;
+     }
+     
+     return batch;
+ }
+ 
+ void StuckMounts::add(const std::shared_ptr<StatvfsBatch>& batch) {
+     std::lock_guard<std::mutex> guard(batch->lock);
+     for (size_t i = 0; i < batch->jobs.size(); ++i) {
+         const StatvfsJob& job = batch->jobs[i];
+         if (job.stuck) entries.push_back(Entry{batch, i, job.path});
+     }
+ }
+ 
+ void StuckMounts::prune() {
+     for (size_t i = 0; i < entries.size();) {
+         bool stuck;
+         {
+             std::lock_guard<std::mutex> guard(entries[i].batch->lock);
+             stuck = entries[i].batch->jobs[entries[i].job].stuck;
+         }
+         if (stuck) {
+             ++i;
+         } else {
+             entries.erase(entries.begin() + i);
+         }
+     }
+ }
+ 
+ bool StuckMounts::contains(const std::string& path) const {
+     for (const auto& entry : entries) {
+         if (entry.path == path) return true;
+     }
+     return false;
+ }
+ 
+ MountFilter::MountFilter()
+     : pseudo({"proc", "sysfs", "devtmpfs", "tmpfs", "devpts", "cgroup", "cgroup2", "securityfs",
+               "debugfs", "tracefs", "configfs", "fusectl", "pstore", "bpf", "mqueue", "hugetlbfs",
+               "autofs", "binfmt_misc", "rpc_pipefs", "nsfs", "efivarfs", "selinuxfs"}) {}
+ 
+ void MountFilter::include(const std::string& list) {
+     add(included, list);
+ }
+ 
+ void MountFilter::exclude(const std::string& list) {
+     add(excluded, list);
+ }
+ 
+ void MountFilter::add(TypeSet& set, const std::string& list) {
+     lists.push_back(list);
+     std::string_view rest = lists.back();
+     while (!rest.empty()) {
+         size_t comma = rest.find(',');
+         std::string_view type = rest.substr(0, comma);
+         if (!type.empty()) set.insert(type);
+         if (comma == std::string_view::npos) break;
+         rest.remove_prefix(comma + 1);
+     }
+ }
+ 
+ bool MountFilter::matches(std::string_view type, std::string_view source) const {
+     if (excluded.count(type)) return false;
+     if (!included.empty()) return included.count(type) > 0;
+     return source.substr(0, 5) == "/dev/" && !pseudo.count(type);
+ }
+ 
+ void readPartitions(const char* mountinfo, const MountFilter& filter, std::vector<PartitionInfo>& partitions) {
+     StatTimer timer(partitions_section);
+     MountEntry entry;
+     for (const char* p = mountinfo; nextMountEntry(p, entry);) {
+         if (entry.filesystem.empty() || !filter.matches(entry.filesystem, entry.source)) continue;
+         
+         PartitionInfo part;
+         part.device = unescapeMountField(entry.source);
+         part.mountpoint = unescapeMountField(entry.mountpoint);
+         part.root = unescapeMountField(entry.root);
+         part.filesystem = std::string(entry.filesystem);
+         part.mount_options = joinMountOptions(entry);
+         
+         const char* number = entry.devno.data();
+         part.major = parseNumber(number);
+         if (*number == ':') {
+             ++number;
+             part.minor = parseNumber(number);
+         }
+         
+         partitions.push_back(part);
+     }
+ }
+ 
+ void readPartitionUsage(std::vector<PartitionInfo>& partitions, int jobs, double timeout) {
+     if (partitions.empty()) return;
+     
+     std::vector<std::string> paths;
+     for (const auto& part : partitions) {
+         paths.push_back(part.mountpoint);
+     }
+     auto batch = statvfsAll(paths, jobs, timeout);
+     
+     std::lock_guard<std::mutex> guard(batch->lock);
+     for (size_t i = 0; i < partitions.size(); ++i) {
+         PartitionInfo& part = partitions[i];
+         const StatvfsJob& job = batch->jobs[i];
+         if (job.state == StatvfsJob::STALE) {
+             part.stale = true;
+             continue;
+         }
+         if (!job.ok) continue;
+         
+         const struct statvfs& stat = job.result;
+         part.total_bytes = static_cast<unsigned long long>(stat.f_blocks) * stat.f_frsize;
+         part.available_bytes = static_cast<unsigned long long>(stat.f_bavail) * stat.f_frsize;
+         part.used_bytes = (static_cast<unsigned long long>(stat.f_blocks) -
+                            static_cast<unsigned long long>(stat.f_bfree)) * stat.f_frsize;
+         
+         if (part.total_bytes > 0) {
+             part.usage_percent = static_cast<double>(part.used_bytes) / part.total_bytes * 100.0;
+         }
+     }
+ }
+ 
+ void parseDiskStats(const char* text, DiskStatsTable& table) {
+     // Devices that disappeared since the last sample are dropped
+     for (auto& row : table.rows) row.present = false;
+     
+     const char* p = text;
+     while (*p) {
+         unsigned int major = parseNumber(p);
+         unsigned int minor = parseNumber(p);
+         while (*p == ' ') ++p;
+         const char* name = p;
+         while (*p && *p != ' ' && *p != '\n') ++p;
+         size_t name_len = p - name;
+         
+         unsigned long long counters[11];
+         for (auto& counter : counters) counter = parseNumber(p);
+         while (*p && *p != '\n') ++p;
+         if (*p) ++p;
+         
+         if (name_len == 0) continue;
+         
+         DiskStats& stat = table.row(major, minor);
+         if (stat.device.compare(0, std::string::npos, name, name_len) != 0) {
+             stat.device.assign(name, name_len);
+         }
+         stat.present = true;
+         stat.reads_completed = counters[0];
+         stat.reads_merged = counters[1];
+         stat.sectors_read = counters[2];
+         stat.time_reading = counters[3];
+         stat.writes_completed = counters[4];
+         stat.writes_merged = counters[5];
+         stat.sectors_written = counters[6];
+         stat.time_writing = counters[7];
+         stat.io_in_progress = counters[8];
+         stat.time_io = counters[9];
+         stat.weighted_time_io = counters[10];
+     }
+ }
+ 
+ void parseCgroupIoStat(const char* text, DiskStatsTable& table, const DiskStatsTable& names) {
+     for (auto& row : table.rows) row.present = false;
+     
+     const char* p = text;
+     while (*p) {
+         unsigned int major = parseNumber(p);
+         if (*p == ':') ++p;
+         unsigned int minor = parseNumber(p);
+         
+         DiskStats& stat = table.row(major, minor);
+         stat.present = true;
+         if (stat.device.empty()) {
+             const DiskStats* known = names.find(major, minor);
+             stat.device = known ? known->device : std::to_string(major) + ":" + std::to_string(minor);
+         }
+         
+         while (*p && *p != '\n') {
+             while (*p == ' ') ++p;
+             const char* key = p;
+             while (*p && *p != '=' && *p != ' ' && *p != '\n') ++p;
+             if (*p != '=') continue;
+             
+             std::string_view name(key, p - key);
+             ++p;
+             unsigned long long value = parseNumber(p);
+             if (name == "rbytes") stat.sectors_read = value / 512;
+             else if (name == "wbytes") stat.sectors_written = value / 512;
+             else if (name == "rios") stat.reads_completed = value;
+             else if (name == "wios") stat.writes_completed = value;
+         }
+         if (*p) ++p;
+     }
+ }
+ 
+ bool cgroupIoMetric(const SysfsDir& dir, unsigned long long& value) {
+     char buf[4096];
+     if (dir.read("io.stat", buf, sizeof(buf)) < 0) return false;
+     
+     // Sum rbytes and wbytes over every device line
+     value = 0;
+     for (const char* p = buf; (p = std::strstr(p, "bytes=")) != nullptr; ) {
+         bool transfer = p > buf && (p[-1] == 'r' || p[-1] == 'w');
+         p += 6;
+         unsigned long long bytes = parseNumber(p);
+         if (transfer) value += bytes;
+     }
+     return true;
+ }
+ 
+ DiskSampler::DiskSampler() : diskstats_fd(-1), mountinfo_fd(-1), cgroup_io_fd(-1) {}
+ 
+ DiskSampler::~DiskSampler() {
+     if (diskstats_fd >= 0) close(diskstats_fd);
+     if (mountinfo_fd >= 0) close(mountinfo_fd);
+     if (cgroup_io_fd >= 0) close(cgroup_io_fd);
+ }
+ 
+ bool DiskSampler::diskStats(DiskStatsTable& table) {
+     StatTimer timer(diskstats_section);
+     if (openProcFile(diskstats_fd, "/proc/diskstats") < 0 ||
+         readProcFile(diskstats_fd, diskstats_buf) < 0) {
+         return false;
+     }
+     
+     parseDiskStats(diskstats_buf.data(), table);
+     return true;
+ }
+ 
+ const char* DiskSampler::mountInfo() {
+     StatTimer timer(mountinfo_section);
+     if (openProcFile(mountinfo_fd, "/proc/self/mountinfo") < 0 ||
+         readProcFile(mountinfo_fd, mountinfo_buf) < 0) {
+         return nullptr;
+     }
+     return mountinfo_buf.data();
+ }
+ 
+ bool DiskSampler::openCgroupIo(const SysfsDir& dir) {
+     if (cgroup_io_fd >= 0) close(cgroup_io_fd);
+     cgroup_io_fd = dir.openFile("io.stat");
+     if (cgroup_io_fd < 0) return false;
+     
+     diskStats(device_names);
+     return true;
+ }
+ 
+ bool DiskSampler::cgroupIoStat(DiskStatsTable& table) {
+     StatTimer timer(cgroup_io_section);
+     if (cgroup_io_fd < 0 || readProcFile(cgroup_io_fd, cgroup_io_buf) < 0) return false;
+     
+     parseCgroupIoStat(cgroup_io_buf.data(), table, device_names);
+     return true;
+ }
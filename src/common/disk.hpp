@@ -0,0 +1,480 @@
+/*
+ * disk - Shared block device, mount and I/O statistics collectors
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef DISK_HPP
+ #define DISK_HPP
+ 
+ #include <string>
+ #include <vector>
+ #include <map>
+ #include <deque>
+ #include <string_view>
+ #include <unordered_map>
+ #include <unordered_set>
+ #include <memory>
+ #include <chrono>
+ #include <mutex>
+ #include <condition_variable>
+ #include <sys/types.h>
+ #include <sys/statvfs.h>
+ 
+ #include "sysfs.hpp"
+ 
+ /**
+  * Fields of the NVMe SMART / Health Information log page (log id 02h)
+  */
+ struct NvmeHealth {
+     bool valid;
+     std::string error;       // Why the log could not be read
+     unsigned int critical_warning;
+     int temperature_c;
+     unsigned int available_spare;
+     unsigned int percentage_used;
+     unsigned long long data_units_read;      // Units of 1000 512-byte blocks
+     unsigned long long data_units_written;
+     unsigned long long power_on_hours;
+     unsigned long long unsafe_shutdowns;
+     unsigned long long media_errors;
+     
+     NvmeHealth() : valid(false), critical_warning(0), temperature_c(0), available_spare(0),
+                    percentage_used(0), data_units_read(0), data_units_written(0),
+                    power_on_hours(0), unsafe_shutdowns(0), media_errors(0) {}
+ };
+ 
+ struct DiskInfo {
+     std::string device;
+     std::string model;
+     std::string vendor;
+     std::string type; // HDD/SSD/NVMe/DM/MD
+     std::string label; // device-mapper name
+     unsigned long long size_bytes;   // sysfs size in 512-byte sectors times 512
+     bool removable;
+     bool rotational;
+     std::string scheduler;
+     unsigned int queue_depth;
+     unsigned int logical_block_size;
+     unsigned int physical_block_size;
+     unsigned int optimal_io_size;
+     unsigned long long discard_max_bytes;
+     unsigned int hw_queues;          // Entries in mq/
+     std::string write_cache;         // "write back" or "write through"
+     bool io_poll;
+     std::string zoned;               // none, host-aware or host-managed
+     unsigned int nr_zones;
+     bool has_scsi_counters;          // SCSI midlayer device/ counters
+     unsigned long long io_requests;
+     unsigned long long io_done;
+     unsigned long long io_errors;
+     unsigned int command_timeout;    // SCSI command timeout in seconds
+     NvmeHealth health;               // Filled with --smart
+     std::vector<std::string> partitions;
+ 
+     DiskInfo() : size_bytes(0), removable(false), rotational(true), queue_depth(0),
+                  logical_block_size(512), physical_block_size(512), optimal_io_size(0),
+                  discard_max_bytes(0), hw_queues(0), io_poll(false), nr_zones(0),
+                  has_scsi_counters(false), io_requests(0), io_done(0), io_errors(0),
+                  command_timeout(0) {}
+ };
+ 
+ /**
+  * Block device or partition in a BlockGraph. slaves, holders, partitions
+  * and parent are indices into BlockGraph::nodes.
+  */
+ struct BlockNode {
+     std::string name;
+     std::string label;       // device-mapper name, empty for other devices
+     unsigned int major;
+     unsigned int minor;
+     int parent;              // Disk of a partition, -1 for whole devices
+     unsigned long long size_bytes;
+     std::vector<int> slaves;      // Devices this one is built on
+     std::vector<int> holders;     // Devices built on this one
+     std::vector<int> partitions;
+     
+     BlockNode() : major(0), minor(0), parent(-1), size_bytes(0) {}
+ };
+ 
+ /**
+  * How dm, md and multipath devices stack on partitions and disks
+  */
+ struct BlockGraph {
+     std::vector<BlockNode> nodes;
+     std::unordered_map<std::string, int> by_name;
+     
+     /**
+      * Find a node by kernel name
+      * @param name Device name such as "sda2" or "dm-0"
+      * @return Node index or -1
+      */
+     int find(const std::string& name) const {
+         auto it = by_name.find(name);
+         return it == by_name.end() ? -1 : it->second;
+     }
+ };
+ 
+ /**
+  * One mount point in a StatvfsBatch
+  */
+ struct StatvfsJob {
+     enum State { PENDING, RUNNING, DONE, STALE };
+     
+     std::string path;
+     State state;
+     std::chrono::steady_clock::time_point started;
+     bool ok;
+     struct statvfs result;
+     int alias;               // Job with the same st_dev whose result is shared
+     bool stuck;              // Stale and its worker not yet returned
+     
+     StatvfsJob() : state(PENDING), ok(false), result(), alias(-1), stuck(false) {}
+ };
+ 
+ /**
+  * statvfs jobs shared between the caller and the worker threads. Held by
+  * shared_ptr so workers abandoned on a hung mount keep it alive.
+  */
+ struct StatvfsBatch {
+     std::mutex lock;
+     std::condition_variable changed;
+     std::vector<StatvfsJob> jobs;
+     size_t next;             // Next job to hand out
+     size_t finished;
+     std::map<dev_t, size_t> owners;
+     
+     StatvfsBatch() : next(0), finished(0) {}
+ };
+ 
+ /**
+  * Structure to hold disk statistics from /proc/diskstats
+  */
+ struct DiskStats {
+     std::string device;
+     unsigned int major;
+     unsigned int minor;
+     bool present;            // Seen in the most recent sample
+     unsigned long long reads_completed;
+     unsigned long long reads_merged;
+     unsigned long long sectors_read;
+     unsigned long long time_reading;
+     unsigned long long writes_completed;
+     unsigned long long writes_merged;
+     unsigned long long sectors_written;
+     unsigned long long time_writing;
+     unsigned long long io_in_progress;
+     unsigned long long time_io;
+     unsigned long long weighted_time_io;
+ 
+     DiskStats() : major(0), minor(0), present(false), reads_completed(0), reads_merged(0), sectors_read(0), time_reading(0),
+                   writes_completed(0), writes_merged(0), sectors_written(0), time_writing(0),
+                   io_in_progress(0), time_io(0), weighted_time_io(0) {}
+ };
+ 
+ /**
+  * /proc/diskstats rows in file order with a [major][minor] index, so a
+  * sample is matched to the previous one without string keys
+  */
+ struct DiskStatsTable {
+     std::vector<DiskStats> rows;
+     std::vector<std::vector<int>> index;   // Row of each major:minor, -1 if none
+     
+     /**
+      * Find the row of a device
+      * @param major Device major number
+      * @param minor Device minor number
+      * @return Row or nullptr if the device was never seen
+      */
+     const DiskStats* find(unsigned int major, unsigned int minor) const {
+         if (major >= index.size() || minor >= index[major].size()) return nullptr;
+         int slot = index[major][minor];
+         return slot < 0 ? nullptr : &rows[slot];
+     }
+     
+     /**
+      * Get the row of a device, adding it if needed
+      * @param major Device major number
+      * @param minor Device minor number
+      * @return Row for the device
+      */
+     DiskStats& row(unsigned int major, unsigned int minor) {
+         if (major >= index.size()) index.resize(major + 1);
+         std::vector<int>& minors = index[major];
+         if (minor >= minors.size()) minors.resize(minor + 1, -1);
+         
+         if (minors[minor] < 0) {
+             minors[minor] = rows.size();
+             rows.emplace_back();
+             rows.back().major = major;
+             rows.back().minor = minor;
+         }
+         return rows[minors[minor]];
+     }
+ };
+ 
+ /**
+  * Read the NVMe SMART / Health log with NVME_IOCTL_ADMIN_CMD. This needs
+  * CAP_SYS_ADMIN and may wake the drive.
+  * @param device Block device path
+  * @param health Structure to fill, or to receive the error
+  */
+ void readNvmeHealth(const std::string& device, NvmeHealth& health);
+ 
+ /**
+  * Read one /sys/block entry; safe to call from several threads on the
+  * same block directory
+  * @param block Open /sys/block directory
+  * @param device_name Kernel device name
+  * @param disk Structure to fill
+  * @param smart Also read the NVMe health log of NVMe devices
+  * @return false if the device directory cannot be opened
+  */
+ bool readDiskInfo(const SysfsDir& block, const std::string& device_name, DiskInfo& disk, bool smart);
+ 
+ /**
+  * Read every disk in /sys/block except loop devices and ram disks
+  * @param disks Where to store the disks, in directory order
+  * @param jobs Threads to split the devices across
+  * @param smart Also read NVMe health logs
+  * @return false if /sys/block cannot be listed
+  */
+ bool readDisks(std::vector<DiskInfo>& disks, int jobs, bool smart);
+ 
+ /**
+  * Build the device graph in one pass over /sys/block
+  * @return Every device and partition with its slaves and holders
+  */
+ BlockGraph readBlockGraph();
+ 
+ /**
+  * Whole disks a device is built on, following slaves down and mapping
+  * partitions to their disk
+  * @param graph Device graph
+  * @param index Node to start from
+  * @return Disk node indices, each listed once
+  */
+ std::vector<int> backingDisks(const BlockGraph& graph, int index);
+ 
+ /**
+  * Check whether a node is a disk at the bottom of the stack. Loop devices
+  * count only when something is stacked on them or on their partitions.
+  * @param graph Device graph
+  * @param node Node to check
+  * @return true for root disks
+  */
+ bool graphRoot(const BlockGraph& graph, const BlockNode& node);
+ 
+ /**
+  * stat and statvfs every path on a small worker pool. A mount whose call
+  * runs past the timeout is marked stale and a replacement worker takes
+  * over the rest of the queue, so a hung NFS or FUSE mount cannot block.
+  * @param paths Mount points
+  * @param jobs Worker threads
+  * @param timeout Seconds before a mount is reported stale
+  * @return Batch with one job per path, in order; lock it to read results
+  */
+ std::shared_ptr<StatvfsBatch> statvfsAll(const std::vector<std::string>& paths, int jobs, double timeout);
+ 
+ /**
+  * Mounts left stale by earlier statvfsAll calls whose worker is still
+  * blocked. A caller that polls statvfsAll leaves them out until the call
+  * returns, so a hung mount holds one thread instead of one per poll.
+  */
+ class StuckMounts {
+ public:
+     /**
+      * Remember the stale mounts of a batch
+      * @param batch Batch returned by statvfsAll
+      */
+     void add(const std::shared_ptr<StatvfsBatch>& batch);
+     
+     /**
+      * Forget the mounts whose worker has returned since they were added
+      */
+     void prune();
+     
+     /**
+      * Check whether a worker is still blocked on a mount
+      * @param path Mount point
+      * @return true if path was stale and has not answered yet
+      */
+     bool contains(const std::string& path) const;
+     
+     /**
+      * Number of mounts still blocked
+      */
+     size_t size() const { return entries.size(); }
+ 
+ private:
+     struct Entry {
+         std::shared_ptr<StatvfsBatch> batch;
+         size_t job;
+         std::string path;
+     };
+     
+     std::vector<Entry> entries;
+ };
+ 
+ /**
+  * One mount listed by readPartitions, with the space usage filled in by
+  * readPartitionUsage
+  */
+ struct PartitionInfo {
+     std::string device;
+     std::string mountpoint;
+     std::string filesystem;
+     unsigned long long total_bytes;
+     unsigned long long used_bytes;
+     unsigned long long available_bytes;
+     double usage_percent;
+     std::string mount_options;
+     std::string root;        // Path inside the filesystem that is mounted
+     unsigned int major;
+     unsigned int minor;
+     bool stale;              // statvfs did not return within the timeout
+     
+     PartitionInfo() : total_bytes(0), used_bytes(0), available_bytes(0), usage_percent(0.0),
+                       major(0), minor(0), stale(false) {}
+ };
+ 
+ /**
+  * Filesystem types readPartitions lists. With no included types only
+  * mounts of block devices that are not pseudo filesystems pass; excluded
+  * types never do.
+  */
+ class MountFilter {
+ public:
+     MountFilter();
+ 
+     // The sets view strings owned by this filter
+     MountFilter(const MountFilter&) = delete;
+     MountFilter& operator=(const MountFilter&) = delete;
+ 
+     /**
+      * List only the given filesystem types
+      * @param list Comma-separated type names
+      */
+     void include(const std::string& list);
+ 
+     /**
+      * Never list the given filesystem types
+      * @param list Comma-separated type names
+      */
+     void exclude(const std::string& list);
+ 
+     /**
+      * Check whether a mount passes the filter
+      * @param type Filesystem type
+      * @param source Mount source, such as /dev/sda1
+      * @return true if the mount is listed
+      */
+     bool matches(std::string_view type, std::string_view source) const;
+ 
+ private:
+     typedef std::unordered_set<std::string_view> TypeSet;
+     
+     // Never moves its strings, so the sets can view them
+     std::deque<std::string> lists;
+     TypeSet included;
+     TypeSet excluded;
+     TypeSet pseudo;
+     
+     void add(TypeSet& set, const std::string& list);
+ };
+ 
+ /**
+  * List the mounts of /proc/self/mountinfo that pass a filter
+  * @param mountinfo NUL-terminated file content, as from DiskSampler::mountInfo
+  * @param filter Filesystem types to list
+  * @param partitions Vector to append the mounts to, in mount order
+  */
+ void readPartitions(const char* mountinfo, const MountFilter& filter, std::vector<PartitionInfo>& partitions);
+ 
+ /**
+  * Fill in the space usage of mounts with statvfsAll; a mount that does
+  * not answer within the timeout is marked stale
+  * @param partitions Mounts from readPartitions
+  * @param jobs Worker threads
+  * @param timeout Seconds before a mount is reported stale
+  */
+ void readPartitionUsage(std::vector<PartitionInfo>& partitions, int jobs, double timeout);
+ 
+ /**
+  * Parse /proc/diskstats into table. Rows are matched by major:minor, so
+  * refilling a table from an earlier sample only updates the counters.
+  * @param text NUL-terminated file content
+  * @param table Table to fill; rows no longer listed are marked not present
+  */
+ void parseDiskStats(const char* text, DiskStatsTable& table);
+ 
+ /**
+  * Parse a cgroup io.stat ("8:0 rbytes=N wbytes=N rios=N wios=N ...") into
+  * table. Bytes are stored as 512-byte sectors so the rows read like
+  * /proc/diskstats ones; io.stat has no time counters.
+  * @param text NUL-terminated file content
+  * @param table Table to fill
+  * @param names /proc/diskstats table used to name new rows
+  */
+ void parseCgroupIoStat(const char* text, DiskStatsTable& table, const DiskStatsTable& names);
+ 
+ /**
+  * Ranking metric for topCgroups: bytes read and written on every device
+  * @param dir Open cgroup directory
+  * @param value Bytes transferred
+  * @return false if the cgroup has no io.stat
+  */
+ bool cgroupIoMetric(const SysfsDir& dir, unsigned long long& value);
+ 
+ /**
+  * Disk collector that keeps /proc/diskstats, /proc/self/mountinfo and a
+  * cgroup io.stat open between samples and re-reads them with pread()
+  */
+ class DiskSampler {
+ public:
+     DiskSampler();
+     ~DiskSampler();
+ 
+     DiskSampler(const DiskSampler&) = delete;
+     DiskSampler& operator=(const DiskSampler&) = delete;
+ 
+     /**
+      * Sample /proc/diskstats
+      * @param table Table to refill
+      * @return false if the file cannot be read
+      */
+     bool diskStats(DiskStatsTable& table);
+ 
+     /**
+      * Read /proc/self/mountinfo for nextMountEntry
+      * @return NUL-terminated text valid until the next call, or nullptr
+      */
+     const char* mountInfo();
+ 
+     /**
+      * Open a cgroup's io.stat for cgroupIoStat and take the device names
+      * from /proc/diskstats
+      * @param dir Open cgroup directory
+      * @return false if the io controller is not enabled
+      */
+     bool openCgroupIo(const SysfsDir& dir);
+ 
+     /**
+      * Sample the io.stat opened with openCgroupIo
+      * @param table Table to refill
+      * @return false if the file cannot be read
+      */
+     bool cgroupIoStat(DiskStatsTable& table);
+ 
+ private:
+     int diskstats_fd;
+     int mountinfo_fd;
+     int cgroup_io_fd;
+     std::vector<char> diskstats_buf;
+     std::vector<char> mountinfo_buf;
+     std::vector<char> cgroup_io_buf;
+     DiskStatsTable device_names;
+ };
+ 
+ #endif // DISK_HPP
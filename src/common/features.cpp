@@ -0,0 +1,244 @@
+/*
+ * features - CPU feature detection from CPUID and the auxiliary vector
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "features.hpp"
+ #include "stats.hpp"
+ 
+ #if defined(__x86_64__) || defined(__i386__)
+ #include <cpuid.h>
+ #endif
+ #if defined(__aarch64__)
+ #include <sys/auxv.h>
+ #endif
+ 
+ namespace {
+ 
+ // --stats timing of the collectors in this file
+ StatSection cpu_features_section("readCpuFeatures");
+ 
+ // CPUID leaves read by readX86Features(); LEAF_NONE for ARM features
+ enum CpuidLeaf : unsigned char {
+     LEAF_NONE, LEAF_1, LEAF_7_0, LEAF_7_1, LEAF_EXT_1, LEAF_COUNT
+ };
+ 
+ enum CpuidRegister : unsigned char { REG_EAX, REG_EBX, REG_ECX, REG_EDX };
+ 
+ // Register state the kernel must have enabled in XCR0 for a feature
+ enum XState : unsigned char { XSTATE_NONE, XSTATE_AVX, XSTATE_AVX512, XSTATE_AMX };
+ 
+ struct FeatureBit {
+     const char* name;
+     CpuidLeaf leaf;
+     CpuidRegister reg;
+     unsigned char bit;
+     XState state;
+     unsigned char hwcap;      // 1 for AT_HWCAP, 2 for AT_HWCAP2, 0 for none
+     unsigned char hwcap_bit;
+ };
+ 
+ constexpr FeatureBit x86(const char* name, CpuidLeaf leaf, CpuidRegister reg, int bit,
+                          XState state = XSTATE_NONE) {
+     return FeatureBit{name, leaf, reg, static_cast<unsigned char>(bit), state, 0, 0};
+ }
+ 
+ constexpr FeatureBit arm(const char* name, int hwcap, int bit) {
+     return FeatureBit{name, LEAF_NONE, REG_EAX, 0, XSTATE_NONE,
+                       static_cast<unsigned char>(hwcap), static_cast<unsigned char>(bit)};
+ }
+ 
+ // In CpuFeature order
+ const FeatureBit feature_bits[] = {
+     x86("sse", LEAF_1, REG_EDX, 25),
+     x86("sse2", LEAF_1, REG_EDX, 26),
+     x86("pni", LEAF_1, REG_ECX, 0),
+     x86("ssse3", LEAF_1, REG_ECX, 9),
+     x86("sse4_1", LEAF_1, REG_ECX, 19),
+     x86("sse4_2", LEAF_1, REG_ECX, 20),
+     x86("pclmulqdq", LEAF_1, REG_ECX, 1),
+     x86("cx16", LEAF_1, REG_ECX, 13),
+     x86("movbe", LEAF_1, REG_ECX, 22),
+     x86("popcnt", LEAF_1, REG_ECX, 23),
+     x86("xsave", LEAF_1, REG_ECX, 26),
+     x86("rdrand", LEAF_1, REG_ECX, 30),
+     x86("hypervisor", LEAF_1, REG_ECX, 31),
+     x86("lm", LEAF_EXT_1, REG_EDX, 29),
+     x86("lahf_lm", LEAF_EXT_1, REG_ECX, 0),
+     x86("abm", LEAF_EXT_1, REG_ECX, 5),
+     x86("rdtscp", LEAF_EXT_1, REG_EDX, 27),
+     x86("avx", LEAF_1, REG_ECX, 28, XSTATE_AVX),
+     x86("f16c", LEAF_1, REG_ECX, 29, XSTATE_AVX),
+     x86("fma", LEAF_1, REG_ECX, 12, XSTATE_AVX),
+     x86("avx2", LEAF_7_0, REG_EBX, 5, XSTATE_AVX),
+     x86("bmi1", LEAF_7_0, REG_EBX, 3),
+     x86("bmi2", LEAF_7_0, REG_EBX, 8),
+     x86("erms", LEAF_7_0, REG_EBX, 9),
+     x86("fsrm", LEAF_7_0, REG_EDX, 4),
+     x86("rdseed", LEAF_7_0, REG_EBX, 18),
+     x86("adx", LEAF_7_0, REG_EBX, 19),
+     x86("clflushopt", LEAF_7_0, REG_EBX, 23),
+     x86("clwb", LEAF_7_0, REG_EBX, 24),
+     x86("sha_ni", LEAF_7_0, REG_EBX, 29),
+     x86("gfni", LEAF_7_0, REG_ECX, 8),
+     x86("vaes", LEAF_7_0, REG_ECX, 9, XSTATE_AVX),
+     x86("vpclmulqdq", LEAF_7_0, REG_ECX, 10, XSTATE_AVX),
+     x86("rdpid", LEAF_7_0, REG_ECX, 22),
+     x86("serialize", LEAF_7_0, REG_EDX, 14),
+     x86("avx_vnni", LEAF_7_1, REG_EAX, 4, XSTATE_AVX),
+     x86("avx512f", LEAF_7_0, REG_EBX, 16, XSTATE_AVX512),
+     x86("avx512dq", LEAF_7_0, REG_EBX, 17, XSTATE_AVX512),
+     x86("avx512ifma", LEAF_7_0, REG_EBX, 21, XSTATE_AVX512),
+     x86("avx512cd", LEAF_7_0, REG_EBX, 28, XSTATE_AVX512),
+     x86("avx512bw", LEAF_7_0, REG_EBX, 30, XSTATE_AVX512),
+     x86("avx512vl", LEAF_7_0, REG_EBX, 31, XSTATE_AVX512),
+     x86("avx512vbmi", LEAF_7_0, REG_ECX, 1, XSTATE_AVX512),
+     x86("avx512_vbmi2", LEAF_7_0, REG_ECX, 6, XSTATE_AVX512),
+     x86("avx512_vnni", LEAF_7_0, REG_ECX, 11, XSTATE_AVX512),
+     x86("avx512_bitalg", LEAF_7_0, REG_ECX, 12, XSTATE_AVX512),
+     x86("avx512_vpopcntdq", LEAF_7_0, REG_ECX, 14, XSTATE_AVX512),
+     x86("avx512_bf16", LEAF_7_1, REG_EAX, 5, XSTATE_AVX512),
+     x86("avx512_fp16", LEAF_7_0, REG_EDX, 23, XSTATE_AVX512),
+     x86("amx_tile", LEAF_7_0, REG_EDX, 24, XSTATE_AMX),
+     x86("amx_int8", LEAF_7_0, REG_EDX, 25, XSTATE_AMX),
+     x86("amx_bf16", LEAF_7_0, REG_EDX, 22, XSTATE_AMX),
+     
+     // AES-NI on x86, HWCAP_AES on ARM
+     FeatureBit{"aes", LEAF_1, REG_ECX, 25, XSTATE_NONE, 1, 3},
+     
+     arm("fp", 1, 0),
+     arm("asimd", 1, 1),
+     arm("pmull", 1, 4),
+     arm("sha1", 1, 5),
+     arm("sha2", 1, 6),
+     arm("crc32", 1, 7),
+     arm("atomics", 1, 8),
+     arm("asimdhp", 1, 10),
+     arm("asimddp", 1, 20),
+     arm("sha3", 1, 17),
+     arm("sha512", 1, 21),
+     arm("sve", 1, 22),
+     arm("paca", 1, 30),
+     arm("sve2", 2, 1),
+     arm("i8mm", 2, 13),
+     arm("bf16", 2, 14),
+     arm("rng", 2, 16),
+     arm("bti", 2, 17),
+     arm("mte", 2, 18),
+     arm("sme", 2, 23)
+ };
+ static_assert(sizeof(feature_bits) / sizeof(feature_bits[0]) == FEATURE_COUNT,
+               "feature_bits must list every CpuFeature");
+ 
+ // Names the kernel does not use, for the flags users know
+ const struct { const char* alias; CpuFeature feature; } feature_aliases[] = {
+     {"sse3", FEATURE_SSE3},
+     {"lzcnt", FEATURE_ABM}
+ };
+ 
+ #if defined(__x86_64__) || defined(__i386__)
+ bool readX86Features(CpuFeatureSet& features) {
+     unsigned regs[LEAF_COUNT][4] = {};
+     unsigned max_leaf = __get_cpuid_max(0, nullptr);
+     if (max_leaf < 1) return false;
+     
+     __cpuid(1, regs[LEAF_1][REG_EAX], regs[LEAF_1][REG_EBX], regs[LEAF_1][REG_ECX], regs[LEAF_1][REG_EDX]);
+     if (max_leaf >= 7) {
+         __cpuid_count(7, 0, regs[LEAF_7_0][REG_EAX], regs[LEAF_7_0][REG_EBX],
+                       regs[LEAF_7_0][REG_ECX], regs[LEAF_7_0][REG_EDX]);
+         // EAX of subleaf 0 is the last subleaf
+         if (regs[LEAF_7_0][REG_EAX] >= 1) {
+             __cpuid_count(7, 1, regs[LEAF_7_1][REG_EAX], regs[LEAF_7_1][REG_EBX],
+                           regs[LEAF_7_1][REG_ECX], regs[LEAF_7_1][REG_EDX]);
+         }
+     }
+     if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000001) {
+         __cpuid(0x80000001, regs[LEAF_EXT_1][REG_EAX], regs[LEAF_EXT_1][REG_EBX],
+                 regs[LEAF_EXT_1][REG_ECX], regs[LEAF_EXT_1][REG_EDX]);
+     }
+     
+     // XCR0 says which register state the kernel saves; without it the
+     // instructions fault even though CPUID lists them
+     unsigned long long xcr0 = 0;
+     if (regs[LEAF_1][REG_ECX] & (1u << 27)) {
+         unsigned low, high;
+         __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+         xcr0 = static_cast<unsigned long long>(high) << 32 | low;
+     }
+     bool enabled[] = {
+         true,
+         (xcr0 & 0x6) == 0x6,          // SSE and AVX state
+         (xcr0 & 0xe6) == 0xe6,        // Also opmask and ZMM state
+         (xcr0 & 0x60000) == 0x60000   // TILECFG and TILEDATA
+     };
+     
+     for (int i = 0; i < FEATURE_COUNT; ++i) {
+         const FeatureBit& bit = feature_bits[i];
+         if (bit.leaf == LEAF_NONE || !enabled[bit.state]) continue;
+         if (regs[bit.leaf][bit.reg] & (1u << bit.bit)) features.set(static_cast<CpuFeature>(i));
+     }
+     return true;
+ }
+ #endif
+ 
+ #if defined(__aarch64__)
+ bool readArmFeatures(CpuFeatureSet& features) {
+     unsigned long hwcap[3] = {0, getauxval(AT_HWCAP), 0};
+ #ifdef AT_HWCAP2
+     hwcap[2] = getauxval(AT_HWCAP2);
+ #endif
+     
+     for (int i = 0; i < FEATURE_COUNT; ++i) {
+         const FeatureBit& bit = feature_bits[i];
+         if (bit.hwcap != 0 && (hwcap[bit.hwcap] & (1UL << bit.hwcap_bit))) {
+             features.set(static_cast<CpuFeature>(i));
+         }
+     }
+     return true;
+ }
+ #endif
+ 
+ }
+ 
+ bool readCpuFeatures(CpuFeatureSet& features) {
+     StatTimer timer(cpu_features_section);
+ #if defined(__x86_64__) || defined(__i386__)
+     return readX86Features(features);
+ #elif defined(__aarch64__)
+     return readArmFeatures(features);
+ #else
+     (void)features;
+     return false;
+ #endif
+ }
+ 
+ const CpuFeatureSet& hostCpuFeatures() {
+     static const CpuFeatureSet features = [] {
+         CpuFeatureSet set;
+         readCpuFeatures(set);
+         return set;
+     }();
+     return features;
+ }
+ 
+ const char* cpuFeatureName(CpuFeature feature) {
+     return feature_bits[feature].name;
+ }
+ 
+ bool findCpuFeature(std::string_view name, CpuFeature& feature) {
+     for (int i = 0; i < FEATURE_COUNT; ++i) {
+         if (name == feature_bits[i].name) {
+             feature = static_cast<CpuFeature>(i);
+             return true;
+         }
+     }
+     for (const auto& alias : feature_aliases) {
+         if (name == alias.alias) {
+             feature = alias.feature;
+             return true;
+         }
+     }
+     return false;
+ }
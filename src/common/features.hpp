@@ -0,0 +1,93 @@
+/*
+ * features - CPU feature detection from CPUID and the auxiliary vector
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef FEATURES_HPP
+ #define FEATURES_HPP
+ 
+ #include <bitset>
+ #include <string_view>
+ 
+ /**
+  * CPU features, named as the flags line of /proc/cpuinfo spells them.
+  * x86 features are read with CPUID, ARM ones from AT_HWCAP and
+  * AT_HWCAP2; a feature of the other architecture is never set.
+  */
+ enum CpuFeature {
+     // x86
+     FEATURE_SSE, FEATURE_SSE2, FEATURE_SSE3, FEATURE_SSSE3, FEATURE_SSE4_1,
+     FEATURE_SSE4_2, FEATURE_PCLMULQDQ, FEATURE_CX16, FEATURE_MOVBE, FEATURE_POPCNT,
+     FEATURE_XSAVE, FEATURE_RDRAND, FEATURE_HYPERVISOR, FEATURE_LM, FEATURE_LAHF_LM,
+     FEATURE_ABM, FEATURE_RDTSCP, FEATURE_AVX, FEATURE_F16C, FEATURE_FMA, FEATURE_AVX2,
+     FEATURE_BMI1, FEATURE_BMI2, FEATURE_ERMS, FEATURE_FSRM, FEATURE_RDSEED, FEATURE_ADX,
+     FEATURE_CLFLUSHOPT, FEATURE_CLWB, FEATURE_SHA_NI, FEATURE_GFNI, FEATURE_VAES,
+     FEATURE_VPCLMULQDQ, FEATURE_RDPID, FEATURE_SERIALIZE, FEATURE_AVX_VNNI,
+     FEATURE_AVX512F, FEATURE_AVX512DQ, FEATURE_AVX512IFMA, FEATURE_AVX512CD,
+     FEATURE_AVX512BW, FEATURE_AVX512VL, FEATURE_AVX512VBMI, FEATURE_AVX512_VBMI2,
+     FEATURE_AVX512_VNNI, FEATURE_AVX512_BITALG, FEATURE_AVX512_VPOPCNTDQ,
+     FEATURE_AVX512_BF16, FEATURE_AVX512_FP16, FEATURE_AMX_TILE, FEATURE_AMX_INT8,
+     FEATURE_AMX_BF16,
+     
+     // Both; AES instructions on x86, the AES extension on ARM
+     FEATURE_AES,
+     
+     // ARM
+     FEATURE_FP, FEATURE_ASIMD, FEATURE_PMULL, FEATURE_SHA1, FEATURE_SHA2, FEATURE_CRC32,
+     FEATURE_ATOMICS, FEATURE_ASIMDHP, FEATURE_ASIMDDP, FEATURE_SHA3, FEATURE_SHA512,
+     FEATURE_SVE, FEATURE_PACA, FEATURE_SVE2, FEATURE_I8MM, FEATURE_BF16, FEATURE_RNG,
+     FEATURE_BTI, FEATURE_MTE, FEATURE_SME,
+     
+     FEATURE_COUNT
+ };
+ 
+ /**
+  * Set of CPU features, one bit per CpuFeature
+  */
+ class CpuFeatureSet {
+ public:
+     bool has(CpuFeature feature) const { return bits.test(feature); }
+     void set(CpuFeature feature) { bits.set(feature); }
+     size_t count() const { return bits.count(); }
+     
+     /**
+      * Whether every feature of another set is in this one
+      */
+     bool hasAll(const CpuFeatureSet& required) const { return (bits & required.bits) == required.bits; }
+ 
+ private:
+     std::bitset<FEATURE_COUNT> bits;
+ };
+ 
+ /**
+  * Read the features of the CPU this runs on and that the kernel has
+  * enabled: the AVX, AVX-512 and AMX features also need their register
+  * state in XCR0. Neither /proc nor /sys is read.
+  * @param features Set to fill
+  * @return false on an architecture with neither CPUID nor hwcaps
+  */
+ bool readCpuFeatures(CpuFeatureSet& features);
+ 
+ /**
+  * Features of this CPU, read once on first use
+  * @return Feature set; empty where readCpuFeatures() is unsupported
+  */
+ const CpuFeatureSet& hostCpuFeatures();
+ 
+ /**
+  * /proc/cpuinfo name of a feature, such as "avx512f"
+  */
+ const char* cpuFeatureName(CpuFeature feature);
+ 
+ /**
+  * Look up a feature by its /proc/cpuinfo name
+  * @param name Name, such as "amx_tile"; "sse3" and "lzcnt" are accepted
+  *             for "pni" and "abm" as well
+  * @param feature Feature found
+  * @return false if no feature has that name
+  */
+ bool findCpuFeature(std::string_view name, CpuFeature& feature);
+ 
+ #endif // FEATURES_HPP
@@ -0,0 +1,377 @@
+/*
+ * format - Machine-readable JSON, Prometheus and TSV output
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "format.hpp"
+ 
+ #include <charconv>
+ #include <cerrno>
+ #include <cmath>
+ #include <cstring>
+ #include <ctime>
+ #include <unistd.h>
+ 
+ bool parseOutputFormat(const std::string& name, OutputFormat& format) {
+     if (name == "text") format = OutputFormat::TEXT;
+     else if (name == "json") format = OutputFormat::JSON;
+     else if (name == "prom" || name == "prometheus") format = OutputFormat::PROMETHEUS;
+     else if (name == "tsv") format = OutputFormat::TSV;
+     else return false;
+     return true;
+ }
+ 
+ double wallClock() {
+     struct timespec now;
+     clock_gettime(CLOCK_REALTIME, &now);
+     return now.tv_sec + now.tv_nsec / 1e9;
+ }
+ 
+ RecordWriter::RecordWriter(const char* prefix) : prefix(prefix) {}
+ 
+ void RecordWriter::begin(double timestamp) {
+     out.clear();
+     prom_cells.clear();
+     prom_text.clear();
+     this->timestamp = timestamp;
+     group_name = nullptr;
+     group_labeled = false;
+     first_group = true;
+     
+     if (output_format == OutputFormat::JSON) {
+         out += '{';
+         if (timestamp > 0.0) {
+             char buf[64];
+             auto result = std::to_chars(buf, buf + sizeof(buf), timestamp, std::chars_format::fixed, 3);
+             out += "\"timestamp\":";
+             out.append(buf, result.ptr - buf);
+             first_group = false;
+         }
+     }
+ }
+ 
+ void RecordWriter::group(const char* name) {
+     closeGroup(name, false);
+     startRow(name, nullptr, std::string_view());
+ }
+ 
+ void RecordWriter::group(const char* name, const char* label, std::string_view value) {
+     closeGroup(name, true);
+     startRow(name, label, value);
+ }
+ 
+ void RecordWriter::group(const char* name, const char* label, long long value) {
+     char buf[32];
+     auto result = std::to_chars(buf, buf + sizeof(buf), value);
+     group(name, label, std::string_view(buf, result.ptr - buf));
+ }
+ 
+ // Open a row of group name; label is null for an unlabeled group
+ void RecordWriter::startRow(const char* name, const char* label, std::string_view value) {
+     group_name = name;
+     group_labeled = label != nullptr;
+     group_label.clear();
+     
+     if (output_format == OutputFormat::JSON) {
+         out += '{';
+         first_field = true;
+         if (label) {
+             appendJsonString(out, label);
+             out += ':';
+             appendJsonString(out, value);
+             first_field = false;
+         }
+     } else if (output_format == OutputFormat::PROMETHEUS) {
+         if (label) {
+             group_label = label;
+             group_label += "=\"";
+             appendPromLabel(group_label, value);
+             group_label += '"';
+         }
+         prom_info.clear();
+     } else if (output_format == OutputFormat::TSV) {
+         row_header = '#';
+         row_header += name;
+         row_text = name;
+         if (label) {
+             row_header += '\t';
+             row_header += label;
+             row_text += '\t';
+             appendTsvValue(row_text, value);
+         }
+         if (timestamp > 0.0) {
+             char buf[64];
+             auto result = std::to_chars(buf, buf + sizeof(buf), timestamp, std::chars_format::fixed, 3);
+             row_header += "\ttimestamp";
+             row_text += '\t';
+             row_text.append(buf, result.ptr - buf);
+         }
+     }
+ }
+ 
+ void RecordWriter::signedField(const char* key, long long value, bool counter) {
+     char buf[32];
+     auto result = std::to_chars(buf, buf + sizeof(buf), value);
+     numberField(key, std::string_view(buf, result.ptr - buf), counter);
+ }
+ 
+ void RecordWriter::unsignedField(const char* key, unsigned long long value, bool counter) {
+     char buf[32];
+     auto result = std::to_chars(buf, buf + sizeof(buf), value);
+     numberField(key, std::string_view(buf, result.ptr - buf), counter);
+ }
+ 
+ void RecordWriter::field(const char* key, double value, int precision) {
+     doubleField(key, value, precision, false);
+ }
+ 
+ void RecordWriter::counter(const char* key, double value, int precision) {
+     doubleField(key, value, precision, true);
+ }
+ 
+ void RecordWriter::doubleField(const char* key, double value, int precision, bool counter) {
+     if (!std::isfinite(value)) {
+         numberField(key, std::string_view(), counter);
+         return;
+     }
+     
+     // Fixed notation does not fit very large values; fall back to the
+     // shortest representation for those
+     char buf[128];
+     auto result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+     if (result.ec != std::errc()) {
+         result = std::to_chars(buf, buf + sizeof(buf), value);
+     }
+     numberField(key, std::string_view(buf, result.ptr - buf), counter);
+ }
+ 
+ void RecordWriter::numberField(const char* key, std::string_view text, bool counter) {
+     if (!group_name) return;
+     
+     if (output_format == OutputFormat::JSON) {
+         if (!first_field) out += ',';
+         first_field = false;
+         appendJsonString(out, key);
+         out += ':';
+         if (text.empty()) out += "null";
+         else out += text;
+     } else if (output_format == OutputFormat::PROMETHEUS) {
+         PromCell cell;
+         cell.key = key;
+         cell.labels = prom_text.size();
+         if (!group_label.empty()) {
+             prom_text += '{';
+             prom_text += group_label;
+             prom_text += '}';
+         }
+         cell.labels_len = prom_text.size() - cell.labels;
+         cell.value = prom_text.size();
+         prom_text += text.empty() ? std::string_view("NaN") : text;
+         cell.value_len = prom_text.size() - cell.value;
+         cell.counter = counter;
+         cell.written = false;
+         prom_cells.push_back(cell);
+     } else if (output_format == OutputFormat::TSV) {
+         row_header += '\t';
+         row_header += key;
+         row_text += '\t';
+         row_text += text;
+     }
+ }
+ 
+ void RecordWriter::field(const char* key, std::string_view value) {
+     if (!group_name) return;
+     
+     if (output_format == OutputFormat::JSON) {
+         if (!first_field) out += ',';
+         first_field = false;
+         appendJsonString(out, key);
+         out += ':';
+         appendJsonString(out, value);
+     } else if (output_format == OutputFormat::PROMETHEUS) {
+         if (!prom_info.empty()) prom_info += ',';
+         prom_info += key;
+         prom_info += "=\"";
+         appendPromLabel(prom_info, value);
+         prom_info += '"';
+     } else if (output_format == OutputFormat::TSV) {
+         row_header += '\t';
+         row_header += key;
+         row_text += '\t';
+         appendTsvValue(row_text, value);
+     }
+ }
+ 
+ // Finish the current row: close its JSON object, turn its string fields
+ // into an info sample, or print it as a TSV line below its header
+ void RecordWriter::closeRow() {
+     if (output_format == OutputFormat::JSON) {
+         out += '}';
+     } else if (output_format == OutputFormat::PROMETHEUS) {
+         if (prom_info.empty()) return;
+         
+         PromCell cell;
+         cell.key = "info";
+         cell.labels = prom_text.size();
+         prom_text += '{';
+         if (!group_label.empty()) {
+             prom_text += group_label;
+             prom_text += ',';
+         }
+         prom_text += prom_info;
+         prom_text += '}';
+         cell.labels_len = prom_text.size() - cell.labels;
+         cell.value = prom_text.size();
+         prom_text += '1';
+         cell.value_len = 1;
+         cell.counter = false;
+         cell.written = false;
+         prom_cells.push_back(cell);
+     } else if (output_format == OutputFormat::TSV) {
+         // The header is repeated only when the columns of a group change
+         TsvHeader* last = nullptr;
+         for (auto& header : tsv_headers) {
+             if (header.name == group_name) last = &header;
+         }
+         if (!last) {
+             tsv_headers.push_back(TsvHeader{group_name, std::string()});
+             last = &tsv_headers.back();
+         }
+         if (last->header != row_header) {
+             last->header = row_header;
+             out += row_header;
+             out += '\n';
+         }
+         out += row_text;
+         out += '\n';
+     }
+ }
+ 
+ // Close the current group before next_name starts. Labeled rows of the
+ // same name stay in one JSON array and one run of Prometheus cells.
+ void RecordWriter::closeGroup(const char* next_name, bool next_labeled) {
+     bool same_run = group_name && next_name && group_labeled && next_labeled &&
+                     std::strcmp(group_name, next_name) == 0;
+     
+     if (group_name) {
+         closeRow();
+         if (output_format == OutputFormat::JSON) {
+             if (same_run) out += ',';
+             else if (group_labeled) out += ']';
+         } else if (output_format == OutputFormat::PROMETHEUS && !same_run) {
+             flushProm();
+         }
+     }
+     
+     if (output_format == OutputFormat::JSON && next_name && !same_run) {
+         if (!first_group) out += ',';
+         first_group = false;
+         appendJsonString(out, next_name);
+         out += ':';
+         if (next_labeled) out += '[';
+     }
+ }
+ 
+ // Write the held back samples grouped by metric name, in the order in
+ // which each name first appeared. Each family starts with its # TYPE
+ // line, counter if it was added with counter() and gauge otherwise.
+ void RecordWriter::flushProm() {
+     auto appendName = [this](const char* key) {
+         out += prefix;
+         out += '_';
+         out += group_name;
+         out += '_';
+         out += key;
+     };
+     
+     for (size_t i = 0; i < prom_cells.size(); ++i) {
+         if (prom_cells[i].written) continue;
+         const char* key = prom_cells[i].key;
+         
+         out += "# TYPE ";
+         appendName(key);
+         out += prom_cells[i].counter ? " counter\n" : " gauge\n";
+         
+         for (size_t j = i; j < prom_cells.size(); ++j) {
+             PromCell& cell = prom_cells[j];
+             if (cell.written || (cell.key != key && std::strcmp(cell.key, key) != 0)) continue;
+             
+             appendName(key);
+             out.append(prom_text, cell.labels, cell.labels_len);
+             out += ' ';
+             out.append(prom_text, cell.value, cell.value_len);
+             out += '\n';
+             cell.written = true;
+         }
+     }
+     prom_cells.clear();
+     prom_text.clear();
+ }
+ 
+ std::string_view RecordWriter::finish() {
+     closeGroup(nullptr, false);
+     group_name = nullptr;
+     if (output_format == OutputFormat::JSON) out += "}\n";
+     return out;
+ }
+ 
+ bool RecordWriter::end() {
+     std::string_view text = finish();
+     
+     size_t done = 0;
+     while (done < text.size()) {
+         ssize_t n = write(STDOUT_FILENO, text.data() + done, text.size() - done);
+         if (n < 0) {
+             if (errno == EINTR) continue;
+             return false;
+         }
+         done += n;
+     }
+     return true;
+ }
+ 
+ void RecordWriter::appendJsonString(std::string& buf, std::string_view text) {
+     static const char hex[] = "0123456789abcdef";
+     
+     buf += '"';
+     for (char c : text) {
+         unsigned char u = static_cast<unsigned char>(c);
+         if (c == '"' || c == '\\') {
+             buf += '\\';
+             buf += c;
+         } else if (c == '\n') {
+             buf += "\\n";
+         } else if (c == '\t') {
+             buf += "\\t";
+         } else if (u < 0x20) {
+             buf += "\\u00";
+             buf += hex[u >> 4];
+             buf += hex[u & 0xf];
+         } else {
+             buf += c;
+         }
+     }
+     buf += '"';
+ }
+ 
+ void RecordWriter::appendPromLabel(std::string& buf, std::string_view text) {
+     for (char c : text) {
+         if (c == '"' || c == '\\') {
+             buf += '\\';
+             buf += c;
+         } else if (c == '\n') {
+             buf += "\\n";
+         } else {
+             buf += c;
+         }
+     }
+ }
+ 
+ // Tabs and newlines would break the row, so they become spaces
+ void RecordWriter::appendTsvValue(std::string& buf, std::string_view text) {
+     for (char c : text) {
+         buf += (c == '\t' || c == '\n' || c == '\r') ? ' ' : c;
+     }
+ }
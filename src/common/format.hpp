@@ -0,0 +1,230 @@
+/*
+ * format - Machine-readable JSON, Prometheus and TSV output
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef FORMAT_HPP
+ #define FORMAT_HPP
+ 
+ #include <string>
+ #include <string_view>
+ #include <type_traits>
+ #include <vector>
+ 
+ /**
+  * Output formats selected with --format
+  */
+ enum class OutputFormat {
+     TEXT,        // Human-readable tables
+     JSON,        // One JSON object per sample and line
+     PROMETHEUS,  // Prometheus text exposition format
+     TSV          // Tab-separated rows with a "#" header per group
+ };
+ 
+ /**
+  * Look up an output format by its --format name
+  * @param name "text", "json", "prom" or "tsv"
+  * @param format Set to the matching format
+  * @return false if the name is unknown
+  */
+ bool parseOutputFormat(const std::string& name, OutputFormat& format);
+ 
+ /**
+  * Current wall-clock time for sample timestamps
+  * @return Seconds since the Unix epoch
+  */
+ double wallClock();
+ 
+ /**
+  * Streaming writer for one sample of named groups of fields.
+  *
+  * A sample is begin(), any number of group() calls each followed by its
+  * field() calls, then end(). Labeled groups of the same name that follow
+  * each other form one table: a JSON array, one Prometheus metric family
+  * per field, or consecutive TSV rows. Numbers are formatted with
+  * std::to_chars into a buffer that is reused between samples, and end()
+  * hands the whole sample to a single write().
+  *
+  * JSON:  {"timestamp":T,"load":{"load1":0.52},"cpu":[{"cpu":"0","user":1.5}]}
+  * Prometheus: cpuinfo_load_load1 0.52, cpuinfo_cpu_user{cpu="0"} 1.5;
+  *        string fields become labels of a GROUP_info metric with value 1;
+  *        each family has a # TYPE line, counter for counter() fields and
+  *        gauge for all others
+  * TSV:   #load<TAB>timestamp<TAB>load1, then load<TAB>T<TAB>0.52
+  */
+ class RecordWriter {
+ public:
+     /**
+      * Constructor
+      * @param prefix Metric name prefix for Prometheus, usually the program name
+      */
+     explicit RecordWriter(const char* prefix);
+     
+     RecordWriter(const RecordWriter&) = delete;
+     RecordWriter& operator=(const RecordWriter&) = delete;
+     
+     /**
+      * Select the output format; TEXT leaves the writer unused
+      * @param format Output format
+      */
+     void setFormat(OutputFormat format) { output_format = format; }
+     
+     /**
+      * Currently selected output format
+      */
+     OutputFormat format() const { return output_format; }
+     
+     /**
+      * Start a sample
+      * @param timestamp Unix time of the sample, or 0 to leave it out.
+      *                  Prometheus output never carries it.
+      */
+     void begin(double timestamp = 0.0);
+     
+     /**
+      * Start an unlabeled group
+      * @param name Group name, a lowercase identifier
+      */
+     void group(const char* name);
+     
+     /**
+      * Start one row of a labeled group
+      * @param name Group name
+      * @param label Name of the label identifying the row, such as "device"
+      * @param value Label value
+      */
+     void group(const char* name, const char* label, std::string_view value);
+     
+     /**
+      * Start one row of a labeled group identified by a number
+      * @param name Group name
+      * @param label Name of the label identifying the row, such as "cpu"
+      * @param value Label value
+      */
+     void group(const char* name, const char* label, long long value);
+     
+     /**
+      * Add an integer field to the current group
+      * @param key Field name, a lowercase identifier
+      * @param value Field value
+      */
+     template <typename T>
+     std::enable_if_t<std::is_integral_v<T>> field(const char* key, T value) {
+         if constexpr (std::is_signed_v<T>) {
+             signedField(key, value, false);
+         } else {
+             unsignedField(key, value, false);
+         }
+     }
+     
+     /**
+      * Add a floating point field to the current group
+      * @param key Field name
+      * @param value Field value; NaN and infinities are written as null/NaN
+      * @param precision Digits after the decimal point
+      */
+     void field(const char* key, double value, int precision = 2);
+     
+     /**
+      * Add an integer counter, a total that only grows while the system
+      * runs; Prometheus output types it counter instead of gauge
+      * @param key Field name, ending in _total
+      * @param value Field value
+      */
+     template <typename T>
+     std::enable_if_t<std::is_integral_v<T>> counter(const char* key, T value) {
+         if constexpr (std::is_signed_v<T>) {
+             signedField(key, value, true);
+         } else {
+             unsignedField(key, value, true);
+         }
+     }
+     
+     /**
+      * Add a floating point counter, such as seconds spent in a state
+      * @param key Field name, ending in _total
+      * @param value Field value
+      * @param precision Digits after the decimal point
+      */
+     void counter(const char* key, double value, int precision = 2);
+     
+     /**
+      * Add a string field to the current group
+      * @param key Field name
+      * @param value Field value
+      */
+     void field(const char* key, std::string_view value);
+     
+     /**
+      * Finish the sample and write it to standard output
+      * @return false if the write failed
+      */
+     bool end();
+     
+     /**
+      * Finish the sample and return its text instead of writing it
+      * @return Formatted sample, valid until the next begin()
+      */
+     std::string_view finish();
+ 
+ private:
+     // A Prometheus sample held back until its labeled group run ends, so
+     // that all samples of a metric family are written together
+     struct PromCell {
+         const char* key;
+         size_t labels;        // Offset of the "{...}" text in prom_text
+         size_t labels_len;
+         size_t value;         // Offset of the value text in prom_text
+         size_t value_len;
+         bool counter;         // # TYPE counter rather than gauge
+         bool written;
+     };
+     
+     // Last TSV header printed for a group name
+     struct TsvHeader {
+         std::string name;
+         std::string header;
+     };
+     
+     OutputFormat output_format = OutputFormat::TEXT;
+     std::string prefix;
+     std::string out;             // Sample text, reused between samples
+     double timestamp = 0.0;
+     
+     const char* group_name = nullptr;
+     std::string group_label;     // Label of the current row, empty if unlabeled
+     bool group_labeled = false;
+     bool first_field = true;     // No field written yet in the current JSON object
+     bool first_group = true;
+     
+     std::string row_text;        // TSV values of the current row
+     std::string row_header;      // TSV header of the current row
+     std::vector<TsvHeader> tsv_headers;
+     
+     std::vector<PromCell> prom_cells;
+     std::string prom_text;       // Label and value text of prom_cells
+     std::string prom_info;       // String fields of the current row as labels
+     
+     void signedField(const char* key, long long value, bool counter);
+     void unsignedField(const char* key, unsigned long long value, bool counter);
+     void doubleField(const char* key, double value, int precision, bool counter);
+     
+     /**
+      * Add a field whose value is already formatted as a number
+      * @param key Field name
+      * @param text Number text, or empty for a missing value
+      * @param counter Whether the value is a counter
+      */
+     void numberField(const char* key, std::string_view text, bool counter);
+     void startRow(const char* name, const char* label, std::string_view value);
+     void closeRow();
+     void closeGroup(const char* next_name, bool next_labeled);
+     void flushProm();
+     void appendJsonString(std::string& buf, std::string_view text);
+     void appendPromLabel(std::string& buf, std::string_view text);
+     void appendTsvValue(std::string& buf, std::string_view text);
+ };
+ 
+ #endif // FORMAT_HPP
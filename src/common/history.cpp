@@ -0,0 +1,125 @@
+/*
+ * history - Fixed-capacity ring of recent samples for watch mode
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "history.hpp"
+ #include "output.hpp"
+ 
+ #include <algorithm>
+ #include <iomanip>
+ #include <iostream>
+ #include <sstream>
+ 
+ SampleHistory::SampleHistory(size_t capacity, size_t width)
+     : slots(capacity > 0 ? capacity : 1), record_width(width > 0 ? width : 1),
+       values(new std::atomic<float>[slots * record_width]), head(0), started(0) {
+     for (size_t i = 0; i < slots * record_width; ++i) {
+         values[i].store(0.0f, std::memory_order_relaxed);
+     }
+ }
+ 
+ size_t SampleHistory::size() const {
+     unsigned long long published = head.load(std::memory_order_acquire);
+     return published < slots ? published : slots;
+ }
+ 
+ // Announce the record before touching its slot, so a reader that saw any
+ // of the new values also sees that the old record is gone
+ void SampleHistory::push(const float* record) {
+     unsigned long long index = head.load(std::memory_order_relaxed);
+     started.store(index + 1, std::memory_order_relaxed);
+     std::atomic_thread_fence(std::memory_order_release);
+     
+     std::atomic<float>* slot = &values[(index % slots) * record_width];
+     for (size_t i = 0; i < record_width; ++i) {
+         slot[i].store(record[i], std::memory_order_relaxed);
+     }
+     head.store(index + 1, std::memory_order_release);
+ }
+ 
+ size_t SampleHistory::column(size_t index, size_t count, std::vector<float>& out) const {
+     out.clear();
+     if (index >= record_width) return 0;
+     
+     unsigned long long end = head.load(std::memory_order_acquire);
+     unsigned long long held = end < slots ? end : slots;
+     if (count > held) count = held;
+     unsigned long long first = end - count;
+     
+     for (unsigned long long i = first; i < end; ++i) {
+         out.push_back(values[(i % slots) * record_width + index].load(std::memory_order_relaxed));
+     }
+     
+     // The record being written when we finished overwrote the one
+     // capacity() before it; anything that old may be torn
+     std::atomic_thread_fence(std::memory_order_acquire);
+     unsigned long long begun = started.load(std::memory_order_relaxed);
+     if (begun > slots && begun - slots > first) {
+         unsigned long long torn = std::min<unsigned long long>(begun - slots - first, out.size());
+         out.erase(out.begin(), out.begin() + torn);
+     }
+     return out.size();
+ }
+ 
+ HistorySummary SampleHistory::summarize(size_t index, std::vector<float>& scratch) const {
+     HistorySummary summary;
+     if (column(index, slots, scratch) == 0) return summary;
+     
+     summary.count = scratch.size();
+     summary.last = scratch.back();
+     double total = 0.0;
+     for (float value : scratch) total += value;
+     summary.mean = static_cast<float>(total / scratch.size());
+     
+     // Nearest rank: the smallest value with at least p% of the samples at
+     // or below it
+     auto rank = [&summary](double percent) {
+         size_t r = static_cast<size_t>(percent / 100.0 * summary.count + 0.999999);
+         return r > 0 ? r - 1 : 0;
+     };
+     std::sort(scratch.begin(), scratch.end());
+     summary.min = scratch.front();
+     summary.max = scratch.back();
+     summary.p50 = scratch[rank(50.0)];
+     summary.p99 = scratch[rank(99.0)];
+     return summary;
+ }
+ 
+ void printHistory(const SampleHistory& history, const std::vector<HistorySeries>& series,
+                   const std::string& title, size_t width, bool colors) {
+     static const char* const blocks[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+     
+     std::string heading = title;
+     heading.resize(std::max<size_t>(heading.size() + 1, width + 10), ' ');
+     std::ostringstream columns;
+     columns << std::right << std::setw(9) << "NOW" << std::setw(9) << "P50"
+             << std::setw(9) << "P99" << std::setw(9) << "MAX";
+     std::cout << colorize(heading + columns.str(), Colors::BOLD, colors) << '\n';
+     
+     std::vector<float> recent, scratch;
+     for (const auto& row : series) {
+         history.column(row.column, width, recent);
+         HistorySummary summary = history.summarize(row.column, scratch);
+         
+         // Scale to the window's maximum when the series has no natural top
+         double top = row.scale;
+         if (top <= 0.0) {
+             for (float value : recent) top = std::max<double>(top, value);
+         }
+         
+         std::string line = row.name;
+         line.resize(std::max<size_t>(line.size() + 1, 10), ' ');
+         line.append(width - recent.size(), ' ');
+         for (float value : recent) {
+             int level = top > 0.0 ? static_cast<int>(value / top * 7.0 + 0.5) : 0;
+             line += blocks[std::clamp(level, 0, 7)];
+         }
+         
+         std::cout << line << std::fixed << std::setprecision(row.precision)
+                   << std::setw(9) << summary.last << std::setw(9) << summary.p50
+                   << std::setw(9) << summary.p99 << std::setw(9) << summary.max << '\n';
+     }
+ }
@@ -0,0 +1,119 @@
+/*
+ * history - Fixed-capacity ring of recent samples for watch mode
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef HISTORY_HPP
+ #define HISTORY_HPP
+ 
+ #include <atomic>
+ #include <cstddef>
+ #include <memory>
+ #include <string>
+ #include <vector>
+ 
+ /**
+  * Summary of one column over the records held in a SampleHistory
+  */
+ struct HistorySummary {
+     size_t count;            // Records summarized
+     float last;
+     float min;
+     float max;
+     float mean;
+     float p50;
+     float p99;
+     
+     HistorySummary() : count(0), last(0), min(0), max(0), mean(0), p50(0), p99(0) {}
+ };
+ 
+ /**
+  * Ring of the last capacity() records, each width() floats wide, such as
+  * one usage value per CPU.
+  *
+  * One thread pushes; any number of threads read without locks. Every
+  * value is a relaxed atomic, and a record is published by advancing the
+  * head with release ordering. A reader copies the records it wants and
+  * then drops any that the writer started overwriting meanwhile, so a copy
+  * never mixes two samples in one record.
+  */
+ class SampleHistory {
+ public:
+     /**
+      * Constructor
+      * @param capacity Records kept; older ones are overwritten
+      * @param width Values per record
+      */
+     SampleHistory(size_t capacity, size_t width);
+     
+     SampleHistory(const SampleHistory&) = delete;
+     SampleHistory& operator=(const SampleHistory&) = delete;
+     
+     size_t capacity() const { return slots; }
+     size_t width() const { return record_width; }
+     
+     /**
+      * Number of records held, at most capacity()
+      */
+     size_t size() const;
+     
+     /**
+      * Append a record; only one thread may push
+      * @param record width() values
+      */
+     void push(const float* record);
+     
+     /**
+      * Copy one column of the newest records
+      * @param index Column, less than width()
+      * @param count Records wanted; fewer are returned while filling up
+      * @param out Replaced by the values, oldest first
+      * @return Number of values copied
+      */
+     size_t column(size_t index, size_t count, std::vector<float>& out) const;
+     
+     /**
+      * Minimum, maximum, mean and nearest-rank percentiles of one column
+      * over every record held
+      * @param index Column, less than width()
+      * @param scratch Buffer reused between calls to avoid allocation
+      * @return Summary, with count 0 if no record has been pushed
+      */
+     HistorySummary summarize(size_t index, std::vector<float>& scratch) const;
+ 
+ private:
+     size_t slots;
+     size_t record_width;
+     std::unique_ptr<std::atomic<float>[]> values;
+     std::atomic<unsigned long long> head;      // Records published
+     std::atomic<unsigned long long> started;   // Records the writer has begun
+ };
+ 
+ /**
+  * One row of a history panel
+  */
+ struct HistorySeries {
+     std::string name;
+     size_t column;           // Column of the SampleHistory
+     double scale;            // Value drawn as a full block, 0 to scale to the maximum seen
+     int precision;           // Digits after the decimal point in the summary
+     
+     HistorySeries(const std::string& name, size_t column, double scale, int precision = 1)
+         : name(name), column(column), scale(scale), precision(precision) {}
+ };
+ 
+ /**
+  * Print a sparkline of the newest records and NOW/P50/P99/MAX for each
+  * series, under a bold heading
+  * @param history Samples to draw
+  * @param series Rows to print
+  * @param title Heading, such as "CPU %" or "AVAIL MB"
+  * @param width Samples per sparkline
+  * @param colors Whether the heading may be printed in bold
+  */
+ void printHistory(const SampleHistory& history, const std::vector<HistorySeries>& series,
+                   const std::string& title, size_t width, bool colors);
+ 
+ #endif // HISTORY_HPP
@@ -0,0 +1,503 @@
+/*
+ * mem - Shared memory collectors for /proc/meminfo, /proc/vmstat and PSI
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "mem.hpp"
+ #include "stats.hpp"
+ #include "procfs.hpp"
+ #include "cgroup.hpp"
+ 
+ #include <algorithm>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <deque>
+ #include <functional>
+ #include <memory>
+ #include <mutex>
+ #include <string_view>
+ #include <thread>
+ #include <fcntl.h>
+ #include <unistd.h>
+ 
+ namespace {
+ 
+ // --stats timing of the collectors in this file
+ StatSection cgroup_memory_section("readCgroupMemoryInfo");
+ StatSection meminfo_section("MemSampler::memoryInfo");
+ StatSection vmstat_section("MemSampler::vmStat");
+ StatSection pressure_section("MemSampler::pressure");
+ StatSection top_processes_section("readTopProcesses");
+ 
+ struct MemInfoKey {
+     std::string_view name;
+     MemField field;
+ };
+ 
+ // Sorted by name for binary search; adding a field only needs an entry here
+ constexpr MemInfoKey MEMINFO_KEYS[] = {
+     {"Active",          MEM_ACTIVE},
+     {"AnonHugePages",   MEM_ANON_HUGE_PAGES},
+     {"AnonPages",       MEM_ANON_PAGES},
+     {"Buffers",         MEM_BUFFERS},
+     {"Cached",          MEM_CACHED},
+     {"CommitLimit",     MEM_COMMIT_LIMIT},
+     {"Committed_AS",    MEM_COMMITTED_AS},
+     {"Dirty",           MEM_DIRTY},
+     {"HugePages_Free",  MEM_HUGE_PAGES_FREE},
+     {"HugePages_Rsvd",  MEM_HUGE_PAGES_RSVD},
+     {"HugePages_Surp",  MEM_HUGE_PAGES_SURP},
+     {"HugePages_Total", MEM_HUGE_PAGES_TOTAL},
+     {"Hugepagesize",    MEM_HUGE_PAGE_SIZE},
+     {"Hugetlb",         MEM_HUGETLB},
+     {"Inactive",        MEM_INACTIVE},
+     {"KReclaimable",    MEM_KRECLAIMABLE},
+     {"KernelStack",     MEM_KERNEL_STACK},
+     {"Mapped",          MEM_MAPPED},
+     {"MemAvailable",    MEM_AVAILABLE},
+     {"MemFree",         MEM_FREE},
+     {"MemTotal",        MEM_TOTAL},
+     {"Mlocked",         MEM_MLOCKED},
+     {"PageTables",      MEM_PAGE_TABLES},
+     {"Percpu",          MEM_PERCPU},
+     {"SReclaimable",    MEM_SRECLAIMABLE},
+     {"SUnreclaim",      MEM_SUNRECLAIM},
+     {"Shmem",           MEM_SHMEM},
+     {"Slab",            MEM_SLAB},
+     {"SwapCached",      MEM_SWAP_CACHED},
+     {"SwapFree",        MEM_SWAP_FREE},
+     {"SwapTotal",       MEM_SWAP_TOTAL},
+     {"VmallocUsed",     MEM_VMALLOC_USED},
+     {"Writeback",       MEM_WRITEBACK}
+ };
+ 
+ constexpr bool keysSorted() {
+     for (size_t i = 1; i < sizeof(MEMINFO_KEYS) / sizeof(MEMINFO_KEYS[0]); ++i) {
+         if (!(MEMINFO_KEYS[i - 1].name < MEMINFO_KEYS[i].name)) return false;
+     }
+     return true;
+ }
+ static_assert(keysSorted(), "MEMINFO_KEYS must be sorted by name");
+ 
+ const MemInfoKey* findMemInfoKey(std::string_view name) {
+     const MemInfoKey* begin = MEMINFO_KEYS;
+     const MemInfoKey* end = MEMINFO_KEYS + sizeof(MEMINFO_KEYS) / sizeof(MEMINFO_KEYS[0]);
+     const MemInfoKey* key = std::lower_bound(begin, end, name,
+                                              [](const MemInfoKey& entry, std::string_view value) {
+                                                  return entry.name < value;
+                                              });
+     return key != end && key->name == name ? key : nullptr;
+ }
+ 
+ // Scans and steals are split by reclaimer (kswapd, direct, khugepaged); the
+ // pgscan_anon/pgscan_file breakdown and pgscan_direct_throttle events are
+ // not added again
+ bool isReclaimer(std::string_view suffix) {
+     if (suffix == "direct_throttle") return false;
+     return suffix.substr(0, 6) == "kswapd" || suffix.substr(0, 6) == "direct" ||
+            suffix.substr(0, 10) == "khugepaged";
+ }
+ 
+ // Resident memory, or swap when ranking by swap, and PID of a process
+ // ranked for the top consumers
+ typedef std::pair<unsigned long, int> MemCandidate;
+ 
+ // Chunks of the PID list owned by one scan worker
+ struct ScanQueue {
+     std::mutex lock;
+     std::deque<size_t> chunks;
+ };
+ 
+ // Parse the value of a "Key:   1234 kB" line starting at p
+ unsigned long smapsValue(const char* p) {
+     while (*p == ' ' || *p == '\t') ++p;
+     unsigned long value = 0;
+     while (*p >= '0' && *p <= '9') {
+         value = value * 10 + (*p - '0');
+         ++p;
+     }
+     return value;
+ }
+ 
+ // Resident set size from the second field of /proc/PID/statm
+ unsigned long readProcessRss(int proc_fd, int pid, unsigned long page_kb) {
+     char path[32];
+     snprintf(path, sizeof(path), "%d/statm", pid);
+     
+     char buf[128];
+     if (readFileAt(proc_fd, path, buf, sizeof(buf)) <= 0) return 0;
+     
+     const char* p = buf;
+     parseNumber(p);
+     return parseNumber(p) * page_kb;
+ }
+ 
+ // Swapped-out memory from VmSwap of /proc/PID/status; kernel threads
+ // have no such line and read as 0
+ unsigned long readProcessSwap(int proc_fd, int pid) {
+     char path[32];
+     snprintf(path, sizeof(path), "%d/status", pid);
+     
+     char buf[4096];
+     if (readFileAt(proc_fd, path, buf, sizeof(buf)) <= 0) return 0;
+     
+     const char* line = std::strstr(buf, "\nVmSwap:");
+     return line ? smapsValue(line + 8) : 0;
+ }
+ 
+ // Offer a process to a bounded min-heap of the top candidates
+ void pushCandidate(std::vector<MemCandidate>& heap, const MemCandidate& candidate, size_t limit) {
+     if (heap.size() == limit && candidate <= heap.front()) return;
+     
+     heap.push_back(candidate);
+     std::push_heap(heap.begin(), heap.end(), std::greater<MemCandidate>());
+     if (heap.size() > limit) {
+         std::pop_heap(heap.begin(), heap.end(), std::greater<MemCandidate>());
+         heap.pop_back();
+     }
+ }
+ 
+ void scanPids(int proc_fd, const int* begin, const int* end, MemSortKey sort, unsigned long page_kb,
+               size_t limit, std::vector<MemCandidate>& heap) {
+     for (const int* pid = begin; pid != end; ++pid) {
+         unsigned long memory_kb = sort == MEM_SORT_SWAP ? readProcessSwap(proc_fd, *pid)
+                                                         : readProcessRss(proc_fd, *pid, page_kb);
+         if (memory_kb > 0) {
+             pushCandidate(heap, MemCandidate(memory_kb, *pid), limit);
+         }
+     }
+ }
+ 
+ // Take a chunk from our own queue, or steal one from the far end of another
+ bool takeChunk(std::vector<std::unique_ptr<ScanQueue>>& queues, size_t self, size_t& chunk) {
+     {
+         std::lock_guard<std::mutex> guard(queues[self]->lock);
+         if (!queues[self]->chunks.empty()) {
+             chunk = queues[self]->chunks.front();
+             queues[self]->chunks.pop_front();
+             return true;
+         }
+     }
+     
+     for (size_t i = 1; i < queues.size(); ++i) {
+         ScanQueue& victim = *queues[(self + i) % queues.size()];
+         std::lock_guard<std::mutex> guard(victim.lock);
+         if (!victim.chunks.empty()) {
+             chunk = victim.chunks.back();
+             victim.chunks.pop_back();
+             return true;
+         }
+     }
+     return false;
+ }
+ 
+ // Split the PID list into chunks spread over per-worker queues; each
+ // worker keeps its own top-N heap and the heaps are merged at the end
+ void scanPidsParallel(int proc_fd, const std::vector<int>& pids, unsigned jobs, MemSortKey sort,
+                       unsigned long page_kb, size_t limit, std::vector<MemCandidate>& heap) {
+     const size_t chunk_size = 64;
+     size_t chunk_count = (pids.size() + chunk_size - 1) / chunk_size;
+     size_t workers = std::min<size_t>(jobs, chunk_count);
+     if (workers <= 1) {
+         scanPids(proc_fd, pids.data(), pids.data() + pids.size(), sort, page_kb, limit, heap);
+         return;
+     }
+     
+     std::vector<std::unique_ptr<ScanQueue>> queues;
+     for (size_t w = 0; w < workers; ++w) {
+         queues.emplace_back(new ScanQueue);
+     }
+     for (size_t c = 0; c < chunk_count; ++c) {
+         queues[c * workers / chunk_count]->chunks.push_back(c);
+     }
+     
+     std::vector<std::vector<MemCandidate>> heaps(workers);
+     auto work = [&](size_t self) {
+         size_t chunk;
+         while (takeChunk(queues, self, chunk)) {
+             const int* begin = pids.data() + chunk * chunk_size;
+             const int* end = pids.data() + std::min(pids.size(), (chunk + 1) * chunk_size);
+             scanPids(proc_fd, begin, end, sort, page_kb, limit, heaps[self]);
+         }
+     };
+     
+     std::vector<std::thread> threads;
+     for (size_t w = 1; w < workers; ++w) {
+         threads.emplace_back(work, w);
+     }
+     work(0);
+     for (auto& thread : threads) {
+         thread.join();
+     }
+     
+     for (const auto& local : heaps) {
+         for (const auto& candidate : local) {
+             pushCandidate(heap, candidate, limit);
+         }
+     }
+ }
+ 
+ // Fill PSS, USS and swap from /proc/PID/smaps_rollup
+ bool readSmapsRollup(int proc_fd, ProcessMemory& proc) {
+     char path[64];
+     snprintf(path, sizeof(path), "%d/smaps_rollup", proc.pid);
+     
+     char buf[4096];
+     if (readFileAt(proc_fd, path, buf, sizeof(buf)) <= 0) return false;
+     
+     unsigned long private_clean = 0;
+     unsigned long private_dirty = 0;
+     for (const char* line = buf; *line;) {
+         if (std::strncmp(line, "Pss:", 4) == 0) {
+             proc.pss_kb = smapsValue(line + 4);
+         } else if (std::strncmp(line, "Private_Clean:", 14) == 0) {
+             private_clean = smapsValue(line + 14);
+         } else if (std::strncmp(line, "Private_Dirty:", 14) == 0) {
+             private_dirty = smapsValue(line + 14);
+         } else if (std::strncmp(line, "Swap:", 5) == 0) {
+             proc.swap_kb = smapsValue(line + 5);
+         }
+         
+         const char* next = std::strchr(line, '\n');
+         if (!next) break;
+         line = next + 1;
+     }
+     
+     proc.uss_kb = private_clean + private_dirty;
+     proc.has_smaps = true;
+     return true;
+ }
+ 
+ unsigned long sortValue(const ProcessMemory& proc, MemSortKey sort) {
+     switch (sort) {
+         case MEM_SORT_PSS: return proc.pss_kb;
+         case MEM_SORT_USS: return proc.uss_kb;
+         case MEM_SORT_SWAP: return proc.swap_kb;
+         default: return proc.rss_kb;
+     }
+ }
+ 
+ }
+ 
+ void parseMemInfo(const char* text, MemoryInfo& info) {
+     const char* p = text;
+     while (*p) {
+         const char* name = p;
+         while (*p && *p != ':' && *p != '\n') ++p;
+         if (*p != ':') break;
+         
+         const MemInfoKey* key = findMemInfoKey(std::string_view(name, p - name));
+         
+         ++p;
+         while (*p == ' ') ++p;
+         unsigned long value = 0;
+         while (*p >= '0' && *p <= '9') {
+             value = value * 10 + (*p - '0');
+             ++p;
+         }
+         if (key) info[key->field] = value;
+         
+         while (*p && *p != '\n') ++p;
+         if (*p) ++p;
+     }
+ }
+ 
+ VmStatCounters parseVmStat(const char* text) {
+     VmStatCounters counters;
+     
+     for (const char* line = text; *line;) {
+         const char* space = std::strchr(line, ' ');
+         if (!space) break;
+         
+         std::string_view name(line, space - line);
+         char* end = nullptr;
+         unsigned long long value = std::strtoull(space + 1, &end, 10);
+         
+         if (name == "pswpin") counters.pswpin = value;
+         else if (name == "pswpout") counters.pswpout = value;
+         else if (name == "pgmajfault") counters.pgmajfault = value;
+         else if (name.substr(0, 7) == "pgscan_" && isReclaimer(name.substr(7))) counters.pgscan += value;
+         else if (name.substr(0, 8) == "pgsteal_" && isReclaimer(name.substr(8))) counters.pgsteal += value;
+         
+         const char* next = std::strchr(end, '\n');
+         if (!next) break;
+         line = next + 1;
+     }
+     
+     return counters;
+ }
+ 
+ // The limit is memory.max capped at physical memory, and, as in kubelet,
+ // the working set is memory.current minus inactive_file
+ MemoryInfo readCgroupMemoryInfo(const SysfsDir& dir, const MemoryInfo& host) {
+     StatTimer timer(cgroup_memory_section);
+     MemoryInfo info;
+     
+     unsigned long long current = 0, limit = CGROUP_UNLIMITED, inactive = 0;
+     readCgroupLimit(dir, "memory.current", current);
+     readCgroupLimit(dir, "memory.max", limit);
+     
+     char stat[8192];
+     if (dir.read("memory.stat", stat, sizeof(stat)) > 0) {
+         cgroupStatValue(stat, "inactive_file", inactive);
+     }
+     
+     unsigned long total_kb = host[MEM_TOTAL];
+     if (limit != CGROUP_UNLIMITED) total_kb = std::min<unsigned long long>(total_kb, limit / 1024);
+     unsigned long working_kb = (current - std::min(current, inactive)) / 1024;
+     
+     info[MEM_TOTAL] = total_kb;
+     info[MEM_AVAILABLE] = total_kb - std::min(total_kb, working_kb);
+     info[MEM_FREE] = total_kb - std::min<unsigned long>(total_kb, current / 1024);
+     
+     unsigned long long swap = 0, swap_limit = CGROUP_UNLIMITED;
+     readCgroupLimit(dir, "memory.swap.current", swap);
+     readCgroupLimit(dir, "memory.swap.max", swap_limit);
+     
+     info[MEM_SWAP_TOTAL] = host[MEM_SWAP_TOTAL];
+     if (swap_limit != CGROUP_UNLIMITED) {
+         info[MEM_SWAP_TOTAL] = std::min<unsigned long long>(info[MEM_SWAP_TOTAL], swap_limit / 1024);
+     }
+     info[MEM_SWAP_FREE] = info[MEM_SWAP_TOTAL] - std::min<unsigned long>(info[MEM_SWAP_TOTAL], swap / 1024);
+     return info;
+ }
+ 
+ bool cgroupMemoryMetric(const SysfsDir& dir, unsigned long long& value) {
+     return dir.readUnsigned("memory.current", value);
+ }
+ 
+ MemSampler::MemSampler() : meminfo_fd(-1), vmstat_fd(-1), pressure_fd(-1) {}
+ 
+ MemSampler::~MemSampler() {
+     if (meminfo_fd >= 0) close(meminfo_fd);
+     if (vmstat_fd >= 0) close(vmstat_fd);
+     if (pressure_fd >= 0) close(pressure_fd);
+ }
+ 
+ void MemSampler::useCgroup(const SysfsDir& dir) {
+     if (vmstat_fd >= 0) close(vmstat_fd);
+     if (pressure_fd >= 0) close(pressure_fd);
+     vmstat_fd = dir.openFile("memory.stat");
+     pressure_fd = dir.openFile("memory.pressure");
+ }
+ 
+ bool MemSampler::openCounters() {
+     openProcFile(pressure_fd, "/proc/pressure/memory");
+     return openProcFile(vmstat_fd, "/proc/vmstat") >= 0;
+ }
+ 
+ MemoryInfo MemSampler::memoryInfo() {
+     StatTimer timer(meminfo_section);
+     MemoryInfo info;
+     if (openProcFile(meminfo_fd, "/proc/meminfo") < 0 || readProcFile(meminfo_fd, meminfo_buf) < 0) {
+         return info;
+     }
+     
+     parseMemInfo(meminfo_buf.data(), info);
+     return info;
+ }
+ 
+ VmStatCounters MemSampler::vmStat() {
+     StatTimer timer(vmstat_section);
+     if (openProcFile(vmstat_fd, "/proc/vmstat") < 0 || readProcFile(vmstat_fd, vmstat_buf) < 0) {
+         return VmStatCounters();
+     }
+     return parseVmStat(vmstat_buf.data());
+ }
+ 
+ // "some avg10=0.00 avg60=0.00 avg300=0.00 total=0" followed by a "full"
+ // line; missing on kernels built without CONFIG_PSI
+ MemoryPressure MemSampler::pressure() {
+     StatTimer timer(pressure_section);
+     MemoryPressure pressure;
+     if (pressure_fd < 0 || readProcFile(pressure_fd, pressure_buf) < 0) return pressure;
+     
+     pressure.available = parsePressure(pressure_buf.data(), pressure.some_avg10, pressure.full_avg10);
+     return pressure;
+ }
+ 
+ bool readTopProcesses(MemSortKey sort, size_t limit, unsigned jobs, bool smaps,
+                       std::vector<ProcessMemory>& processes) {
+     StatTimer timer(top_processes_section);
+     processes.clear();
+     if (limit == 0) return true;
+     
+     int proc_fd = openSystemFile("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+     if (proc_fd < 0) return false;
+     std::vector<int> pids;
+     bool complete = listPids(proc_fd, pids);
+     
+     // Min-heap of (memory, pid) holding the current top entries. PSS and
+     // USS never exceed RSS, so when ranking by them a few times more
+     // candidates are pre-selected by RSS before smaps_rollup is read.
+     // Swapped-out pages are not resident, so swap is ranked by VmSwap.
+     size_t candidates = limit;
+     if (sort == MEM_SORT_PSS || sort == MEM_SORT_USS) {
+         candidates = std::max<size_t>(limit * 4, 64);
+     }
+     
+     long page_size = sysconf(_SC_PAGESIZE);
+     unsigned long page_kb = page_size > 0 ? page_size / 1024 : 4;
+     
+     std::vector<MemCandidate> heap;
+     heap.reserve(candidates + 1);
+     scanPidsParallel(proc_fd, pids, jobs, sort, page_kb, candidates, heap);
+     std::sort_heap(heap.begin(), heap.end(), std::greater<MemCandidate>());
+     
+     std::vector<ProcessMemory> ranked;
+     ranked.reserve(heap.size());
+     for (const auto& candidate : heap) {
+         ProcessMemory proc;
+         proc.pid = candidate.second;
+         if (sort == MEM_SORT_SWAP) {
+             proc.swap_kb = candidate.first;
+             proc.rss_kb = readProcessRss(proc_fd, proc.pid, page_kb);
+         } else {
+             proc.rss_kb = candidate.first;
+         }
+         if (smaps || sort != MEM_SORT_RSS) {
+             readSmapsRollup(proc_fd, proc);
+         }
+         ranked.push_back(proc);
+     }
+     
+     if (sort != MEM_SORT_RSS) {
+         std::stable_sort(ranked.begin(), ranked.end(), [sort](const ProcessMemory& a, const ProcessMemory& b) {
+             return sortValue(a, sort) > sortValue(b, sort);
+         });
+         if (ranked.size() > limit) {
+             ranked.resize(limit);
+         }
+     }
+     
+     char path[64];
+     char buf[4096];
+     for (auto& proc : ranked) {
+         // The process may have exited since it was ranked
+         snprintf(path, sizeof(path), "%d/comm", proc.pid);
+         ssize_t n = readFileAt(proc_fd, path, buf, sizeof(buf));
+         if (n <= 0) continue;
+         if (buf[n - 1] == '\n') --n;
+         proc.name.assign(buf, n);
+         
+         // Replace the null bytes between arguments with spaces
+         snprintf(path, sizeof(path), "%d/cmdline", proc.pid);
+         n = readFileAt(proc_fd, path, buf, sizeof(buf));
+         if (n > 0) {
+             std::replace(buf, buf + n, '\0', ' ');
+             while (n > 0 && buf[n - 1] == ' ') --n;
+             proc.cmd.assign(buf, n);
+             if (proc.cmd.length() > 40) {
+                 proc.cmd = proc.cmd.substr(0, 37) + "...";
+             }
+         }
+         
+         processes.push_back(proc);
+     }
+     
+     close(proc_fd);
+     return complete;
+ }
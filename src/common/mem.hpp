@@ -0,0 +1,223 @@
+/*
+ * mem - Shared memory collectors for /proc/meminfo, /proc/vmstat and PSI
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef MEM_HPP
+ #define MEM_HPP
+ 
+ #include <string>
+ #include <vector>
+ #include <sys/types.h>
+ 
+ #include "sysfs.hpp"
+ 
+ /**
+  * Fields of /proc/meminfo kept in MemoryInfo. Values are in kB except the
+  * HugePages_* counts.
+  */
+ enum MemField {
+     MEM_TOTAL,
+     MEM_FREE,
+     MEM_AVAILABLE,
+     MEM_BUFFERS,
+     MEM_CACHED,
+     MEM_SWAP_CACHED,
+     MEM_ACTIVE,
+     MEM_INACTIVE,
+     MEM_MLOCKED,
+     MEM_SWAP_TOTAL,
+     MEM_SWAP_FREE,
+     MEM_DIRTY,
+     MEM_WRITEBACK,
+     MEM_ANON_PAGES,
+     MEM_MAPPED,
+     MEM_SHMEM,
+     MEM_KRECLAIMABLE,
+     MEM_SLAB,
+     MEM_SRECLAIMABLE,
+     MEM_SUNRECLAIM,
+     MEM_KERNEL_STACK,
+     MEM_PAGE_TABLES,
+     MEM_COMMIT_LIMIT,
+     MEM_COMMITTED_AS,
+     MEM_VMALLOC_USED,
+     MEM_PERCPU,
+     MEM_ANON_HUGE_PAGES,
+     MEM_HUGE_PAGES_TOTAL,
+     MEM_HUGE_PAGES_FREE,
+     MEM_HUGE_PAGES_RSVD,
+     MEM_HUGE_PAGES_SURP,
+     MEM_HUGE_PAGE_SIZE,
+     MEM_HUGETLB,
+     MEM_FIELD_COUNT
+ };
+ 
+ /**
+  * Structure to hold memory information from /proc/meminfo, indexed by MemField
+  */
+ struct MemoryInfo {
+     unsigned long fields[MEM_FIELD_COUNT];
+     
+     MemoryInfo() : fields() {}
+     
+     unsigned long operator[](MemField field) const { return fields[field]; }
+     unsigned long& operator[](MemField field) { return fields[field]; }
+ };
+ 
+ /**
+  * Reclaim and paging counters from /proc/vmstat. Scans and steals are
+  * summed over all reclaimers (kswapd, direct, khugepaged).
+  */
+ struct VmStatCounters {
+     unsigned long long pgscan;
+     unsigned long long pgsteal;
+     unsigned long long pswpin;
+     unsigned long long pswpout;
+     unsigned long long pgmajfault;
+     
+     VmStatCounters() : pgscan(0), pgsteal(0), pswpin(0), pswpout(0), pgmajfault(0) {}
+ };
+ 
+ /**
+  * Stall averages from /proc/pressure/memory, in percent of wall time
+  */
+ struct MemoryPressure {
+     bool available;
+     double some_avg10;
+     double full_avg10;
+     
+     MemoryPressure() : available(false), some_avg10(0.0), full_avg10(0.0) {}
+ };
+ 
+ /**
+  * Key used to rank the top memory consumers
+  */
+ enum MemSortKey {
+     MEM_SORT_RSS,
+     MEM_SORT_PSS,
+     MEM_SORT_USS,
+     MEM_SORT_SWAP
+ };
+ 
+ /**
+  * Memory use of one process ranked by readTopProcesses, in kB
+  */
+ struct ProcessMemory {
+     int pid;
+     std::string name;
+     std::string cmd;             // Command line, cut to 40 columns
+     unsigned long rss_kb;
+     bool has_smaps;              // PSS, USS and swap were read from smaps_rollup
+     unsigned long pss_kb;
+     unsigned long uss_kb;
+     unsigned long swap_kb;
+     
+     ProcessMemory() : pid(0), rss_kb(0), has_smaps(false), pss_kb(0), uss_kb(0), swap_kb(0) {}
+ };
+ 
+ /**
+  * Parse /proc/meminfo into info; keys without a MemField are skipped
+  * @param text NUL-terminated file content
+  * @param info Where to store the values
+  */
+ void parseMemInfo(const char* text, MemoryInfo& info);
+ 
+ /**
+  * Sum the reclaim counters of /proc/vmstat or of a cgroup memory.stat,
+  * which uses the same keys
+  * @param text NUL-terminated file content
+  * @return Parsed counters
+  */
+ VmStatCounters parseVmStat(const char* text);
+ 
+ /**
+  * Map cgroup memory onto the /proc/meminfo fields: memory.max capped at
+  * physical memory as total, the limit minus the working set as available
+  * and the cgroup swap counters as swap
+  * @param dir Open cgroup directory
+  * @param host /proc/meminfo of the host, for the caps
+  * @return Memory information of the cgroup
+  */
+ MemoryInfo readCgroupMemoryInfo(const SysfsDir& dir, const MemoryInfo& host);
+ 
+ /**
+  * Ranking metric for topCgroups: memory.current
+  * @param dir Open cgroup directory
+  * @param value Memory charged to the cgroup in bytes
+  * @return false if the cgroup has no memory.current
+  */
+ bool cgroupMemoryMetric(const SysfsDir& dir, unsigned long long& value);
+ 
+ /**
+  * Rank the processes using the most memory. Every statm, or status when
+  * ranking by swap, is read, split over jobs threads with a bounded heap
+  * each; smaps_rollup, which is costly for the kernel to produce, is read
+  * only for a few times limit candidates, and names and command lines
+  * only for the winners.
+  * @param sort Ranking key
+  * @param limit Processes to return
+  * @param jobs Threads reading statm or status
+  * @param smaps Whether to read PSS, USS and swap when ranking by RSS
+  * @param processes Where to store the processes, largest first
+  * @return false if /proc could not be listed completely
+  */
+ bool readTopProcesses(MemSortKey sort, size_t limit, unsigned jobs, bool smaps,
+                       std::vector<ProcessMemory>& processes);
+ 
+ /**
+  * Memory collector that keeps /proc/meminfo, /proc/vmstat and
+  * /proc/pressure/memory open between samples and re-reads them with pread()
+  */
+ class MemSampler {
+ public:
+     MemSampler();
+     ~MemSampler();
+ 
+     MemSampler(const MemSampler&) = delete;
+     MemSampler& operator=(const MemSampler&) = delete;
+ 
+     /**
+      * Read reclaim counters and pressure from a cgroup's memory.stat and
+      * memory.pressure instead of the host files
+      * @param dir Open cgroup directory
+      */
+     void useCgroup(const SysfsDir& dir);
+ 
+     /**
+      * Open the vmstat and pressure files ahead of the first sample; the
+      * host files are used for any the cgroup does not provide
+      * @return true if the vmstat file could be opened
+      */
+     bool openCounters();
+ 
+     /**
+      * Sample /proc/meminfo
+      * @return Memory information, zero if the file cannot be read
+      */
+     MemoryInfo memoryInfo();
+ 
+     /**
+      * Sample the reclaim and paging counters
+      * @return Counters, zero if the file cannot be read
+      */
+     VmStatCounters vmStat();
+ 
+     /**
+      * Sample the memory stall averages; missing on kernels without PSI
+      * @return Pressure, not available if the file cannot be read
+      */
+     MemoryPressure pressure();
+ 
+ private:
+     int meminfo_fd;
+     int vmstat_fd;
+     int pressure_fd;
+     std::vector<char> meminfo_buf;
+     std::vector<char> vmstat_buf;
+     std::vector<char> pressure_buf;
+ };
+ 
+ #endif // MEM_HPP
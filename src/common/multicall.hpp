@@ -0,0 +1,28 @@
+/*
+ * multicall - Entry points of the tools inside the infoutils binary
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef MULTICALL_HPP
+ #define MULTICALL_HPP
+ 
+ /**
+  * Define the entry point of a tool. Built on its own a tool defines
+  * main(); built into infoutils with INFOUTILS_MULTICALL it defines
+  * TOOLMain() for the dispatcher to call by name.
+  */
+ #ifdef INFOUTILS_MULTICALL
+ #define INFOUTILS_MAIN(tool) int tool##Main(int argc, char* argv[])
+ #else
+ #define INFOUTILS_MAIN(tool) int main(int argc, char* argv[])
+ #endif
+ 
+ int cpuinfoMain(int argc, char* argv[]);
+ int meminfoMain(int argc, char* argv[]);
+ int disklsMain(int argc, char* argv[]);
+ int osinfoMain(int argc, char* argv[]);
+ int exporterMain(int argc, char* argv[]);
+ 
+ #endif // MULTICALL_HPP
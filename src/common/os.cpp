@@ -0,0 +1,389 @@
+/*
+ * os - Shared operating system, login and account collectors
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "os.hpp"
+ #include "stats.hpp"
+ #include "procfs.hpp"
+ #include "cpu.hpp"
+ 
+ #include <algorithm>
+ #include <chrono>
+ #include <condition_variable>
+ #include <cstdlib>
+ #include <cstring>
+ #include <ctime>
+ #include <fstream>
+ #include <memory>
+ #include <mutex>
+ #include <thread>
+ #include <unistd.h>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <sys/utsname.h>
+ #include <sys/sysinfo.h>
+ #include <pwd.h>
+ #include <grp.h>
+ #include <utmp.h>
+ 
+ namespace {
+ 
+ // --stats timing of the collectors in this file
+ StatSection system_section("readSystemInfo");
+ StatSection distro_section("readDistroInfo");
+ StatSection users_section("readUserInfo");
+ StatSection environment_section("readEnvironmentInfo");
+ StatSection nss_section("readUserInfo NSS enumeration");
+ 
+ // Result of a background NSS enumeration, shared with its worker so a
+ // lookup stuck on a remote directory can be abandoned
+ struct NssCount {
+     std::mutex lock;
+     std::condition_variable finished;
+     bool done = false;
+     int users = 0;
+     int groups = 0;
+ };
+ 
+ // Call visit for every login session in utmp. The file is a flat array
+ // of fixed-size records, so it is mapped and walked in place.
+ template <typename Visit>
+ bool forEachLoginSession(Visit visit) {
+     int fd = openSystemFile(_PATH_UTMP, O_RDONLY | O_CLOEXEC);
+     if (fd < 0) return false;
+     
+     struct stat st;
+     if (fstat(fd, &st) != 0) {
+         close(fd);
+         return false;
+     }
+     size_t records = st.st_size / sizeof(struct utmp);
+     if (records == 0) {
+         close(fd);
+         return true;
+     }
+     
+     void* map = mmap(nullptr, records * sizeof(struct utmp), PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (map == MAP_FAILED) return false;
+     
+     const struct utmp* entry = static_cast<const struct utmp*>(map);
+     for (size_t i = 0; i < records; ++i) {
+         if (entry[i].ut_type == USER_PROCESS && entry[i].ut_user[0] != '\0') {
+             visit(entry[i]);
+         }
+     }
+     
+     munmap(map, records * sizeof(struct utmp));
+     return true;
+ }
+ 
+ // Enumerate the passwd and group databases through NSS, which includes
+ // LDAP, SSSD and other directory users and may be slow
+ void nssCountWorker(std::shared_ptr<NssCount> count) {
+     int users = 0;
+     int groups = 0;
+     
+     setpwent();
+     while (getpwent() != nullptr) {
+         users++;
+     }
+     endpwent();
+     
+     setgrent();
+     while (getgrent() != nullptr) {
+         groups++;
+     }
+     endgrent();
+     
+     std::lock_guard<std::mutex> guard(count->lock);
+     count->users = users;
+     count->groups = groups;
+     count->done = true;
+     count->finished.notify_all();
+ }
+ 
+ }
+ 
+ // Name of the container runtime we run under, or empty. Only marker
+ // files, the environment and the cgroup of PID 1 are checked.
+ std::string detectContainer() {
+     // Set by systemd-nspawn, podman and LXC; it describes this process,
+     // not a system inspected through --root
+     const char* env = getenv("container");
+     if (env && *env && systemRoot().empty()) return env;
+     
+     if (access(systemPath("/.dockerenv").c_str(), F_OK) == 0) return "docker";
+     if (access(systemPath("/run/.containerenv").c_str(), F_OK) == 0) return "podman";
+     if (access(systemPath("/proc/vz").c_str(), F_OK) == 0 && access(systemPath("/proc/bc").c_str(), F_OK) != 0) {
+         return "openvz";
+     }
+     
+     char buf[4096];
+     if (readFileAt(AT_FDCWD, systemPath("/proc/1/cgroup").c_str(), buf, sizeof(buf)) <= 0) return "";
+     
+     if (std::strstr(buf, "/kubepods")) return "kubernetes";
+     if (std::strstr(buf, "/docker")) return "docker";
+     if (std::strstr(buf, "/lxc")) return "lxc";
+     return "";
+ }
+ 
+ bool isRunningInContainer() {
+     return !detectContainer().empty();
+ }
+ 
+ // btime is one of the counters parseProcStat() picks up after the cpu
+ // lines; it is formatted as local time
+ std::string getBootTime() {
+     int fd = -1;
+     std::vector<char> buf;
+     if (openProcFile(fd, "/proc/stat") < 0) return "";
+     ssize_t len = readProcFile(fd, buf);
+     close(fd);
+     
+     CpuLoad load;
+     ProcStatCounters counters;
+     if (len < 0 || !parseProcStat(buf.data(), len, load, nullptr, &counters) || counters.boot_time == 0) {
+         return "";
+     }
+     
+     time_t boot = counters.boot_time;
+     struct tm local;
+     char text[32];
+     if (!localtime_r(&boot, &local) || strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local) == 0) {
+         return "";
+     }
+     return text;
+ }
+ 
+ int getLoggedUserCount() {
+     int sessions = 0;
+     if (!forEachLoginSession([&sessions](const struct utmp&) { sessions++; })) return -1;
+     return sessions;
+ }
+ 
+ int getLoggedUsers(std::vector<std::string>& users) {
+     int sessions = 0;
+     bool ok = forEachLoginSession([&](const struct utmp& entry) {
+         sessions++;
+         users.emplace_back(entry.ut_user, strnlen(entry.ut_user, sizeof(entry.ut_user)));
+     });
+     if (!ok) return -1;
+     
+     std::sort(users.begin(), users.end());
+     users.erase(std::unique(users.begin(), users.end()), users.end());
+     return sessions;
+ }
+ 
+ // sysinfo() reports the load averages in fixed point, which saves
+ // opening /proc/loadavg
+ bool getLoadAverages(double& load1, double& load5, double& load15) {
+     struct sysinfo si;
+     if (sysinfo(&si) != 0) return false;
+     
+     const double scale = 1 << SI_LOAD_SHIFT;
+     load1 = si.loads[0] / scale;
+     load5 = si.loads[1] / scale;
+     load15 = si.loads[2] / scale;
+     return true;
+ }
+ 
+ // Count the entries of a passwd-style file: lines that are not blank,
+ // comments or NIS "+"/"-" compat entries. The file is mapped rather
+ // than read line by line, as it can be large on shared hosts.
+ int countFileEntries(const char* path) {
+     int fd = openSystemFile(path, O_RDONLY | O_CLOEXEC);
+     if (fd < 0) return -1;
+     
+     struct stat st;
+     if (fstat(fd, &st) != 0) {
+         close(fd);
+         return -1;
+     }
+     if (st.st_size == 0) {
+         close(fd);
+         return 0;
+     }
+     
+     void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (map == MAP_FAILED) return -1;
+     
+     const char* p = static_cast<const char*>(map);
+     const char* end = p + st.st_size;
+     int count = 0;
+     while (p < end) {
+         const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+         if (!eol) eol = end;
+         if (eol > p && *p != '#' && *p != '+' && *p != '-') count++;
+         p = eol + 1;
+     }
+     
+     munmap(map, st.st_size);
+     return count;
+ }
+ 
+ SystemInfo readSystemInfo() {
+     StatTimer timer(system_section);
+     SystemInfo info;
+     
+     // Get uname information
+     struct utsname uts;
+     if (uname(&uts) == 0) {
+         info.kernel_name = uts.sysname;
+         info.kernel_release = uts.release;
+         info.kernel_version = uts.version;
+         info.architecture = uts.machine;
+         info.hostname = uts.nodename;
+     }
+     
+     // Get domain name
+     char domainname[256];
+     if (getdomainname(domainname, sizeof(domainname)) == 0) {
+         info.domain_name = domainname;
+     }
+     
+     // Get uptime and load from a single sysinfo() call
+     struct sysinfo si;
+     if (sysinfo(&si) == 0) {
+         const double scale = 1 << SI_LOAD_SHIFT;
+         info.uptime_seconds = si.uptime;
+         info.have_load = true;
+         info.load1 = si.loads[0] / scale;
+         info.load5 = si.loads[1] / scale;
+         info.load15 = si.loads[2] / scale;
+     }
+     
+     info.boot_time = getBootTime();
+     info.container = detectContainer();
+     
+     // Try to get timezone
+     std::ifstream timezone_file(systemPath("/etc/timezone"));
+     if (timezone_file.is_open()) {
+         std::getline(timezone_file, info.timezone);
+     } else {
+         // Fallback to TZ environment variable
+         const char* tz = getenv("TZ");
+         if (tz) {
+             info.timezone = tz;
+         }
+     }
+     
+     return info;
+ }
+ 
+ DistroInfo readDistroInfo() {
+     StatTimer timer(distro_section);
+     DistroInfo info;
+     
+     // Read /etc/os-release
+     std::ifstream os_release(systemPath("/etc/os-release"));
+     std::string line;
+     
+     while (std::getline(os_release, line)) {
+         size_t equals = line.find('=');
+         if (equals == std::string::npos) continue;
+         
+         std::string key = line.substr(0, equals);
+         std::string value = line.substr(equals + 1);
+         
+         // Remove quotes
+         if (value.front() == '"' && value.back() == '"') {
+             value = value.substr(1, value.length() - 2);
+         }
+         
+         if (key == "NAME") info.name = value;
+         else if (key == "VERSION") info.version = value;
+         else if (key == "ID") info.id = value;
+         else if (key == "ID_LIKE") info.id_like = value;
+         else if (key == "VERSION_CODENAME") info.version_codename = value;
+         else if (key == "VERSION_ID") info.version_id = value;
+         else if (key == "PRETTY_NAME") info.pretty_name = value;
+         else if (key == "HOME_URL") info.home_url = value;
+         else if (key == "SUPPORT_URL") info.support_url = value;
+         else if (key == "BUG_REPORT_URL") info.bug_report_url = value;
+     }
+     
+     return info;
+ }
+ 
+ UserInfo readUserInfo(bool nss, double timeout) {
+     StatTimer timer(users_section);
+     UserInfo info;
+     
+     // Current user information
+     uid_t uid = getuid();
+     gid_t gid = getgid();
+     
+     struct passwd* pw = getpwuid(uid);
+     if (pw) {
+         info.current_user = pw->pw_name;
+         info.home_directory = pw->pw_dir;
+         info.shell = pw->pw_shell;
+     }
+     
+     struct group* gr = getgrgid(gid);
+     if (gr) {
+         info.current_group = gr->gr_name;
+     }
+     
+     info.session_count = getLoggedUsers(info.logged_users);
+     
+     // Count local accounts without going through NSS
+     info.local_user_count = countFileEntries("/etc/passwd");
+     info.local_group_count = countFileEntries("/etc/group");
+     
+     // Full enumeration is opt-in and bounded by timeout; a worker that
+     // does not finish in time is left behind detached
+     if (nss) {
+         StatTimer nss_timer(nss_section);
+         auto count = std::make_shared<NssCount>();
+         std::thread(nssCountWorker, count).detach();
+         
+         auto limit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+             std::chrono::duration<double>(timeout));
+         std::unique_lock<std::mutex> guard(count->lock);
+         if (count->finished.wait_for(guard, limit, [&count] { return count->done; })) {
+             info.nss_counted = true;
+             info.user_count = count->users;
+             info.group_count = count->groups;
+         } else {
+             info.nss_timed_out = true;
+         }
+     }
+     
+     return info;
+ }
+ 
+ EnvironmentInfo readEnvironmentInfo() {
+     StatTimer timer(environment_section);
+     EnvironmentInfo info;
+     
+     const char* env_vars[] = {
+         "PATH", "LANG", "EDITOR", "PAGER", "BROWSER",
+         "DESKTOP_SESSION", "XDG_CURRENT_DESKTOP", "WINDOWMANAGER"
+     };
+     
+     for (const char* var : env_vars) {
+         const char* value = getenv(var);
+         if (value) {
+             std::string var_name = var;
+             if (var_name == "PATH") info.path = value;
+             else if (var_name == "LANG") info.lang = value;
+             else if (var_name == "EDITOR") info.editor = value;
+             else if (var_name == "PAGER") info.pager = value;
+             else if (var_name == "BROWSER") info.browser = value;
+             else if (var_name == "DESKTOP_SESSION") info.desktop_session = value;
+             else if (var_name == "XDG_CURRENT_DESKTOP") info.window_manager = value;
+             else if (var_name == "WINDOWMANAGER") {
+                 if (info.window_manager.empty()) info.window_manager = value;
+             }
+         }
+     }
+     
+     return info;
+ }
@@ -0,0 +1,171 @@
+/*
+ * os - Shared operating system, login and account collectors
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef OS_HPP
+ #define OS_HPP
+ 
+ #include <string>
+ #include <vector>
+ 
+ /**
+  * Structure to hold basic system information
+  */
+ struct SystemInfo {
+     std::string os_name;
+     std::string os_version;
+     std::string os_id;
+     std::string os_codename;
+     std::string kernel_name;
+     std::string kernel_release;
+     std::string kernel_version;
+     std::string architecture;
+     std::string hostname;
+     std::string domain_name;
+     unsigned long uptime_seconds;
+     std::string boot_time;
+     std::string timezone;
+     bool have_load;
+     double load1;
+     double load5;
+     double load15;
+     std::string container;   // Container runtime, empty if none detected
+ 
+     SystemInfo() : uptime_seconds(0), have_load(false), load1(0.0), load5(0.0), load15(0.0) {}
+ };
+ 
+ /**
+  * Structure to hold distribution-specific information
+  */
+ struct DistroInfo {
+     std::string name;
+     std::string version;
+     std::string id;
+     std::string id_like;
+     std::string version_codename;
+     std::string version_id;
+     std::string pretty_name;
+     std::string home_url;
+     std::string support_url;
+     std::string bug_report_url;
+ 
+     DistroInfo() = default;
+ };
+ 
+ /**
+  * Structure to hold user and login information
+  */
+ struct UserInfo {
+     std::string current_user;
+     std::string current_group;
+     std::string home_directory;
+     std::string shell;
+     int local_user_count;    // Entries in /etc/passwd, -1 if unreadable
+     int local_group_count;   // Entries in /etc/group, -1 if unreadable
+     bool nss_counted;        // user_count/group_count hold NSS totals
+     bool nss_timed_out;      // NSS enumeration did not finish within the timeout
+     int user_count;
+     int group_count;
+     int session_count;       // Login sessions in utmp, -1 if unreadable
+     std::vector<std::string> logged_users;   // Distinct names of logged in users
+ 
+     UserInfo() : local_user_count(-1), local_group_count(-1), nss_counted(false),
+                  nss_timed_out(false), user_count(0), group_count(0), session_count(-1) {}
+ };
+ 
+ /**
+  * Structure to hold environment information
+  */
+ struct EnvironmentInfo {
+     std::string path;
+     std::string lang;
+     std::string editor;
+     std::string pager;
+     std::string browser;
+     std::string desktop_session;
+     std::string display_manager;
+     std::string window_manager;
+ 
+     EnvironmentInfo() = default;
+ };
+ 
+ /**
+  * Detect the container runtime from marker files, the environment
+  * and the cgroup of PID 1, without spawning any command
+  * @return Runtime name (docker, podman, kubernetes, lxc, ...) or empty string
+  */
+ std::string detectContainer();
+ 
+ /**
+  * Check if running in a container environment
+  * @return true if running in container, false otherwise
+  */
+ bool isRunningInContainer();
+ 
+ /**
+  * Get system boot time from the btime line of /proc/stat
+  * @return Boot time as local "YYYY-MM-DD HH:MM:SS", or empty string
+  */
+ std::string getBootTime();
+ 
+ /**
+  * Count login sessions in a read-only mapping of utmp
+  * @return Number of sessions, or -1 if utmp cannot be read
+  */
+ int getLoggedUserCount();
+ 
+ /**
+  * Collect the users with a login session in utmp
+  * @param users Filled with the distinct user names, sorted
+  * @return Number of sessions, or -1 if utmp cannot be read
+  */
+ int getLoggedUsers(std::vector<std::string>& users);
+ 
+ /**
+  * Get system load averages from sysinfo()
+  * @param load1 Reference to store 1-minute load
+  * @param load5 Reference to store 5-minute load  
+  * @param load15 Reference to store 15-minute load
+  * @return true if successful, false otherwise
+  */
+ bool getLoadAverages(double& load1, double& load5, double& load15);
+ 
+ /**
+  * Count the entries of a passwd-style file through a read-only mapping,
+  * skipping blank lines, comments and NIS compat entries
+  * @param path File to count
+  * @return Number of entries, or -1 if the file cannot be read
+  */
+ int countFileEntries(const char* path);
+ 
+ /**
+  * Read uname, uptime, load, boot time, container and timezone
+  * @return SystemInfo structure with basic system details
+  */
+ SystemInfo readSystemInfo();
+ 
+ /**
+  * Read distribution information from /etc/os-release
+  * @return DistroInfo structure with distribution details
+  */
+ DistroInfo readDistroInfo();
+ 
+ /**
+  * Read the current user, login sessions and local account counts
+  * @param nss Also enumerate users and groups through NSS on a worker
+  *            thread; a worker that misses the timeout is left detached
+  * @param timeout Seconds to wait for the NSS enumeration
+  * @return UserInfo structure with user and login details
+  */
+ UserInfo readUserInfo(bool nss, double timeout);
+ 
+ /**
+  * Read environment information from environment variables
+  * @return EnvironmentInfo structure with environment details
+  */
+ EnvironmentInfo readEnvironmentInfo();
+ 
+ #endif // OS_HPP
@@ -0,0 +1,77 @@
+/*
+ * output - Shared terminal output helpers
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "output.hpp"
+ 
+ #include <iomanip>
+ #include <iostream>
+ #include <sstream>
+ #include <unistd.h>
+ 
+ namespace Colors {
+     const std::string RESET = "\033[0m";
+     const std::string BOLD = "\033[1m";
+     const std::string RED = "\033[31m";
+     const std::string GREEN = "\033[32m";
+     const std::string YELLOW = "\033[33m";
+     const std::string BLUE = "\033[34m";
+     const std::string MAGENTA = "\033[35m";
+     const std::string CYAN = "\033[36m";
+     const std::string WHITE = "\033[37m";
+     const std::string DIM = "\033[2m";
+ }
+ 
+ std::string colorize(const std::string& text, const std::string& color, bool enabled) {
+     if (!enabled) return text;
+     return color + text + Colors::RESET;
+ }
+ 
+ namespace {
+ 
+ // -1 until setStdoutTerminal() is called
+ int stdout_terminal = -1;
+ 
+ }
+ 
+ bool stdoutIsTerminal() {
+     if (stdout_terminal < 0) return isatty(STDOUT_FILENO);
+     return stdout_terminal != 0;
+ }
+ 
+ void setStdoutTerminal(bool terminal) {
+     stdout_terminal = terminal ? 1 : 0;
+ }
+ 
+ std::string formatBytes(unsigned long long bytes) {
+     if (bytes == 0) return "0 B";
+     
+     const char* units[] = {"B", "KB", "MB", "GB", "TB", "PB"};
+     int unit = 0;
+     double size = static_cast<double>(bytes);
+     
+     while (size >= 1024.0 && unit < 5) {
+         size /= 1024.0;
+         unit++;
+     }
+     
+     std::ostringstream oss;
+     if (unit == 0) {
+         oss << static_cast<unsigned long long>(size) << " " << units[unit];
+     } else {
+         oss << std::fixed << std::setprecision(1) << size << " " << units[unit];
+     }
+     return oss.str();
+ }
+ 
+ void printSeparator(const std::string& title, bool colors) {
+     if (title.empty()) {
+         std::cout << std::string(70, '-') << '\n';
+     } else {
+         std::cout << colorize(title, Colors::BOLD, colors) << '\n';
+         std::cout << std::string(title.length(), '=') << '\n';
+     }
+ }
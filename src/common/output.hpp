@@ -0,0 +1,63 @@
+/*
+ * output - Shared terminal output helpers
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef OUTPUT_HPP
+ #define OUTPUT_HPP
+ 
+ #include <string>
+ 
+ // ANSI Color codes
+ namespace Colors {
+     extern const std::string RESET;
+     extern const std::string BOLD;
+     extern const std::string RED;
+     extern const std::string GREEN;
+     extern const std::string YELLOW;
+     extern const std::string BLUE;
+     extern const std::string MAGENTA;
+     extern const std::string CYAN;
+     extern const std::string WHITE;
+     extern const std::string DIM;
+ }
+ 
+ /**
+  * Wrap text in an ANSI color code
+  * @param text Text to colorize
+  * @param color ANSI color code
+  * @param enabled false to return the text unchanged
+  * @return Colorized or plain text
+  */
+ std::string colorize(const std::string& text, const std::string& color, bool enabled);
+ 
+ /**
+  * Whether standard output is a terminal, deciding colors and redraws
+  * @return isatty() of stdout unless overridden by setStdoutTerminal()
+  */
+ bool stdoutIsTerminal();
+ 
+ /**
+  * Override stdoutIsTerminal(), for output that is captured through a
+  * pipe on its way to a terminal
+  */
+ void setStdoutTerminal(bool terminal);
+ 
+ /**
+  * Format bytes with human-readable units (B, KB, MB, GB, TB, PB)
+  * @param bytes Size in bytes
+  * @return Formatted string such as "1.5 GB"; "0 B" for zero
+  */
+ std::string formatBytes(unsigned long long bytes);
+ 
+ /**
+  * Print a bold section title underlined with '=', or a 70-column rule
+  * when the title is empty
+  * @param title Section title
+  * @param colors Whether the title may be printed in bold
+  */
+ void printSeparator(const std::string& title, bool colors);
+ 
+ #endif // OUTPUT_HPP
@@ -0,0 +1,614 @@
+/*
+ * process - Per-process CPU, run-queue delay and I/O rates from /proc
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "process.hpp"
+ #include "procfs.hpp"
+ #include "stats.hpp"
+ 
+ #include <algorithm>
+ #include <cerrno>
+ #include <climits>
+ #include <cstdio>
+ #include <cstring>
+ #include <fcntl.h>
+ #include <time.h>
+ #include <unistd.h>
+ #include <sys/socket.h>
+ #include <sys/time.h>
+ #include <linux/netlink.h>
+ #include <linux/genetlink.h>
+ #include <linux/connector.h>
+ #include <linux/cn_proc.h>
+ #include <linux/taskstats.h>
+ 
+ namespace {
+ 
+ // --stats timing of the collectors in this file
+ StatSection process_section("ProcessSampler::sample");
+ 
+ // Processes asked about in one taskstats round trip
+ const size_t taskstats_batch = 32;
+ 
+ // Room for one taskstats reply; the kernel's struct grows with its version
+ const size_t taskstats_reply_size = 1024;
+ 
+ struct TaskstatsRequest {
+     struct nlmsghdr header;
+     struct genlmsghdr genl;
+     struct nlattr attr;
+     __u32 tgid;
+ };
+ 
+ // Proc connector events; Linux 6.6 moved the PROC_EVENT_* names out of
+ // struct proc_event, so the values are used instead
+ const unsigned event_fork = 0x00000001;
+ const unsigned event_exec = 0x00000002;
+ const unsigned event_comm = 0x00000200;
+ 
+ double bootSeconds() {
+     struct timespec now;
+     clock_gettime(CLOCK_BOOTTIME, &now);
+     return now.tv_sec + now.tv_nsec / 1e9;
+ }
+ 
+ unsigned long long delta(unsigned long long before, unsigned long long after) {
+     return after > before ? after - before : 0;
+ }
+ 
+ // Read the value of a "name: value" line, 0 if there is none
+ unsigned long long findField(const char* text, const char* name) {
+     const char* p = std::strstr(text, name);
+     if (!p) return 0;
+     p += std::strlen(name);
+     return parseNumber(p);
+ }
+ 
+ // Find a netlink attribute among length bytes of attributes
+ const struct nlattr* findAttribute(const char* data, size_t length, unsigned short type) {
+     while (length >= NLA_HDRLEN) {
+         const struct nlattr* attr = reinterpret_cast<const struct nlattr*>(data);
+         if (attr->nla_len < NLA_HDRLEN || attr->nla_len > length) return nullptr;
+         if ((attr->nla_type & NLA_TYPE_MASK) == type) return attr;
+         size_t step = std::min<size_t>(NLA_ALIGN(attr->nla_len), length);
+         data += step;
+         length -= step;
+     }
+     return nullptr;
+ }
+ 
+ // Generic netlink family ID of TASKSTATS, 0 if it is not there
+ unsigned short findTaskstatsFamily(int fd) {
+     union {
+         struct {
+             struct nlmsghdr header;
+             struct genlmsghdr genl;
+             struct nlattr attr;
+             char name[sizeof(TASKSTATS_GENL_NAME)];
+         } request;
+         char reply[4096];
+     } buf;
+     std::memset(&buf.request, 0, sizeof(buf.request));
+     buf.request.header.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN + NLA_HDRLEN + sizeof(TASKSTATS_GENL_NAME));
+     buf.request.header.nlmsg_type = GENL_ID_CTRL;
+     buf.request.header.nlmsg_flags = NLM_F_REQUEST;
+     buf.request.genl.cmd = CTRL_CMD_GETFAMILY;
+     buf.request.genl.version = 1;
+     buf.request.attr.nla_type = CTRL_ATTR_FAMILY_NAME;
+     buf.request.attr.nla_len = NLA_HDRLEN + sizeof(TASKSTATS_GENL_NAME);
+     std::memcpy(buf.request.name, TASKSTATS_GENL_NAME, sizeof(TASKSTATS_GENL_NAME));
+     if (send(fd, &buf.request, buf.request.header.nlmsg_len, 0) < 0) return 0;
+     
+     ssize_t n = recv(fd, buf.reply, sizeof(buf.reply), 0);
+     const struct nlmsghdr* header = reinterpret_cast<const struct nlmsghdr*>(buf.reply);
+     if (n < static_cast<ssize_t>(NLMSG_HDRLEN + GENL_HDRLEN) || !NLMSG_OK(header, static_cast<size_t>(n)) ||
+         header->nlmsg_type != GENL_ID_CTRL) {
+         return 0;
+     }
+     
+     const char* attrs = buf.reply + NLMSG_HDRLEN + GENL_HDRLEN;
+     const struct nlattr* id = findAttribute(attrs, header->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN, CTRL_ATTR_FAMILY_ID);
+     if (!id || id->nla_len < NLA_HDRLEN + sizeof(unsigned short)) return 0;
+     unsigned short family;
+     std::memcpy(&family, reinterpret_cast<const char*>(id) + NLA_HDRLEN, sizeof(family));
+     return family;
+ }
+ 
+ }
+ 
+ ProcessSampler::ProcessSampler(unsigned files)
+     : files(files), proc_fd(-1), ticks_per_second(sysconf(_SC_CLK_TCK)), generation(1), last_time(0.0),
+       process_count(0), events_fd(-1), taskstats_fd(-1), taskstats_family(0) {
+     if (ticks_per_second <= 0) ticks_per_second = 100;
+ }
+ 
+ ProcessSampler::~ProcessSampler() {
+     stopEvents();
+     if (proc_fd >= 0) close(proc_fd);
+ }
+ 
+ bool ProcessSampler::readProcess(int pid, Slot& slot) {
+     char path[64];
+     char buf[1024];
+     
+     snprintf(path, sizeof(path), "%d/stat", pid);
+     if (readFileAt(proc_fd, path, buf, sizeof(buf)) <= 0) return false;
+     
+     // comm may hold spaces and parentheses; it ends at the last ')'
+     const char* open = std::strchr(buf, '(');
+     const char* close = std::strrchr(buf, ')');
+     if (!open || !close || close < open) return false;
+     size_t comm_length = std::min<size_t>(close - open - 1, sizeof(slot.comm) - 1);
+     std::memcpy(slot.comm, open + 1, comm_length);
+     slot.comm[comm_length] = '\0';
+     
+     // Fields after comm, from state (field 3) on: utime is the 12th,
+     // stime the 13th and starttime the 20th
+     const char* p = close + 1;
+     unsigned long long utime = 0, stime = 0;
+     for (int field = 1; field <= 20 && *p; ++field) {
+         while (*p == ' ') ++p;
+         if (field == 12) {
+             utime = parseNumber(p);
+         } else if (field == 13) {
+             stime = parseNumber(p);
+         } else if (field == 20) {
+             slot.start_time = parseNumber(p);
+         } else {
+             while (*p && *p != ' ') ++p;
+         }
+     }
+     slot.pid = pid;
+     slot.cpu_ns = (utime + stime) * 1000000000ULL / ticks_per_second;
+     
+     // Time on the CPU, then time waiting on a run queue, in nanoseconds
+     slot.run_delay_ns = 0;
+     if (files & PROCESS_FILE_SCHEDSTAT) {
+         snprintf(path, sizeof(path), "%d/schedstat", pid);
+         if (readFileAt(proc_fd, path, buf, sizeof(buf)) > 0) {
+             p = buf;
+             parseNumber(p);
+             slot.run_delay_ns = parseNumber(p);
+         }
+     }
+     
+     readIo(pid, slot);
+     return true;
+ }
+ 
+ void ProcessSampler::readIo(int pid, Slot& slot) {
+     slot.read_bytes = 0;
+     slot.write_bytes = 0;
+     slot.has_io = false;
+     if (!(files & PROCESS_FILE_IO)) return;
+     
+     char path[64];
+     char buf[1024];
+     snprintf(path, sizeof(path), "%d/io", pid);
+     if (readFileAt(proc_fd, path, buf, sizeof(buf)) > 0) {
+         slot.read_bytes = findField(buf, "\nread_bytes:");
+         slot.write_bytes = findField(buf, "\nwrite_bytes:");
+         slot.has_io = true;
+     }
+ }
+ 
+ void ProcessSampler::readComm(int pid, Slot& slot) {
+     char path[64];
+     char buf[64];
+     snprintf(path, sizeof(path), "%d/comm", pid);
+     ssize_t n = readFileAt(proc_fd, path, buf, sizeof(buf));
+     if (n > 0 && buf[n - 1] == '\n') --n;
+     size_t length = n > 0 ? std::min<size_t>(n, sizeof(slot.comm) - 1) : 0;
+     std::memcpy(slot.comm, buf, length);
+     slot.comm[length] = '\0';
+ }
+ 
+ bool ProcessSampler::followEvents() {
+     if (events_fd >= 0) return true;
+     
+     // The events and taskstats describe this machine, not one under --root
+     if (!systemRoot().empty()) return false;
+     if (proc_fd < 0) proc_fd = openSystemFile("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+     if (proc_fd < 0) return false;
+     
+     // Joining the connector's group needs CAP_NET_ADMIN; the buffer is
+     // made large enough to ride out a burst of forks between samples
+     events_fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+     if (events_fd < 0) return false;
+     int size = 4 << 20;
+     if (setsockopt(events_fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0) {
+         setsockopt(events_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+     }
+     struct sockaddr_nl address;
+     std::memset(&address, 0, sizeof(address));
+     address.nl_family = AF_NETLINK;
+     address.nl_groups = CN_IDX_PROC;
+     if (bind(events_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+         stopEvents();
+         return false;
+     }
+     
+     alignas(struct nlmsghdr) char listen[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))];
+     std::memset(listen, 0, sizeof(listen));
+     struct nlmsghdr* header = reinterpret_cast<struct nlmsghdr*>(listen);
+     header->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op));
+     header->nlmsg_type = NLMSG_DONE;
+     struct cn_msg* message = static_cast<struct cn_msg*>(NLMSG_DATA(header));
+     message->id.idx = CN_IDX_PROC;
+     message->id.val = CN_VAL_PROC;
+     message->len = sizeof(enum proc_cn_mcast_op);
+     enum proc_cn_mcast_op op = PROC_CN_MCAST_LISTEN;
+     std::memcpy(message->data, &op, sizeof(op));
+     if (send(events_fd, listen, header->nlmsg_len, 0) < 0) {
+         stopEvents();
+         return false;
+     }
+     
+     // A reply that never comes ends the events rather than the sample
+     taskstats_fd = socket(PF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+     struct timeval timeout = {1, 0};
+     if (taskstats_fd < 0 ||
+         setsockopt(taskstats_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0 ||
+         (taskstats_family = findTaskstatsFamily(taskstats_fd)) == 0) {
+         stopEvents();
+         return false;
+     }
+     
+     // taskstats needs CAP_NET_ADMIN as well; ask about ourselves to find out
+     int self = getpid();
+     Slot slot;
+     bool found = false;
+     if (!readTaskstats(&self, 1, &slot, &found) || !found) {
+         stopEvents();
+         return false;
+     }
+     
+     // Processes that fork from here on arrive as events; the rest are
+     // listed once
+     pids.clear();
+     if (!listPids(proc_fd, pids)) {
+         stopEvents();
+         return false;
+     }
+     std::sort(pids.begin(), pids.end());
+     return true;
+ }
+ 
+ void ProcessSampler::stopEvents() {
+     if (events_fd >= 0) close(events_fd);
+     if (taskstats_fd >= 0) close(taskstats_fd);
+     events_fd = -1;
+     taskstats_fd = -1;
+     forked.clear();
+     renamed.clear();
+ }
+ 
+ // Add the processes forked since the last sample to pids. Exits are not
+ // followed: a process stays listed until taskstats no longer finds it.
+ bool ProcessSampler::readEvents() {
+     alignas(struct nlmsghdr) char buf[4096];
+     bool lost = false;
+     for (;;) {
+         ssize_t n = recv(events_fd, buf, sizeof(buf), MSG_DONTWAIT);
+         if (n < 0) {
+             if (errno == EINTR) continue;
+             if (errno == ENOBUFS) {
+                 lost = true;
+                 continue;
+             }
+             break;
+         }
+         countStat(STAT_READS);
+         countStat(STAT_READ_BYTES, n);
+         
+         size_t length = n;
+         for (const struct nlmsghdr* header = reinterpret_cast<const struct nlmsghdr*>(buf);
+              NLMSG_OK(header, length); header = NLMSG_NEXT(header, length)) {
+             if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_NOOP) continue;
+             const struct cn_msg* message = static_cast<const struct cn_msg*>(NLMSG_DATA(header));
+             if (message->id.idx != CN_IDX_PROC || message->len < sizeof(struct proc_event)) continue;
+             
+             struct proc_event event;
+             std::memcpy(&event, message->data, sizeof(event));
+             unsigned what = event.what;
+             if (what == event_fork) {
+                 // New threads fork too, but only new thread groups are processes
+                 if (event.event_data.fork.child_pid == event.event_data.fork.child_tgid) {
+                     forked.push_back(event.event_data.fork.child_tgid);
+                 }
+             } else if (what == event_exec) {
+                 renamed.push_back(event.event_data.exec.process_tgid);
+             } else if (what == event_comm) {
+                 if (event.event_data.comm.process_pid == event.event_data.comm.process_tgid) {
+                     renamed.push_back(event.event_data.comm.process_tgid);
+                 }
+             }
+         }
+     }
+     if (lost) return false;
+     
+     if (!forked.empty()) {
+         std::sort(forked.begin(), forked.end());
+         forked.erase(std::unique(forked.begin(), forked.end()), forked.end());
+         pids.insert(pids.end(), forked.begin(), forked.end());
+         std::sort(pids.begin(), pids.end());
+         pids.erase(std::unique(pids.begin(), pids.end()), pids.end());
+     }
+     std::sort(renamed.begin(), renamed.end());
+     return true;
+ }
+ 
+ // Ask taskstats about up to taskstats_batch thread groups with one send
+ // and one reply each. A thread group's times and delays are those of all
+ // of its threads, including the ones that have exited.
+ bool ProcessSampler::readTaskstats(const int* tgids, size_t count, Slot* slots, bool* found) {
+     TaskstatsRequest requests[taskstats_batch];
+     std::memset(requests, 0, sizeof(requests));
+     for (size_t i = 0; i < count; ++i) {
+         requests[i].header.nlmsg_len = sizeof(TaskstatsRequest);
+         requests[i].header.nlmsg_type = taskstats_family;
+         requests[i].header.nlmsg_flags = NLM_F_REQUEST;
+         requests[i].header.nlmsg_seq = i;
+         requests[i].genl.cmd = TASKSTATS_CMD_GET;
+         requests[i].genl.version = TASKSTATS_GENL_VERSION;
+         requests[i].attr.nla_len = NLA_HDRLEN + sizeof(__u32);
+         requests[i].attr.nla_type = TASKSTATS_CMD_ATTR_TGID;
+         requests[i].tgid = tgids[i];
+         found[i] = false;
+     }
+     if (send(taskstats_fd, requests, count * sizeof(TaskstatsRequest), 0) < 0) return false;
+     
+     if (replies.size() < taskstats_batch * taskstats_reply_size) {
+         replies.resize(taskstats_batch * taskstats_reply_size);
+     }
+     struct mmsghdr messages[taskstats_batch];
+     struct iovec iov[taskstats_batch];
+     
+     size_t answered = 0;
+     while (answered < count) {
+         size_t wanted = count - answered;
+         std::memset(messages, 0, sizeof(messages[0]) * wanted);
+         for (size_t i = 0; i < wanted; ++i) {
+             iov[i].iov_base = replies.data() + i * taskstats_reply_size;
+             iov[i].iov_len = taskstats_reply_size;
+             messages[i].msg_hdr.msg_iov = &iov[i];
+             messages[i].msg_hdr.msg_iovlen = 1;
+         }
+         
+         int received = recvmmsg(taskstats_fd, messages, wanted, MSG_WAITFORONE, nullptr);
+         if (received < 0) {
+             if (errno == EINTR) continue;
+             return false;
+         }
+         countStat(STAT_READS, received);
+         
+         for (int i = 0; i < received; ++i) {
+             const char* reply = replies.data() + i * taskstats_reply_size;
+             size_t length = messages[i].msg_len;
+             countStat(STAT_READ_BYTES, length);
+             const struct nlmsghdr* header = reinterpret_cast<const struct nlmsghdr*>(reply);
+             if (!NLMSG_OK(header, length) || header->nlmsg_seq >= count) continue;
+             size_t seq = header->nlmsg_seq;
+             answered++;
+             
+             // A process that has exited is ESRCH; anything else ends the events
+             if (header->nlmsg_type == NLMSG_ERROR) {
+                 const struct nlmsgerr* error = static_cast<const struct nlmsgerr*>(NLMSG_DATA(header));
+                 if (error->error != -ESRCH) return false;
+                 continue;
+             }
+             if (header->nlmsg_len < NLMSG_HDRLEN + GENL_HDRLEN) continue;
+             
+             const char* attrs = reply + NLMSG_HDRLEN + GENL_HDRLEN;
+             size_t attrs_length = header->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN;
+             const struct nlattr* aggregate = findAttribute(attrs, attrs_length, TASKSTATS_TYPE_AGGR_TGID);
+             if (!aggregate) continue;
+             const struct nlattr* stats = findAttribute(reinterpret_cast<const char*>(aggregate) + NLA_HDRLEN,
+                                                        aggregate->nla_len - NLA_HDRLEN, TASKSTATS_TYPE_STATS);
+             if (!stats) continue;
+             
+             struct taskstats task;
+             std::memset(&task, 0, sizeof(task));
+             std::memcpy(&task, reinterpret_cast<const char*>(stats) + NLA_HDRLEN,
+                         std::min<size_t>(sizeof(task), stats->nla_len - NLA_HDRLEN));
+             
+             Slot& slot = slots[seq];
+             slot.pid = tgids[seq];
+             slot.start_time = 0;
+             slot.cpu_ns = (task.ac_utime + task.ac_stime) * 1000ULL;
+             slot.run_delay_ns = task.cpu_delay_total;
+             slot.read_bytes = 0;
+             slot.write_bytes = 0;
+             slot.has_io = false;
+             slot.comm[0] = '\0';
+             found[seq] = true;
+         }
+     }
+     return true;
+ }
+ 
+ size_t ProcessSampler::insert(const Slot& slot) {
+     size_t mask = current.size() - 1;
+     unsigned long long key = static_cast<unsigned long long>(slot.pid) << 40 ^ slot.start_time;
+     size_t i = static_cast<size_t>(key * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+     while (current[i].generation == generation) i = (i + 1) & mask;
+     current[i] = slot;
+     current[i].generation = generation;
+     return i;
+ }
+ 
+ const ProcessSampler::Slot* ProcessSampler::findPrevious(int pid, unsigned long long start_time) const {
+     if (previous.empty()) return nullptr;
+     
+     unsigned previous_generation = generation == 1 ? UINT_MAX : generation - 1;
+     size_t mask = previous.size() - 1;
+     unsigned long long key = static_cast<unsigned long long>(pid) << 40 ^ start_time;
+     size_t i = static_cast<size_t>(key * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+     while (previous[i].generation == previous_generation) {
+         if (previous[i].pid == pid && previous[i].start_time == start_time) return &previous[i];
+         i = (i + 1) & mask;
+     }
+     return nullptr;
+ }
+ 
+ void ProcessSampler::rank(size_t index, const Slot* before, ProcessMetric metric, size_t limit) {
+     static const Slot zero = Slot();
+     const Slot& after = current[index];
+     const Slot& from = before ? *before : zero;
+     
+     double value = 0.0;
+     switch (metric) {
+         case PROCESS_CPU:
+             value = delta(from.cpu_ns, after.cpu_ns);
+             break;
+         case PROCESS_DELAY:
+             value = delta(from.run_delay_ns, after.run_delay_ns);
+             break;
+         case PROCESS_IO:
+             value = delta(from.read_bytes, after.read_bytes) + delta(from.write_bytes, after.write_bytes);
+             break;
+         case PROCESS_READ:
+             value = delta(from.read_bytes, after.read_bytes);
+             break;
+         case PROCESS_WRITE:
+             value = delta(from.write_bytes, after.write_bytes);
+             break;
+     }
+     if (value <= 0.0) return;
+     
+     // Min-heap of the busiest so far; its root is the one to beat
+     auto busier = [](const Ranked& a, const Ranked& b) { return a.value > b.value; };
+     if (heap.size() < limit) {
+         heap.push_back(Ranked{value, index, before});
+         std::push_heap(heap.begin(), heap.end(), busier);
+     } else if (value > heap.front().value) {
+         std::pop_heap(heap.begin(), heap.end(), busier);
+         heap.back() = Ranked{value, index, before};
+         std::push_heap(heap.begin(), heap.end(), busier);
+     }
+ }
+ 
+ bool ProcessSampler::sample(ProcessMetric metric, size_t limit, std::vector<ProcessActivity>& top) {
+     StatTimer timer(process_section);
+     top.clear();
+     if (proc_fd < 0) proc_fd = openSystemFile("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+     if (proc_fd < 0) return false;
+     
+     // Following events, only a lost event means listing /proc again;
+     // processes missed that way are left out until the next sample
+     bool events = events_fd >= 0;
+     if (!events || !readEvents()) {
+         pids.clear();
+         forked.clear();
+         renamed.clear();
+         if (!listPids(proc_fd, pids)) return false;
+         if (events) std::sort(pids.begin(), pids.end());
+     }
+     double now = bootSeconds();
+     
+     std::swap(current, previous);
+     if (++generation == 0) generation = 1;
+     
+     // At most half full, so probes stay short; the size is a power of two
+     size_t size = current.empty() ? 64 : current.size();
+     while (size < pids.size() * 2) size *= 2;
+     if (current.size() < size) current.resize(size, Slot());
+     
+     double interval = last_time > 0.0 ? now - last_time : 0.0;
+     bool ranking = interval > 0.0 && limit > 0;
+     heap.clear();
+     process_count = 0;
+     
+     if (events) {
+         Slot slots[taskstats_batch];
+         bool found[taskstats_batch];
+         size_t live = 0;
+         for (size_t first = 0; first < pids.size(); first += taskstats_batch) {
+             size_t count = std::min(taskstats_batch, pids.size() - first);
+             if (!readTaskstats(pids.data() + first, count, slots, found)) {
+                 // Back to scanning /proc, from a new baseline
+                 stopEvents();
+                 last_time = 0.0;
+                 return sample(metric, limit, top);
+             }
+             
+             for (size_t i = 0; i < count; ++i) {
+                 if (!found[i]) continue;
+                 Slot& slot = slots[i];
+                 pids[live++] = slot.pid;
+                 
+                 // Names come from the last sample unless the process is new
+                 bool started = std::binary_search(forked.begin(), forked.end(), slot.pid);
+                 const Slot* before = started ? nullptr : findPrevious(slot.pid, 0);
+                 if (before && !std::binary_search(renamed.begin(), renamed.end(), slot.pid)) {
+                     std::memcpy(slot.comm, before->comm, sizeof(slot.comm));
+                 } else {
+                     readComm(slot.pid, slot);
+                 }
+                 readIo(slot.pid, slot);
+                 
+                 size_t index = insert(slot);
+                 ++process_count;
+                 if (ranking && (before || started)) rank(index, before, metric, limit);
+             }
+         }
+         pids.resize(live);
+         forked.clear();
+         renamed.clear();
+     } else {
+         Slot slot;
+         for (int pid : pids) {
+             if (!readProcess(pid, slot)) continue;
+             size_t index = insert(slot);
+             ++process_count;
+             if (!ranking) continue;
+             
+             // New processes count from zero; others missing from the baseline
+             // were not readable then and are left out. starttime is rounded
+             // down to a clock tick.
+             const Slot* before = findPrevious(slot.pid, slot.start_time);
+             if (before || static_cast<double>(slot.start_time + 1) / ticks_per_second >= last_time) {
+                 rank(index, before, metric, limit);
+             }
+         }
+     }
+     last_time = now;
+     
+     // Busiest first
+     std::sort_heap(heap.begin(), heap.end(), [](const Ranked& a, const Ranked& b) { return a.value > b.value; });
+     
+     static const Slot zero = Slot();
+     char path[64];
+     char buf[4096];
+     for (const Ranked& entry : heap) {
+         const Slot& after = current[entry.index];
+         const Slot& before = entry.before ? *entry.before : zero;
+         
+         ProcessActivity activity;
+         activity.pid = after.pid;
+         activity.name = after.comm;
+         activity.cpu_percent = delta(before.cpu_ns, after.cpu_ns) / 1e7 / interval;
+         activity.delay_percent = delta(before.run_delay_ns, after.run_delay_ns) / 1e7 / interval;
+         activity.read_rate = delta(before.read_bytes, after.read_bytes) / interval;
+         activity.write_rate = delta(before.write_bytes, after.write_bytes) / interval;
+         activity.has_io = after.has_io;
+         
+         // Only the winners' command lines are read
+         snprintf(path, sizeof(path), "%d/cmdline", after.pid);
+         ssize_t n = readFileAt(proc_fd, path, buf, sizeof(buf));
+         if (n > 0) {
+             // Replace null bytes with spaces
+             std::replace(buf, buf + n, '\0', ' ');
+             while (n > 0 && buf[n - 1] == ' ') --n;
+             activity.cmd.assign(buf, n);
+             if (activity.cmd.length() > 40) {
+                 activity.cmd = activity.cmd.substr(0, 37) + "...";
+             }
+         }
+         top.push_back(activity);
+     }
+     return true;
+ }
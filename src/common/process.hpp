@@ -0,0 +1,152 @@
+/*
+ * process - Per-process CPU, run-queue delay and I/O rates from /proc
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef PROCESS_HPP
+ #define PROCESS_HPP
+ 
+ #include <string>
+ #include <vector>
+ 
+ /**
+  * Files read for every process besides /proc/PID/stat
+  */
+ enum ProcessFiles {
+     PROCESS_FILE_SCHEDSTAT = 1,   // Run-queue delay
+     PROCESS_FILE_IO = 2           // Storage bytes; other users' processes need root
+ };
+ 
+ /**
+  * What the busiest processes are ranked by
+  */
+ enum ProcessMetric {
+     PROCESS_CPU,                  // utime + stime
+     PROCESS_DELAY,                // Time spent runnable but waiting for a CPU
+     PROCESS_IO,                   // Bytes read and written
+     PROCESS_READ,
+     PROCESS_WRITE
+ };
+ 
+ /**
+  * Activity of one process between two samples
+  */
+ struct ProcessActivity {
+     int pid;
+     std::string name;             // comm from /proc/PID/stat
+     std::string cmd;              // Command line, shortened to 40 characters
+     double cpu_percent;           // 100 for one CPU kept busy
+     double delay_percent;         // Run-queue wait of the main thread, of the interval
+     double read_rate;             // Bytes per second read from storage
+     double write_rate;            // Bytes per second written to storage
+     bool has_io;                  // false if /proc/PID/io was not readable
+     
+     ProcessActivity() : pid(0), cpu_percent(0.0), delay_percent(0.0), read_rate(0.0),
+                         write_rate(0.0), has_io(false) {}
+ };
+ 
+ /**
+  * Samples every process and ranks them by what they did since the
+  * previous sample. Counters live in two open-addressed tables keyed by
+  * PID and start time, so a reused PID is never mistaken for the process
+  * that had it before; the tables, the PID list and the ranking heap are
+  * kept between samples and only grow, so a steady-state sample does not
+  * allocate except for the names of the winners.
+  */
+ class ProcessSampler {
+ public:
+     /**
+      * Constructor; /proc is opened by the first sample
+      * @param files ProcessFiles to read for every process
+      */
+     explicit ProcessSampler(unsigned files);
+     ~ProcessSampler();
+     
+     ProcessSampler(const ProcessSampler&) = delete;
+     ProcessSampler& operator=(const ProcessSampler&) = delete;
+     
+     /**
+      * Read every process and rank them by their activity since the
+      * previous call. Processes started since then count all of their
+      * activity; the first call only sets the baseline and ranks none.
+      * @param metric Ranking key
+      * @param limit Processes to return
+      * @param top Filled with the busiest processes, busiest first
+      * @return false if /proc could not be listed
+      */
+     bool sample(ProcessMetric metric, size_t limit, std::vector<ProcessActivity>& top);
+     
+     /**
+      * Follow processes with the fork and exec events of the proc connector
+      * and read their CPU time and run-queue delay with taskstats, instead
+      * of listing /proc and reading stat and schedstat every sample. Only
+      * new and renamed processes have their names read from /proc;
+      * /proc/PID/io is still read for PROCESS_FILE_IO. Needs CAP_NET_ADMIN
+      * in the initial network namespace and no systemRoot().
+      * @return false if the events are unavailable; samples keep scanning /proc
+      */
+     bool followEvents();
+     
+     /**
+      * Whether samples come from followEvents() rather than a /proc scan.
+      * Turns false if events were lost and taskstats stopped answering.
+      */
+     bool followingEvents() const { return events_fd >= 0; }
+     
+     /**
+      * Processes seen by the last sample
+      */
+     size_t processCount() const { return process_count; }
+ 
+ private:
+     struct Slot {
+         unsigned generation;       // Sample that filled the slot; others are empty
+         int pid;
+         unsigned long long start_time;   // Clock ticks after boot, 0 when following events
+         unsigned long long cpu_ns;
+         unsigned long long run_delay_ns;   // Of the main thread, or every thread with taskstats
+         unsigned long long read_bytes;
+         unsigned long long write_bytes;
+         bool has_io;
+         char comm[16];
+     };
+     
+     struct Ranked {
+         double value;              // Ranking metric
+         size_t index;              // Into current
+         const Slot* before;        // Into previous, nullptr to count from zero
+     };
+     
+     unsigned files;
+     int proc_fd;
+     long ticks_per_second;
+     unsigned generation;
+     double last_time;              // CLOCK_BOOTTIME of the previous sample, 0 before it
+     size_t process_count;
+     std::vector<int> pids;
+     std::vector<Slot> current;
+     std::vector<Slot> previous;
+     std::vector<Ranked> heap;      // Busiest so far, least busy at the root
+     
+     // followEvents(): pids is kept up to date from the events between samples
+     int events_fd;                 // Proc connector, -1 while scanning /proc
+     int taskstats_fd;
+     unsigned short taskstats_family;
+     std::vector<int> forked;       // Processes started since the last sample
+     std::vector<int> renamed;      // Processes that called exec or changed comm
+     std::vector<char> replies;     // One taskstats reply per process of a batch
+     
+     bool readProcess(int pid, Slot& slot);
+     void readIo(int pid, Slot& slot);
+     void readComm(int pid, Slot& slot);
+     bool readEvents();
+     bool readTaskstats(const int* tgids, size_t count, Slot* slots, bool* found);
+     void stopEvents();
+     void rank(size_t index, const Slot* before, ProcessMetric metric, size_t limit);
+     size_t insert(const Slot& slot);
+     const Slot* findPrevious(int pid, unsigned long long start_time) const;
+ };
+ 
+ #endif // PROCESS_HPP
@@ -0,0 +1,215 @@
+/*
+ * procfs - Shared /proc file readers and mountinfo parser
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "procfs.hpp"
+ #include "stats.hpp"
+ 
+ #include <cerrno>
+ #include <cstring>
+ #include <string_view>
+ #include <unistd.h>
+ #include <fcntl.h>
+ #include <sys/stat.h>
+ #include <sys/syscall.h>
+ 
+ namespace {
+ 
+ // Record layout returned by the getdents64 system call
+ struct LinuxDirent64 {
+     unsigned long long d_ino;
+     long long d_off;
+     unsigned short d_reclen;
+     unsigned char d_type;
+     char d_name[1];
+ };
+ 
+ // --root directory without a trailing slash, empty for /
+ std::string system_root;
+ 
+ // Next space-separated field of the current line; p is left on the
+ // separator, or on the newline at the end of the line
+ std::string_view nextField(const char*& p) {
+     while (*p == ' ') ++p;
+     const char* start = p;
+     while (*p && *p != ' ' && *p != '\n') ++p;
+     return std::string_view(start, p - start);
+ }
+ 
+ }
+ 
+ bool setSystemRoot(const std::string& root) {
+     struct stat st;
+     if (!root.empty() && stat(root.c_str(), &st) != 0) return false;
+     if (!root.empty() && !S_ISDIR(st.st_mode)) {
+         errno = ENOTDIR;
+         return false;
+     }
+     
+     system_root = root;
+     while (!system_root.empty() && system_root.back() == '/') system_root.pop_back();
+     return true;
+ }
+ 
+ const std::string& systemRoot() {
+     return system_root;
+ }
+ 
+ std::string systemPath(const char* path) {
+     if (system_root.empty() || path[0] != '/') return path;
+     
+     if (std::strncmp(path, "/proc/self/", 11) == 0) {
+         return system_root + "/proc/1/" + (path + 11);
+     }
+     return system_root + path;
+ }
+ 
+ int openSystemFile(const char* path, int flags) {
+     countStat(STAT_OPENS);
+     if (system_root.empty()) return open(path, flags);
+     return open(systemPath(path).c_str(), flags);
+ }
+ 
+ int openProcFile(int& fd, const char* path) {
+     if (fd < 0) {
+         fd = openSystemFile(path, O_RDONLY | O_CLOEXEC);
+     }
+     return fd;
+ }
+ 
+ ssize_t readProcFile(int fd, std::vector<char>& buf) {
+     if (buf.empty()) buf.resize(4096);
+     
+     size_t len = 0;
+     for (;;) {
+         if (len + 1 >= buf.size()) buf.resize(buf.size() * 2);
+         
+         ssize_t n = pread(fd, buf.data() + len, buf.size() - len - 1, len);
+         if (n < 0) {
+             if (errno == EINTR) continue;
+             return -1;
+         }
+         countStat(STAT_READS);
+         countStat(STAT_READ_BYTES, n);
+         if (n == 0) break;
+         len += n;
+     }
+     
+     buf[len] = '\0';
+     return len;
+ }
+ 
+ ssize_t readFileAt(int dir_fd, const char* path, char* buf, size_t size) {
+     countStat(STAT_OPENS);
+     int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+     if (fd < 0) return -1;
+     
+     ssize_t n = read(fd, buf, size - 1);
+     close(fd);
+     if (n < 0) return -1;
+     countStat(STAT_READS);
+     countStat(STAT_READ_BYTES, n);
+     
+     buf[n] = '\0';
+     return n;
+ }
+ 
+ bool listPids(int proc_fd, std::vector<int>& pids) {
+     char buf[32768];
+     
+     lseek(proc_fd, 0, SEEK_SET);
+     for (;;) {
+         long n = syscall(SYS_getdents64, proc_fd, buf, sizeof(buf));
+         if (n < 0) return false;
+         countStat(STAT_READS);
+         countStat(STAT_READ_BYTES, n);
+         if (n == 0) return true;
+         
+         for (long offset = 0; offset < n;) {
+             const LinuxDirent64* entry = reinterpret_cast<const LinuxDirent64*>(buf + offset);
+             offset += entry->d_reclen;
+             countStat(STAT_DIRENTS);
+             
+             const char* name = entry->d_name;
+             if (name[0] < '0' || name[0] > '9') continue;
+             
+             int pid = 0;
+             while (*name >= '0' && *name <= '9') {
+                 pid = pid * 10 + (*name - '0');
+                 ++name;
+             }
+             pids.push_back(pid);
+         }
+     }
+ }
+ 
+ unsigned long long parseNumber(const char*& p) {
+     while (*p == ' ' || *p == '\t') ++p;
+     unsigned long long value = 0;
+     while (*p >= '0' && *p <= '9') {
+         value = value * 10 + (*p - '0');
+         ++p;
+     }
+     return value;
+ }
+ 
+ // Lines look like
+ // "36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue"
+ bool nextMountEntry(const char*& p, MountEntry& entry) {
+     if (!*p) return false;
+     
+     nextField(p);                                 // mount ID
+     nextField(p);                                 // parent ID
+     entry.devno = nextField(p);
+     entry.root = nextField(p);
+     entry.mountpoint = nextField(p);
+     entry.mount_options = nextField(p);
+     
+     // Optional fields end with a single "-"
+     std::string_view field;
+     do {
+         field = nextField(p);
+     } while (!field.empty() && field != "-");
+     
+     entry.filesystem = nextField(p);
+     entry.source = nextField(p);
+     entry.super_options = nextField(p);
+     
+     while (*p && *p != '\n') ++p;
+     if (*p) ++p;
+     return true;
+ }
+ 
+ std::string unescapeMountField(std::string_view field) {
+     std::string result;
+     result.reserve(field.size());
+     
+     for (size_t i = 0; i < field.size(); ++i) {
+         if (field[i] == '\\' && i + 3 < field.size() &&
+             field[i + 1] >= '0' && field[i + 1] <= '3' &&
+             field[i + 2] >= '0' && field[i + 2] <= '7' &&
+             field[i + 3] >= '0' && field[i + 3] <= '7') {
+             result += static_cast<char>((field[i + 1] - '0') * 64 + (field[i + 2] - '0') * 8 + (field[i + 3] - '0'));
+             i += 3;
+         } else {
+             result += field[i];
+         }
+     }
+     return result;
+ }
+ 
+ std::string joinMountOptions(const MountEntry& entry) {
+     std::string options(entry.mount_options);
+     std::string_view super_options = entry.super_options;
+     if (super_options.substr(0, 2) == "rw" || super_options.substr(0, 2) == "ro") {
+         super_options.remove_prefix(super_options.size() > 2 && super_options[2] == ',' ? 3 : 2);
+     }
+     if (!super_options.empty()) {
+         options += ',';
+         options += super_options;
+     }
+     return options;
+ }
@@ -0,0 +1,127 @@
+/*
+ * procfs - Shared /proc file readers and mountinfo parser
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef PROCFS_HPP
+ #define PROCFS_HPP
+ 
+ #include <string>
+ #include <string_view>
+ #include <vector>
+ #include <sys/types.h>
+ 
+ /**
+  * Read /proc, /sys, /etc and mount points under root instead of /, such as
+  * a host filesystem mounted into a container or a directory of fixtures.
+  * Call it once, before any collector runs.
+  * @param root Directory, empty or "/" for the real root
+  * @return false with errno set if root is not a directory
+  */
+ bool setSystemRoot(const std::string& root);
+ 
+ /**
+  * Directory set by setSystemRoot, empty for the real root
+  */
+ const std::string& systemRoot();
+ 
+ /**
+  * Map an absolute path to the root set by setSystemRoot. Under a root,
+  * /proc/self/ is read as /proc/1/, so mounts and cgroups are those of the
+  * system being inspected rather than of this process.
+  * @param path Absolute path, such as "/proc/stat"
+  * @return Path to open; relative paths are returned unchanged
+  */
+ std::string systemPath(const char* path);
+ 
+ /**
+  * open() a path mapped by systemPath
+  * @param path Absolute path
+  * @param flags open() flags
+  * @return File descriptor or -1 on error
+  */
+ int openSystemFile(const char* path, int flags);
+ 
+ /**
+  * Open a /proc file once and keep the descriptor for later samples
+  * @param fd Cached descriptor, opened if still negative
+  * @param path Path to the file, mapped by systemPath
+  * @return File descriptor or -1 on error
+  */
+ int openProcFile(int& fd, const char* path);
+ 
+ /**
+  * Re-read a whole /proc file from offset 0 with pread(). The buffer only
+  * grows, so repeated samples do not allocate once it is large enough.
+  * @param fd Open file descriptor
+  * @param buf Reusable buffer, grown as needed and NUL-terminated
+  * @return Number of bytes read or -1 on error
+  */
+ ssize_t readProcFile(int fd, std::vector<char>& buf);
+ 
+ /**
+  * Read a small file relative to a directory descriptor with one read()
+  * @param dir_fd Directory descriptor, such as an open /proc
+  * @param path Relative path
+  * @param buf Output buffer, NUL-terminated
+  * @param size Size of buf
+  * @return Number of bytes read or -1 on error
+  */
+ ssize_t readFileAt(int dir_fd, const char* path, char* buf, size_t size);
+ 
+ /**
+  * List the numeric entries of /proc with getdents64 in large batches
+  * @param proc_fd Directory descriptor of /proc, read from the start
+  * @param pids Vector to append the process IDs to
+  * @return true on success, false if the directory could not be read
+  */
+ bool listPids(int proc_fd, std::vector<int>& pids);
+ 
+ /**
+  * Parse a decimal number after optional blanks and advance p past it
+  * @param p Parse position
+  * @return Parsed value, 0 if no digits follow
+  */
+ unsigned long long parseNumber(const char*& p);
+ 
+ /**
+  * One line of /proc/self/mountinfo. Fields view the parsed text and keep
+  * the kernel's octal escapes; see unescapeMountField.
+  */
+ struct MountEntry {
+     std::string_view devno;          // "major:minor"
+     std::string_view root;           // Path inside the filesystem that is mounted
+     std::string_view mountpoint;
+     std::string_view mount_options;  // Per-mount options
+     std::string_view filesystem;
+     std::string_view source;
+     std::string_view super_options;  // Superblock options
+ };
+ 
+ /**
+  * Parse the next line of /proc/self/mountinfo
+  * @param p Position in the NUL-terminated text, moved past the line
+  * @param entry Where to store the fields
+  * @return false at the end of the text
+  */
+ bool nextMountEntry(const char*& p, MountEntry& entry);
+ 
+ /**
+  * Decode the \ooo octal escapes the kernel uses for blanks, newlines and
+  * backslashes in mount fields
+  * @param field Escaped field
+  * @return Decoded text
+  */
+ std::string unescapeMountField(std::string_view field);
+ 
+ /**
+  * Join per-mount and superblock options the way /proc/mounts does,
+  * dropping the repeated leading rw/ro of the superblock options
+  * @param entry Mount entry
+  * @return Comma-separated options
+  */
+ std::string joinMountOptions(const MountEntry& entry);
+ 
+ #endif // PROCFS_HPP
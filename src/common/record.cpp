@@ -0,0 +1,479 @@
+/*
+ * record - Binary recording and replay of raw samples
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "record.hpp"
+ 
+ #include <cerrno>
+ #include <cmath>
+ #include <cstring>
+ #include <unistd.h>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ 
+ namespace {
+ 
+ const char RECORD_MAGIC[8] = {'I', 'U', 'R', 'E', 'C', '0', '0', '1'};
+ 
+ enum FrameType : unsigned char {
+     FRAME_RESET = 0,         // Deltas start again from zero
+     FRAME_SAMPLE = 1,        // Start of a sample: time in microseconds
+     FRAME_CPU = 2,           // Load averages x100, aggregate counters, per-CPU rows
+     FRAME_MEMORY = 3,        // meminfo fields, vmstat counters, pressure x100
+     FRAME_DISK_NAMES = 4,    // major, minor and name of every DISKS row
+     FRAME_DISKS = 5,         // 11 counters per device
+     FRAME_PROCESSES = 6      // Page size, then pid, size, resident, shared
+ };
+ 
+ const int CPU_COUNTERS = CPU_COUNTER_COUNT;
+ const int DISK_COUNTERS = 11;
+ 
+ void putVarint(std::string& buf, unsigned long long value) {
+     while (value >= 0x80) {
+         buf += static_cast<char>((value & 0x7f) | 0x80);
+         value >>= 7;
+     }
+     buf += static_cast<char>(value);
+ }
+ 
+ bool getVarint(const unsigned char*& p, const unsigned char* end, unsigned long long& value) {
+     value = 0;
+     for (int shift = 0; p < end && shift < 64; shift += 7) {
+         unsigned char byte = *p++;
+         value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+         if (!(byte & 0x80)) return true;
+     }
+     return false;
+ }
+ 
+ // Map small negative differences to small unsigned numbers
+ unsigned long long zigzag(long long value) {
+     return (static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> 63);
+ }
+ 
+ long long unzigzag(unsigned long long value) {
+     return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+ }
+ 
+ unsigned long long fixed100(double value) {
+     return value > 0.0 ? static_cast<unsigned long long>(std::llround(value * 100.0)) : 0;
+ }
+ 
+ void diskCounters(const DiskStats& stat, unsigned long long* counters) {
+     counters[0] = stat.reads_completed;
+     counters[1] = stat.reads_merged;
+     counters[2] = stat.sectors_read;
+     counters[3] = stat.time_reading;
+     counters[4] = stat.writes_completed;
+     counters[5] = stat.writes_merged;
+     counters[6] = stat.sectors_written;
+     counters[7] = stat.time_writing;
+     counters[8] = stat.io_in_progress;
+     counters[9] = stat.time_io;
+     counters[10] = stat.weighted_time_io;
+ }
+ 
+ }
+ 
+ SampleRecorder::SampleRecorder() : fd(-1), last_time_us(0) {}
+ 
+ SampleRecorder::~SampleRecorder() {
+     if (fd >= 0) close(fd);
+ }
+ 
+ bool SampleRecorder::open(const char* path) {
+     int file = ::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+     if (file < 0) return false;
+     
+     struct stat st;
+     if (fstat(file, &st) != 0) {
+         int error = errno;
+         close(file);
+         errno = error;
+         return false;
+     }
+     
+     out.clear();
+     if (st.st_size == 0) {
+         out.append(RECORD_MAGIC, sizeof(RECORD_MAGIC));
+     } else {
+         // Appending to a previous recording: check that it is one
+         char magic[sizeof(RECORD_MAGIC)];
+         int reader = ::open(path, O_RDONLY | O_CLOEXEC);
+         bool valid = reader >= 0 && pread(reader, magic, sizeof(magic), 0) == sizeof(magic) &&
+                      std::memcmp(magic, RECORD_MAGIC, sizeof(magic)) == 0;
+         if (reader >= 0) close(reader);
+         if (!valid) {
+             close(file);
+             errno = EINVAL;
+             return false;
+         }
+         addFrame(FRAME_RESET, std::string());
+     }
+     
+     if (fd >= 0) close(fd);
+     fd = file;
+     for (auto& last : previous) last.clear();
+     disk_names.clear();
+     last_time_us = 0;
+     return true;
+ }
+ 
+ void SampleRecorder::addFrame(unsigned char type, const std::string& data) {
+     out += static_cast<char>(type);
+     putVarint(out, data.size());
+     out += data;
+ }
+ 
+ // Encode values as differences from the previous frame of this type
+ void SampleRecorder::addNumbers(unsigned char type) {
+     std::vector<unsigned long long>& last = previous[type];
+     payload.clear();
+     putVarint(payload, values.size());
+     for (size_t i = 0; i < values.size(); ++i) {
+         unsigned long long before = i < last.size() ? last[i] : 0;
+         putVarint(payload, zigzag(static_cast<long long>(values[i] - before)));
+     }
+     last.swap(values);
+     addFrame(type, payload);
+ }
+ 
+ void SampleRecorder::beginSample(double timestamp) {
+     long long now_us = std::llround(timestamp * 1e6);
+     payload.clear();
+     putVarint(payload, zigzag(now_us - last_time_us));
+     last_time_us = now_us;
+     addFrame(FRAME_SAMPLE, payload);
+ }
+ 
+ void SampleRecorder::addCpu(const CpuLoad& load, const CpuStatTable* per_cpu) {
+     values.clear();
+     values.push_back(fixed100(load.load1));
+     values.push_back(fixed100(load.load5));
+     values.push_back(fixed100(load.load15));
+     const unsigned long long counters[CPU_COUNTERS] = {
+         load.user, load.nice, load.system, load.idle, load.iowait,
+         load.irq, load.softirq, load.steal, load.guest, load.guest_nice
+     };
+     values.insert(values.end(), counters, counters + CPU_COUNTERS);
+     
+     size_t rows = per_cpu ? per_cpu->size() : 0;
+     values.push_back(rows);
+     for (size_t row = 0; row < rows; ++row) {
+         values.push_back(per_cpu->cpu[row]);
+         for (int counter = 0; counter < CPU_COUNTERS; ++counter) {
+             values.push_back(per_cpu->counters[counter][row]);
+         }
+     }
+     addNumbers(FRAME_CPU);
+ }
+ 
+ void SampleRecorder::addMemory(const MemoryInfo& info, const VmStatCounters& vmstat, const MemoryPressure& pressure) {
+     values.clear();
+     values.push_back(MEM_FIELD_COUNT);
+     values.insert(values.end(), info.fields, info.fields + MEM_FIELD_COUNT);
+     values.push_back(vmstat.pgscan);
+     values.push_back(vmstat.pgsteal);
+     values.push_back(vmstat.pswpin);
+     values.push_back(vmstat.pswpout);
+     values.push_back(vmstat.pgmajfault);
+     values.push_back(pressure.available);
+     values.push_back(fixed100(pressure.some_avg10));
+     values.push_back(fixed100(pressure.full_avg10));
+     addNumbers(FRAME_MEMORY);
+ }
+ 
+ void SampleRecorder::addDisks(const DiskStatsTable& table) {
+     current_names.clear();
+     values.clear();
+     values.push_back(0);
+     unsigned long long counters[DISK_COUNTERS];
+     for (const auto& row : table.rows) {
+         if (!row.present) continue;
+         current_names.push_back(std::to_string(row.major) + ":" + std::to_string(row.minor) + " " + row.device);
+         diskCounters(row, counters);
+         values.insert(values.end(), counters, counters + DISK_COUNTERS);
+     }
+     values[0] = current_names.size();
+     
+     if (current_names != disk_names) {
+         payload.clear();
+         putVarint(payload, current_names.size());
+         for (const auto& row : table.rows) {
+             if (!row.present) continue;
+             putVarint(payload, row.major);
+             putVarint(payload, row.minor);
+             putVarint(payload, row.device.size());
+             payload += row.device;
+         }
+         addFrame(FRAME_DISK_NAMES, payload);
+         disk_names.swap(current_names);
+     }
+     addNumbers(FRAME_DISKS);
+ }
+ 
+ void SampleRecorder::addProcesses(const std::vector<ProcessStatm>& processes, unsigned long page_size) {
+     values.clear();
+     values.push_back(page_size);
+     values.push_back(processes.size());
+     for (const auto& proc : processes) {
+         values.push_back(proc.pid);
+         values.push_back(proc.size);
+         values.push_back(proc.resident);
+         values.push_back(proc.shared);
+     }
+     addNumbers(FRAME_PROCESSES);
+ }
+ 
+ bool SampleRecorder::endSample() {
+     if (fd < 0) return false;
+     
+     size_t done = 0;
+     while (done < out.size()) {
+         ssize_t n = write(fd, out.data() + done, out.size() - done);
+         if (n < 0) {
+             if (errno == EINTR) continue;
+             out.clear();
+             return false;
+         }
+         done += n;
+     }
+     out.clear();
+     return true;
+ }
+ 
+ SampleReader::SampleReader() : data(nullptr), size(0), pos(0), cut_short(false), last_time_us(0) {}
+ 
+ SampleReader::~SampleReader() {
+     if (data) munmap(const_cast<unsigned char*>(data), size);
+ }
+ 
+ bool SampleReader::open(const char* path) {
+     int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+     if (fd < 0) return false;
+     
+     struct stat st;
+     if (fstat(fd, &st) != 0) {
+         int error = errno;
+         close(fd);
+         errno = error;
+         return false;
+     }
+     if (st.st_size < static_cast<off_t>(sizeof(RECORD_MAGIC))) {
+         close(fd);
+         errno = EINVAL;
+         return false;
+     }
+     
+     void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (map == MAP_FAILED) return false;
+     
+     if (std::memcmp(map, RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0) {
+         munmap(map, st.st_size);
+         errno = EINVAL;
+         return false;
+     }
+     madvise(map, st.st_size, MADV_SEQUENTIAL);
+     
+     if (data) munmap(const_cast<unsigned char*>(data), size);
+     data = static_cast<const unsigned char*>(map);
+     size = st.st_size;
+     pos = sizeof(RECORD_MAGIC);
+     cut_short = false;
+     reset();
+     return true;
+ }
+ 
+ void SampleReader::reset() {
+     for (auto& last : previous) last.clear();
+     disk_devices.clear();
+     disk_names.clear();
+     last_time_us = 0;
+ }
+ 
+ bool SampleReader::readFrame(unsigned char& type, const unsigned char*& payload, size_t& length) {
+     const unsigned char* p = data + pos;
+     const unsigned char* end = data + size;
+     if (p >= end) return false;
+     
+     type = *p++;
+     unsigned long long len;
+     if (!getVarint(p, end, len) || len > static_cast<unsigned long long>(end - p)) {
+         cut_short = true;
+         return false;
+     }
+     payload = p;
+     length = len;
+     pos = (p - data) + len;
+     return true;
+ }
+ 
+ bool SampleReader::decodeNumbers(unsigned char type, const unsigned char* payload, size_t length) {
+     const unsigned char* p = payload;
+     const unsigned char* end = payload + length;
+     unsigned long long count;
+     if (!getVarint(p, end, count) || count > length) return false;
+     
+     std::vector<unsigned long long>& last = previous[type];
+     values.resize(count);
+     for (size_t i = 0; i < count; ++i) {
+         unsigned long long delta;
+         if (!getVarint(p, end, delta)) return false;
+         values[i] = (i < last.size() ? last[i] : 0) + static_cast<unsigned long long>(unzigzag(delta));
+     }
+     last = values;
+     return true;
+ }
+ 
+ void SampleReader::decodeDiskNames(const unsigned char* payload, size_t length) {
+     const unsigned char* p = payload;
+     const unsigned char* end = payload + length;
+     disk_devices.clear();
+     disk_names.clear();
+     
+     unsigned long long count;
+     if (!getVarint(p, end, count)) return;
+     for (unsigned long long i = 0; i < count; ++i) {
+         unsigned long long major, minor, len;
+         if (!getVarint(p, end, major) || !getVarint(p, end, minor) || !getVarint(p, end, len) ||
+             len > static_cast<unsigned long long>(end - p)) {
+             return;
+         }
+         disk_devices.emplace_back(major, minor);
+         disk_names.emplace_back(reinterpret_cast<const char*>(p), len);
+         p += len;
+     }
+ }
+ 
+ bool SampleReader::next(RecordedSample& sample) {
+     unsigned char type;
+     const unsigned char* payload;
+     size_t length;
+     
+     // Skip to the start of the next sample
+     sample.restarted = false;
+     for (;;) {
+         if (!readFrame(type, payload, length)) return false;
+         if (type == FRAME_RESET) {
+             reset();
+             sample.restarted = true;
+         } else if (type == FRAME_SAMPLE) {
+             break;
+         }
+     }
+     
+     const unsigned char* p = payload;
+     unsigned long long delta;
+     if (!getVarint(p, payload + length, delta)) return false;
+     last_time_us += unzigzag(delta);
+     sample.timestamp = last_time_us / 1e6;
+     sample.has_cpu = sample.has_memory = sample.has_disks = sample.has_processes = false;
+     
+     // Sections run up to the next SAMPLE or RESET frame
+     for (;;) {
+         size_t frame_start = pos;
+         if (!readFrame(type, payload, length)) break;
+         if (type == FRAME_SAMPLE || type == FRAME_RESET) {
+             pos = frame_start;
+             break;
+         }
+         
+         if (type == FRAME_DISK_NAMES) {
+             decodeDiskNames(payload, length);
+             continue;
+         }
+         if (type >= sizeof(previous) / sizeof(previous[0]) || !decodeNumbers(type, payload, length)) {
+             continue;
+         }
+         
+         if (type == FRAME_CPU && values.size() >= 3 + CPU_COUNTERS + 1) {
+             CpuLoad& load = sample.load;
+             load.load1 = values[0] / 100.0;
+             load.load5 = values[1] / 100.0;
+             load.load15 = values[2] / 100.0;
+             const unsigned long long* counters = &values[3];
+             load.user = counters[CPU_USER];
+             load.nice = counters[CPU_NICE];
+             load.system = counters[CPU_SYSTEM];
+             load.idle = counters[CPU_IDLE];
+             load.iowait = counters[CPU_IOWAIT];
+             load.irq = counters[CPU_IRQ];
+             load.softirq = counters[CPU_SOFTIRQ];
+             load.steal = counters[CPU_STEAL];
+             load.guest = counters[CPU_GUEST];
+             load.guest_nice = counters[CPU_GUEST_NICE];
+             
+             size_t base = 3 + CPU_COUNTERS;
+             size_t rows = values[base++];
+             if (values.size() < base + rows * (1 + CPU_COUNTERS)) rows = 0;
+             sample.per_cpu.resize(rows);
+             for (size_t row = 0; row < rows; ++row) {
+                 sample.per_cpu.cpu[row] = static_cast<int>(values[base++]);
+                 for (int counter = 0; counter < CPU_COUNTERS; ++counter) {
+                     sample.per_cpu.counters[counter][row] = values[base++];
+                 }
+             }
+             sample.has_cpu = true;
+         } else if (type == FRAME_MEMORY && !values.empty()) {
+             size_t fields = values[0];
+             if (values.size() < 1 + fields + 8) continue;
+             sample.memory = MemoryInfo();
+             for (size_t i = 0; i < fields && i < MEM_FIELD_COUNT; ++i) {
+                 sample.memory.fields[i] = values[1 + i];
+             }
+             const unsigned long long* rest = &values[1 + fields];
+             sample.vmstat.pgscan = rest[0];
+             sample.vmstat.pgsteal = rest[1];
+             sample.vmstat.pswpin = rest[2];
+             sample.vmstat.pswpout = rest[3];
+             sample.vmstat.pgmajfault = rest[4];
+             sample.pressure.available = rest[5] != 0;
+             sample.pressure.some_avg10 = rest[6] / 100.0;
+             sample.pressure.full_avg10 = rest[7] / 100.0;
+             sample.has_memory = true;
+         } else if (type == FRAME_DISKS && !values.empty()) {
+             size_t rows = values[0];
+             if (rows != disk_devices.size() || values.size() < 1 + rows * DISK_COUNTERS) continue;
+             
+             // Devices missing from this sample keep their rows, marked absent
+             for (auto& row : sample.disks.rows) row.present = false;
+             for (size_t i = 0; i < rows; ++i) {
+                 DiskStats& stat = sample.disks.row(disk_devices[i].first, disk_devices[i].second);
+                 const unsigned long long* counters = &values[1 + i * DISK_COUNTERS];
+                 if (stat.device != disk_names[i]) stat.device = disk_names[i];
+                 stat.present = true;
+                 stat.reads_completed = counters[0];
+                 stat.reads_merged = counters[1];
+                 stat.sectors_read = counters[2];
+                 stat.time_reading = counters[3];
+                 stat.writes_completed = counters[4];
+                 stat.writes_merged = counters[5];
+                 stat.sectors_written = counters[6];
+                 stat.time_writing = counters[7];
+                 stat.io_in_progress = counters[8];
+                 stat.time_io = counters[9];
+                 stat.weighted_time_io = counters[10];
+             }
+             sample.has_disks = true;
+         } else if (type == FRAME_PROCESSES && values.size() >= 2) {
+             size_t count = values[1];
+             if (values.size() < 2 + count * 4) continue;
+             sample.page_size = values[0];
+             sample.processes.resize(count);
+             for (size_t i = 0; i < count; ++i) {
+                 const unsigned long long* fields = &values[2 + i * 4];
+                 sample.processes[i].pid = static_cast<int>(fields[0]);
+                 sample.processes[i].size = fields[1];
+                 sample.processes[i].resident = fields[2];
+                 sample.processes[i].shared = fields[3];
+             }
+             sample.has_processes = true;
+         }
+     }
+     return true;
+ }
@@ -0,0 +1,189 @@
+/*
+ * record - Binary recording and replay of raw samples
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef RECORD_HPP
+ #define RECORD_HPP
+ 
+ #include <cstddef>
+ #include <string>
+ #include <vector>
+ 
+ #include "cpu.hpp"
+ #include "mem.hpp"
+ #include "disk.hpp"
+ 
+ /**
+  * Sizes from /proc/PID/statm, in pages
+  */
+ struct ProcessStatm {
+     int pid;
+     unsigned long long size;
+     unsigned long long resident;
+     unsigned long long shared;
+     
+     ProcessStatm() : pid(0), size(0), resident(0), shared(0) {}
+ };
+ 
+ /**
+  * One sample read back from a recording. Sections the recorder did not
+  * write are left empty with their has_ flag unset.
+  */
+ struct RecordedSample {
+     double timestamp;        // Unix time of the sample
+     bool restarted;          // First sample after the recording was appended to
+     
+     bool has_cpu;
+     CpuLoad load;
+     CpuStatTable per_cpu;
+     
+     bool has_memory;
+     MemoryInfo memory;
+     VmStatCounters vmstat;
+     MemoryPressure pressure;
+     
+     bool has_disks;
+     DiskStatsTable disks;
+     
+     bool has_processes;
+     unsigned long page_size;
+     std::vector<ProcessStatm> processes;
+     
+     RecordedSample() : timestamp(0.0), restarted(false), has_cpu(false), has_memory(false), has_disks(false),
+                        has_processes(false), page_size(0) {}
+ };
+ 
+ /**
+  * Append-only writer of a sample recording.
+  *
+  * The file is an 8-byte magic followed by frames of a type byte, a
+  * varint payload length and the payload, so a reader can skip frame
+  * types it does not know. A sample is a SAMPLE frame holding its time
+  * followed by one frame per section. Numeric sections are a varint count
+  * and one zigzag varint per value, each the difference from the same
+  * position in the previous frame of that type; counters grow slowly, so
+  * most values take a single byte. Device names are written only when the
+  * set of disks changes. Opening an existing recording appends a RESET
+  * frame, after which every delta starts again from zero.
+  */
+ class SampleRecorder {
+ public:
+     SampleRecorder();
+     ~SampleRecorder();
+     
+     SampleRecorder(const SampleRecorder&) = delete;
+     SampleRecorder& operator=(const SampleRecorder&) = delete;
+     
+     /**
+      * Create a recording or append to an existing one
+      * @param path File name
+      * @return false with errno set on failure, EINVAL if the file is not
+      *         a recording
+      */
+     bool open(const char* path);
+     
+     bool isOpen() const { return fd >= 0; }
+     
+     /**
+      * Start a sample; sections added until endSample() belong to it
+      * @param timestamp Unix time of the sample
+      */
+     void beginSample(double timestamp);
+     
+     /**
+      * Add the /proc/stat counters
+      * @param load Aggregate counters and load averages
+      * @param per_cpu Per-CPU counters, or nullptr
+      */
+     void addCpu(const CpuLoad& load, const CpuStatTable* per_cpu);
+     
+     /**
+      * Add /proc/meminfo, /proc/vmstat and memory pressure
+      */
+     void addMemory(const MemoryInfo& info, const VmStatCounters& vmstat, const MemoryPressure& pressure);
+     
+     /**
+      * Add the devices of a diskstats table that are present
+      */
+     void addDisks(const DiskStatsTable& table);
+     
+     /**
+      * Add per-process statm sizes
+      * @param processes Processes in any order
+      * @param page_size Bytes per page
+      */
+     void addProcesses(const std::vector<ProcessStatm>& processes, unsigned long page_size);
+     
+     /**
+      * Append the sample to the file with a single write()
+      * @return false if the write failed
+      */
+     bool endSample();
+ 
+ private:
+     int fd;
+     std::string out;                 // Frames of the current sample
+     std::string payload;             // Payload of the frame being built
+     std::vector<unsigned long long> values;
+     std::vector<unsigned long long> previous[8];  // Last values of each frame type
+     std::vector<std::string> disk_names;          // "major:minor name" of the last DISK_NAMES frame
+     std::vector<std::string> current_names;
+     long long last_time_us;
+     
+     void addFrame(unsigned char type, const std::string& data);
+     void addNumbers(unsigned char type);
+ };
+ 
+ /**
+  * Reader of a recording through a read-only mapping of the whole file.
+  * A recording cut short by a crash reads up to its last complete frame.
+  */
+ class SampleReader {
+ public:
+     SampleReader();
+     ~SampleReader();
+     
+     SampleReader(const SampleReader&) = delete;
+     SampleReader& operator=(const SampleReader&) = delete;
+     
+     /**
+      * Map a recording
+      * @param path File name
+      * @return false with errno set on failure, EINVAL if the file is not
+      *         a recording
+      */
+     bool open(const char* path);
+     
+     /**
+      * Decode the next sample
+      * @param sample Filled with the sample; tables are reused
+      * @return false at the end of the recording
+      */
+     bool next(RecordedSample& sample);
+     
+     /**
+      * Whether the recording ended in the middle of a frame
+      */
+     bool truncated() const { return cut_short; }
+ 
+ private:
+     const unsigned char* data;
+     size_t size;
+     size_t pos;
+     bool cut_short;
+     std::vector<unsigned long long> values;
+     std::vector<unsigned long long> previous[8];
+     std::vector<std::pair<unsigned, unsigned>> disk_devices;
+     std::vector<std::string> disk_names;
+     long long last_time_us;
+     
+     bool readFrame(unsigned char& type, const unsigned char*& payload, size_t& length);
+     bool decodeNumbers(unsigned char type, const unsigned char* payload, size_t length);
+     void decodeDiskNames(const unsigned char* payload, size_t length);
+     void reset();
+ };
+ 
+ #endif // RECORD_HPP
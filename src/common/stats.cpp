@@ -0,0 +1,91 @@
+/*
+ * stats - Self-instrumentation of the collectors for --stats
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "stats.hpp"
+ 
+ #include <algorithm>
+ #include <iomanip>
+ #include <iostream>
+ #include <string>
+ #include <vector>
+ 
+ namespace stats_detail {
+     bool enabled = false;
+     std::atomic<unsigned long long> counters[STAT_COUNTER_COUNT];
+ }
+ 
+ namespace {
+ 
+ // Constant-initialized, so sections of any translation unit can link
+ // themselves in during static initialization
+ const StatSection* first_section = nullptr;
+ 
+ struct timespec enabled_at;
+ 
+ const char* const counter_names[STAT_COUNTER_COUNT] = {
+     "opens_total", "reads_total", "read_bytes_total", "dirents_total", "statvfs_total"
+ };
+ 
+ const char* const counter_labels[STAT_COUNTER_COUNT] = {
+     "opens", "reads", "bytes read", "directory entries", "statvfs calls"
+ };
+ 
+ }
+ 
+ StatSection::StatSection(const char* name)
+     : section_name(name), call_count(0), total_ns(0), next_section(first_section) {
+     first_section = this;
+ }
+ 
+ const StatSection* firstStatSection() {
+     return first_section;
+ }
+ 
+ void enableStats() {
+     clock_gettime(CLOCK_MONOTONIC, &enabled_at);
+     stats_detail::enabled = true;
+ }
+ 
+ unsigned long long statCounter(StatCounter counter) {
+     return stats_detail::counters[counter].load(std::memory_order_relaxed);
+ }
+ 
+ const char* statCounterName(StatCounter counter) {
+     return counter_names[counter];
+ }
+ 
+ void printStats(const char* program) {
+     struct timespec now;
+     clock_gettime(CLOCK_MONOTONIC, &now);
+     double wall_ms = (now.tv_sec - enabled_at.tv_sec) * 1e3 + (now.tv_nsec - enabled_at.tv_nsec) / 1e6;
+     
+     std::vector<const StatSection*> sections;
+     for (const StatSection* section = firstStatSection(); section; section = section->next()) {
+         if (section->calls() > 0) sections.push_back(section);
+     }
+     std::stable_sort(sections.begin(), sections.end(), [](const StatSection* a, const StatSection* b) {
+         return a->nanoseconds() > b->nanoseconds();
+     });
+     
+     std::cerr << program << ": " << std::fixed << std::setprecision(3) << wall_ms << " ms in total" << '\n';
+     std::cerr << std::left << std::setw(28) << "COLLECTOR" << std::right << std::setw(8) << "CALLS"
+               << std::setw(12) << "TOTAL MS" << std::setw(12) << "AVG MS" << '\n';
+     for (const StatSection* section : sections) {
+         double total_ms = section->nanoseconds() / 1e6;
+         std::cerr << std::left << std::setw(28) << section->name() << std::right
+                   << std::setw(8) << section->calls()
+                   << std::setw(12) << total_ms
+                   << std::setw(12) << total_ms / section->calls() << '\n';
+     }
+     
+     std::string line;
+     for (int i = 0; i < STAT_COUNTER_COUNT; ++i) {
+         if (i > 0) line += ", ";
+         line += std::to_string(statCounter(static_cast<StatCounter>(i))) + " " + counter_labels[i];
+     }
+     std::cerr << line << '\n';
+ }
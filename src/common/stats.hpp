@@ -0,0 +1,140 @@
+/*
+ * stats - Self-instrumentation of the collectors for --stats
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef STATS_HPP
+ #define STATS_HPP
+ 
+ #include <atomic>
+ #include <ctime>
+ 
+ /**
+  * System calls counted while stats are enabled
+  */
+ enum StatCounter {
+     STAT_OPENS,              // open() and openat()
+     STAT_READS,              // read(), pread() and getdents64()
+     STAT_READ_BYTES,         // Bytes returned by those reads
+     STAT_DIRENTS,            // Directory entries listed
+     STAT_STATVFS,            // statvfs() of mount points
+     STAT_COUNTER_COUNT
+ };
+ 
+ namespace stats_detail {
+     extern bool enabled;
+     extern std::atomic<unsigned long long> counters[STAT_COUNTER_COUNT];
+ }
+ 
+ /**
+  * Start counting and timing. Call it once, before any collector runs;
+  * until then every hook is a single predicted branch.
+  */
+ void enableStats();
+ 
+ inline bool statsEnabled() {
+     return __builtin_expect(stats_detail::enabled, false);
+ }
+ 
+ /**
+  * Add to a system call counter if stats are enabled
+  * @param counter Counter
+  * @param amount Amount to add
+  */
+ inline void countStat(StatCounter counter, unsigned long long amount = 1) {
+     if (statsEnabled()) {
+         stats_detail::counters[counter].fetch_add(amount, std::memory_order_relaxed);
+     }
+ }
+ 
+ /**
+  * Current value of a counter
+  */
+ unsigned long long statCounter(StatCounter counter);
+ 
+ /**
+  * Metric name of a counter, such as "opens_total"
+  */
+ const char* statCounterName(StatCounter counter);
+ 
+ /**
+  * Calls and time spent in one collector. Sections are defined at
+  * namespace scope and link themselves into a list during static
+  * initialization, so any thread may time them without locking.
+  */
+ class StatSection {
+ public:
+     /**
+      * Constructor
+      * @param name Collector name, such as "readCpuInfo"; must outlive the section
+      */
+     explicit StatSection(const char* name);
+     
+     StatSection(const StatSection&) = delete;
+     StatSection& operator=(const StatSection&) = delete;
+     
+     const char* name() const { return section_name; }
+     unsigned long long calls() const { return call_count.load(std::memory_order_relaxed); }
+     unsigned long long nanoseconds() const { return total_ns.load(std::memory_order_relaxed); }
+     
+     /**
+      * Next section after this one, or nullptr
+      */
+     const StatSection* next() const { return next_section; }
+     
+     /**
+      * Record one call
+      * @param ns Time it took
+      */
+     void add(unsigned long long ns) {
+         call_count.fetch_add(1, std::memory_order_relaxed);
+         total_ns.fetch_add(ns, std::memory_order_relaxed);
+     }
+ 
+ private:
+     const char* section_name;
+     std::atomic<unsigned long long> call_count;
+     std::atomic<unsigned long long> total_ns;
+     const StatSection* next_section;
+ };
+ 
+ /**
+  * First registered section, for walking them all with next()
+  */
+ const StatSection* firstStatSection();
+ 
+ /**
+  * Times its enclosing scope into a section; reads no clock while stats
+  * are disabled
+  */
+ class StatTimer {
+ public:
+     explicit StatTimer(StatSection& section) : section(section), start(statsEnabled() ? now() : 0) {}
+     ~StatTimer() {
+         if (start != 0) section.add(now() - start);
+     }
+     
+     StatTimer(const StatTimer&) = delete;
+     StatTimer& operator=(const StatTimer&) = delete;
+ 
+ private:
+     StatSection& section;
+     unsigned long long start;
+     
+     static unsigned long long now() {
+         struct timespec ts;
+         clock_gettime(CLOCK_MONOTONIC, &ts);
+         return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+     }
+ };
+ 
+ /**
+  * Print the time of every section that ran, slowest first, and the
+  * system call counters to stderr
+  * @param program Program name for the heading
+  */
+ void printStats(const char* program);
+ 
+ #endif // STATS_HPP
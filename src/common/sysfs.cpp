@@ -0,0 +1,174 @@
+/*
+ * sysfs - Shared sysfs attribute reader
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "sysfs.hpp"
+ #include "procfs.hpp"
+ #include "stats.hpp"
+ 
+ #include <cerrno>
+ #include <cstring>
+ #include <unistd.h>
+ #include <fcntl.h>
+ #include <dirent.h>
+ #include <sys/stat.h>
+ 
+ bool parseUnsigned(const char* text, unsigned long long& value) {
+     if (*text < '0' || *text > '9') return false;
+ 
+     value = 0;
+     while (*text >= '0' && *text <= '9') {
+         value = value * 10 + (*text - '0');
+         ++text;
+     }
+     return true;
+ }
+ 
+ bool parseSigned(const char* text, long long& value) {
+     bool negative = *text == '-';
+     unsigned long long magnitude;
+     if (!parseUnsigned(negative ? text + 1 : text, magnitude)) return false;
+ 
+     value = negative ? -static_cast<long long>(magnitude) : static_cast<long long>(magnitude);
+     return true;
+ }
+ 
+ SysfsDir::~SysfsDir() {
+     close();
+ }
+ 
+ SysfsDir& SysfsDir::operator=(SysfsDir&& other) noexcept {
+     if (this != &other) {
+         close();
+         fd = other.fd;
+         other.fd = -1;
+     }
+     return *this;
+ }
+ 
+ bool SysfsDir::open(const char* path) {
+     close();
+     fd = openSystemFile(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+     return fd >= 0;
+ }
+ 
+ bool SysfsDir::open(const SysfsDir& parent, const char* name) {
+     close();
+     if (!parent.valid()) return false;
+     countStat(STAT_OPENS);
+     fd = openat(parent.fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+     return fd >= 0;
+ }
+ 
+ void SysfsDir::close() {
+     if (fd >= 0) {
+         ::close(fd);
+         fd = -1;
+     }
+ }
+ 
+ ssize_t SysfsDir::read(const char* name, char* buf, size_t size) const {
+     if (fd < 0 || size == 0) return -1;
+ 
+     countStat(STAT_OPENS);
+     int file = openat(fd, name, O_RDONLY | O_CLOEXEC);
+     if (file < 0) return -1;
+ 
+     ssize_t n;
+     do {
+         n = ::read(file, buf, size - 1);
+     } while (n < 0 && errno == EINTR);
+     ::close(file);
+     if (n < 0) return -1;
+     countStat(STAT_READS);
+     countStat(STAT_READ_BYTES, n);
+ 
+     while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == ' ' ||
+                      buf[n - 1] == '\t' || buf[n - 1] == '\r')) {
+         --n;
+     }
+     buf[n] = '\0';
+     return n;
+ }
+ 
+ bool SysfsDir::readString(const char* name, std::string& value) const {
+     char buf[4096];
+     ssize_t n = read(name, buf, sizeof(buf));
+     if (n < 0) return false;
+ 
+     value.assign(buf, n);
+     return true;
+ }
+ 
+ bool SysfsDir::readUnsigned(const char* name, unsigned long long& value) const {
+     char buf[64];
+     return read(name, buf, sizeof(buf)) > 0 && parseUnsigned(buf, value);
+ }
+ 
+ bool SysfsDir::readInt(const char* name, long long& value) const {
+     char buf[64];
+     return read(name, buf, sizeof(buf)) > 0 && parseSigned(buf, value);
+ }
+ 
+ int SysfsDir::openFile(const char* name) const {
+     if (fd < 0) return -1;
+     countStat(STAT_OPENS);
+     return openat(fd, name, O_RDONLY | O_CLOEXEC);
+ }
+ 
+ bool SysfsDir::list(std::vector<std::string>& names) const {
+     return listEntries(names, false);
+ }
+ 
+ bool SysfsDir::listDirectories(std::vector<std::string>& names) const {
+     return listEntries(names, true);
+ }
+ 
+ bool SysfsDir::listEntries(std::vector<std::string>& names, bool directories) const {
+     names.clear();
+     if (fd < 0) return false;
+ 
+     // fdopendir takes ownership, so hand it a duplicate and rewind it
+     int dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+     if (dup_fd < 0) return false;
+     DIR* dir = fdopendir(dup_fd);
+     if (!dir) {
+         ::close(dup_fd);
+         return false;
+     }
+     rewinddir(dir);
+ 
+     while (struct dirent* entry = readdir(dir)) {
+         const char* name = entry->d_name;
+         countStat(STAT_DIRENTS);
+         if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+         
+         // d_type saves a stat per entry; only fall back when it is unknown
+         if (directories && entry->d_type != DT_DIR) {
+             struct stat st;
+             if (entry->d_type != DT_UNKNOWN || fstatat(fd, name, &st, 0) != 0 ||
+                 !S_ISDIR(st.st_mode)) {
+                 continue;
+             }
+         }
+         names.push_back(name);
+     }
+     closedir(dir);
+     return true;
+ }
+ 
+ bool SysfsDir::rereadUnsigned(int fd, unsigned long long& value) {
+     if (fd < 0) return false;
+ 
+     char buf[32];
+     ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+     if (n <= 0) return false;
+     countStat(STAT_READS);
+     countStat(STAT_READ_BYTES, n);
+ 
+     buf[n] = '\0';
+     return parseUnsigned(buf, value);
+ }
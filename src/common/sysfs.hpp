@@ -0,0 +1,148 @@
+/*
+ * sysfs - Shared sysfs attribute reader
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef SYSFS_HPP
+ #define SYSFS_HPP
+ 
+ #include <string>
+ #include <vector>
+ #include <sys/types.h>
+ 
+ /**
+  * Directory descriptor for reading sysfs attributes. Attributes are opened
+  * with openat relative to the held descriptor and read with a single read
+  * into a stack buffer, so walking many devices costs one open per attribute
+  * and no path building or stream setup.
+  */
+ class SysfsDir {
+ public:
+     SysfsDir() : fd(-1) {}
+     ~SysfsDir();
+ 
+     SysfsDir(SysfsDir&& other) noexcept : fd(other.fd) { other.fd = -1; }
+     SysfsDir& operator=(SysfsDir&& other) noexcept;
+ 
+     SysfsDir(const SysfsDir&) = delete;
+     SysfsDir& operator=(const SysfsDir&) = delete;
+ 
+     /**
+      * Open a directory by absolute path, under the --root directory if set
+      * @param path Directory path, mapped by systemPath
+      * @return true on success, false otherwise
+      */
+     bool open(const char* path);
+ 
+     /**
+      * Open a directory relative to another one
+      * @param parent Open parent directory
+      * @param name Relative path, may contain several components
+      * @return true on success, false otherwise
+      */
+     bool open(const SysfsDir& parent, const char* name);
+ 
+     /**
+      * Close the directory
+      */
+     void close();
+ 
+     /**
+      * Check whether a directory is open
+      * @return true if open
+      */
+     bool valid() const { return fd >= 0; }
+ 
+     /**
+      * Get the raw directory descriptor
+      * @return Descriptor or -1
+      */
+     int get() const { return fd; }
+ 
+     /**
+      * Read an attribute into buf with trailing whitespace removed
+      * @param name Attribute path relative to this directory
+      * @param buf Buffer to store the NUL-terminated value
+      * @param size Size of buf
+      * @return Length of the value or -1 if the attribute cannot be read
+      */
+     ssize_t read(const char* name, char* buf, size_t size) const;
+ 
+     /**
+      * Read a text attribute
+      * @param name Attribute path relative to this directory
+      * @param value String to store the trimmed value
+      * @return true on success, false otherwise
+      */
+     bool readString(const char* name, std::string& value) const;
+ 
+     /**
+      * Read an unsigned decimal attribute
+      * @param name Attribute path relative to this directory
+      * @param value Where to store the parsed value
+      * @return true if the attribute was read and starts with a number
+      */
+     bool readUnsigned(const char* name, unsigned long long& value) const;
+ 
+     /**
+      * Read a signed decimal attribute
+      * @param name Attribute path relative to this directory
+      * @param value Where to store the parsed value
+      * @return true if the attribute was read and starts with a number
+      */
+     bool readInt(const char* name, long long& value) const;
+ 
+     /**
+      * Open an attribute to be re-read later with rereadUnsigned
+      * @param name Attribute path relative to this directory
+      * @return File descriptor owned by the caller, or -1
+      */
+     int openFile(const char* name) const;
+ 
+     /**
+      * List the entries of the directory, without "." and ".."
+      * @param names Vector to store the entry names in directory order
+      * @return true on success, false otherwise
+      */
+     bool list(std::vector<std::string>& names) const;
+     
+     /**
+      * List the subdirectories of the directory
+      * @param names Vector to store the subdirectory names in directory order
+      * @return true on success, false otherwise
+      */
+     bool listDirectories(std::vector<std::string>& names) const;
+ 
+     /**
+      * Re-read an unsigned attribute from offset 0 of a held descriptor
+      * @param fd Descriptor from openFile
+      * @param value Where to store the parsed value
+      * @return true on success, false otherwise
+      */
+     static bool rereadUnsigned(int fd, unsigned long long& value);
+ 
+ private:
+     bool listEntries(std::vector<std::string>& names, bool directories) const;
+     
+     int fd;
+ };
+ 
+ /**
+  * Parse an unsigned decimal number without locale or stream overhead
+  * @param text Text starting with the number
+  * @param value Where to store the parsed value
+  * @return true if text starts with a digit
+  */
+ bool parseUnsigned(const char* text, unsigned long long& value);
+ 
+ /**
+  * Parse a signed decimal number without locale or stream overhead
+  * @param text Text starting with the number, optionally negative
+  * @param value Where to store the parsed value
+  * @return true if text starts with a number
+  */
+ bool parseSigned(const char* text, long long& value);
+ 
+ #endif // SYSFS_HPP
@@ -0,0 +1,324 @@
+/*
+ * topology - Shared CPU topology model read from sysfs
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include "topology.hpp"
+ #include "stats.hpp"
+ #include "sysfs.hpp"
+ 
+ #include <algorithm>
+ #include <cstdlib>
+ #include <cstring>
+ 
+ namespace {
+ 
+ // --stats timing of the collectors in this file
+ StatSection topology_section("CpuTopology::load");
+ 
+ bool readIntAttr(const SysfsDir& dir, const char* name, int& value) {
+     long long parsed;
+     if (!dir.readInt(name, parsed)) return false;
+     value = parsed;
+     return true;
+ }
+ 
+ // Cache sizes are reported as "48K", "2048K" or occasionally "1M"
+ unsigned long parseCacheSize(const std::string& text) {
+     char* end = nullptr;
+     unsigned long size = std::strtoul(text.c_str(), &end, 10);
+     if (*end == 'M') size *= 1024;
+     else if (*end == 'G') size *= 1024 * 1024;
+     else if (*end != 'K') size /= 1024;
+     return size;
+ }
+ 
+ // Entry used to group CPUs into cores and packages with a single sort
+ struct CpuKey {
+     int package_id;
+     int die_id;
+     int core_id;
+     int cpu_id;
+ 
+     bool operator<(const CpuKey& other) const {
+         if (package_id != other.package_id) return package_id < other.package_id;
+         if (die_id != other.die_id) return die_id < other.die_id;
+         if (core_id != other.core_id) return core_id < other.core_id;
+         return cpu_id < other.cpu_id;
+     }
+ };
+ 
+ }
+ 
+ void parseCpuList(const std::string& text, std::vector<int>& ids) {
+     ids.clear();
+     const char* p = text.c_str();
+ 
+     while (*p) {
+         if (*p < '0' || *p > '9') {
+             ++p;
+             continue;
+         }
+ 
+         char* end = nullptr;
+         int first = std::strtol(p, &end, 10);
+         int last = first;
+         if (*end == '-') {
+             last = std::strtol(end + 1, &end, 10);
+         }
+         for (int id = first; id <= last; ++id) {
+             ids.push_back(id);
+         }
+         p = end;
+     }
+ 
+     std::sort(ids.begin(), ids.end());
+ }
+ 
+ std::string formatCpuList(const int* begin, const int* end) {
+     std::string result;
+ 
+     for (const int* p = begin; p != end;) {
+         const int* run = p;
+         while (run + 1 != end && run[1] == run[0] + 1) ++run;
+ 
+         if (!result.empty()) result += ',';
+         result += std::to_string(*p);
+         if (run != p) {
+             result += '-';
+             result += std::to_string(*run);
+         }
+         p = run + 1;
+     }
+ 
+     return result;
+ }
+ 
+ CpuRange CpuTopology::appendRange(const std::vector<int>& ids) {
+     CpuRange range;
+     range.offset = cpu_lists.size();
+     range.count = ids.size();
+     cpu_lists.insert(cpu_lists.end(), ids.begin(), ids.end());
+     return range;
+ }
+ 
+ bool CpuTopology::load(const std::string& root) {
+     StatTimer timer(topology_section);
+     cpus.clear();
+     cores.clear();
+     packages.clear();
+     nodes.clear();
+     caches.clear();
+     cpu_lists.clear();
+     cpu_index.clear();
+ 
+     SysfsDir cpu_dir;
+     std::vector<std::string> names;
+     std::string cpu_path = root + "/cpu";
+     if (!cpu_dir.open(cpu_path.c_str()) || !cpu_dir.list(names)) return false;
+ 
+     // Offline CPUs have no topology directory and are skipped
+     std::vector<CpuKey> keys;
+     SysfsDir topology_dir;
+     for (const auto& entry : names) {
+         const char* name = entry.c_str();
+         if (std::strncmp(name, "cpu", 3) != 0 || name[3] < '0' || name[3] > '9') continue;
+ 
+         std::string topology_path = entry + "/topology";
+         if (!topology_dir.open(cpu_dir, topology_path.c_str())) continue;
+ 
+         CpuKey key = {0, 0, 0, std::atoi(name + 3)};
+         bool online = readIntAttr(topology_dir, "core_id", key.core_id);
+         readIntAttr(topology_dir, "physical_package_id", key.package_id);
+         readIntAttr(topology_dir, "die_id", key.die_id);
+ 
+         if (online) keys.push_back(key);
+     }
+ 
+     if (keys.empty()) return false;
+ 
+     // Sorting by (package, die, core, cpu) makes every core and package a
+     // contiguous run, so grouping needs no associative containers
+     std::sort(keys.begin(), keys.end());
+ 
+     int max_id = 0;
+     for (const auto& key : keys) max_id = std::max(max_id, key.cpu_id);
+ 
+     std::vector<int> ids_by_number;
+     for (const auto& key : keys) ids_by_number.push_back(key.cpu_id);
+     std::sort(ids_by_number.begin(), ids_by_number.end());
+ 
+     cpu_index.assign(max_id + 1, -1);
+     cpus.resize(keys.size());
+     for (size_t i = 0; i < ids_by_number.size(); ++i) {
+         cpus[i].id = ids_by_number[i];
+         cpu_index[ids_by_number[i]] = i;
+     }
+ 
+     std::vector<int> threads;
+     std::vector<int> package_cpus;
+     for (size_t i = 0; i < keys.size();) {
+         const CpuKey& first = keys[i];
+ 
+         if (packages.empty() || packages.back().package_id != first.package_id) {
+             if (!packages.empty()) {
+                 std::sort(package_cpus.begin(), package_cpus.end());
+                 packages.back().cpus = appendRange(package_cpus);
+                 package_cpus.clear();
+             }
+             TopologyPackage package;
+             package.package_id = first.package_id;
+             package.first_core = cores.size();
+             packages.push_back(package);
+         }
+ 
+         threads.clear();
+         size_t j = i;
+         for (; j < keys.size() && keys[j].package_id == first.package_id &&
+                keys[j].die_id == first.die_id && keys[j].core_id == first.core_id; ++j) {
+             threads.push_back(keys[j].cpu_id);
+ 
+             TopologyCpu& cpu = cpus[cpu_index[keys[j].cpu_id]];
+             cpu.package = packages.size() - 1;
+             cpu.core = cores.size();
+         }
+ 
+         TopologyCore core;
+         core.core_id = first.core_id;
+         core.package = packages.size() - 1;
+         core.threads = appendRange(threads);
+         cores.push_back(core);
+ 
+         packages.back().core_count++;
+         package_cpus.insert(package_cpus.end(), threads.begin(), threads.end());
+         i = j;
+     }
+     std::sort(package_cpus.begin(), package_cpus.end());
+     packages.back().cpus = appendRange(package_cpus);
+ 
+     loadNodes(root);
+     loadCaches(cpu_dir);
+ 
+     return true;
+ }
+ 
+ void CpuTopology::loadNodes(const std::string& root) {
+     SysfsDir dir;
+     std::vector<std::string> names;
+     std::string node_path = root + "/node";
+     if (!dir.open(node_path.c_str()) || !dir.list(names)) return;
+ 
+     std::vector<int> ids;
+     SysfsDir node_dir;
+     for (const auto& entry : names) {
+         const char* name = entry.c_str();
+         if (std::strncmp(name, "node", 4) != 0 || name[4] < '0' || name[4] > '9') continue;
+ 
+         if (!node_dir.open(dir, name)) continue;
+ 
+         TopologyNode node;
+         node.node_id = std::atoi(name + 4);
+ 
+         std::string text;
+         if (node_dir.readString("cpulist", text)) {
+             parseCpuList(text, ids);
+             ids.erase(std::remove_if(ids.begin(), ids.end(),
+                                      [this](int id) { return cpuIndex(id) < 0; }),
+                       ids.end());
+             node.cpus = appendRange(ids);
+         }
+ 
+         // "Node 0 MemTotal:       263783812 kB"
+         if (node_dir.readString("meminfo", text)) {
+             size_t pos = text.find("MemTotal:");
+             if (pos != std::string::npos) {
+                 node.memory_kb = std::strtoull(text.c_str() + pos + 9, nullptr, 10);
+             }
+         }
+ 
+         nodes.push_back(node);
+     }
+ 
+     std::sort(nodes.begin(), nodes.end(),
+               [](const TopologyNode& a, const TopologyNode& b) {
+                   return a.node_id < b.node_id;
+               });
+ 
+     for (size_t i = 0; i < nodes.size(); ++i) {
+         for (const int* id = rangeBegin(nodes[i].cpus); id != rangeEnd(nodes[i].cpus); ++id) {
+             cpus[cpuIndex(*id)].node = i;
+         }
+     }
+ }
+ 
+ void CpuTopology::loadCaches(const SysfsDir& cpu_dir) {
+     std::vector<int> shared;
+     std::string text;
+     SysfsDir cache_dir;
+ 
+     for (const auto& cpu : cpus) {
+         for (int index = 0;; ++index) {
+             char path[64];
+             snprintf(path, sizeof(path), "cpu%d/cache/index%d", cpu.id, index);
+             if (!cache_dir.open(cpu_dir, path)) break;
+ 
+             // A shared cache is described once, by the first online CPU using it
+             if (!cache_dir.readString("shared_cpu_list", text)) continue;
+             parseCpuList(text, shared);
+             shared.erase(std::remove_if(shared.begin(), shared.end(),
+                                         [this](int id) { return cpuIndex(id) < 0; }),
+                          shared.end());
+             if (shared.empty() || shared.front() != cpu.id) continue;
+ 
+             TopologyCache cache;
+             readIntAttr(cache_dir, "level", cache.level);
+             if (cache_dir.readString("type", text) && !text.empty()) {
+                 cache.type = text[0];
+             }
+             if (cache_dir.readString("size", text)) {
+                 cache.size_kb = parseCacheSize(text);
+             }
+             readIntAttr(cache_dir, "ways_of_associativity", cache.ways);
+             readIntAttr(cache_dir, "coherency_line_size", cache.line_size);
+ 
+             cache.cpus = appendRange(shared);
+             caches.push_back(cache);
+         }
+     }
+ 
+     std::stable_sort(caches.begin(), caches.end(),
+                      [](const TopologyCache& a, const TopologyCache& b) {
+                          if (a.level != b.level) return a.level < b.level;
+                          return a.type < b.type;
+                      });
+ }
+ 
+ int CpuTopology::cpuIndex(int cpu_id) const {
+     if (cpu_id < 0 || cpu_id >= static_cast<int>(cpu_index.size())) return -1;
+     return cpu_index[cpu_id];
+ }
+ 
+ int CpuTopology::cacheOf(int cpu_id, int level, char type) const {
+     for (size_t i = 0; i < caches.size(); ++i) {
+         const TopologyCache& cache = caches[i];
+         if (cache.level != level || cache.type != type) continue;
+         if (std::binary_search(rangeBegin(cache.cpus), rangeEnd(cache.cpus), cpu_id)) {
+             return i;
+         }
+     }
+     return -1;
+ }
+ 
+ int CpuTopology::threadsPerCore() const {
+     int threads = 0;
+     for (const auto& core : cores) {
+         threads = std::max(threads, core.threads.count);
+     }
+     return threads;
+ }
+ 
+ std::string CpuTopology::formatRange(const CpuRange& range) const {
+     return formatCpuList(rangeBegin(range), rangeEnd(range));
+ }
@@ -0,0 +1,190 @@
+/*
+ * topology - Shared CPU topology model read from sysfs
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef TOPOLOGY_HPP
+ #define TOPOLOGY_HPP
+ 
+ #include <string>
+ #include <vector>
+ 
+ class SysfsDir;
+ 
+ /**
+  * Slice of CpuTopology::cpu_lists holding sorted logical CPU numbers
+  */
+ struct CpuRange {
+     int offset;
+     int count;
+ 
+     CpuRange() : offset(0), count(0) {}
+ };
+ 
+ /**
+  * One online logical CPU. package, core and node are indices into the
+  * corresponding CpuTopology vectors, node is -1 without NUMA information.
+  */
+ struct TopologyCpu {
+     int id;
+     int package;
+     int core;
+     int node;
+ 
+     TopologyCpu() : id(0), package(0), core(0), node(-1) {}
+ };
+ 
+ /**
+  * Physical core with its SMT sibling threads
+  */
+ struct TopologyCore {
+     int core_id;
+     int package;
+     CpuRange threads;
+ 
+     TopologyCore() : core_id(0), package(0) {}
+ };
+ 
+ /**
+  * Physical package (socket). Its cores are contiguous in CpuTopology::cores.
+  */
+ struct TopologyPackage {
+     int package_id;
+     int first_core;
+     int core_count;
+     CpuRange cpus;
+ 
+     TopologyPackage() : package_id(0), first_core(0), core_count(0) {}
+ };
+ 
+ /**
+  * NUMA node from /sys/devices/system/node
+  */
+ struct TopologyNode {
+     int node_id;
+     unsigned long long memory_kb;
+     CpuRange cpus;
+ 
+     TopologyNode() : node_id(0), memory_kb(0) {}
+ };
+ 
+ /**
+  * One cache instance and the CPUs sharing it
+  */
+ struct TopologyCache {
+     int level;
+     char type; // 'D'ata, 'I'nstruction or 'U'nified
+     unsigned long size_kb;
+     int ways;
+     int line_size;
+     CpuRange cpus;
+ 
+     TopologyCache() : level(0), type('U'), size_kb(0), ways(0), line_size(0) {}
+ };
+ 
+ /**
+  * CPU topology built from sysfs: packages, cores, SMT threads, NUMA nodes
+  * and caches. Everything is stored in flat vectors that refer to each other
+  * by index, with member CPU lists packed into a single array.
+  */
+ class CpuTopology {
+ public:
+     std::vector<TopologyCpu> cpus;
+     std::vector<TopologyCore> cores;
+     std::vector<TopologyPackage> packages;
+     std::vector<TopologyNode> nodes;
+     std::vector<TopologyCache> caches;
+     std::vector<int> cpu_lists;
+ 
+     /**
+      * Read the topology of all online CPUs
+      * @param root sysfs system directory, normally /sys/devices/system
+      * @return true if at least one CPU was found, false otherwise
+      */
+     bool load(const std::string& root = "/sys/devices/system");
+ 
+     /**
+      * Find the index of a logical CPU in cpus
+      * @param cpu_id Logical CPU number
+      * @return Index into cpus or -1 if the CPU is offline or unknown
+      */
+     int cpuIndex(int cpu_id) const;
+ 
+     /**
+      * Get the first CPU number of a range
+      * @param range Range into cpu_lists
+      * @return Pointer to the first CPU number
+      */
+     const int* rangeBegin(const CpuRange& range) const { return cpu_lists.data() + range.offset; }
+ 
+     /**
+      * Get the end of a range
+      * @param range Range into cpu_lists
+      * @return Pointer past the last CPU number
+      */
+     const int* rangeEnd(const CpuRange& range) const { return cpu_lists.data() + range.offset + range.count; }
+ 
+     /**
+      * Find the cache of a given level and type used by a CPU
+      * @param cpu_id Logical CPU number
+      * @param level Cache level (1, 2, 3...)
+      * @param type Cache type ('D', 'I' or 'U')
+      * @return Index into caches or -1 if not found
+      */
+     int cacheOf(int cpu_id, int level, char type) const;
+ 
+     /**
+      * Number of SMT threads per core, taken from the largest core
+      * @return Threads per core
+      */
+     int threadsPerCore() const;
+ 
+     /**
+      * Format a range as a compact CPU list such as "0-3,8-11"
+      * @param range Range into cpu_lists
+      * @return Formatted CPU list
+      */
+     std::string formatRange(const CpuRange& range) const;
+ 
+ private:
+     // Logical CPU number to index into cpus, -1 for missing CPUs
+     std::vector<int> cpu_index;
+ 
+     /**
+      * Append CPU numbers to cpu_lists
+      * @param ids CPU numbers in ascending order
+      * @return Range covering the appended numbers
+      */
+     CpuRange appendRange(const std::vector<int>& ids);
+ 
+     /**
+      * Read NUMA nodes and their memory size
+      * @param root sysfs system directory
+      */
+     void loadNodes(const std::string& root);
+ 
+     /**
+      * Read cache descriptions, recording each shared cache once
+      * @param cpu_dir Open /sys/devices/system/cpu directory
+      */
+     void loadCaches(const SysfsDir& cpu_dir);
+ };
+ 
+ /**
+  * Parse a kernel CPU list such as "0-3,8-11"
+  * @param text CPU list text
+  * @param ids Vector to store the CPU numbers in ascending order
+  */
+ void parseCpuList(const std::string& text, std::vector<int>& ids);
+ 
+ /**
+  * Format ascending CPU numbers as a compact CPU list such as "0-3,8-11"
+  * @param begin First CPU number
+  * @param end Past the last CPU number
+  * @return Formatted CPU list
+  */
+ std::string formatCpuList(const int* begin, const int* end);
+ 
+ #endif // TOPOLOGY_HPP
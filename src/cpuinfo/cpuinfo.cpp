@@ -9,529 +9,1465 @@
  #include <fstream>
  #include <sstream>
  #include <string>
+ #include <string_view>
  #include <vector>
  #include <map>
  #include <algorithm>
  #include <iomanip>
  #include <filesystem>
  #include <cstring>
+ #include <cerrno>
+ #include <cstdlib>
+ #include <ctime>
+ #include <stdexcept>
  #include <unistd.h>
  #include <sys/sysinfo.h>
  
+ #include "cpuinfo.hpp"
+ #include "output.hpp"
+ #include "cli.hpp"
+ #include "format.hpp"
+ #include "procfs.hpp"
+ #include "stats.hpp"
+ #include "cpu.hpp"
+ #include "features.hpp"
+ #include "topology.hpp"
+ #include "sysfs.hpp"
+ #include "cgroup.hpp"
+ #include "history.hpp"
+ #include "record.hpp"
+ #include "process.hpp"
+ #include "multicall.hpp"
+ 
  namespace fs = std::filesystem;
  
- // ANSI Color codes
- namespace Colors {
-     const std::string RESET = "\033[0m";
-     const std::string BOLD = "\033[1m";
-     const std::string RED = "\033[31m";
-     const std::string GREEN = "\033[32m";
-     const std::string YELLOW = "\033[33m";
-     const std::string BLUE = "\033[34m";
-     const std::string MAGENTA = "\033[35m";
-     const std::string CYAN = "\033[36m";
-     const std::string WHITE = "\033[37m";
-     const std::string DIM = "\033[2m";
- }
- 
- struct CpuInfo {
-     std::string model_name;
-     std::string vendor_id;
-     std::string cpu_family;
-     std::string model;
-     std::string stepping;
-     std::string microcode;
-     std::string cache_size;
-     std::vector<std::string> flags;
-     double cpu_mhz = 0.0;
-     int physical_cores = 0;
-     int logical_cores = 0;
-     int siblings = 0;
-     int core_id = 0;
-     std::string architecture;
-     std::string byte_order;
-     std::string virtualization;
- };
- 
- struct CpuLoad {
-     double load1 = 0.0;
-     double load5 = 0.0;
-     double load15 = 0.0;
-     double cpu_usage = 0.0;
-     unsigned long long user = 0;
-     unsigned long long nice = 0;
-     unsigned long long system = 0;
-     unsigned long long idle = 0;
-     unsigned long long iowait = 0;
-     unsigned long long irq = 0;
-     unsigned long long softirq = 0;
- };
- 
- struct CpuFrequency {
-     double current_mhz = 0.0;
-     double min_mhz = 0.0;
-     double max_mhz = 0.0;
-     std::string governor;
-     std::string driver;
- };
- 
- class CpuInfoUtil {
- private:
-     bool show_detailed = false;
-     bool show_frequencies = false;
-     bool show_load = false;
-     bool show_topology = false;
-     bool use_colors = true;
- 
-     std::string colorize(const std::string& text, const std::string& color) {
-         if (!use_colors) return text;
-         return color + text + Colors::RESET;
-     }
- 
-     std::string formatFrequency(double mhz) {
-         if (mhz >= 1000.0) {
-             return std::to_string(static_cast<int>(mhz / 1000.0)) + "." + 
-                    std::to_string(static_cast<int>(static_cast<int>(mhz) % 1000 / 100)) + " GHz";
+ std::string CpuInfoUtil::colorize(const std::string& text, const std::string& color) {
+     return ::colorize(text, color, use_colors);
+ }
+ 
+ std::string CpuInfoUtil::formatFrequency(double mhz) {
+     if (mhz >= 1000.0) {
+         return std::to_string(static_cast<int>(mhz / 1000.0)) + "." + 
+                std::to_string(static_cast<int>(static_cast<int>(mhz) % 1000 / 100)) + " GHz";
+     } else {
+         return std::to_string(static_cast<int>(mhz)) + " MHz";
+     }
+ }
+ 
+ // --has: whether the CPU has every feature in the list. Features
+ // known to features.hpp come from CPUID or the hwcaps without reading
+ // /proc; only other names fall back to the flags of /proc/cpuinfo.
+ bool CpuInfoUtil::hasFeatures() {
+     CpuFeatureSet host;
+     bool direct = readCpuFeatures(host);
+     
+     CpuFeatureSet required;
+     std::vector<std::string_view> others;
+     std::string_view list = has_features;
+     while (!list.empty()) {
+         size_t comma = list.find(',');
+         std::string_view name = list.substr(0, comma);
+         list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+         if (name.empty()) continue;
+         
+         CpuFeature feature;
+         if (direct && findCpuFeature(name, feature)) {
+             required.set(feature);
          } else {
-             return std::to_string(static_cast<int>(mhz)) + " MHz";
+             others.push_back(name);
          }
      }
+     if (!host.hasAll(required)) return false;
+     if (others.empty()) return true;
+     
+     CpuInfo info = readCpuInfo();
+     std::string flags = " " + info.flags + " ";
+     for (std::string_view name : others) {
+         if (flags.find(" " + std::string(name) + " ") == std::string::npos) return false;
+     }
+     return true;
+ }
+ 
+ void CpuInfoUtil::openCgroup() {
+     if (cgroup_dir.valid()) return;
+     
+     std::string path = resolveCgroup(cgroup_spec);
+     if (!cgroup_dir.open(path.c_str())) {
+         throw std::runtime_error("cannot open cgroup " + path + ": " + std::strerror(errno));
+     }
+     cgroup_stat_fd = cgroup_dir.openFile("cpu.stat");
+     if (cgroup_stat_fd < 0) {
+         throw std::runtime_error("cannot open " + path + "/cpu.stat: " + std::strerror(errno));
+     }
+     cgroup_spec = path;
+ }
  
-     CpuInfo getCpuInfo() {
-         CpuInfo info;
-         std::ifstream file("/proc/cpuinfo");
-         std::string line;
-         std::map<std::string, int> core_count;
+ CgroupCpuStat CpuInfoUtil::getCgroupCpuStat() {
+     if (readProcFile(cgroup_stat_fd, cgroup_stat_buf) < 0) return CgroupCpuStat();
+     return parseCgroupCpuStat(cgroup_stat_buf.data());
+ }
+ 
+ void CpuInfoUtil::printSeparator(const std::string& title) {
+     ::printSeparator(title, use_colors);
+ }
+ 
+ void CpuInfoUtil::printGeneralInfo() {
+     CpuInfo info = readCpuInfo();
+     
+     printSeparator("CPU Information");
+     
+     if (!info.model_name.empty()) {
+         std::cout << std::left << std::setw(18) << "Model:" 
+                   << info.model_name << '\n';
+     }
+     
+     if (!info.vendor_id.empty()) {
+         std::cout << std::left << std::setw(18) << "Vendor:" 
+                   << info.vendor_id << '\n';
+     }
+     
+     if (info.logical_cores > 0) {
+         std::cout << std::left << std::setw(18) << "Logical cores:" 
+                   << info.logical_cores << '\n';
+     }
+     
+     if (info.physical_cores > 0 && info.physical_cores != info.logical_cores) {
+         std::cout << std::left << std::setw(18) << "Physical cores:" 
+                   << info.physical_cores << '\n';
+     }
+     
+     if (info.cpu_mhz > 0) {
+         std::cout << std::left << std::setw(18) << "Base frequency:" 
+                   << formatFrequency(info.cpu_mhz) << '\n';
+     }
+     
+     if (!info.cache_size.empty()) {
+         std::cout << std::left << std::setw(18) << "Cache size:" 
+                   << info.cache_size << '\n';
+     }
+     
+     if (show_detailed) {
+         if (!info.cpu_family.empty()) {
+             std::cout << std::left << std::setw(18) << "CPU family:" 
+                       << info.cpu_family << '\n';
+         }
          
-         while (std::getline(file, line)) {
-             size_t colon = line.find(':');
-             if (colon == std::string::npos) continue;
-             
-             std::string key = line.substr(0, colon);
-             std::string value = line.substr(colon + 1);
-             
-             // Trim whitespace
-             key.erase(key.find_last_not_of(" \t") + 1);
-             value.erase(0, value.find_first_not_of(" \t"));
+         if (!info.model.empty()) {
+             std::cout << std::left << std::setw(18) << "Model:" 
+                       << info.model << '\n';
+         }
+         
+         if (!info.stepping.empty()) {
+             std::cout << std::left << std::setw(18) << "Stepping:" 
+                       << info.stepping << '\n';
+         }
+         
+         if (!info.microcode.empty()) {
+             std::cout << std::left << std::setw(18) << "Microcode:" 
+                       << info.microcode << '\n';
+         }
+         
+         if (!info.flags.empty()) {
+             std::cout << std::left << std::setw(18) << "Features:" << '\n';
              
-             if (key == "model name" && info.model_name.empty()) {
-                 info.model_name = value;
-             } else if (key == "vendor_id" && info.vendor_id.empty()) {
-                 info.vendor_id = value;
-             } else if (key == "cpu family" && info.cpu_family.empty()) {
-                 info.cpu_family = value;
-             } else if (key == "model" && info.model.empty()) {
-                 info.model = value;
-             } else if (key == "stepping" && info.stepping.empty()) {
-                 info.stepping = value;
-             } else if (key == "microcode" && info.microcode.empty()) {
-                 info.microcode = value;
-             } else if (key == "cache size" && info.cache_size.empty()) {
-                 info.cache_size = value;
-             } else if (key == "cpu MHz" && info.cpu_mhz == 0.0) {
-                 info.cpu_mhz = std::stod(value);
-             } else if (key == "siblings") {
-                 info.siblings = std::stoi(value);
-             } else if (key == "core id") {
-                 core_count[value]++;
-             } else if (key == "processor") {
-                 info.logical_cores++;
-             } else if (key == "flags" && info.flags.empty()) {
-                 std::istringstream iss(value);
-                 std::string flag;
-                 while (iss >> flag) {
-                     info.flags.push_back(flag);
+             // Print flags in columns
+             const int cols = 4;
+             const int col_width = 15;
+             std::string_view flags = info.flags;
+             int col = 0;
+             while (!flags.empty()) {
+                 size_t space = flags.find(' ');
+                 std::string_view flag = flags.substr(0, space);
+                 flags.remove_prefix(space == std::string_view::npos ? flags.size() : space + 1);
+                 
+                 if (col == 0) std::cout << "  ";
+                 std::cout << std::left << std::setw(col_width) << flag;
+                 if (++col == cols) {
+                     std::cout << '\n';
+                     col = 0;
                  }
              }
+             if (col != 0) std::cout << '\n';
          }
-         
-         info.physical_cores = core_count.size();
-         if (info.physical_cores == 0) {
-             info.physical_cores = info.logical_cores;
+     }
+ }
+ 
+ void CpuInfoUtil::printLoadInfo() {
+     CpuStatTable per_cpu;
+     CpuLoad load = sampler.load(show_per_cpu ? &per_cpu : nullptr);
+     
+     std::cout << '\n';
+     printSeparator("CPU Load");
+     
+     std::cout << std::left << std::setw(18) << "Load average:" 
+               << std::fixed << std::setprecision(2)
+               << load.load1 << ", " << load.load5 << ", " << load.load15 << '\n';
+     
+     std::cout << std::left << std::setw(18) << "CPU usage:" 
+               << std::fixed << std::setprecision(1) << load.cpu_usage << "%" << '\n';
+     
+     if (show_detailed) {
+         std::cout << std::left << std::setw(18) << "User time:" 
+                   << load.user << " jiffies" << '\n';
+         std::cout << std::left << std::setw(18) << "System time:" 
+                   << load.system << " jiffies" << '\n';
+         std::cout << std::left << std::setw(18) << "Idle time:" 
+                   << load.idle << " jiffies" << '\n';
+         std::cout << std::left << std::setw(18) << "I/O wait time:" 
+                   << load.iowait << " jiffies" << '\n';
+         std::cout << std::left << std::setw(18) << "Steal time:" 
+                   << load.steal << " jiffies" << '\n';
+     }
+     
+     if (show_per_cpu) {
+         // Without a previous sample the breakdown covers the time since boot
+         CpuStatTable since_boot;
+         std::cout << '\n';
+         printPerCpuHeader(false);
+         printPerCpuLines(since_boot, per_cpu, nullptr);
+     }
+ }
+ 
+ void CpuInfoUtil::printPerCpuHeader(bool with_time) {
+     std::string header = with_time ? "TIME     " : "";
+     header += "CPU    %USR  %NICE   %SYS  %IOWAIT   %IRQ  %SOFT %STEAL  %IDLE";
+     std::cout << colorize(header, Colors::BOLD) << '\n';
+ }
+ 
+ // Print one line per CPU with the utilization between two tables. Rows
+ // are compared against zero counters when the set of CPUs changed.
+ void CpuInfoUtil::printPerCpuLines(const CpuStatTable& prev, const CpuStatTable& cur,
+                                    const char* timestamp) {
+     bool same_cpus = prev.cpu == cur.cpu;
+ 
+     for (size_t row = 0; row < cur.size(); ++row) {
+         unsigned long long elapsed = rowJiffies(cur, row) - (same_cpus ? rowJiffies(prev, row) : 0);
+         auto percent = [&](int counter) {
+             return deltaPercent(same_cpus ? prev.counters[counter][row] : 0,
+                                 cur.counters[counter][row], elapsed);
+         };
+ 
+         if (timestamp) std::cout << std::left << std::setw(9) << timestamp;
+         std::cout << std::left << std::setw(4) << cur.cpu[row] << std::right
+                   << std::fixed << std::setprecision(1)
+                   << std::setw(7) << percent(CPU_USER)
+                   << std::setw(7) << percent(CPU_NICE)
+                   << std::setw(7) << percent(CPU_SYSTEM)
+                   << std::setw(9) << percent(CPU_IOWAIT)
+                   << std::setw(7) << percent(CPU_IRQ)
+                   << std::setw(7) << percent(CPU_SOFTIRQ)
+                   << std::setw(7) << percent(CPU_STEAL)
+                   << std::setw(7) << percent(CPU_IDLE)
+                   << '\n';
+     }
+ }
+ 
+ void CpuInfoUtil::printFrequencyInfo() {
+     auto frequencies = sampler.frequencies();
+     
+     std::cout << '\n';
+     printSeparator("CPU Frequency");
+     
+     if (frequencies.empty()) {
+         std::cout << colorize("Warning: CPU frequency information not available", Colors::YELLOW) << '\n';
+         std::cout << "This may require cpufreq driver support or root privileges" << '\n';
+         return;
+     }
+     
+     const auto& freq = frequencies[0];
+     
+     if (freq.current_mhz > 0) {
+         std::cout << std::left << std::setw(18) << "Current:" 
+                   << formatFrequency(freq.current_mhz) << '\n';
+     }
+     
+     if (frequencies.size() > 1) {
+         double lowest, average, highest;
+         summarizeFrequencies(frequencies, lowest, average, highest);
+         std::cout << std::left << std::setw(18) << "Current range:" 
+                   << formatFrequency(lowest) << " - " << formatFrequency(highest)
+                   << " (average " << formatFrequency(average) << ", "
+                   << frequencies.size() << " CPUs)" << '\n';
+     }
+     
+     if (freq.min_mhz > 0) {
+         std::cout << std::left << std::setw(18) << "Minimum:" 
+                   << formatFrequency(freq.min_mhz) << '\n';
+     }
+     
+     if (freq.max_mhz > 0) {
+         std::cout << std::left << std::setw(18) << "Maximum:" 
+                   << formatFrequency(freq.max_mhz) << '\n';
+     }
+     
+     if (!freq.governor.empty()) {
+         std::cout << std::left << std::setw(18) << "Governor:" 
+                   << freq.governor << '\n';
+     }
+     
+     if (!freq.driver.empty()) {
+         std::cout << std::left << std::setw(18) << "Driver:" 
+                   << freq.driver << '\n';
+     }
+     
+     if (show_per_cpu) {
+         std::cout << '\n';
+         std::cout << colorize("CPU   CUR_MHZ  MIN_MHZ  MAX_MHZ   %MAX  GOVERNOR", Colors::BOLD) << '\n';
+         for (const auto& cpu_freq : frequencies) {
+             std::cout << std::left << std::setw(4) << cpu_freq.cpu << std::right
+                       << std::fixed << std::setprecision(0)
+                       << std::setw(9) << cpu_freq.current_mhz
+                       << std::setw(9) << cpu_freq.min_mhz
+                       << std::setw(9) << cpu_freq.max_mhz
+                       << std::setprecision(1)
+                       << std::setw(7) << percentOfMax(cpu_freq)
+                       << "  " << cpu_freq.governor << '\n';
          }
-         
-         return info;
      }
+ }
  
-     CpuLoad getCpuLoad() {
-         CpuLoad load;
+ double CpuInfoUtil::percentOfMax(const CpuFrequency& freq) {
+     return freq.max_mhz > 0 ? freq.current_mhz / freq.max_mhz * 100.0 : 0.0;
+ }
+ 
+ // Lowest, average and highest current frequency across CPUs
+ void CpuInfoUtil::summarizeFrequencies(const std::vector<CpuFrequency>& frequencies,
+                                        double& lowest, double& average, double& highest) {
+     lowest = highest = average = 0.0;
+     if (frequencies.empty()) return;
+ 
+     lowest = highest = frequencies[0].current_mhz;
+     double sum = 0.0;
+     for (const auto& freq : frequencies) {
+         lowest = std::min(lowest, freq.current_mhz);
+         highest = std::max(highest, freq.current_mhz);
+         sum += freq.current_mhz;
+     }
+     average = sum / frequencies.size();
+ }
+ 
+ void CpuInfoUtil::printTopologyInfo() {
+     std::cout << '\n';
+     printSeparator("CPU Topology");
+     
+     CpuTopology topology;
+     if (!topology.load()) {
+         std::cout << colorize("Warning: Could not read topology information", Colors::YELLOW) << '\n';
+         return;
+     }
+     
+     std::cout << std::left << std::setw(18) << "Sockets:" 
+               << topology.packages.size() << '\n';
+     
+     std::cout << std::left << std::setw(18) << "Cores per socket:" 
+               << topology.cores.size() / topology.packages.size() << '\n';
+     
+     std::cout << std::left << std::setw(18) << "Threads per core:" 
+               << topology.threadsPerCore() << '\n';
+     
+     if (!topology.nodes.empty()) {
+         std::cout << std::left << std::setw(18) << "NUMA nodes:" 
+                   << topology.nodes.size() << '\n';
+     }
+     
+     // Caches are sorted by level and type, one summary line per kind
+     for (size_t i = 0; i < topology.caches.size();) {
+         const TopologyCache& cache = topology.caches[i];
+         size_t j = i;
+         while (j < topology.caches.size() && topology.caches[j].level == cache.level &&
+                topology.caches[j].type == cache.type) ++j;
          
-         // Get load average
-         std::ifstream loadavg("/proc/loadavg");
-         if (loadavg.is_open()) {
-             loadavg >> load.load1 >> load.load5 >> load.load15;
-         }
+         std::string label = "L" + std::to_string(cache.level);
+         if (cache.type == 'D') label += "d";
+         else if (cache.type == 'I') label += "i";
+         label += " cache:";
          
-         // Get CPU statistics
-         std::ifstream stat("/proc/stat");
-         std::string line;
-         if (stat.is_open() && std::getline(stat, line)) {
-             std::istringstream iss(line);
-             std::string cpu;
-             iss >> cpu >> load.user >> load.nice >> load.system >> load.idle 
-                 >> load.iowait >> load.irq >> load.softirq;
-             
-             unsigned long long total = load.user + load.nice + load.system + 
-                                      load.idle + load.iowait + load.irq + load.softirq;
-             unsigned long long used = total - load.idle - load.iowait;
+         std::cout << std::left << std::setw(18) << label 
+                   << cache.size_kb << " KB x " << (j - i);
+         if (cache.cpus.count > 1) {
+             std::cout << " (shared by " << cache.cpus.count << " CPUs)";
+         }
+         std::cout << '\n';
+         i = j;
+     }
+     
+     if (show_detailed) {
+         for (const auto& package : topology.packages) {
+             std::cout << "Socket " << package.package_id << ": CPUs " 
+                       << topology.formatRange(package.cpus) 
+                       << " (" << package.core_count << " cores)" << '\n';
              
-             if (total > 0) {
-                 load.cpu_usage = (double)used / total * 100.0;
+             for (int c = package.first_core; c < package.first_core + package.core_count; ++c) {
+                 const TopologyCore& core = topology.cores[c];
+                 std::cout << "  Core " << core.core_id << ": CPUs " 
+                           << topology.formatRange(core.threads) << '\n';
              }
          }
          
-         return load;
+         for (const auto& node : topology.nodes) {
+             std::cout << "Node " << node.node_id << ": CPUs " 
+                       << (node.cpus.count ? topology.formatRange(node.cpus) : "none");
+             if (node.memory_kb > 0) {
+                 std::cout << ", " << node.memory_kb / 1024 << " MB";
+             }
+             std::cout << '\n';
+         }
      }
+ }
  
-     std::vector<CpuFrequency> getCpuFrequencies() {
-         std::vector<CpuFrequency> frequencies;
-         
-         try {
-             for (const auto& entry : fs::directory_iterator("/sys/devices/system/cpu/")) {
-                 std::string dirname = entry.path().filename();
-                 if (dirname.find("cpu") != 0 || !std::isdigit(dirname[3])) continue;
-                 
-                 std::string cpufreq_path = entry.path() / "cpufreq";
-                 if (!fs::exists(cpufreq_path)) continue;
-                 
-                 CpuFrequency freq;
-                 
-                 // Current frequency
-                 std::ifstream cur_freq(cpufreq_path + "/scaling_cur_freq");
-                 if (cur_freq.is_open()) {
-                     unsigned long khz;
-                     cur_freq >> khz;
-                     freq.current_mhz = khz / 1000.0;
-                 }
-                 
-                 // Min frequency
-                 std::ifstream min_freq(cpufreq_path + "/scaling_min_freq");
-                 if (min_freq.is_open()) {
-                     unsigned long khz;
-                     min_freq >> khz;
-                     freq.min_mhz = khz / 1000.0;
-                 }
-                 
-                 // Max frequency
-                 std::ifstream max_freq(cpufreq_path + "/scaling_max_freq");
-                 if (max_freq.is_open()) {
-                     unsigned long khz;
-                     max_freq >> khz;
-                     freq.max_mhz = khz / 1000.0;
-                 }
-                 
-                 // Governor
-                 std::ifstream gov(cpufreq_path + "/scaling_governor");
-                 if (gov.is_open()) {
-                     std::getline(gov, freq.governor);
-                 }
-                 
-                 // Driver
-                 std::ifstream drv(cpufreq_path + "/scaling_driver");
-                 if (drv.is_open()) {
-                     std::getline(drv, freq.driver);
-                 }
-                 
-                 frequencies.push_back(freq);
-                 break; // Just get the first one for summary
-             }
-         } catch (const std::exception& e) {
-             // Ignore errors
+ void CpuInfoUtil::printCgroupInfo() {
+     openCgroup();
+     CgroupCpuStat stat = getCgroupCpuStat();
+     double limit = readCgroupCpuLimit(cgroup_dir);
+     
+     std::cout << '\n';
+     printSeparator("Cgroup CPU");
+     
+     std::cout << std::left << std::setw(18) << "Cgroup:" << cgroup_spec << '\n';
+     
+     std::cout << std::left << std::setw(18) << "CPU limit:";
+     if (limit > 0.0) {
+         std::cout << std::fixed << std::setprecision(2) << limit << " CPUs" << '\n';
+     } else {
+         std::cout << "unlimited" << '\n';
+     }
+     
+     std::string cpus;
+     if (cgroup_dir.readString("cpuset.cpus.effective", cpus) && !cpus.empty()) {
+         std::cout << std::left << std::setw(18) << "Allowed CPUs:" << cpus << '\n';
+     }
+     
+     unsigned long long weight;
+     if (cgroup_dir.readUnsigned("cpu.weight", weight)) {
+         std::cout << std::left << std::setw(18) << "Weight:" << weight << '\n';
+     }
+     
+     std::cout << std::left << std::setw(18) << "CPU time:" 
+               << std::fixed << std::setprecision(1) << stat.usage_usec / 1e6 << " s" << '\n';
+     
+     if (show_detailed) {
+         std::cout << std::left << std::setw(18) << "User time:" 
+                   << stat.user_usec / 1e6 << " s" << '\n';
+         std::cout << std::left << std::setw(18) << "System time:" 
+                   << stat.system_usec / 1e6 << " s" << '\n';
+     }
+     
+     if (stat.nr_periods > 0) {
+         std::cout << std::left << std::setw(18) << "Throttled:" 
+                   << stat.nr_throttled << " of " << stat.nr_periods << " periods "
+                   << colorize("(" + std::to_string(static_cast<int>(100.0 * stat.nr_throttled / stat.nr_periods)) + "%)",
+                               Colors::DIM) << '\n';
+         std::cout << std::left << std::setw(18) << "Throttled time:" 
+                   << std::setprecision(1) << stat.throttled_usec / 1e6 << " s" << '\n';
+     }
+     
+     char text[512];
+     double some, full;
+     if (cgroup_dir.read("cpu.pressure", text, sizeof(text)) > 0 && parsePressure(text, some, full)) {
+         std::cout << std::left << std::setw(18) << "Pressure:" 
+                   << std::setprecision(2) << "some " << some << "%, full " << full << "% (avg10)" << '\n';
+     }
+ }
+ 
+ // Rank the cgroups below --cgroup, or below the hierarchy root, by the
+ // CPU time they have used
+ void CpuInfoUtil::printCgroupTop() {
+     std::string root = resolveCgroup(cgroup_mode ? cgroup_spec : "/");
+     auto top = topCgroups(root, cgroup_top, cgroupCpuMetric);
+     
+     std::cout << '\n';
+     printSeparator("Top CPU Cgroups");
+     
+     std::cout << std::left << std::setw(14) << "CPU TIME" << std::setw(10) << "LIMIT" << "CGROUP" << '\n';
+     printSeparator();
+     
+     SysfsDir root_dir, dir;
+     root_dir.open(root.c_str());
+     char buf[64];
+     for (const auto& usage : top) {
+         std::string limit = "-";
+         if (dir.open(root_dir, usage.path.c_str()) && dir.read("cpu.max", buf, sizeof(buf)) > 0 &&
+             std::strncmp(buf, "max", 3) != 0) {
+             char* end = nullptr;
+             double quota = std::strtod(buf, &end);
+             double period = std::strtod(end, nullptr);
+             std::ostringstream text;
+             text << std::fixed << std::setprecision(2) << (period > 0.0 ? quota / period : 0.0);
+             limit = text.str();
          }
          
-         return frequencies;
+         std::ostringstream seconds;
+         seconds << std::fixed << std::setprecision(1) << usage.value / 1e6 << " s";
+         std::cout << std::left << std::setw(14) << seconds.str() << std::setw(10) << limit
+                   << usage.path << '\n';
      }
+ }
  
-     void printSeparator(const std::string& title = "") {
-         if (title.empty()) {
-             std::cout << std::string(70, '-') << std::endl;
-         } else {
-             std::cout << colorize(title, Colors::BOLD) << std::endl;
-             std::cout << std::string(title.length(), '=') << std::endl;
-         }
+ // --events: follow processes with the kernel's events instead of
+ // listing /proc for every sample, where we are allowed to
+ void CpuInfoUtil::startProcessSampler() {
+     if (process_events && !process_sampler.followingEvents() && !process_sampler.followEvents()) {
+         std::cerr << colorize("cpuinfo: cannot follow process events (needs CAP_NET_ADMIN), scanning /proc",
+                               Colors::YELLOW) << '\n';
      }
+ }
  
-     void printGeneralInfo() {
-         CpuInfo info = getCpuInfo();
-         
-         printSeparator("CPU Information");
+ // Sample every process twice, watch_interval apart, and rank them by
+ // the CPU time or run-queue delay in between
+ void CpuInfoUtil::sampleProcesses() {
+     startProcessSampler();
+     process_sampler.sample(process_sort, 15, top_processes);
+     struct timespec deadline;
+     clock_gettime(CLOCK_MONOTONIC, &deadline);
+     waitForNextTick(deadline, watch_interval);
+     if (!process_sampler.sample(process_sort, 15, top_processes)) {
+         throw std::runtime_error(std::string("cannot list /proc: ") + std::strerror(errno));
+     }
+ }
+ 
+ // CPU% counts every thread, so a process can use more than 100%;
+ // DELAY% is the share of the interval its main thread (every thread
+ // with --events) spent runnable but waiting for a CPU
+ void CpuInfoUtil::printProcessTable() {
+     std::cout << std::left
+               << std::setw(8) << "PID"
+               << std::setw(16) << "COMMAND"
+               << std::setw(9) << "CPU%"
+               << std::setw(9) << "DELAY%"
+               << "CMDLINE" << '\n';
+     printSeparator();
+     
+     for (const auto& proc : top_processes) {
+         std::cout << std::left << std::fixed << std::setprecision(1)
+                   << std::setw(8) << proc.pid
+                   << std::setw(16) << proc.name
+                   << std::setw(9) << proc.cpu_percent
+                   << std::setw(9) << proc.delay_percent
+                   << proc.cmd << '\n';
+     }
+ }
+ 
+ void CpuInfoUtil::printProcesses() {
+     sampleProcesses();
+     std::cout << '\n';
+     printSeparator("Top CPU Consumers");
+     printProcessTable();
+ }
+ 
+ void CpuInfoUtil::writeProcesses() {
+     for (const auto& proc : top_processes) {
+         writer.group("process", "pid", proc.pid);
+         writer.field("name", proc.name);
+         writer.field("cpu_percent", proc.cpu_percent, 1);
+         writer.field("delay_percent", proc.delay_percent, 1);
+         writer.field("cmdline", proc.cmd);
+     }
+ }
+ 
+ bool CpuInfoUtil::machineOutput() const {
+     return writer.format() != OutputFormat::TEXT;
+ }
+ 
+ // Utilization between two samples, in percent of the elapsed jiffies
+ void CpuInfoUtil::writeUtilization(const CpuLoad& prev, const CpuLoad& cur) {
+     unsigned long long elapsed = totalJiffies(cur) - totalJiffies(prev);
+     double idle = deltaPercent(prev.idle, cur.idle, elapsed);
+     double iowait = deltaPercent(prev.iowait, cur.iowait, elapsed);
+     
+     writer.group("utilization");
+     writer.field("user", deltaPercent(prev.user, cur.user, elapsed), 1);
+     writer.field("nice", deltaPercent(prev.nice, cur.nice, elapsed), 1);
+     writer.field("system", deltaPercent(prev.system, cur.system, elapsed), 1);
+     writer.field("iowait", iowait, 1);
+     writer.field("irq", deltaPercent(prev.irq, cur.irq, elapsed), 1);
+     writer.field("softirq", deltaPercent(prev.softirq, cur.softirq, elapsed), 1);
+     writer.field("steal", deltaPercent(prev.steal, cur.steal, elapsed), 1);
+     writer.field("idle", idle, 1);
+     writer.field("busy", elapsed > 0 ? 100.0 - idle - iowait : 0.0, 1);
+ }
+ 
+ void CpuInfoUtil::writePerCpu(const CpuStatTable& prev, const CpuStatTable& cur) {
+     bool same_cpus = prev.cpu == cur.cpu;
+     
+     for (size_t row = 0; row < cur.size(); ++row) {
+         unsigned long long elapsed = rowJiffies(cur, row) - (same_cpus ? rowJiffies(prev, row) : 0);
+         auto percent = [&](int counter) {
+             return deltaPercent(same_cpus ? prev.counters[counter][row] : 0,
+                                 cur.counters[counter][row], elapsed);
+         };
          
-         if (!info.model_name.empty()) {
-             std::cout << std::left << std::setw(18) << "Model:" 
-                       << info.model_name << std::endl;
+         writer.group("per_cpu", "cpu", cur.cpu[row]);
+         writer.field("user", percent(CPU_USER), 1);
+         writer.field("nice", percent(CPU_NICE), 1);
+         writer.field("system", percent(CPU_SYSTEM), 1);
+         writer.field("iowait", percent(CPU_IOWAIT), 1);
+         writer.field("irq", percent(CPU_IRQ), 1);
+         writer.field("softirq", percent(CPU_SOFTIRQ), 1);
+         writer.field("steal", percent(CPU_STEAL), 1);
+         writer.field("idle", percent(CPU_IDLE), 1);
+     }
+ }
+ 
+ void CpuInfoUtil::writeFrequencies(const std::vector<CpuFrequency>& frequencies) {
+     for (const auto& freq : frequencies) {
+         writer.group("frequency", "cpu", freq.cpu);
+         writer.field("current_mhz", freq.current_mhz, 0);
+         writer.field("min_mhz", freq.min_mhz, 0);
+         writer.field("max_mhz", freq.max_mhz, 0);
+         if (!freq.governor.empty()) writer.field("governor", freq.governor);
+         if (!freq.driver.empty()) writer.field("driver", freq.driver);
+     }
+ }
+ 
+ void CpuInfoUtil::writeReport() {
+     writer.begin(wallClock());
+     
+     if (show_general) {
+         CpuInfo info = readCpuInfo();
+         writer.group("cpu");
+         writer.field("model_name", info.model_name);
+         writer.field("vendor", info.vendor_id);
+         writer.field("logical_cores", info.logical_cores);
+         writer.field("physical_cores", info.physical_cores);
+         writer.field("base_mhz", info.cpu_mhz, 0);
+         if (!info.cache_size.empty()) writer.field("cache_size", info.cache_size);
+         if (show_detailed) {
+             writer.field("family", info.cpu_family);
+             writer.field("model", info.model);
+             writer.field("stepping", info.stepping);
+             writer.field("microcode", info.microcode);
+             writer.field("flags", info.flags);
          }
+     }
+     
+     if (show_load) {
+         CpuStatTable per_cpu;
+         CpuLoad load = sampler.load(show_per_cpu ? &per_cpu : nullptr);
          
-         if (!info.vendor_id.empty()) {
-             std::cout << std::left << std::setw(18) << "Vendor:" 
-                       << info.vendor_id << std::endl;
-         }
+         writer.group("load");
+         writer.field("load1", load.load1);
+         writer.field("load5", load.load5);
+         writer.field("load15", load.load15);
+         writer.field("usage", load.cpu_usage, 1);
          
-         if (info.logical_cores > 0) {
-             std::cout << std::left << std::setw(18) << "Logical cores:" 
-                       << info.logical_cores << std::endl;
-         }
+         // /proc/stat counts in clock ticks; the totals are written in seconds
+         long ticks = sysconf(_SC_CLK_TCK);
+         double tick_seconds = ticks > 0 ? ticks : 100.0;
+         writer.counter("user_seconds_total", load.user / tick_seconds);
+         writer.counter("nice_seconds_total", load.nice / tick_seconds);
+         writer.counter("system_seconds_total", load.system / tick_seconds);
+         writer.counter("idle_seconds_total", load.idle / tick_seconds);
+         writer.counter("iowait_seconds_total", load.iowait / tick_seconds);
+         writer.counter("irq_seconds_total", load.irq / tick_seconds);
+         writer.counter("softirq_seconds_total", load.softirq / tick_seconds);
+         writer.counter("steal_seconds_total", load.steal / tick_seconds);
          
-         if (info.physical_cores > 0 && info.physical_cores != info.logical_cores) {
-             std::cout << std::left << std::setw(18) << "Physical cores:" 
-                       << info.physical_cores << std::endl;
-         }
+         // Without a previous sample the breakdown covers the time since boot
+         if (show_per_cpu) writePerCpu(CpuStatTable(), per_cpu);
+     }
+     
+     if (show_frequencies) {
+         writeFrequencies(sampler.frequencies());
+     }
+     
+     CpuTopology topology;
+     if (show_topology && topology.load()) {
+         writer.group("topology");
+         writer.field("sockets", topology.packages.size());
+         writer.field("cores", topology.cores.size());
+         writer.field("threads_per_core", topology.threadsPerCore());
+         writer.field("numa_nodes", topology.nodes.size());
          
-         if (info.cpu_mhz > 0) {
-             std::cout << std::left << std::setw(18) << "Base frequency:" 
-                       << formatFrequency(info.cpu_mhz) << std::endl;
+         for (size_t i = 0; i < topology.caches.size();) {
+             const TopologyCache& cache = topology.caches[i];
+             size_t j = i;
+             while (j < topology.caches.size() && topology.caches[j].level == cache.level &&
+                    topology.caches[j].type == cache.type) ++j;
+             
+             std::string name = "L" + std::to_string(cache.level);
+             if (cache.type == 'D') name += "d";
+             else if (cache.type == 'I') name += "i";
+             
+             writer.group("cache", "cache", name);
+             writer.field("size_bytes", cache.size_kb * 1024ULL);
+             writer.field("count", j - i);
+             writer.field("shared_cpus", cache.cpus.count);
+             i = j;
          }
+     }
+     
+     if (cgroup_mode) {
+         openCgroup();
+         CgroupCpuStat stat = getCgroupCpuStat();
+         double limit = readCgroupCpuLimit(cgroup_dir);
          
-         if (!info.cache_size.empty()) {
-             std::cout << std::left << std::setw(18) << "Cache size:" 
-                       << info.cache_size << std::endl;
-         }
+         writer.group("cgroup");
+         writer.field("path", cgroup_spec);
+         if (limit > 0.0) writer.field("cpu_limit", limit);
+         unsigned long long weight;
+         if (cgroup_dir.readUnsigned("cpu.weight", weight)) writer.field("weight", weight);
+         writer.counter("usage_seconds_total", stat.usage_usec / 1e6, 6);
+         writer.counter("user_seconds_total", stat.user_usec / 1e6, 6);
+         writer.counter("system_seconds_total", stat.system_usec / 1e6, 6);
+         writer.counter("periods_total", stat.nr_periods);
+         writer.counter("throttled_periods_total", stat.nr_throttled);
+         writer.counter("throttled_seconds_total", stat.throttled_usec / 1e6, 6);
          
-         if (show_detailed) {
-             if (!info.cpu_family.empty()) {
-                 std::cout << std::left << std::setw(18) << "CPU family:" 
-                           << info.cpu_family << std::endl;
-             }
-             
-             if (!info.model.empty()) {
-                 std::cout << std::left << std::setw(18) << "Model:" 
-                           << info.model << std::endl;
-             }
-             
-             if (!info.stepping.empty()) {
-                 std::cout << std::left << std::setw(18) << "Stepping:" 
-                           << info.stepping << std::endl;
-             }
-             
-             if (!info.microcode.empty()) {
-                 std::cout << std::left << std::setw(18) << "Microcode:" 
-                           << info.microcode << std::endl;
+         char text[512];
+         double some, full;
+         if (cgroup_dir.read("cpu.pressure", text, sizeof(text)) > 0 && parsePressure(text, some, full)) {
+             writer.field("pressure_some", some);
+             writer.field("pressure_full", full);
+         }
+     }
+     
+     if (cgroup_top > 0) {
+         std::string root = resolveCgroup(cgroup_mode ? cgroup_spec : "/");
+         for (const auto& usage : topCgroups(root, cgroup_top, cgroupCpuMetric)) {
+             writer.group("cgroup_top", "cgroup", usage.path);
+             writer.counter("usage_seconds_total", usage.value / 1e6, 6);
+         }
+     }
+     
+     if (show_processes) {
+         sampleProcesses();
+         writeProcesses();
+     }
+     
+     writer.end();
+ }
+ 
+ // Watch samples carry the recorded time when replaying
+ double CpuInfoUtil::sampleTime() const {
+     return replay_time > 0.0 ? replay_time : wallClock();
+ }
+ 
+ void CpuInfoUtil::formatTimestamp(char* buf, size_t size) {
+     time_t now = replay_time > 0.0 ? static_cast<time_t>(replay_time) : time(nullptr);
+     struct tm local;
+     localtime_r(&now, &local);
+     strftime(buf, size, "%H:%M:%S", &local);
+ }
+ 
+ void CpuInfoUtil::printWatchHeader() {
+     std::cout << colorize("TIME      LOAD1  LOAD5 LOAD15   %USR  %NICE   %SYS  %IOWAIT   %IRQ  %SOFT %STEAL  %IDLE   %CPU",
+                           Colors::BOLD) << '\n';
+ }
+ 
+ void CpuInfoUtil::printWatchLine(const CpuLoad& prev, const CpuLoad& cur) {
+     unsigned long long elapsed = totalJiffies(cur) - totalJiffies(prev);
+     double idle = deltaPercent(prev.idle, cur.idle, elapsed);
+     double iowait = deltaPercent(prev.iowait, cur.iowait, elapsed);
+     
+     char timestamp[16];
+     formatTimestamp(timestamp, sizeof(timestamp));
+ 
+     std::cout << std::left << std::setw(8) << timestamp << std::right
+               << std::fixed << std::setprecision(2)
+               << std::setw(7) << cur.load1
+               << std::setw(7) << cur.load5
+               << std::setw(7) << cur.load15
+               << std::setprecision(1)
+               << std::setw(7) << deltaPercent(prev.user, cur.user, elapsed)
+               << std::setw(7) << deltaPercent(prev.nice, cur.nice, elapsed)
+               << std::setw(7) << deltaPercent(prev.system, cur.system, elapsed)
+               << std::setw(9) << iowait
+               << std::setw(7) << deltaPercent(prev.irq, cur.irq, elapsed)
+               << std::setw(7) << deltaPercent(prev.softirq, cur.softirq, elapsed)
+               << std::setw(7) << deltaPercent(prev.steal, cur.steal, elapsed)
+               << std::setw(7) << idle
+               << std::setw(7) << (elapsed > 0 ? 100.0 - idle - iowait : 0.0)
+               << '\n';
+ }
+ 
+ // Per-CPU watch output: an "all" line followed by one line per CPU,
+ // each prefixed with the time so lines can be shipped independently
+ void CpuInfoUtil::printPerCpuTick(const CpuLoad& prev, const CpuLoad& cur,
+                                   const CpuStatTable& prev_cpus, const CpuStatTable& cur_cpus) {
+     char timestamp[16];
+     formatTimestamp(timestamp, sizeof(timestamp));
+ 
+     unsigned long long elapsed = totalJiffies(cur) - totalJiffies(prev);
+     std::cout << std::left << std::setw(9) << timestamp << std::setw(4) << "all"
+               << std::right << std::fixed << std::setprecision(1)
+               << std::setw(7) << deltaPercent(prev.user, cur.user, elapsed)
+               << std::setw(7) << deltaPercent(prev.nice, cur.nice, elapsed)
+               << std::setw(7) << deltaPercent(prev.system, cur.system, elapsed)
+               << std::setw(9) << deltaPercent(prev.iowait, cur.iowait, elapsed)
+               << std::setw(7) << deltaPercent(prev.irq, cur.irq, elapsed)
+               << std::setw(7) << deltaPercent(prev.softirq, cur.softirq, elapsed)
+               << std::setw(7) << deltaPercent(prev.steal, cur.steal, elapsed)
+               << std::setw(7) << deltaPercent(prev.idle, cur.idle, elapsed)
+               << '\n';
+     printPerCpuLines(prev_cpus, cur_cpus, timestamp);
+ }
+ 
+ void CpuInfoUtil::writeWatchSample(const CpuLoad& prev, const CpuLoad& cur,
+                                    const CpuStatTable& prev_cpus, const CpuStatTable& cur_cpus) {
+     writer.begin(sampleTime());
+     writer.group("load");
+     writer.field("load1", cur.load1);
+     writer.field("load5", cur.load5);
+     writer.field("load15", cur.load15);
+     writeUtilization(prev, cur);
+     if (show_per_cpu) writePerCpu(prev_cpus, cur_cpus);
+     writer.end();
+ }
+ 
+ // Frequency watch output: current frequency range across CPUs, or one
+ // line per CPU with --per-cpu. Samples need no delta, so the first line
+ // is printed immediately.
+ void CpuInfoUtil::printFrequencyWatch() {
+     std::vector<CpuFrequency> samples;
+     sampler.sampleFrequencies(samples);
+     if (samples.empty()) {
+         throw std::runtime_error("CPU frequency information not available");
+     }
+ 
+     if (machineOutput()) {
+         // Every sample is self-describing
+     } else if (show_per_cpu) {
+         std::cout << colorize("TIME     CPU   CUR_MHZ  MAX_MHZ   %MAX", Colors::BOLD) << '\n';
+     } else {
+         std::cout << colorize("TIME     CPUS   MIN_MHZ  AVG_MHZ  MAX_MHZ", Colors::BOLD) << '\n';
+     }
+ 
+     struct timespec deadline;
+     clock_gettime(CLOCK_MONOTONIC, &deadline);
+ 
+     for (long tick = 0; watch_count == 0 || tick < watch_count; ++tick) {
+         if (tick > 0) {
+             waitForNextTick(deadline, watch_interval);
+             sampler.sampleFrequencies(samples);
+         }
+ 
+         if (machineOutput()) {
+             writer.begin(wallClock());
+             if (show_per_cpu) {
+                 writeFrequencies(samples);
+             } else {
+                 double lowest, average, highest;
+                 summarizeFrequencies(samples, lowest, average, highest);
+                 writer.group("frequency_summary");
+                 writer.field("cpus", samples.size());
+                 writer.field("min_mhz", lowest, 0);
+                 writer.field("avg_mhz", average, 0);
+                 writer.field("max_mhz", highest, 0);
              }
-             
-             if (!info.flags.empty()) {
-                 std::cout << std::left << std::setw(18) << "Features:" << std::endl;
-                 
-                 // Print flags in columns
-                 const int cols = 4;
-                 const int col_width = 15;
-                 for (size_t i = 0; i < info.flags.size(); i += cols) {
-                     std::cout << "  ";
-                     for (int j = 0; j < cols && i + j < info.flags.size(); ++j) {
-                         std::cout << std::left << std::setw(col_width) << info.flags[i + j];
-                     }
-                     std::cout << std::endl;
-                 }
+             writer.end();
+             continue;
+         }
+ 
+         char timestamp[16];
+         formatTimestamp(timestamp, sizeof(timestamp));
+         std::cout << std::fixed << std::setprecision(0);
+ 
+         if (show_per_cpu) {
+             for (const auto& freq : samples) {
+                 std::cout << std::left << std::setw(9) << timestamp
+                           << std::setw(4) << freq.cpu << std::right
+                           << std::setw(9) << freq.current_mhz
+                           << std::setw(9) << freq.max_mhz
+                           << std::setprecision(1) << std::setw(7) << percentOfMax(freq)
+                           << std::setprecision(0) << '\n';
              }
+         } else {
+             double lowest, average, highest;
+             summarizeFrequencies(samples, lowest, average, highest);
+             std::cout << std::left << std::setw(9) << timestamp
+                       << std::setw(4) << samples.size() << std::right
+                       << std::setw(10) << lowest
+                       << std::setw(9) << average
+                       << std::setw(9) << highest << '\n';
          }
+         std::cout.flush();
      }
+ }
  
-     void printLoadInfo() {
-         CpuLoad load = getCpuLoad();
+ // Cgroup watch output: CPUs used, share of the cpu.max limit, and the
+ // fraction of enforcement periods in which the cgroup was throttled
+ void CpuInfoUtil::printCgroupWatch() {
+     openCgroup();
+     double limit = readCgroupCpuLimit(cgroup_dir);
+     
+     if (!machineOutput()) {
+         std::cout << colorize("TIME        CPUS  %LIMIT   %USR   %SYS  %THROTTLED  THR_MS/s", Colors::BOLD) << '\n';
+         std::cout.flush();
+     }
+     
+     CgroupCpuStat prev = getCgroupCpuStat();
+     struct timespec prev_time;
+     clock_gettime(CLOCK_MONOTONIC, &prev_time);
+     
+     struct timespec deadline = prev_time;
+     for (long tick = 0; watch_count == 0 || tick < watch_count; ++tick) {
+         waitForNextTick(deadline, watch_interval);
          
-         std::cout << std::endl;
-         printSeparator("CPU Load");
+         CgroupCpuStat cur = getCgroupCpuStat();
+         struct timespec now;
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         double elapsed_us = ((now.tv_sec - prev_time.tv_sec) * 1e9 + (now.tv_nsec - prev_time.tv_nsec)) / 1e3;
          
-         std::cout << std::left << std::setw(18) << "Load average:" 
-                   << std::fixed << std::setprecision(2)
-                   << load.load1 << ", " << load.load5 << ", " << load.load15 << std::endl;
+         auto delta = [](unsigned long long a, unsigned long long b) {
+             return b >= a ? static_cast<double>(b - a) : 0.0;
+         };
+         double cpus = elapsed_us > 0 ? delta(prev.usage_usec, cur.usage_usec) / elapsed_us : 0.0;
+         double periods = delta(prev.nr_periods, cur.nr_periods);
+         double user = elapsed_us > 0 ? delta(prev.user_usec, cur.user_usec) / elapsed_us * 100.0 : 0.0;
+         double system = elapsed_us > 0 ? delta(prev.system_usec, cur.system_usec) / elapsed_us * 100.0 : 0.0;
+         double throttled = periods > 0 ? delta(prev.nr_throttled, cur.nr_throttled) / periods * 100.0 : 0.0;
+         double throttled_ms = elapsed_us > 0 ? delta(prev.throttled_usec, cur.throttled_usec) / elapsed_us * 1e3 : 0.0;
+         prev = cur;
+         prev_time = now;
          
-         std::cout << std::left << std::setw(18) << "CPU usage:" 
-                   << std::fixed << std::setprecision(1) << load.cpu_usage << "%" << std::endl;
+         if (machineOutput()) {
+             writer.begin(wallClock());
+             writer.group("cgroup");
+             writer.field("path", cgroup_spec);
+             writer.field("cpus", cpus);
+             if (limit > 0.0) writer.field("limit_percent", cpus / limit * 100.0, 1);
+             writer.field("user", user, 1);
+             writer.field("system", system, 1);
+             writer.field("throttled", throttled, 1);
+             writer.field("throttled_ms_per_s", throttled_ms, 1);
+             writer.end();
+             continue;
+         }
          
-         if (show_detailed) {
-             std::cout << std::left << std::setw(18) << "User time:" 
-                       << load.user << " jiffies" << std::endl;
-             std::cout << std::left << std::setw(18) << "System time:" 
-                       << load.system << " jiffies" << std::endl;
-             std::cout << std::left << std::setw(18) << "Idle time:" 
-                       << load.idle << " jiffies" << std::endl;
-             std::cout << std::left << std::setw(18) << "I/O wait time:" 
-                       << load.iowait << " jiffies" << std::endl;
+         char timestamp[16];
+         formatTimestamp(timestamp, sizeof(timestamp));
+         std::cout << std::left << std::setw(8) << timestamp << std::right
+                   << std::fixed << std::setprecision(2)
+                   << std::setw(8) << cpus
+                   << std::setprecision(1);
+         if (limit > 0.0) {
+             std::cout << std::setw(8) << cpus / limit * 100.0;
+         } else {
+             std::cout << std::setw(8) << "-";
          }
+         std::cout << std::setw(7) << user
+                   << std::setw(7) << system
+                   << std::setw(12) << throttled
+                   << std::setw(10) << throttled_ms
+                   << '\n';
+         std::cout.flush();
      }
+ }
  
-     void printFrequencyInfo() {
-         auto frequencies = getCpuFrequencies();
-         
-         std::cout << std::endl;
-         printSeparator("CPU Frequency");
+ // Open the --record file before the first sample
+ void CpuInfoUtil::openRecording() {
+     if (record_path.empty() || recorder.isOpen()) return;
+     if (!recorder.open(record_path.c_str())) {
+         throw std::runtime_error("cannot record to " + record_path + ": " +
+                                  (errno == EINVAL ? "not a recording" : std::strerror(errno)));
+     }
+ }
+ 
+ // Append one sample of the aggregate and per-CPU counters to --record
+ void CpuInfoUtil::recordSample(const CpuLoad& load, const CpuStatTable& per_cpu) {
+     if (!recorder.isOpen()) return;
+     recorder.beginSample(wallClock());
+     recorder.addCpu(load, &per_cpu);
+     if (!recorder.endSample()) {
+         throw std::runtime_error("cannot write " + record_path + ": " + std::strerror(errno));
+     }
+ }
+ 
+ // --replay: render a --record file like a live watch, with the
+ // recorded times and without waiting between samples
+ void CpuInfoUtil::printReplay() {
+     SampleReader reader;
+     if (!reader.open(replay_path.c_str())) {
+         throw std::runtime_error("cannot replay " + replay_path + ": " +
+                                  (errno == EINVAL ? "not a recording" : std::strerror(errno)));
+     }
+     
+     if (machineOutput()) {
+         // Every sample is self-describing
+     } else if (show_per_cpu) {
+         printPerCpuHeader(true);
+     } else {
+         printWatchHeader();
+     }
+     
+     RecordedSample sample;
+     CpuLoad prev;
+     CpuStatTable prev_cpus;
+     bool have_prev = false;
+     long shown = 0;
+     while ((watch_count == 0 || shown < watch_count) && reader.next(sample)) {
+         if (!sample.has_cpu) continue;
          
-         if (frequencies.empty()) {
-             std::cout << colorize("Warning: CPU frequency information not available", Colors::YELLOW) << std::endl;
-             std::cout << "This may require cpufreq driver support or root privileges" << std::endl;
-             return;
+         // Samples from different recording sessions are not compared
+         if (have_prev && !sample.restarted) {
+             replay_time = sample.timestamp;
+             if (machineOutput()) {
+                 writeWatchSample(prev, sample.load, prev_cpus, sample.per_cpu);
+             } else if (show_per_cpu) {
+                 printPerCpuTick(prev, sample.load, prev_cpus, sample.per_cpu);
+             } else {
+                 printWatchLine(prev, sample.load);
+             }
+             shown++;
          }
+         prev = sample.load;
+         std::swap(prev_cpus, sample.per_cpu);
+         have_prev = true;
+     }
+     std::cout.flush();
+     replay_time = 0.0;
+     
+     if (reader.truncated()) {
+         std::cerr << colorize("cpuinfo: " + replay_path + " ends in an incomplete sample", Colors::YELLOW) << '\n';
+     }
+ }
+ 
+ // --history: keep the busy percentage of every CPU in a ring and
+ // redraw sparklines of it with NOW/P50/P99/MAX after each sample
+ void CpuInfoUtil::printHistoryWatch() {
+     if (!sampler.openStat()) {
+         throw std::runtime_error(std::string("cannot open /proc/stat: ") + std::strerror(errno));
+     }
+     
+     CpuStatTable prev_cpus, cur_cpus;
+     CpuLoad prev = sampler.load(&cur_cpus);
+     openRecording();
+     recordSample(prev, cur_cpus);
+     
+     // Column 0 is the whole system, then one column per CPU
+     SampleHistory history(history_size, cur_cpus.size() + 1);
+     std::vector<HistorySeries> series;
+     series.emplace_back("all", 0, 100.0);
+     for (size_t row = 0; row < cur_cpus.size(); ++row) {
+         series.emplace_back("cpu" + std::to_string(cur_cpus.cpu[row]), row + 1, 100.0);
+     }
+     std::vector<float> record(history.width());
+     bool redraw = stdoutIsTerminal();
+     
+     struct timespec deadline;
+     clock_gettime(CLOCK_MONOTONIC, &deadline);
+     
+     for (long tick = 0; watch_count == 0 || tick < watch_count; ++tick) {
+         waitForNextTick(deadline, watch_interval);
          
-         const auto& freq = frequencies[0];
+         std::swap(prev_cpus, cur_cpus);
+         CpuLoad cur = sampler.load(&cur_cpus);
+         recordSample(cur, cur_cpus);
          
-         if (freq.current_mhz > 0) {
-             std::cout << std::left << std::setw(18) << "Current:" 
-                       << formatFrequency(freq.current_mhz) << std::endl;
-         }
+         unsigned long long elapsed = totalJiffies(cur) - totalJiffies(prev);
+         record[0] = elapsed > 0 ? 100.0 - deltaPercent(prev.idle, cur.idle, elapsed) -
+                                   deltaPercent(prev.iowait, cur.iowait, elapsed) : 0.0;
          
-         if (freq.min_mhz > 0) {
-             std::cout << std::left << std::setw(18) << "Minimum:" 
-                       << formatFrequency(freq.min_mhz) << std::endl;
+         // A CPU going offline shifts the rows; its column reads 0 until
+         // the set is stable again
+         bool same_cpus = prev_cpus.cpu == cur_cpus.cpu;
+         for (size_t row = 0; row + 1 < record.size(); ++row) {
+             record[row + 1] = 0.0f;
+             if (!same_cpus || row >= cur_cpus.size()) continue;
+             unsigned long long cpu_elapsed = rowJiffies(cur_cpus, row) - rowJiffies(prev_cpus, row);
+             if (cpu_elapsed == 0) continue;
+             record[row + 1] = 100.0 -
+                 deltaPercent(prev_cpus.counters[CPU_IDLE][row], cur_cpus.counters[CPU_IDLE][row], cpu_elapsed) -
+                 deltaPercent(prev_cpus.counters[CPU_IOWAIT][row], cur_cpus.counters[CPU_IOWAIT][row], cpu_elapsed);
          }
+         history.push(record.data());
          
-         if (freq.max_mhz > 0) {
-             std::cout << std::left << std::setw(18) << "Maximum:" 
-                       << formatFrequency(freq.max_mhz) << std::endl;
+         if (redraw) {
+             std::cout << "\033[H\033[J";
+         } else if (tick > 0) {
+             std::cout << '\n';
+         }
+         printHistory(history, series, "CPU BUSY % (" + std::to_string(history.size()) + " of " +
+                      std::to_string(history.capacity()) + " samples)", 60, use_colors);
+         std::cout.flush();
+         prev = cur;
+     }
+ }
+ 
+ // Process watch: the busiest processes of every interval, redrawn in
+ // place on a terminal like top
+ void CpuInfoUtil::printProcessWatch() {
+     startProcessSampler();
+     process_sampler.sample(process_sort, 15, top_processes);
+     bool redraw = stdoutIsTerminal() && !machineOutput();
+     
+     struct timespec deadline;
+     clock_gettime(CLOCK_MONOTONIC, &deadline);
+     
+     for (long tick = 0; watch_count == 0 || tick < watch_count; ++tick) {
+         waitForNextTick(deadline, watch_interval);
+         if (!process_sampler.sample(process_sort, 15, top_processes)) {
+             throw std::runtime_error(std::string("cannot list /proc: ") + std::strerror(errno));
          }
          
-         if (!freq.governor.empty()) {
-             std::cout << std::left << std::setw(18) << "Governor:" 
-                       << freq.governor << std::endl;
+         if (machineOutput()) {
+             writer.begin(wallClock());
+             writeProcesses();
+             writer.end();
+             std::cout.flush();
+             continue;
          }
          
-         if (!freq.driver.empty()) {
-             std::cout << std::left << std::setw(18) << "Driver:" 
-                       << freq.driver << std::endl;
+         if (redraw) {
+             std::cout << "\033[H\033[J";
+         } else if (tick > 0) {
+             std::cout << '\n';
+         }
+         char timestamp[16];
+         formatTimestamp(timestamp, sizeof(timestamp));
+         std::cout << colorize(std::string(timestamp) + "  " + std::to_string(process_sampler.processCount()) +
+                               " processes", Colors::BOLD) << '\n';
+         printProcessTable();
+         std::cout.flush();
+     }
+ }
+ 
+ // Sample /proc/stat every watch_interval seconds and report utilization
+ // computed from the jiffy deltas between consecutive samples
+ void CpuInfoUtil::printWatch() {
+     if (!record_path.empty() && (cgroup_mode || show_frequencies || show_processes)) {
+         throw std::runtime_error("--record only records CPU utilization, not -C, -f or -p watch output");
+     }
+     if (show_processes) {
+         printProcessWatch();
+         return;
+     }
+     if (cgroup_mode && !show_frequencies) {
+         printCgroupWatch();
+         return;
+     }
+     if (show_frequencies) {
+         printFrequencyWatch();
+         return;
+     }
+     if (history_size > 0 && !machineOutput()) {
+         printHistoryWatch();
+         return;
+     }
+     
+     if (!sampler.openStat()) {
+         throw std::runtime_error(std::string("cannot open /proc/stat: ") + std::strerror(errno));
+     }
+     
+     // Tables are swapped between ticks so steady-state sampling reuses them.
+     // Recordings always carry the per-CPU counters.
+     CpuStatTable prev_cpus, cur_cpus;
+     CpuStatTable* per_cpu = show_per_cpu || !record_path.empty() ? &cur_cpus : nullptr;
+ 
+     CpuLoad prev = sampler.load(per_cpu);
+     openRecording();
+     recordSample(prev, cur_cpus);
+     if (machineOutput()) {
+         // Every sample is self-describing
+     } else if (show_per_cpu) {
+         printPerCpuHeader(true);
+     } else {
+         printWatchHeader();
+     }
+     std::cout.flush();
+     
+     struct timespec deadline;
+     clock_gettime(CLOCK_MONOTONIC, &deadline);
+ 
+     for (long tick = 0; watch_count == 0 || tick < watch_count; ++tick) {
+         waitForNextTick(deadline, watch_interval);
+ 
+         std::swap(prev_cpus, cur_cpus);
+         CpuLoad cur = sampler.load(per_cpu);
+         recordSample(cur, cur_cpus);
+         if (machineOutput()) {
+             writeWatchSample(prev, cur, prev_cpus, cur_cpus);
+         } else if (show_per_cpu) {
+             printPerCpuTick(prev, cur, prev_cpus, cur_cpus);
+         } else {
+             printWatchLine(prev, cur);
          }
+         std::cout.flush();
+         prev = cur;
      }
+ }
+ 
+ // Naming a section leaves out every section that isn't named,
+ // along with the files only those sections read
+ bool CpuInfoUtil::selectSection(const std::string& name) {
+     if (!sections_named) {
+         sections_named = true;
+         show_general = false;
+     }
+     
+     if (name == "general") show_general = true;
+     else if (name == "load") show_load = true;
+     else if (name == "frequencies") show_frequencies = true;
+     else if (name == "topology") show_topology = true;
+     else if (name == "cgroup") cgroup_mode = true;
+     else if (name == "processes") show_processes = true;
+     else return false;
+     return true;
+ }
  
-     void printTopologyInfo() {
-         std::cout << std::endl;
-         printSeparator("CPU Topology");
+ CpuInfoUtil::CpuInfoUtil() {
+     // Check if output is terminal for color support
+     use_colors = stdoutIsTerminal();
+ }
+ 
+ CpuInfoUtil::~CpuInfoUtil() {
+     if (cgroup_stat_fd >= 0) close(cgroup_stat_fd);
+ }
+ 
+ void CpuInfoUtil::parseArgs(int argc, char* argv[]) {
+     for (int i = 1; i < argc; ++i) {
+         std::string arg = argv[i];
          
-         try {
-             std::map<int, std::vector<int>> sockets;
-             std::map<int, std::vector<int>> cores;
-             
-             for (const auto& entry : fs::directory_iterator("/sys/devices/system/cpu/")) {
-                 std::string dirname = entry.path().filename();
-                 if (dirname.find("cpu") != 0 || !std::isdigit(dirname[3])) continue;
-                 
-                 int cpu_num = std::stoi(dirname.substr(3));
-                 
-                 // Physical package ID (socket)
-                 std::ifstream pkg_file(entry.path() / "topology/physical_package_id");
-                 if (pkg_file.is_open()) {
-                     int pkg_id;
-                     pkg_file >> pkg_id;
-                     sockets[pkg_id].push_back(cpu_num);
-                 }
-                 
-                 // Core ID
-                 std::ifstream core_file(entry.path() / "topology/core_id");
-                 if (core_file.is_open()) {
-                     int core_id;
-                     core_file >> core_id;
-                     cores[core_id].push_back(cpu_num);
-                 }
+         if (arg == "--help" || arg == "-h") {
+             printHelp();
+             exit(0);
+         } else if (arg == "--version" || arg == "-V") {
+             printVersion();
+             exit(0);
+         } else if (arg == "--detailed" || arg == "-d") {
+             show_detailed = true;
+         } else if (arg == "--frequencies" || arg == "-f") {
+             show_frequencies = true;
+         } else if (arg == "--load" || arg == "-l") {
+             show_load = true;
+         } else if (arg == "--topology" || arg == "-t") {
+             show_topology = true;
+         } else if (arg == "--all" || arg == "-a") {
+             show_detailed = show_frequencies = show_load = show_topology = true;
+         } else if (arg == "--per-cpu" || arg == "-P") {
+             show_per_cpu = true;
+         } else if (arg == "--watch" || arg == "-w") {
+             watch_mode = true;
+         } else if (arg == "--interval" || arg == "-i" || arg.rfind("--interval=", 0) == 0) {
+             std::string value = optionValue("cpuinfo", argc, argv, i, arg, "interval", use_colors);
+             char* end = nullptr;
+             watch_interval = std::strtod(value.c_str(), &end);
+             if (value.empty() || *end != '\0' || !(watch_interval >= 0.01)) {
+                 invalidValue("cpuinfo", "interval", value, use_colors);
              }
-             
-             std::cout << std::left << std::setw(18) << "Sockets:" 
-                       << sockets.size() << std::endl;
-             
-             std::cout << std::left << std::setw(18) << "Cores per socket:" 
-                       << cores.size() / (sockets.empty() ? 1 : sockets.size()) << std::endl;
-             
-             if (show_detailed) {
-                 for (const auto& socket : sockets) {
-                     std::cout << "Socket " << socket.first << ": CPUs ";
-                     for (size_t i = 0; i < socket.second.size(); ++i) {
-                         if (i > 0) std::cout << ", ";
-                         std::cout << socket.second[i];
-                     }
-                     std::cout << std::endl;
+             watch_mode = true;
+         } else if (arg == "--count" || arg == "-c" || arg.rfind("--count=", 0) == 0) {
+             std::string value = optionValue("cpuinfo", argc, argv, i, arg, "count", use_colors);
+             char* end = nullptr;
+             watch_count = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || watch_count <= 0) {
+                 invalidValue("cpuinfo", "count", value, use_colors);
+             }
+             watch_mode = true;
+         } else if (arg == "--processes" || arg == "-p") {
+             show_processes = true;
+         } else if (arg == "--events") {
+             process_events = show_processes = true;
+         } else if (arg == "--sort" || arg == "-S" || arg.rfind("--sort=", 0) == 0) {
+             std::string value = optionValue("cpuinfo", argc, argv, i, arg, "sort", use_colors);
+             if (value == "cpu") process_sort = PROCESS_CPU;
+             else if (value == "delay") process_sort = PROCESS_DELAY;
+             else invalidValue("cpuinfo", "sort key", value, use_colors);
+             show_processes = true;
+         } else if (arg == "--jobs" || arg == "-j" || arg.rfind("--jobs=", 0) == 0) {
+             std::string value = optionValue("cpuinfo", argc, argv, i, arg, "jobs", use_colors);
+             char* end = nullptr;
+             long jobs = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || jobs < 1 || jobs > 64) {
+                 invalidValue("cpuinfo", "jobs", value, use_colors);
+             }
+             sampler.setJobs(jobs);
+         } else if (arg == "--cgroup" || arg == "-C" || arg.rfind("--cgroup=", 0) == 0) {
+             // The path is optional, so it is only taken from --cgroup=PATH
+             cgroup_mode = true;
+             if (arg.find('=') != std::string::npos) cgroup_spec = arg.substr(arg.find('=') + 1);
+         } else if (arg == "--cgroup-top" || arg == "-G" || arg.rfind("--cgroup-top=", 0) == 0) {
+             std::string value = optionValue("cpuinfo", argc, argv, i, arg, "cgroup-top", use_colors);
+             char* end = nullptr;
+             long top = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || top < 1 || top > 10000) {
+                 invalidValue("cpuinfo", "cgroup count", value, use_colors);
+             }
+             cgroup_top = top;
+         } else if (arg == "--history" || arg.rfind("--history=", 0) == 0) {
+             // The sample count is optional, so it is only taken from --history=N
+             history_size = 600;
+             if (arg.find('=') != std::string::npos) {
+                 std::string value = arg.substr(arg.find('=') + 1);
+                 char* end = nullptr;
+                 long size = std::strtol(value.c_str(), &end, 10);
+                 if (value.empty() || *end != '\0' || size < 2 || size > 1000000) {
+                     invalidValue("cpuinfo", "history size", value, use_colors);
                  }
+                 history_size = size;
              }
-             
-         } catch (const std::exception& e) {
-             std::cout << colorize("Warning: Could not read topology information", Colors::YELLOW) << std::endl;
+             watch_mode = true;
+         } else if (arg == "--record" || arg.rfind("--record=", 0) == 0) {
+             record_path = optionValue("cpuinfo", argc, argv, i, arg, "record", use_colors);
+             watch_mode = true;
+         } else if (arg == "--replay" || arg.rfind("--replay=", 0) == 0) {
+             replay_path = optionValue("cpuinfo", argc, argv, i, arg, "replay", use_colors);
+         } else if (arg == "--format" || arg.rfind("--format=", 0) == 0) {
+             std::string value = optionValue("cpuinfo", argc, argv, i, arg, "format", use_colors);
+             OutputFormat format;
+             if (!parseOutputFormat(value, format)) {
+                 invalidValue("cpuinfo", "format", value, use_colors);
+             }
+             writer.setFormat(format);
+         } else if (arg == "--stats") {
+             enableStats();
+         } else if (arg == "--has" || arg.rfind("--has=", 0) == 0) {
+             has_features = optionValue("cpuinfo", argc, argv, i, arg, "has", use_colors);
+             if (has_features.find_first_not_of(',') == std::string::npos) {
+                 invalidValue("cpuinfo", "feature list", has_features, use_colors);
+             }
+         } else if (arg == "--root" || arg.rfind("--root=", 0) == 0) {
+             std::string value = optionValue("cpuinfo", argc, argv, i, arg, "root", use_colors);
+             if (value.empty() || !setSystemRoot(value)) {
+                 invalidValue("cpuinfo", "root directory", value, use_colors);
+             }
+         } else if (arg == "--no-color") {
+             use_colors = false;
+         } else if (!arg.empty() && arg[0] != '-') {
+             if (!selectSection(arg)) invalidValue("cpuinfo", "section", arg, use_colors);
+         } else {
+             std::cerr << colorize("cpuinfo: invalid option -- '" + arg + "'", Colors::RED) << '\n';
+             std::cerr << "Try 'cpuinfo --help' for more information." << '\n';
+             exit(1);
          }
      }
+ }
  
- public:
-     CpuInfoUtil() {
-         // Check if output is terminal for color support
-         use_colors = isatty(STDOUT_FILENO);
-     }
+ void CpuInfoUtil::printVersion() {
+     std::cout << "cpuinfo (QCO InfoUtils) 1.0" << '\n';
+     std::cout << "Copyright (C) 2025 AnmiTaliDev" << '\n';
+     std::cout << "License Apache 2.0: Apache License version 2.0" << '\n';
+     std::cout << "This is free software: you are free to change and redistribute it." << '\n';
+     std::cout << "There is NO WARRANTY, to the extent permitted by law." << '\n';
+ }
  
-     void parseArgs(int argc, char* argv[]) {
-         for (int i = 1; i < argc; ++i) {
-             std::string arg = argv[i];
-             
-             if (arg == "--help" || arg == "-h") {
-                 printHelp();
-                 exit(0);
-             } else if (arg == "--version" || arg == "-V") {
-                 printVersion();
-                 exit(0);
-             } else if (arg == "--detailed" || arg == "-d") {
-                 show_detailed = true;
-             } else if (arg == "--frequencies" || arg == "-f") {
-                 show_frequencies = true;
-             } else if (arg == "--load" || arg == "-l") {
-                 show_load = true;
-             } else if (arg == "--topology" || arg == "-t") {
-                 show_topology = true;
-             } else if (arg == "--all" || arg == "-a") {
-                 show_detailed = show_frequencies = show_load = show_topology = true;
-             } else if (arg == "--no-color") {
-                 use_colors = false;
-             } else {
-                 std::cerr << colorize("cpuinfo: invalid option -- '" + arg + "'", Colors::RED) << std::endl;
-                 std::cerr << "Try 'cpuinfo --help' for more information." << std::endl;
-                 exit(1);
-             }
-         }
-     }
+ void CpuInfoUtil::printHelp() {
+     std::cout << "Usage: cpuinfo [OPTION]... [SECTION]..." << '\n';
+     std::cout << "Display information about system CPU." << '\n';
+     std::cout << '\n';
+     std::cout << "  -a, --all         display all available information" << '\n';
+     std::cout << "  -c, --count N     stop watch mode after N samples" << '\n';
+     std::cout << "  -C, --cgroup[=P]  show CPU limit and throttling of cgroup v2 P (default: own" << '\n';
+     std::cout << "                    cgroup); with -w, report its usage instead of the host's" << '\n';
+     std::cout << "  -d, --detailed    show detailed CPU information" << '\n';
+     std::cout << "      --events      follow processes with the kernel's fork and exec events and" << '\n';
+     std::cout << "                    taskstats rather than reading /proc for each (needs" << '\n';
+     std::cout << "                    CAP_NET_ADMIN; implies -p)" << '\n';
+     std::cout << "  -f, --frequencies show CPU frequency information" << '\n';
+     std::cout << "      --format=FMT  print text (default), json, prom or tsv records" << '\n';
+     std::cout << "  -G, --cgroup-top N" << '\n';
+     std::cout << "                    rank the N cgroups that used the most CPU time" << '\n';
+     std::cout << "      --has LIST    print nothing and exit with status 0 if the CPU has every" << '\n';
+     std::cout << "                    feature of the comma-separated LIST, 1 if it does not" << '\n';
+     std::cout << "  -h, --help        display this help and exit" << '\n';
+     std::cout << "      --history[=N] keep the last N samples (default: 600) of each CPU's" << '\n';
+     std::cout << "                    utilization and redraw them as sparklines (implies -w)" << '\n';
+     std::cout << "  -i, --interval N  sample every N seconds (implies --watch)" << '\n';
+     std::cout << "  -j, --jobs N      read per-CPU frequencies with N threads" << '\n';
+     std::cout << "  -l, --load        show CPU load information" << '\n';
+     std::cout << "      --no-color    disable colored output" << '\n';
+     std::cout << "  -p, --processes   show the processes that used the most CPU in one second;" << '\n';
+     std::cout << "                    with -w, redraw them every interval like top" << '\n';
+     std::cout << "  -P, --per-cpu     break load, frequency and watch output down by CPU" << '\n';
+     std::cout << "      --record FILE append the raw counters of every watch sample to FILE" << '\n';
+     std::cout << "      --replay FILE print the watch output of a recording made with --record" << '\n';
+     std::cout << "      --root DIR    read /proc, /sys and /etc under DIR, such as the host's /" << '\n';
+     std::cout << "                    mounted into a container" << '\n';
+     std::cout << "  -S, --sort KEY    rank processes by cpu or delay, the time spent waiting for" << '\n';
+     std::cout << "                    a CPU (implies -p)" << '\n';
+     std::cout << "      --stats       print the time and system calls of each collector on exit" << '\n';
+     std::cout << "  -t, --topology    show CPU topology information" << '\n';
+     std::cout << "  -V, --version     output version information and exit" << '\n';
+     std::cout << "  -w, --watch       report CPU utilization (or frequency with -f)" << '\n';
+     std::cout << "                    every interval" << '\n';
+     std::cout << '\n';
+     std::cout << "Naming SECTIONs (general, load, frequencies, topology, cgroup, processes)" << '\n';
+     std::cout << "shows only those, and reads only the files they need." << '\n';
+     std::cout << '\n';
+     std::cout << "Examples:" << '\n';
+     std::cout << "  cpuinfo           Show basic CPU information" << '\n';
+     std::cout << "  cpuinfo -a        Show comprehensive CPU report" << '\n';
+     std::cout << "  cpuinfo -l        Show CPU information with load" << '\n';
+     std::cout << "  cpuinfo topology  Show only the CPU topology" << '\n';
+     std::cout << "  cpuinfo -w -i 5   Report CPU utilization every 5 seconds" << '\n';
+     std::cout << "  cpuinfo -w -P     Report per-CPU utilization every second" << '\n';
+     std::cout << "  cpuinfo -w -f -P  Report every CPU's current frequency each second" << '\n';
+     std::cout << "  cpuinfo -w -C     Report CPU use and throttling of this cgroup" << '\n';
+     std::cout << "  cpuinfo -w -S delay" << '\n';
+     std::cout << "                    Show which processes wait longest for a CPU, like top" << '\n';
+     std::cout << "  cpuinfo --has avx512f,amx_tile" << '\n';
+     std::cout << "                    Check for AVX-512 and AMX without reading /proc" << '\n';
+     std::cout << "  cpuinfo --history Chart the last 10 minutes of every CPU's utilization" << '\n';
+     std::cout << "  cpuinfo -i 0.1 --record cpu.rec" << '\n';
+     std::cout << "                    Record /proc/stat every 100 ms; replay it with" << '\n';
+     std::cout << "                    cpuinfo --replay cpu.rec -P" << '\n';
+     std::cout << "  cpuinfo -a --format=json" << '\n';
+     std::cout << "                    Print the comprehensive report as one JSON object" << '\n';
+     std::cout << '\n';
+     std::cout << "QCO InfoUtils home page: <https://github.com/Qainar-Projects/infoutils>" << '\n';
+ }
  
-     void printVersion() {
-         std::cout << "cpuinfo (QCO InfoUtils) 1.0" << std::endl;
-         std::cout << "Copyright (C) 2025 AnmiTaliDev" << std::endl;
-         std::cout << "License Apache 2.0: Apache License version 2.0" << std::endl;
-         std::cout << "This is free software: you are free to change and redistribute it." << std::endl;
-         std::cout << "There is NO WARRANTY, to the extent permitted by law." << std::endl;
-     }
- 
-     void printHelp() {
-         std::cout << "Usage: cpuinfo [OPTION]..." << std::endl;
-         std::cout << "Display information about system CPU." << std::endl;
-         std::cout << std::endl;
-         std::cout << "  -a, --all         display all available information" << std::endl;
-         std::cout << "  -d, --detailed    show detailed CPU information" << std::endl;
-         std::cout << "  -f, --frequencies show CPU frequency information" << std::endl;
-         std::cout << "  -h, --help        display this help and exit" << std::endl;
-         std::cout << "  -l, --load        show CPU load information" << std::endl;
-         std::cout << "      --no-color    disable colored output" << std::endl;
-         std::cout << "  -t, --topology    show CPU topology information" << std::endl;
-         std::cout << "  -V, --version     output version information and exit" << std::endl;
-         std::cout << std::endl;
-         std::cout << "Examples:" << std::endl;
-         std::cout << "  cpuinfo           Show basic CPU information" << std::endl;
-         std::cout << "  cpuinfo -a        Show comprehensive CPU report" << std::endl;
-         std::cout << "  cpuinfo -l        Show CPU information with load" << std::endl;
-         std::cout << std::endl;
-         std::cout << "QCO InfoUtils home page: <https://github.com/Qainar-Projects/infoutils>" << std::endl;
-     }
- 
-     void run() {
+ // Returns the exit status
+ int CpuInfoUtil::run() {
+     if (!has_features.empty()) {
+         return hasFeatures() ? 0 : 1;
+     }
+     
+     if (!replay_path.empty()) {
+         printReplay();
+         return 0;
+     }
+     
+     if (watch_mode) {
+         printWatch();
+         return 0;
+     }
+     
+     if (machineOutput()) {
+         writeReport();
+         return 0;
+     }
+     
+     if (show_general) {
          printGeneralInfo();
-         
-         if (show_load) {
-             printLoadInfo();
-         }
-         
-         if (show_frequencies) {
-             printFrequencyInfo();
-         }
-         
-         if (show_topology) {
-             printTopologyInfo();
-         }
      }
- };
+     
+     if (show_load) {
+         printLoadInfo();
+     }
+     
+     if (show_frequencies) {
+         printFrequencyInfo();
+     }
+     
+     if (show_topology) {
+         printTopologyInfo();
+     }
+     
+     if (cgroup_mode) {
+         printCgroupInfo();
+     }
+     
+     if (cgroup_top > 0) {
+         printCgroupTop();
+     }
+     
+     if (show_processes) {
+         printProcesses();
+     }
+     
+     return 0;
+ }
  
- int main(int argc, char* argv[]) {
+ INFOUTILS_MAIN(cpuinfo) {
      try {
          CpuInfoUtil util;
          util.parseArgs(argc, argv);
-         util.run();
-         return 0;
+         int status = util.run();
+         if (statsEnabled()) printStats("cpuinfo");
+         return status;
      } catch (const std::exception& e) {
-         std::cerr << "cpuinfo: " << e.what() << std::endl;
+         std::cerr << "cpuinfo: " << e.what() << '\n';
          return 1;
      }
  }
\ No newline at end of file
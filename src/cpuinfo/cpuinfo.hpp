@@ -11,95 +11,57 @@
  #include <string>
  #include <vector>
  
- // Forward declarations
- struct CpuInfo;
- struct CpuLoad;
- struct CpuFrequency;
- 
- // ANSI Color codes namespace
- namespace Colors {
-     extern const std::string RESET;
-     extern const std::string BOLD;
-     extern const std::string RED;
-     extern const std::string GREEN;
-     extern const std::string YELLOW;
-     extern const std::string BLUE;
-     extern const std::string MAGENTA;
-     extern const std::string CYAN;
-     extern const std::string WHITE;
-     extern const std::string DIM;
- }
- 
- /**
-  * Structure to hold CPU information from /proc/cpuinfo
-  */
- struct CpuInfo {
-     std::string model_name;
-     std::string vendor_id;
-     std::string cpu_family;
-     std::string model;
-     std::string stepping;
-     std::string microcode;
-     std::string cache_size;
-     std::vector<std::string> flags;
-     double cpu_mhz;
-     int physical_cores;
-     int logical_cores;
-     int siblings;
-     int core_id;
-     std::string architecture;
-     std::string byte_order;
-     std::string virtualization;
- 
-     CpuInfo() : cpu_mhz(0.0), physical_cores(0), logical_cores(0), 
-                 siblings(0), core_id(0) {}
- };
- 
- /**
-  * Structure to hold CPU load information
-  */
- struct CpuLoad {
-     double load1;
-     double load5;
-     double load15;
-     double cpu_usage;
-     unsigned long long user;
-     unsigned long long nice;
-     unsigned long long system;
-     unsigned long long idle;
-     unsigned long long iowait;
-     unsigned long long irq;
-     unsigned long long softirq;
- 
-     CpuLoad() : load1(0.0), load5(0.0), load15(0.0), cpu_usage(0.0),
-                 user(0), nice(0), system(0), idle(0), iowait(0), irq(0), softirq(0) {}
- };
- 
- /**
-  * Structure to hold CPU frequency information
-  */
- struct CpuFrequency {
-     double current_mhz;
-     double min_mhz;
-     double max_mhz;
-     std::string governor;
-     std::string driver;
- 
-     CpuFrequency() : current_mhz(0.0), min_mhz(0.0), max_mhz(0.0) {}
- };
+ #include "format.hpp"
+ #include "cpu.hpp"
+ #include "sysfs.hpp"
+ #include "record.hpp"
+ #include "process.hpp"
  
  /**
   * Main utility class for CPU information display
   */
  class CpuInfoUtil {
  private:
-     // Configuration flags
-     bool show_detailed;
-     bool show_frequencies;
-     bool show_load;
-     bool show_topology;
-     bool use_colors;
- 
+     bool show_general = true;     // Model and cores from /proc/cpuinfo
+     bool sections_named = false;  // A SECTION argument was given
+     bool show_detailed = false;
+     bool show_frequencies = false;
+     bool show_load = false;
+     bool show_topology = false;
+     bool use_colors = true;
+     bool show_per_cpu = false;
+     bool watch_mode = false;
+     double watch_interval = 1.0;
+     long watch_count = 0;
+     bool cgroup_mode = false;     // Report a cgroup v2 cgroup as well as the host
+     std::string cgroup_spec;      // --cgroup=PATH, empty for our own cgroup
+     size_t cgroup_top = 0;        // Cgroups ranked with --cgroup-top, 0 for none
+     size_t history_size = 0;      // Samples kept for --history, 0 without it
+     SysfsDir cgroup_dir;
+     int cgroup_stat_fd = -1;      // cpu.stat, re-read with pread in watch mode
+     std::vector<char> cgroup_stat_buf;
+     
+     // /proc/stat, /proc/loadavg and cpufreq files, kept open between samples
+     CpuSampler sampler;
+     
+     // --format=json|prom|tsv output, reused for every sample
+     RecordWriter writer{"cpuinfo"};
+     
+     // --record FILE and --replay FILE
+     std::string record_path;
+     std::string replay_path;
+     SampleRecorder recorder;
+     double replay_time = 0.0;     // Time of the replayed sample, 0 when sampling live
+     
+     std::string has_features;     // --has LIST, empty without it
+     
+     // --processes: the busiest processes between two samples
+     bool show_processes = false;
+     ProcessMetric process_sort = PROCESS_CPU;
+     ProcessSampler process_sampler{PROCESS_FILE_SCHEDSTAT};
+     std::vector<ProcessActivity> top_processes;
+     bool process_events = false;  // --events
+     
      /**
       * Apply color formatting to text if colors are enabled
       * @param text Text to colorize
@@ -116,23 +78,24 @@
      std::string formatFrequency(double mhz);
  
      /**
-      * Read CPU information from /proc/cpuinfo
-      * @return CpuInfo structure with CPU details
+      * Check the CPU for every feature of --has, from CPUID or the hwcaps;
+      * only names unknown to features.hpp are looked up in /proc/cpuinfo
+      * @return true if the CPU has them all
       */
-     CpuInfo getCpuInfo();
- 
+     bool hasFeatures();
+     
      /**
-      * Read CPU load information from /proc/loadavg and /proc/stat
-      * @return CpuLoad structure with load statistics
+      * Open the cgroup selected by --cgroup and its cpu.stat
+      * @throws std::runtime_error if the cgroup cannot be opened
       */
-     CpuLoad getCpuLoad();
- 
+     void openCgroup();
+     
      /**
-      * Read CPU frequency information from /sys/devices/system/cpu/
-      * @return Vector of CpuFrequency structures for each CPU
+      * Re-read the cgroup cpu.stat
+      * @return Current counters
       */
-     std::vector<CpuFrequency> getCpuFrequencies();
- 
+     CgroupCpuStat getCgroupCpuStat();
+     
      /**
       * Print section separator with optional title
       * @param title Optional section title
@@ -150,131 +113,254 @@
      void printLoadInfo();
  
      /**
-      * Display CPU frequency information
+      * Print the column header for per-CPU output
+      * @param with_time Whether lines start with a timestamp column
       */
-     void printFrequencyInfo();
+     void printPerCpuHeader(bool with_time);
  
      /**
-      * Display CPU topology information
+      * Print one line per CPU with the utilization between two tables
+      * @param prev Previous per-CPU sample
+      * @param cur Current per-CPU sample
+      * @param timestamp Optional timestamp printed at the start of each line
       */
-     void printTopologyInfo();
+     void printPerCpuLines(const CpuStatTable& prev, const CpuStatTable& cur,
+                           const char* timestamp);
  
- public:
      /**
-      * Constructor - initializes utility state
+      * Display CPU frequency information
       */
-     CpuInfoUtil();
+     void printFrequencyInfo();
  
      /**
-      * Destructor
+      * Current frequency as a percentage of the maximum
+      * @param freq Frequency sample
+      * @return Percentage of the maximum frequency
       */
-     ~CpuInfoUtil() = default;
- 
-     // Disable copy constructor and assignment operator
-     CpuInfoUtil(const CpuInfoUtil&) = delete;
-     CpuInfoUtil& operator=(const CpuInfoUtil&) = delete;
+     static double percentOfMax(const CpuFrequency& freq);
  
      /**
-      * Parse command line arguments
-      * @param argc Argument count
-      * @param argv Argument values
+      * Compute the range and average of current frequencies
+      * @param frequencies Per-CPU frequency samples
+      * @param lowest Reference to store the lowest frequency
+      * @param average Reference to store the average frequency
+      * @param highest Reference to store the highest frequency
       */
-     void parseArgs(int argc, char* argv[]);
+     static void summarizeFrequencies(const std::vector<CpuFrequency>& frequencies,
+                                      double& lowest, double& average, double& highest);
  
      /**
-      * Print version information
+      * Display CPU topology information: sockets, cores, SMT threads,
+      * NUMA nodes and caches as reported by CpuTopology
       */
-     void printVersion();
- 
+     void printTopologyInfo();
+     
      /**
-      * Print help message
+      * Display CPU limit, usage, throttling and pressure of the cgroup
       */
-     void printHelp();
- 
+     void printCgroupInfo();
+     
      /**
-      * Run the main program logic
+      * Display the cgroups that used the most CPU time
+      */
+     void printCgroupTop();
+     
+     /**
+      * With --events, switch process_sampler to the kernel's process
+      * events, or warn that it keeps scanning /proc
+      */
+     void startProcessSampler();
+     
+     /**
+      * Rank the processes by their CPU time or run-queue delay over one
+      * interval into top_processes
+      * @throws std::runtime_error if /proc cannot be listed
+      */
+     void sampleProcesses();
+     
+     /**
+      * Print top_processes with their CPU and delay percentages
+      */
+     void printProcessTable();
+     
+     /**
+      * Display the processes that used the most CPU in one interval
+      */
+     void printProcesses();
+     
+     /**
+      * Add one "process" row per entry of top_processes
+      */
+     void writeProcesses();
+     
+     /**
+      * Check whether --format selected a machine-readable format
+      */
+     bool machineOutput() const;
+     
+     /**
+      * Add the "utilization" group: time spent per state between two samples
+      * @param prev Previous sample
+      * @param cur Current sample
       */
-     void run();
+     void writeUtilization(const CpuLoad& prev, const CpuLoad& cur);
+     
+     /**
+      * Add one "per_cpu" row per CPU, compared like printPerCpuLines()
+      * @param prev Earlier per-CPU counters, empty for the time since boot
+      * @param cur Current per-CPU counters
+      */
+     void writePerCpu(const CpuStatTable& prev, const CpuStatTable& cur);
+     
+     /**
+      * Add one "frequency" row per CPU
+      * @param frequencies Frequency samples
+      */
+     void writeFrequencies(const std::vector<CpuFrequency>& frequencies);
+     
+     /**
+      * Write the selected sections as one --format sample
+      */
+     void writeReport();
+     
+     /**
+      * Time of the sample being printed
+      * @return The recorded time while replaying, the wall clock otherwise
+      */
+     double sampleTime() const;
+     
+     /**
+      * Format the current local time as HH:MM:SS
+      * @param buf Output buffer
+      * @param size Size of the output buffer
+      */
+     void formatTimestamp(char* buf, size_t size);
  
-     // Accessor methods for configuration flags
-     bool isShowDetailed() const { return show_detailed; }
-     bool isShowFrequencies() const { return show_frequencies; }
-     bool isShowLoad() const { return show_load; }
-     bool isShowTopology() const { return show_topology; }
-     bool isUseColors() const { return use_colors; }
+     /**
+      * Print the column header for watch mode
+      */
+     void printWatchHeader();
+     
+     /**
+      * Print one watch mode line with utilization between two samples
+      * @param prev Previous sample
+      * @param cur Current sample
+      */
+     void printWatchLine(const CpuLoad& prev, const CpuLoad& cur);
+     
+     /**
+      * Print one per-CPU watch mode tick
+      * @param prev Previous aggregate sample
+      * @param cur Current aggregate sample
+      * @param prev_cpus Previous per-CPU sample
+      * @param cur_cpus Current per-CPU sample
+      */
+     void printPerCpuTick(const CpuLoad& prev, const CpuLoad& cur,
+                          const CpuStatTable& prev_cpus, const CpuStatTable& cur_cpus);
  
-     // Setter methods for testing purposes
-     void setShowDetailed(bool value) { show_detailed = value; }
-     void setShowFrequencies(bool value) { show_frequencies = value; }
-     void setShowLoad(bool value) { show_load = value; }
-     void setShowTopology(bool value) { show_topology = value; }
-     void setUseColors(bool value) { use_colors = value; }
- };
+     /**
+      * Write one --format sample of watch mode
+      * @param prev Previous sample
+      * @param cur Current sample
+      * @param prev_cpus Previous per-CPU counters
+      * @param cur_cpus Current per-CPU counters
+      */
+     void writeWatchSample(const CpuLoad& prev, const CpuLoad& cur,
+                           const CpuStatTable& prev_cpus, const CpuStatTable& cur_cpus);
  
- /**
-  * Utility functions namespace
-  */
- namespace CpuInfoUtils {
      /**
-      * Check if output terminal supports colors
-      * @return true if colors are supported, false otherwise
+      * Sample CPU frequencies every interval until the sample count is reached
       */
-     bool supportsColors();
+     void printFrequencyWatch();
  
      /**
-      * Read a single line from a file
-      * @param filepath Path to the file
-      * @param line Reference to store the read line
-      * @return true if successful, false otherwise
+      * Report cgroup CPU use, share of the limit and throttling per interval
+      */
+     void printCgroupWatch();
+     
+     /**
+      * Open the --record file, if any
+      * @throws std::runtime_error if it cannot be opened or is not a recording
+      */
+     void openRecording();
+     
+     /**
+      * Append a sample to the --record file, if any
+      * @param load Aggregate counters
+      * @param per_cpu Per-CPU counters
+      * @throws std::runtime_error if the write fails
+      */
+     void recordSample(const CpuLoad& load, const CpuStatTable& per_cpu);
+     
+     /**
+      * Print the watch output of a --replay file with its recorded times
+      * @throws std::runtime_error if the file cannot be read
+      */
+     void printReplay();
+     
+     /**
+      * Keep the busy percentage of every CPU in a SampleHistory and redraw
+      * it as sparklines after each sample
       */
-     bool readFileLine(const std::string& filepath, std::string& line);
+     void printHistoryWatch();
+     
+     /**
+      * Redraw the busiest processes of every interval, or write them as
+      * one --format sample per interval
+      */
+     void printProcessWatch();
+     
+     /**
+      * Sample CPU utilization every interval until the sample count is reached
+      */
+     void printWatch();
+     
+     /**
+      * Select a section named on the command line; the first one named
+      * turns off the sections shown by default
+      * @param name Section name
+      * @return false if there is no such section
+      */
+     bool selectSection(const std::string& name);
  
+ public:
      /**
-      * Parse a key-value pair from /proc/cpuinfo format
-      * @param line Line to parse
-      * @param key Reference to store the key
-      * @param value Reference to store the value
-      * @return true if parsing successful, false otherwise
+      * Constructor - initializes utility state
       */
-     bool parseCpuInfoLine(const std::string& line, std::string& key, std::string& value);
+     CpuInfoUtil();
+     
+     /**
+      * Destructor - closes cached /proc file descriptors
+      */
+     ~CpuInfoUtil();
+ 
+     // Disable copy constructor and assignment operator
+     CpuInfoUtil(const CpuInfoUtil&) = delete;
+     CpuInfoUtil& operator=(const CpuInfoUtil&) = delete;
  
      /**
-      * Convert MHz to GHz with appropriate formatting
-      * @param mhz Frequency in MHz
-      * @return Formatted frequency string
+      * Parse command line arguments
+      * @param argc Argument count
+      * @param argv Argument values
       */
-     std::string formatMhzToGhz(double mhz);
+     void parseArgs(int argc, char* argv[]);
  
      /**
-      * Calculate CPU usage percentage from stat values
-      * @param user User time
-      * @param nice Nice time
-      * @param system System time
-      * @param idle Idle time
-      * @param iowait I/O wait time
-      * @param irq IRQ time
-      * @param softirq Soft IRQ time
-      * @return CPU usage percentage
-      */
-     double calculateCpuUsage(unsigned long long user, unsigned long long nice,
-                            unsigned long long system, unsigned long long idle,
-                            unsigned long long iowait, unsigned long long irq,
-                            unsigned long long softirq);
+      * Print version information
+      */
+     void printVersion();
  
      /**
-      * Get number of online CPUs
-      * @return Number of online CPUs
+      * Print help message
       */
-     int getOnlineCpuCount();
+     void printHelp();
  
      /**
-      * Check if CPU supports a specific feature flag
-      * @param flags Vector of CPU flags
-      * @param feature Feature to check for
-      * @return true if feature is supported, false otherwise
+      * Run the main program logic
+      * @return Exit status; 1 if --has found a feature missing
       */
-     bool supportsCpuFeature(const std::vector<std::string>& flags, const std::string& feature);
- }
+     int run();
+ };
  
  // Version information
  namespace Version {
@@ -15,534 +15,1330 @@
  #include <iomanip>
  #include <filesystem>
  #include <cstring>
+ #include <cerrno>
+ #include <cstdlib>
+ #include <ctime>
+ #include <stdexcept>
+ #include <string_view>
+ #include <memory>
  #include <unistd.h>
- #include <sys/statvfs.h>
- #include <sys/stat.h>
+ 
+ #include "diskls.hpp"
+ #include "output.hpp"
+ #include "cli.hpp"
+ #include "format.hpp"
+ #include "procfs.hpp"
+ #include "stats.hpp"
+ #include "disk.hpp"
+ #include "sysfs.hpp"
+ #include "cgroup.hpp"
+ #include "history.hpp"
+ #include "record.hpp"
+ #include "process.hpp"
+ #include "multicall.hpp"
  
  namespace fs = std::filesystem;
  
- // ANSI Color codes
- namespace Colors {
-     const std::string RESET = "\033[0m";
-     const std::string BOLD = "\033[1m";
-     const std::string RED = "\033[31m";
-     const std::string GREEN = "\033[32m";
-     const std::string YELLOW = "\033[33m";
-     const std::string BLUE = "\033[34m";
-     const std::string MAGENTA = "\033[35m";
-     const std::string CYAN = "\033[36m";
-     const std::string WHITE = "\033[37m";
-     const std::string DIM = "\033[2m";
- }
- 
- struct DiskInfo {
-     std::string device;
-     std::string model;
-     std::string vendor;
-     std::string type; // HDD/SSD/NVMe
-     unsigned long long size_bytes = 0;
-     std::string size_human;
-     bool removable = false;
-     bool rotational = true;
-     std::string scheduler;
-     unsigned int queue_depth = 0;
-     std::vector<std::string> partitions;
- };
- 
- struct PartitionInfo {
-     std::string device;
-     std::string mountpoint;
-     std::string filesystem;
-     unsigned long long total_bytes = 0;
-     unsigned long long used_bytes = 0;
-     unsigned long long available_bytes = 0;
-     double usage_percent = 0.0;
-     std::string mount_options;
- };
- 
- struct DiskStats {
-     std::string device;
-     unsigned long long reads_completed = 0;
-     unsigned long long reads_merged = 0;
-     unsigned long long sectors_read = 0;
-     unsigned long long time_reading = 0;
-     unsigned long long writes_completed = 0;
-     unsigned long long writes_merged = 0;
-     unsigned long long sectors_written = 0;
-     unsigned long long time_writing = 0;
-     unsigned long long io_in_progress = 0;
-     unsigned long long time_io = 0;
-     unsigned long long weighted_time_io = 0;
- };
- 
- class DiskLsUtil {
- private:
-     bool show_detailed = false;
-     bool show_usage = false;
-     bool show_mounts = false;
-     bool show_types = false;
-     bool use_colors = true;
- 
-     std::string colorize(const std::string& text, const std::string& color) {
-         if (!use_colors) return text;
-         return color + text + Colors::RESET;
-     }
- 
-     std::string formatBytes(unsigned long long bytes) {
-         if (bytes == 0) return "0 B";
-         
-         const char* units[] = {"B", "KB", "MB", "GB", "TB", "PB"};
-         int unit = 0;
-         double size = static_cast<double>(bytes);
-         
-         while (size >= 1024.0 && unit < 5) {
-             size /= 1024.0;
-             unit++;
-         }
-         
-         std::ostringstream oss;
-         if (unit == 0) {
-             oss << static_cast<unsigned long long>(size) << " " << units[unit];
-         } else {
-             oss << std::fixed << std::setprecision(1) << size << " " << units[unit];
-         }
-         return oss.str();
-     }
+ std::string DiskLsUtil::colorize(const std::string& text, const std::string& color) {
+     return ::colorize(text, color, use_colors);
+ }
  
-     std::vector<DiskInfo> getDiskInfo() {
-         std::vector<DiskInfo> disks;
-         
-         try {
-             // Read from /sys/block/
-             for (const auto& entry : fs::directory_iterator("/sys/block/")) {
-                 std::string device_name = entry.path().filename();
-                 
-                 // Skip loop devices and ram disks by default
-                 if (device_name.find("loop") == 0 || device_name.find("ram") == 0) {
-                     continue;
-                 }
-                 
-                 DiskInfo disk;
-                 disk.device = "/dev/" + device_name;
-                 
-                 // Read size
-                 std::ifstream size_file(entry.path() / "size");
-                 if (size_file.is_open()) {
-                     unsigned long long sectors;
-                     size_file >> sectors;
-                     disk.size_bytes = sectors * 512; // Assume 512 byte sectors
-                     disk.size_human = formatBytes(disk.size_bytes);
-                 }
-                 
-                 // Read model
-                 std::ifstream model_file(entry.path() / "device/model");
-                 if (model_file.is_open()) {
-                     std::getline(model_file, disk.model);
-                     // Trim whitespace
-                     disk.model.erase(disk.model.find_last_not_of(" \t\n\r") + 1);
-                 }
-                 
-                 // Read vendor
-                 std::ifstream vendor_file(entry.path() / "device/vendor");
-                 if (vendor_file.is_open()) {
-                     std::getline(vendor_file, disk.vendor);
-                     disk.vendor.erase(disk.vendor.find_last_not_of(" \t\n\r") + 1);
-                 }
-                 
-                 // Check if removable
-                 std::ifstream removable_file(entry.path() / "removable");
-                 if (removable_file.is_open()) {
-                     int removable_flag;
-                     removable_file >> removable_flag;
-                     disk.removable = (removable_flag == 1);
-                 }
-                 
-                 // Check if rotational (SSD vs HDD)
-                 std::ifstream rotational_file(entry.path() / "queue/rotational");
-                 if (rotational_file.is_open()) {
-                     int rotational_flag;
-                     rotational_file >> rotational_flag;
-                     disk.rotational = (rotational_flag == 1);
-                 }
-                 
-                 // Determine disk type
-                 if (device_name.find("nvme") == 0) {
-                     disk.type = "NVMe";
-                 } else if (!disk.rotational) {
-                     disk.type = "SSD";
-                 } else {
-                     disk.type = "HDD";
-                 }
-                 
-                 // Read scheduler
-                 std::ifstream scheduler_file(entry.path() / "queue/scheduler");
-                 if (scheduler_file.is_open()) {
-                     std::string scheduler_line;
-                     std::getline(scheduler_file, scheduler_line);
-                     
-                     // Extract current scheduler (between square brackets)
-                     size_t start = scheduler_line.find('[');
-                     size_t end = scheduler_line.find(']');
-                     if (start != std::string::npos && end != std::string::npos) {
-                         disk.scheduler = scheduler_line.substr(start + 1, end - start - 1);
-                     }
-                 }
-                 
-                 // Read queue depth
-                 std::ifstream queue_file(entry.path() / "queue/nr_requests");
-                 if (queue_file.is_open()) {
-                     queue_file >> disk.queue_depth;
-                 }
-                 
-                 // Find partitions
-                 try {
-                     for (const auto& part_entry : fs::directory_iterator(entry.path())) {
-                         std::string part_name = part_entry.path().filename();
-                         if (part_name.find(device_name) == 0 && part_name != device_name) {
-                             disk.partitions.push_back("/dev/" + part_name);
-                         }
-                     }
-                 } catch (const std::exception& e) {
-                     // Ignore partition enumeration errors
-                 }
-                 
-                 disks.push_back(disk);
-             }
-         } catch (const std::exception& e) {
-             std::cerr << colorize("Warning: Could not read all disk information", Colors::YELLOW) << std::endl;
-         }
-         
-         return disks;
+ // Read every disk in /sys/block. Devices are split across statvfs_jobs
+ // threads, since the SMART ioctl can take tens of milliseconds per drive.
+ std::vector<DiskInfo> DiskLsUtil::getDiskInfo() {
+     std::vector<DiskInfo> disks;
+     if (!readDisks(disks, statvfs_jobs, show_smart)) {
+         std::cerr << colorize("Warning: Could not read all disk information", Colors::YELLOW) << '\n';
      }
+     return disks;
+ }
  
-     std::vector<PartitionInfo> getPartitionInfo() {
-         std::vector<PartitionInfo> partitions;
-         
-         // Read from /proc/mounts
-         std::ifstream mounts_file("/proc/mounts");
-         std::string line;
-         
-         while (std::getline(mounts_file, line)) {
-             std::istringstream iss(line);
-             std::string device, mountpoint, filesystem, options;
-             
-             if (iss >> device >> mountpoint >> filesystem >> options) {
-                 // Skip special filesystems
-                 if (device.find("/dev/") != 0) continue;
-                 if (filesystem == "proc" || filesystem == "sysfs" || 
-                     filesystem == "devtmpfs" || filesystem == "tmpfs") continue;
-                 
-                 PartitionInfo part;
-                 part.device = device;
-                 part.mountpoint = mountpoint;
-                 part.filesystem = filesystem;
-                 part.mount_options = options;
-                 
-                 // Get space usage
-                 struct statvfs stat;
-                 if (statvfs(mountpoint.c_str(), &stat) == 0) {
-                     part.total_bytes = static_cast<unsigned long long>(stat.f_blocks) * stat.f_frsize;
-                     part.available_bytes = static_cast<unsigned long long>(stat.f_bavail) * stat.f_frsize;
-                     part.used_bytes = (static_cast<unsigned long long>(stat.f_blocks) - 
-                                      static_cast<unsigned long long>(stat.f_bfree)) * stat.f_frsize;
-                     
-                     if (part.total_bytes > 0) {
-                         part.usage_percent = static_cast<double>(part.used_bytes) / part.total_bytes * 100.0;
-                     }
-                 }
-                 
-                 partitions.push_back(part);
-             }
-         }
-         
+ std::vector<PartitionInfo> DiskLsUtil::getPartitionInfo(bool with_usage) {
+     std::vector<PartitionInfo> partitions;
+     const char* text = sampler.mountInfo();
+     if (!text) {
+         std::cerr << colorize("Warning: Could not read mount information", Colors::YELLOW) << '\n';
          return partitions;
      }
+     
+     readPartitions(text, mount_filter, partitions);
+     if (with_usage) readPartitionUsage(partitions, statvfs_jobs, statvfs_timeout);
+     return partitions;
+ }
+ 
+ const std::vector<DiskInfo>& DiskLsUtil::disks() {
+     if (!disks_read) {
+         disk_cache = getDiskInfo();
+         disks_read = true;
+     }
+     return disk_cache;
+ }
+ 
+ const std::vector<PartitionInfo>& DiskLsUtil::partitions(bool with_usage) {
+     if (!partitions_read || (with_usage && !partition_usage_read)) {
+         partition_cache = getPartitionInfo(with_usage);
+         partitions_read = true;
+         partition_usage_read = with_usage;
+     }
+     return partition_cache;
+ }
+ 
+ const BlockGraph& DiskLsUtil::blockGraph() {
+     if (!graph_read) {
+         graph_cache = readBlockGraph();
+         graph_read = true;
+     }
+     return graph_cache;
+ }
+ 
+ void DiskLsUtil::openCgroup() {
+     if (cgroup_dir.valid()) return;
+     
+     std::string path = resolveCgroup(cgroup_spec);
+     if (!cgroup_dir.open(path.c_str())) {
+         throw std::runtime_error("cannot open cgroup " + path + ": " + std::strerror(errno));
+     }
+     if (!sampler.openCgroupIo(cgroup_dir)) {
+         throw std::runtime_error("io controller is not enabled for " + path);
+     }
+     cgroup_spec = path;
+ }
+ 
+ void DiskLsUtil::printSeparator(const std::string& title) {
+     ::printSeparator(title, use_colors);
+ }
  
-     std::map<std::string, DiskStats> getDiskStats() {
-         std::map<std::string, DiskStats> stats;
+ void DiskLsUtil::printDiskInfo() {
+     const auto& disks = this->disks();
+     
+     printSeparator("Disk Information");
+     
+     if (disks.empty()) {
+         std::cout << "No disks found" << '\n';
+         return;
+     }
+     
+     for (const auto& disk : disks) {
+         std::cout << colorize(disk.device, Colors::BOLD) << '\n';
          
-         std::ifstream diskstats_file("/proc/diskstats");
-         std::string line;
+         if (!disk.model.empty()) {
+             std::cout << "  " << std::left << std::setw(16) << "Model:" 
+                       << disk.model << '\n';
+         }
          
-         while (std::getline(diskstats_file, line)) {
-             std::istringstream iss(line);
-             unsigned int major, minor;
-             std::string device;
-             DiskStats stat;
-             
-             if (iss >> major >> minor >> device >> 
-                 stat.reads_completed >> stat.reads_merged >> stat.sectors_read >> stat.time_reading >>
-                 stat.writes_completed >> stat.writes_merged >> stat.sectors_written >> stat.time_writing >>
-                 stat.io_in_progress >> stat.time_io >> stat.weighted_time_io) {
-                 
-                 stat.device = device;
-                 stats[device] = stat;
-             }
+         if (!disk.vendor.empty()) {
+             std::cout << "  " << std::left << std::setw(16) << "Vendor:" 
+                       << disk.vendor << '\n';
          }
          
-         return stats;
-     }
- 
-     void printSeparator(const std::string& title = "") {
-         if (title.empty()) {
-             std::cout << std::string(70, '-') << std::endl;
-         } else {
-             std::cout << colorize(title, Colors::BOLD) << std::endl;
-             std::cout << std::string(title.length(), '=') << std::endl;
+         if (!disk.label.empty()) {
+             std::cout << "  " << std::left << std::setw(16) << "Name:" 
+                       << disk.label << '\n';
          }
-     }
- 
-     void printDiskInfo() {
-         auto disks = getDiskInfo();
          
-         printSeparator("Disk Information");
+         std::cout << "  " << std::left << std::setw(16) << "Type:" 
+                   << disk.type << '\n';
          
-         if (disks.empty()) {
-             std::cout << "No disks found" << std::endl;
-             return;
+         std::cout << "  " << std::left << std::setw(16) << "Size:" 
+                   << formatBytes(disk.size_bytes);
+         
+         if (show_detailed) {
+             std::cout << colorize(" (" + std::to_string(disk.size_bytes) + " bytes)", Colors::DIM);
+         }
+         std::cout << '\n';
+         
+         if (disk.removable) {
+             std::cout << "  " << std::left << std::setw(16) << "Removable:" 
+                       << "Yes" << '\n';
          }
          
-         for (const auto& disk : disks) {
-             std::cout << colorize(disk.device, Colors::BOLD) << std::endl;
+         if (show_detailed) {
+             if (!disk.scheduler.empty()) {
+                 std::cout << "  " << std::left << std::setw(16) << "Scheduler:" 
+                           << disk.scheduler << '\n';
+             }
              
-             if (!disk.model.empty()) {
-                 std::cout << "  " << std::left << std::setw(16) << "Model:" 
-                           << disk.model << std::endl;
+             if (disk.queue_depth > 0) {
+                 std::cout << "  " << std::left << std::setw(16) << "Queue depth:" 
+                           << disk.queue_depth << '\n';
              }
              
-             if (!disk.vendor.empty()) {
-                 std::cout << "  " << std::left << std::setw(16) << "Vendor:" 
-                           << disk.vendor << std::endl;
+             std::cout << "  " << std::left << std::setw(16) << "Block size:" 
+                       << disk.logical_block_size << " logical, "
+                       << disk.physical_block_size << " physical" << '\n';
+             
+             if (disk.optimal_io_size > 0) {
+                 std::cout << "  " << std::left << std::setw(16) << "Optimal I/O:" 
+                           << formatBytes(disk.optimal_io_size) << '\n';
              }
              
-             std::cout << "  " << std::left << std::setw(16) << "Type:" 
-                       << disk.type << std::endl;
+             if (disk.discard_max_bytes > 0) {
+                 std::cout << "  " << std::left << std::setw(16) << "Discard max:" 
+                           << formatBytes(disk.discard_max_bytes) << '\n';
+             }
              
-             std::cout << "  " << std::left << std::setw(16) << "Size:" 
-                       << disk.size_human;
+             if (disk.hw_queues > 0) {
+                 std::cout << "  " << std::left << std::setw(16) << "HW queues:" 
+                           << disk.hw_queues << '\n';
+             }
              
-             if (show_detailed) {
-                 std::cout << colorize(" (" + std::to_string(disk.size_bytes) + " bytes)", Colors::DIM);
+             if (!disk.write_cache.empty()) {
+                 std::cout << "  " << std::left << std::setw(16) << "Write cache:" 
+                           << disk.write_cache << '\n';
              }
-             std::cout << std::endl;
              
-             if (disk.removable) {
-                 std::cout << "  " << std::left << std::setw(16) << "Removable:" 
-                           << "Yes" << std::endl;
+             if (disk.io_poll) {
+                 std::cout << "  " << std::left << std::setw(16) << "I/O polling:" 
+                           << "enabled" << '\n';
              }
              
-             if (show_detailed) {
-                 if (!disk.scheduler.empty()) {
-                     std::cout << "  " << std::left << std::setw(16) << "Scheduler:" 
-                               << disk.scheduler << std::endl;
-                 }
-                 
-                 if (disk.queue_depth > 0) {
-                     std::cout << "  " << std::left << std::setw(16) << "Queue depth:" 
-                               << disk.queue_depth << std::endl;
-                 }
-                 
-                 if (!disk.partitions.empty()) {
-                     std::cout << "  " << std::left << std::setw(16) << "Partitions:";
-                     for (size_t i = 0; i < disk.partitions.size(); ++i) {
-                         if (i > 0) std::cout << ", ";
-                         std::cout << fs::path(disk.partitions[i]).filename().string();
-                     }
-                     std::cout << std::endl;
+             if (!disk.zoned.empty() && disk.zoned != "none") {
+                 std::cout << "  " << std::left << std::setw(16) << "Zoned:" 
+                           << disk.zoned << " (" << disk.nr_zones << " zones)" << '\n';
+             }
+             
+             if (disk.has_scsi_counters) {
+                 std::cout << "  " << std::left << std::setw(16) << "SCSI commands:" 
+                           << disk.io_requests << " issued, " << disk.io_done << " done, "
+                           << disk.io_errors << " errors" << '\n';
+             }
+             
+             if (disk.command_timeout > 0) {
+                 std::cout << "  " << std::left << std::setw(16) << "Cmd timeout:" 
+                           << disk.command_timeout << " s" << '\n';
+             }
+             
+             if (!disk.partitions.empty()) {
+                 std::cout << "  " << std::left << std::setw(16) << "Partitions:";
+                 for (size_t i = 0; i < disk.partitions.size(); ++i) {
+                     if (i > 0) std::cout << ", ";
+                     std::cout << fs::path(disk.partitions[i]).filename().string();
                  }
+                 std::cout << '\n';
              }
              
-             std::cout << std::endl;
+             const BlockGraph& graph = blockGraph();
+             int index = graph.find(disk.device.substr(5));
+             if (index >= 0) printStackInfo(graph, index);
          }
-     }
- 
-     void printUsageInfo() {
-         auto partitions = getPartitionInfo();
-         
-         std::cout << std::endl;
-         printSeparator("Disk Usage");
          
-         if (partitions.empty()) {
-             std::cout << "No mounted partitions found" << std::endl;
-             return;
+         if (show_smart && disk.type == "NVMe") {
+             printHealthInfo(disk.health);
          }
          
-         std::cout << std::left 
-                   << std::setw(20) << "DEVICE"
-                   << std::setw(15) << "SIZE"
-                   << std::setw(15) << "USED"
-                   << std::setw(15) << "AVAILABLE"
-                   << std::setw(8) << "USE%"
-                   << "MOUNTED ON" << std::endl;
-         printSeparator();
+         std::cout << '\n';
+     }
+ }
+ 
+ void DiskLsUtil::printHealthInfo(const NvmeHealth& health) {
+     if (!health.valid) {
+         std::cout << "  " << std::left << std::setw(16) << "Health:" 
+                   << colorize("unavailable (" + health.error + ")", Colors::DIM) << '\n';
+         return;
+     }
+     
+     if (health.critical_warning != 0) {
+         std::ostringstream warning;
+         warning << "0x" << std::hex << health.critical_warning;
+         std::cout << "  " << std::left << std::setw(16) << "Warnings:" 
+                   << colorize(warning.str(), Colors::RED) << '\n';
+     }
+     
+     std::cout << "  " << std::left << std::setw(16) << "Temperature:" 
+               << health.temperature_c << " C" << '\n';
+     std::cout << "  " << std::left << std::setw(16) << "Life used:" 
+               << health.percentage_used << "%" << '\n';
+     std::cout << "  " << std::left << std::setw(16) << "Spare:" 
+               << health.available_spare << "%" << '\n';
+     
+     std::string errors = std::to_string(health.media_errors);
+     std::cout << "  " << std::left << std::setw(16) << "Media errors:" 
+               << (health.media_errors > 0 ? colorize(errors, Colors::YELLOW) : errors) << '\n';
+     
+     std::cout << "  " << std::left << std::setw(16) << "Data read:" 
+               << formatBytes(health.data_units_read * 512000) << '\n';
+     std::cout << "  " << std::left << std::setw(16) << "Data written:" 
+               << formatBytes(health.data_units_written * 512000) << '\n';
+     std::cout << "  " << std::left << std::setw(16) << "Power-on hours:" 
+               << health.power_on_hours << '\n';
+     std::cout << "  " << std::left << std::setw(16) << "Unsafe stops:" 
+               << health.unsafe_shutdowns << '\n';
+ }
+ 
+ void DiskLsUtil::printNodeList(const BlockGraph& graph, const std::vector<int>& nodes) {
+     for (size_t i = 0; i < nodes.size(); ++i) {
+         if (i > 0) std::cout << ", ";
+         std::cout << graph.nodes[nodes[i]].name;
+     }
+     std::cout << '\n';
+ }
+ 
+ // Slaves, holders and backing disks of one device in the -d listing.
+ // Holders of a partition are shown with the partition in parentheses.
+ void DiskLsUtil::printStackInfo(const BlockGraph& graph, int index) {
+     const BlockNode& node = graph.nodes[index];
+     
+     if (!node.slaves.empty()) {
+         std::cout << "  " << std::left << std::setw(16) << "Slaves:";
+         printNodeList(graph, node.slaves);
          
-         for (const auto& part : partitions) {
+         std::cout << "  " << std::left << std::setw(16) << "Backing disks:";
+         printNodeList(graph, backingDisks(graph, index));
+     }
+     
+     bool first = true;
+     auto printHolders = [&](const BlockNode& held, bool partition) {
+         for (int holder : held.holders) {
+             std::cout << (first ? "  " : ", ");
+             if (first) std::cout << std::left << std::setw(16) << "Holders:";
+             std::cout << graph.nodes[holder].name;
+             if (partition) std::cout << " (" << held.name << ")";
+             first = false;
+         }
+     };
+     printHolders(node, false);
+     for (int part : node.partitions) printHolders(graph.nodes[part], true);
+     if (!first) std::cout << '\n';
+ }
+ 
+ void DiskLsUtil::printGraphNode(const BlockGraph& graph, int index, int depth) {
+     const BlockNode& node = graph.nodes[index];
+     
+     std::string name = std::string(depth * 2, ' ') + node.name;
+     if (!node.label.empty()) name += " (" + node.label + ")";
+     
+     const char* kind = node.parent >= 0 ? "part" :
+                        node.name.find("dm-") == 0 ? "dm" :
+                        node.name.find("md") == 0 ? "md" :
+                        node.name.find("loop") == 0 ? "loop" : "disk";
+     
+     std::cout << std::left << std::setw(32) << name << " "
+               << std::right << std::setw(10) << formatBytes(node.size_bytes) << "  "
+               << kind << '\n';
+     
+     // The kernel keeps the graph acyclic; the depth limit only guards
+     // against a sysfs snapshot that changed while it was being read
+     if (depth >= 16) return;
+     for (int part : node.partitions) printGraphNode(graph, part, depth + 1);
+     for (int holder : node.holders) printGraphNode(graph, holder, depth + 1);
+ }
+ 
+ // Print the device stack top-down from the physical disks, like lsblk.
+ // A device built on several disks appears under each of them.
+ void DiskLsUtil::printGraphInfo() {
+     const BlockGraph& graph = blockGraph();
+     
+     std::cout << '\n';
+     printSeparator("Device Stack");
+     
+     bool any = false;
+     for (size_t i = 0; i < graph.nodes.size(); ++i) {
+         if (!graphRoot(graph, graph.nodes[i])) continue;
+         printGraphNode(graph, i, 0);
+         any = true;
+     }
+     if (!any) {
+         std::cout << "No block devices found" << '\n';
+     }
+ }
+ 
+ // Bytes and operations of the --cgroup cgroup per device, from io.stat
+ void DiskLsUtil::printCgroupInfo() {
+     openCgroup();
+     DiskStatsTable table;
+     sampler.cgroupIoStat(table);
+     
+     std::cout << '\n';
+     printSeparator("Cgroup I/O");
+     std::cout << std::left << std::setw(18) << "Cgroup:" << cgroup_spec << '\n';
+     
+     char text[512];
+     double some, full;
+     if (cgroup_dir.read("io.pressure", text, sizeof(text)) > 0 && parsePressure(text, some, full)) {
+         std::cout << std::left << std::setw(18) << "Pressure:" 
+                   << std::fixed << std::setprecision(2)
+                   << "some " << some << "%, full " << full << "% (avg10)" << '\n';
+     }
+     std::cout << '\n';
+     
+     if (table.rows.empty()) {
+         std::cout << "No I/O recorded" << '\n';
+         return;
+     }
+     
+     std::cout << colorize("DEVICE        READ        WRITTEN       READS      WRITES", Colors::BOLD) << '\n';
+     for (const auto& stat : table.rows) {
+         std::cout << std::left << std::setw(14) << stat.device.substr(0, 13)
+                   << std::setw(12) << formatBytes(stat.sectors_read * 512)
+                   << std::setw(12) << formatBytes(stat.sectors_written * 512)
+                   << std::right
+                   << std::setw(7) << stat.reads_completed
+                   << std::setw(12) << stat.writes_completed << '\n';
+     }
+ }
+ 
+ // Rank the cgroups below --cgroup, or below the hierarchy root, by the
+ // bytes they have read and written
+ void DiskLsUtil::printCgroupTop() {
+     std::string root = resolveCgroup(cgroup_mode ? cgroup_spec : "/");
+     auto top = topCgroups(root, cgroup_top, cgroupIoMetric);
+     
+     std::cout << '\n';
+     printSeparator("Top I/O Cgroups");
+     std::cout << std::left << std::setw(14) << "TRANSFERRED" << "CGROUP" << '\n';
+     printSeparator();
+     
+     for (const auto& usage : top) {
+         std::cout << std::left << std::setw(14) << formatBytes(usage.value) << usage.path << '\n';
+     }
+ }
+ 
+ // --events: follow processes with the kernel's events instead of
+ // listing /proc for every sample, where we are allowed to
+ void DiskLsUtil::startProcessSampler() {
+     if (process_events && !process_sampler.followingEvents() && !process_sampler.followEvents()) {
+         std::cerr << colorize("diskls: cannot follow process events (needs CAP_NET_ADMIN), scanning /proc",
+                               Colors::YELLOW) << '\n';
+     }
+ }
+ 
+ // Sample every process twice, watch_interval apart, and rank them by
+ // the bytes they read from and wrote to storage in between
+ void DiskLsUtil::sampleProcesses() {
+     startProcessSampler();
+     process_sampler.sample(process_sort, 15, top_processes);
+     struct timespec deadline;
+     clock_gettime(CLOCK_MONOTONIC, &deadline);
+     waitForNextTick(deadline, watch_interval);
+     if (!process_sampler.sample(process_sort, 15, top_processes)) {
+         throw std::runtime_error(std::string("cannot list /proc: ") + std::strerror(errno));
+     }
+ }
+ 
+ // /proc/PID/io of other users' processes needs root, so without it
+ // only our own processes are ranked
+ void DiskLsUtil::printProcessTable() {
+     std::cout << std::left
+               << std::setw(8) << "PID"
+               << std::setw(16) << "COMMAND"
+               << std::setw(12) << "READ/s"
+               << std::setw(12) << "WRITE/s"
+               << "CMDLINE" << '\n';
+     printSeparator();
+     
+     for (const auto& proc : top_processes) {
+         std::cout << std::left
+                   << std::setw(8) << proc.pid
+                   << std::setw(16) << proc.name
+                   << std::setw(12) << formatBytes(static_cast<unsigned long long>(proc.read_rate))
+                   << std::setw(12) << formatBytes(static_cast<unsigned long long>(proc.write_rate))
+                   << proc.cmd << '\n';
+     }
+ }
+ 
+ void DiskLsUtil::printProcesses() {
+     sampleProcesses();
+     std::cout << '\n';
+     printSeparator("Top I/O Processes");
+     printProcessTable();
+ }
+ 
+ void DiskLsUtil::printUsageInfo() {
+     const auto& partitions = this->partitions(true);
+     
+     std::cout << '\n';
+     printSeparator("Disk Usage");
+     
+     if (partitions.empty()) {
+         std::cout << "No mounted partitions found" << '\n';
+         return;
+     }
+     
+     std::cout << std::left 
+               << std::setw(20) << "DEVICE"
+               << std::setw(15) << "SIZE"
+               << std::setw(15) << "USED"
+               << std::setw(15) << "AVAILABLE"
+               << std::setw(8) << "USE%"
+               << "MOUNTED ON" << '\n';
+     printSeparator();
+     
+     for (const auto& part : partitions) {
+         if (part.stale) {
              std::cout << std::left 
                        << std::setw(20) << part.device.substr(0, 19)
-                       << std::setw(15) << formatBytes(part.total_bytes)
-                       << std::setw(15) << formatBytes(part.used_bytes)
-                       << std::setw(15) << formatBytes(part.available_bytes)
-                       << std::setw(7) << std::fixed << std::setprecision(0) << part.usage_percent << "%"
-                       << part.mountpoint << std::endl;
+                       << colorize("stale", Colors::YELLOW) << std::string(10, ' ')
+                       << std::setw(15) << "-"
+                       << std::setw(15) << "-"
+                       << std::setw(8) << "-"
+                       << part.mountpoint << '\n';
+             continue;
          }
+         
+         std::cout << std::left 
+                   << std::setw(20) << part.device.substr(0, 19)
+                   << std::setw(15) << formatBytes(part.total_bytes)
+                   << std::setw(15) << formatBytes(part.used_bytes)
+                   << std::setw(15) << formatBytes(part.available_bytes)
+                   << std::setw(7) << std::fixed << std::setprecision(0) << part.usage_percent << "%"
+                   << part.mountpoint << '\n';
      }
+ }
  
-     void printMountInfo() {
-         auto partitions = getPartitionInfo();
+ void DiskLsUtil::printMountInfo() {
+     const auto& partitions = this->partitions();
+     
+     std::cout << '\n';
+     printSeparator("Mount Information");
+     
+     for (const auto& part : partitions) {
+         std::cout << colorize(part.device, Colors::BOLD) << '\n';
+         std::cout << "  " << std::left << std::setw(16) << "Mount point:" 
+                   << part.mountpoint << '\n';
+         std::cout << "  " << std::left << std::setw(16) << "Filesystem:" 
+                   << part.filesystem << '\n';
          
-         std::cout << std::endl;
-         printSeparator("Mount Information");
-         
-         for (const auto& part : partitions) {
-             std::cout << colorize(part.device, Colors::BOLD) << std::endl;
-             std::cout << "  " << std::left << std::setw(16) << "Mount point:" 
-                       << part.mountpoint << std::endl;
-             std::cout << "  " << std::left << std::setw(16) << "Filesystem:" 
-                       << part.filesystem << std::endl;
-             
-             if (show_detailed) {
-                 std::cout << "  " << std::left << std::setw(16) << "Mount options:" 
-                           << part.mount_options << std::endl;
+         if (show_detailed) {
+             std::cout << "  " << std::left << std::setw(16) << "Mount options:" 
+                       << part.mount_options << '\n';
+             std::cout << "  " << std::left << std::setw(16) << "Device number:" 
+                       << part.major << ":" << part.minor << '\n';
+             if (part.root != "/") {
+                 std::cout << "  " << std::left << std::setw(16) << "Mounted path:" 
+                           << part.root << '\n';
              }
-             
-             std::cout << std::endl;
          }
+         
+         std::cout << '\n';
      }
+ }
  
-     void printTypeInfo() {
-         auto disks = getDiskInfo();
-         auto partitions = getPartitionInfo();
-         
-         std::cout << std::endl;
-         printSeparator("Disk Types and Filesystems");
-         
-         // Group disks by type
-         std::map<std::string, std::vector<std::string>> disk_types;
-         for (const auto& disk : disks) {
-             disk_types[disk.type].push_back(fs::path(disk.device).filename().string());
+ void DiskLsUtil::printTypeInfo() {
+     const auto& disks = this->disks();
+     const auto& partitions = this->partitions();
+     
+     std::cout << '\n';
+     printSeparator("Disk Types and Filesystems");
+     
+     // Group disks by type
+     std::map<std::string, std::vector<std::string>> disk_types;
+     for (const auto& disk : disks) {
+         disk_types[disk.type].push_back(fs::path(disk.device).filename().string());
+     }
+     
+     std::cout << colorize("Disk Types:", Colors::BOLD) << '\n';
+     for (const auto& type : disk_types) {
+         std::cout << "  " << std::left << std::setw(16) << (type.first + ":") << '\n';
+         std::cout << "    ";
+         for (size_t i = 0; i < type.second.size(); ++i) {
+             if (i > 0) std::cout << ", ";
+             std::cout << type.second[i];
+         }
+         std::cout << '\n';
+     }
+     
+     std::cout << '\n';
+     
+     // Group filesystems
+     std::map<std::string, std::vector<std::string>> filesystems;
+     for (const auto& part : partitions) {
+         filesystems[part.filesystem].push_back(fs::path(part.device).filename().string());
+     }
+     
+     std::cout << colorize("Filesystems:", Colors::BOLD) << '\n';
+     for (const auto& fs_type : filesystems) {
+         std::cout << "  " << std::left << std::setw(16) << (fs_type.first + ":") << '\n';
+         std::cout << "    ";
+         for (size_t i = 0; i < fs_type.second.size(); ++i) {
+             if (i > 0) std::cout << ", ";
+             std::cout << fs_type.second[i];
          }
+         std::cout << '\n';
+     }
+ }
+ 
+ bool DiskLsUtil::machineOutput() const {
+     return writer.format() != OutputFormat::TEXT;
+ }
+ 
+ void DiskLsUtil::writeDiskInfo() {
+     const auto& disks = this->disks();
+     
+     for (const auto& disk : disks) {
+         std::string name = fs::path(disk.device).filename().string();
+         writer.group("disk", "device", name);
+         writer.field("model", disk.model);
+         writer.field("vendor", disk.vendor);
+         writer.field("name", disk.label);
+         writer.field("type", disk.type);
+         writer.field("size_bytes", disk.size_bytes);
+         writer.field("removable", disk.removable);
+         writer.field("rotational", disk.rotational);
          
-         std::cout << colorize("Disk Types:", Colors::BOLD) << std::endl;
-         for (const auto& type : disk_types) {
-             std::cout << "  " << std::left << std::setw(16) << (type.first + ":") << std::endl;
-             std::cout << "    ";
-             for (size_t i = 0; i < type.second.size(); ++i) {
-                 if (i > 0) std::cout << ", ";
-                 std::cout << type.second[i];
+         if (show_detailed) {
+             writer.field("scheduler", disk.scheduler);
+             writer.field("write_cache", disk.write_cache);
+             writer.field("zoned", disk.zoned);
+             writer.field("queue_depth", disk.queue_depth);
+             writer.field("logical_block_size", disk.logical_block_size);
+             writer.field("physical_block_size", disk.physical_block_size);
+             writer.field("optimal_io_size", disk.optimal_io_size);
+             writer.field("discard_max_bytes", disk.discard_max_bytes);
+             writer.field("hw_queues", disk.hw_queues);
+             writer.field("io_poll", disk.io_poll);
+             writer.field("nr_zones", disk.nr_zones);
+             writer.field("command_timeout", disk.command_timeout);
+             if (disk.has_scsi_counters) {
+                 writer.counter("io_requests_total", disk.io_requests);
+                 writer.counter("io_done_total", disk.io_done);
+                 writer.counter("io_errors_total", disk.io_errors);
              }
-             std::cout << std::endl;
          }
+     }
+     
+     if (!show_smart) return;
+     for (const auto& disk : disks) {
+         if (disk.type != "NVMe" || !disk.health.valid) continue;
+         const NvmeHealth& health = disk.health;
+         writer.group("nvme_health", "device", fs::path(disk.device).filename().string());
+         writer.field("critical_warning", health.critical_warning);
+         writer.field("temperature_celsius", health.temperature_c);
+         writer.field("percentage_used", health.percentage_used);
+         writer.field("available_spare", health.available_spare);
+         writer.counter("media_errors_total", health.media_errors);
+         writer.counter("read_bytes_total", health.data_units_read * 512000);
+         writer.counter("written_bytes_total", health.data_units_written * 512000);
+         writer.counter("power_on_seconds_total", health.power_on_hours * 3600);
+         writer.counter("unsafe_shutdowns_total", health.unsafe_shutdowns);
+     }
+ }
+ 
+ // One row per device in the stack, with its neighbours by name
+ void DiskLsUtil::writeGraphInfo() {
+     const BlockGraph& graph = blockGraph();
+     
+     auto names = [&graph](const std::vector<int>& nodes) {
+         std::string list;
+         for (int node : nodes) {
+             if (!list.empty()) list += ',';
+             list += graph.nodes[node].name;
+         }
+         return list;
+     };
+     
+     for (const auto& node : graph.nodes) {
+         writer.group("block", "device", node.name);
+         writer.field("label", node.label);
+         writer.field("parent", node.parent >= 0 ? graph.nodes[node.parent].name : std::string());
+         writer.field("slaves", names(node.slaves));
+         writer.field("holders", names(node.holders));
+         writer.field("major", node.major);
+         writer.field("minor", node.minor);
+         writer.field("size_bytes", node.size_bytes);
+     }
+ }
+ 
+ // Mounts with their usage when -u is given; stale mounts have no sizes
+ void DiskLsUtil::writePartitionInfo() {
+     for (const auto& part : partitions(show_usage)) {
+         writer.group("filesystem", "mountpoint", part.mountpoint);
+         writer.field("device", part.device);
+         writer.field("fstype", part.filesystem);
+         if (show_mounts) {
+             writer.field("options", part.mount_options);
+             writer.field("root", part.root);
+             writer.field("major", part.major);
+             writer.field("minor", part.minor);
+         }
+         if (show_usage) {
+             writer.field("stale", part.stale);
+             if (!part.stale) {
+                 writer.field("size_bytes", part.total_bytes);
+                 writer.field("used_bytes", part.used_bytes);
+                 writer.field("available_bytes", part.available_bytes);
+                 writer.field("usage", part.usage_percent, 1);
+             }
+         }
+     }
+ }
+ 
+ void DiskLsUtil::writeProcesses() {
+     for (const auto& proc : top_processes) {
+         writer.group("process", "pid", proc.pid);
+         writer.field("name", proc.name);
+         writer.field("read_bytes_per_s", proc.read_rate, 0);
+         writer.field("write_bytes_per_s", proc.write_rate, 0);
+         writer.field("cmdline", proc.cmd);
+     }
+ }
+ 
+ void DiskLsUtil::writeCgroupInfo() {
+     openCgroup();
+     DiskStatsTable table;
+     sampler.cgroupIoStat(table);
+     
+     writer.group("cgroup");
+     writer.field("path", cgroup_spec);
+     char text[512];
+     double some, full;
+     if (cgroup_dir.read("io.pressure", text, sizeof(text)) > 0 && parsePressure(text, some, full)) {
+         writer.field("pressure_some", some);
+         writer.field("pressure_full", full);
+     }
+     
+     for (const auto& stat : table.rows) {
+         writer.group("cgroup_io", "device", stat.device);
+         writer.counter("read_bytes_total", stat.sectors_read * 512);
+         writer.counter("written_bytes_total", stat.sectors_written * 512);
+         writer.counter("reads_total", stat.reads_completed);
+         writer.counter("writes_total", stat.writes_completed);
+     }
+ }
+ 
+ // The sections selected on the command line as one --format sample.
+ // The -t summary is left out, as every disk and filesystem row
+ // already carries its type.
+ void DiskLsUtil::writeReport() {
+     writer.begin(wallClock());
+     
+     if (show_disks) writeDiskInfo();
+     if (show_graph) writeGraphInfo();
+     if (show_usage || show_mounts) writePartitionInfo();
+     if (cgroup_mode) writeCgroupInfo();
+     
+     if (cgroup_top > 0) {
+         std::string root = resolveCgroup(cgroup_mode ? cgroup_spec : "/");
+         for (const auto& usage : topCgroups(root, cgroup_top, cgroupIoMetric)) {
+             writer.group("cgroup_top", "cgroup", usage.path);
+             writer.counter("transferred_bytes_total", usage.value);
+         }
+     }
+     
+     if (show_processes) {
+         sampleProcesses();
+         writeProcesses();
+     }
+     
+     writer.end();
+ }
+ 
+ void DiskLsUtil::formatTimestamp(char* buf, size_t size) {
+     time_t now = replay_time > 0.0 ? static_cast<time_t>(replay_time) : time(nullptr);
+     struct tm local;
+     localtime_r(&now, &local);
+     strftime(buf, size, "%H:%M:%S", &local);
+ }
+ 
+ // Loop devices and ram disks are skipped, as in the disk listing
+ bool DiskLsUtil::watchedDevice(const DiskStats& stat) {
+     return stat.present && stat.device.compare(0, 4, "loop") != 0 &&
+            stat.device.compare(0, 3, "ram") != 0;
+ }
+ 
+ void DiskLsUtil::printWatchHeader() {
+     if (cgroup_mode) {
+         std::cout << colorize("TIME     DEVICE             r/s      w/s   rMB/s   wMB/s", Colors::BOLD) << '\n';
+         return;
+     }
+     std::cout << colorize("TIME     DEVICE             r/s      w/s   rMB/s   wMB/s  r_await  w_await  aqu-sz  %util",
+                           Colors::BOLD) << '\n';
+ }
+ 
+ IoRates DiskLsUtil::ioRates(const DiskStats& before, const DiskStats& stat, double elapsed) {
+     double elapsed_ms = elapsed * 1000.0;
+     
+     auto delta = [](unsigned long long a, unsigned long long b) {
+         return b >= a ? static_cast<double>(b - a) : 0.0;
+     };
+     double reads = delta(before.reads_completed, stat.reads_completed);
+     double writes = delta(before.writes_completed, stat.writes_completed);
+     double read_ms = delta(before.time_reading, stat.time_reading);
+     double write_ms = delta(before.time_writing, stat.time_writing);
+     double busy_ms = delta(before.time_io, stat.time_io);
+     double queue_ms = delta(before.weighted_time_io, stat.weighted_time_io);
+     
+     IoRates rates;
+     rates.reads = reads / elapsed;
+     rates.writes = writes / elapsed;
+     rates.read_mb = delta(before.sectors_read, stat.sectors_read) * 512.0 / (1024.0 * 1024.0) / elapsed;
+     rates.write_mb = delta(before.sectors_written, stat.sectors_written) * 512.0 / (1024.0 * 1024.0) / elapsed;
+     rates.read_await = reads > 0 ? read_ms / reads : 0.0;
+     rates.write_await = writes > 0 ? write_ms / writes : 0.0;
+     rates.queue_size = queue_ms / elapsed_ms;
+     rates.util = std::min(100.0, busy_ms / elapsed_ms * 100.0);
+     return rates;
+ }
+ 
+ void DiskLsUtil::printWatchRow(const char* timestamp, const std::string& device, const DiskStats& before,
+                                const DiskStats& stat, double elapsed) {
+     IoRates rates = ioRates(before, stat, elapsed);
+     
+     if (machineOutput()) {
+         writer.group("io", "device", device);
+         writer.field("reads_per_s", rates.reads, 1);
+         writer.field("writes_per_s", rates.writes, 1);
+         writer.field("read_bytes_per_s", rates.read_mb * 1048576.0, 0);
+         writer.field("write_bytes_per_s", rates.write_mb * 1048576.0, 0);
+         if (!cgroup_mode) {
+             writer.field("read_await_ms", rates.read_await);
+             writer.field("write_await_ms", rates.write_await);
+             writer.field("queue_size", rates.queue_size);
+             writer.field("util", rates.util, 1);
+         }
+         return;
+     }
+     
+     std::cout << std::left << std::setw(9) << timestamp
+               << std::setw(14) << device.substr(0, 13) << std::right
+               << std::fixed << std::setprecision(1)
+               << std::setw(8) << rates.reads
+               << std::setw(9) << rates.writes
+               << std::setprecision(2)
+               << std::setw(8) << rates.read_mb
+               << std::setw(8) << rates.write_mb;
+     if (cgroup_mode) {
+         std::cout << '\n';
+         return;
+     }
+     std::cout << std::setw(9) << rates.read_await
+               << std::setw(9) << rates.write_await
+               << std::setw(8) << rates.queue_size
+               << std::setprecision(1)
+               << std::setw(7) << rates.util
+               << '\n';
+ }
+ 
+ void DiskLsUtil::addStats(DiskStats& sum, const DiskStats& stat) {
+     sum.reads_completed += stat.reads_completed;
+     sum.reads_merged += stat.reads_merged;
+     sum.sectors_read += stat.sectors_read;
+     sum.time_reading += stat.time_reading;
+     sum.writes_completed += stat.writes_completed;
+     sum.writes_merged += stat.writes_merged;
+     sum.sectors_written += stat.sectors_written;
+     sum.time_writing += stat.time_writing;
+     sum.io_in_progress += stat.io_in_progress;
+     sum.time_io += stat.time_io;
+     sum.weighted_time_io += stat.weighted_time_io;
+ }
+ 
+ void DiskLsUtil::buildWatchStacks() {
+     BlockGraph graph = readBlockGraph();
+     
+     for (size_t i = 0; i < graph.nodes.size(); ++i) {
+         const BlockNode& node = graph.nodes[i];
+         if (node.slaves.empty() || !node.holders.empty()) continue;
          
-         std::cout << std::endl;
-         
-         // Group filesystems
-         std::map<std::string, std::vector<std::string>> filesystems;
-         for (const auto& part : partitions) {
-             filesystems[part.filesystem].push_back(fs::path(part.device).filename().string());
+         WatchStack stack;
+         stack.label = node.name + ":disks";
+         for (int disk : backingDisks(graph, i)) {
+             stack.disks.emplace_back(graph.nodes[disk].major, graph.nodes[disk].minor);
          }
+         watch_stacks.push_back(std::move(stack));
+     }
+ }
+ 
+ // One line per device with rates from the counter deltas, each prefixed
+ // with the time so lines can be shipped independently. With --graph,
+ // each top-level stacked device is followed by the summed load of the
+ // disks under it, so logical and physical I/O can be compared.
+ void DiskLsUtil::printWatchTick(const DiskStatsTable& prev, const DiskStatsTable& cur, double elapsed) {
+     char timestamp[16];
+     formatTimestamp(timestamp, sizeof(timestamp));
+     if (machineOutput()) writer.begin(replay_time > 0.0 ? replay_time : wallClock());
+     
+     for (const auto& stat : cur.rows) {
+         if (!watchedDevice(stat)) continue;
+         const DiskStats* before = prev.find(stat.major, stat.minor);
+         if (!before || !before->present) continue;
          
-         std::cout << colorize("Filesystems:", Colors::BOLD) << std::endl;
-         for (const auto& fs_type : filesystems) {
-             std::cout << "  " << std::left << std::setw(16) << (fs_type.first + ":") << std::endl;
-             std::cout << "    ";
-             for (size_t i = 0; i < fs_type.second.size(); ++i) {
-                 if (i > 0) std::cout << ", ";
-                 std::cout << fs_type.second[i];
-             }
-             std::cout << std::endl;
+         printWatchRow(timestamp, stat.device, *before, stat, elapsed);
+     }
+     
+     for (const auto& stack : watch_stacks) {
+         DiskStats before_sum, cur_sum;
+         for (const auto& dev : stack.disks) {
+             const DiskStats* before = prev.find(dev.first, dev.second);
+             const DiskStats* stat = cur.find(dev.first, dev.second);
+             if (!before || !stat || !before->present || !stat->present) continue;
+             addStats(before_sum, *before);
+             addStats(cur_sum, *stat);
          }
+         printWatchRow(timestamp, stack.label, before_sum, cur_sum, elapsed);
      }
+     
+     if (machineOutput()) writer.end();
+ }
  
- public:
-     DiskLsUtil() {
-         // Check if output is terminal for color support
-         use_colors = isatty(STDOUT_FILENO);
+ // --history: keep the await and utilization of every device watched at
+ // the first sample and redraw sparklines of them after each tick
+ void DiskLsUtil::printHistoryTick(SampleHistory& history, const DiskStatsTable& prev, const DiskStatsTable& cur,
+                                   double elapsed, long tick) {
+     std::vector<float>& record = history_record;
+     record.assign(history.width(), 0.0f);
+     
+     for (size_t i = 0; i < history_devices.size(); ++i) {
+         const DiskStats* before = prev.find(history_devices[i].first, history_devices[i].second);
+         const DiskStats* stat = cur.find(history_devices[i].first, history_devices[i].second);
+         if (!before || !stat || !before->present || !stat->present) continue;
+         
+         IoRates rates = ioRates(*before, *stat, elapsed);
+         double requests = rates.reads + rates.writes;
+         record[2 * i] = requests > 0 ? (rates.read_await * rates.reads + rates.write_await * rates.writes) / requests : 0.0;
+         record[2 * i + 1] = rates.util;
      }
+     history.push(record.data());
+     
+     if (stdoutIsTerminal()) {
+         std::cout << "\033[H\033[J";
+     } else if (tick > 0) {
+         std::cout << '\n';
+     }
+     std::string samples = " (" + std::to_string(history.size()) + " of " + std::to_string(history.capacity()) + " samples)";
+     printHistory(history, history_await, "AWAIT MS" + samples, 60, use_colors);
+     std::cout << '\n';
+     printHistory(history, history_util, "UTIL %" + samples, 60, use_colors);
+ }
  
-     void parseArgs(int argc, char* argv[]) {
-         for (int i = 1; i < argc; ++i) {
-             std::string arg = argv[i];
-             
-             if (arg == "--help" || arg == "-h") {
-                 printHelp();
-                 exit(0);
-             } else if (arg == "--version" || arg == "-V") {
-                 printVersion();
-                 exit(0);
-             } else if (arg == "--detailed" || arg == "-d") {
-                 show_detailed = true;
-             } else if (arg == "--usage" || arg == "-u") {
-                 show_usage = true;
-             } else if (arg == "--mounts" || arg == "-m") {
-                 show_mounts = true;
-             } else if (arg == "--types" || arg == "-t") {
-                 show_types = true;
-             } else if (arg == "--all" || arg == "-a") {
-                 show_detailed = show_usage = show_mounts = show_types = true;
-             } else if (arg == "--no-color") {
-                 use_colors = false;
-             } else {
-                 std::cerr << colorize("diskls: invalid option -- '" + arg + "'", Colors::RED) << std::endl;
-                 std::cerr << "Try 'diskls --help' for more information." << std::endl;
-                 exit(1);
-             }
+ void DiskLsUtil::recordSample(const DiskStatsTable& table) {
+     if (!recorder.isOpen()) return;
+     recorder.beginSample(wallClock());
+     recorder.addDisks(table);
+     if (!recorder.endSample()) {
+         throw std::runtime_error("cannot write " + record_path + ": " + std::strerror(errno));
+     }
+ }
+ 
+ // --replay: print the ticks of a --record file with their recorded
+ // times, as fast as they decode
+ void DiskLsUtil::printReplay() {
+     SampleReader reader;
+     if (!reader.open(replay_path.c_str())) {
+         throw std::runtime_error("cannot replay " + replay_path + ": " +
+                                  (errno == EINVAL ? "not a recording" : std::strerror(errno)));
+     }
+     if (!machineOutput()) printWatchHeader();
+     
+     // Samples are swapped like the live tables, so the decoder reuses them
+     RecordedSample prev, cur;
+     bool have_prev = false;
+     long shown = 0;
+     while ((watch_count == 0 || shown < watch_count) && reader.next(cur)) {
+         if (!cur.has_disks) continue;
+         
+         // Samples from different recording sessions are not compared
+         if (have_prev && !cur.restarted) {
+             replay_time = cur.timestamp;
+             printWatchTick(prev.disks, cur.disks, cur.timestamp - prev.timestamp);
+             shown++;
          }
+         std::swap(prev, cur);
+         have_prev = true;
+     }
+     std::cout.flush();
+     replay_time = 0.0;
+     
+     if (reader.truncated()) {
+         std::cerr << colorize("diskls: " + replay_path + " ends in an incomplete sample", Colors::YELLOW) << '\n';
      }
+ }
  
-     void printVersion() {
-         std::cout << "diskls (QCO InfoUtils) 1.0" << std::endl;
-         std::cout << "Copyright (C) 2025 AnmiTaliDev" << std::endl;
-         std::cout << "License Apache 2.0: Apache License version 2.0" << std::endl;
-         std::cout << "This is free software: you are free to change and redistribute it." << std::endl;
-         std::cout << "There is NO WARRANTY, to the extent permitted by law." << std::endl;
-     }
- 
-     void printHelp() {
-         std::cout << "Usage: diskls [OPTION]..." << std::endl;
-         std::cout << "Display information about system disks and storage." << std::endl;
-         std::cout << std::endl;
-         std::cout << "  -a, --all         display all available information" << std::endl;
-         std::cout << "  -d, --detailed    show detailed disk information" << std::endl;
-         std::cout << "  -h, --help        display this help and exit" << std::endl;
-         std::cout << "  -m, --mounts      show mount point information" << std::endl;
-         std::cout << "      --no-color    disable colored output" << std::endl;
-         std::cout << "  -t, --types       show disk types and filesystems" << std::endl;
-         std::cout << "  -u, --usage       show disk space usage" << std::endl;
-         std::cout << "  -V, --version     output version information and exit" << std::endl;
-         std::cout << std::endl;
-         std::cout << "Examples:" << std::endl;
-         std::cout << "  diskls            Show basic disk information" << std::endl;
-         std::cout << "  diskls -a         Show comprehensive disk report" << std::endl;
-         std::cout << "  diskls -u         Show disk usage information" << std::endl;
-         std::cout << std::endl;
-         std::cout << "QCO InfoUtils home page: <https://github.com/Qainar-Projects/infoutils>" << std::endl;
-     }
- 
-     void run() {
-         printDiskInfo();
+ // Process watch: the busiest processes of every interval, redrawn in
+ // place on a terminal like iotop
+ void DiskLsUtil::printProcessWatch() {
+     startProcessSampler();
+     if (!record_path.empty()) {
+         throw std::runtime_error("--record only records device counters, not -p watch output");
+     }
+     process_sampler.sample(process_sort, 15, top_processes);
+     bool redraw = stdoutIsTerminal() && !machineOutput();
+     
+     struct timespec deadline;
+     clock_gettime(CLOCK_MONOTONIC, &deadline);
+     
+     for (long tick = 0; watch_count == 0 || tick < watch_count; ++tick) {
+         waitForNextTick(deadline, watch_interval);
+         if (!process_sampler.sample(process_sort, 15, top_processes)) {
+             throw std::runtime_error(std::string("cannot list /proc: ") + std::strerror(errno));
+         }
          
-         if (show_usage) {
-             printUsageInfo();
+         if (machineOutput()) {
+             writer.begin(wallClock());
+             writeProcesses();
+             writer.end();
+             std::cout.flush();
+             continue;
          }
          
-         if (show_mounts) {
-             printMountInfo();
+         if (redraw) {
+             std::cout << "\033[H\033[J";
+         } else if (tick > 0) {
+             std::cout << '\n';
+         }
+         char timestamp[16];
+         formatTimestamp(timestamp, sizeof(timestamp));
+         std::cout << colorize(std::string(timestamp) + "  " + std::to_string(process_sampler.processCount()) +
+                               " processes", Colors::BOLD) << '\n';
+         printProcessTable();
+         std::cout.flush();
+     }
+ }
+ 
+ // Sample /proc/diskstats every watch_interval seconds and report
+ // iostat-style per-device throughput, latency and utilization
+ void DiskLsUtil::printWatch() {
+     if (show_processes) {
+         printProcessWatch();
+         return;
+     }
+     
+     // Tables are swapped between ticks so steady-state sampling reuses them
+     DiskStatsTable prev, cur;
+     if (cgroup_mode) {
+         openCgroup();
+         sampler.cgroupIoStat(cur);
+     } else if (!sampler.diskStats(cur)) {
+         throw std::runtime_error(std::string("cannot read /proc/diskstats: ") + std::strerror(errno));
+     }
+     
+     if (show_graph && !cgroup_mode) buildWatchStacks();
+     
+     // A recording starts with a full sample to take deltas from
+     if (!record_path.empty()) {
+         if (!recorder.open(record_path.c_str())) {
+             throw std::runtime_error("cannot record to " + record_path + ": " +
+                                      (errno == EINVAL ? "not a recording" : std::strerror(errno)));
          }
+         recordSample(cur);
+     }
+     
+     // The devices charted by --history are fixed at the first sample
+     std::unique_ptr<SampleHistory> history;
+     if (history_size > 0 && !machineOutput()) {
+         for (const auto& stat : cur.rows) {
+             if (!watchedDevice(stat)) continue;
+             size_t column = 2 * history_devices.size();
+             history_devices.emplace_back(stat.major, stat.minor);
+             history_await.emplace_back(stat.device, column, 0.0, 2);
+             history_util.emplace_back(stat.device, column + 1, 100.0);
+         }
+         history.reset(new SampleHistory(history_size, 2 * history_devices.size()));
+     }
+     
+     struct timespec prev_time;
+     clock_gettime(CLOCK_MONOTONIC, &prev_time);
+     
+     if (!machineOutput() && !history) {
+         printWatchHeader();
+         std::cout.flush();
+     }
+     
+     struct timespec deadline = prev_time;
+     for (long tick = 0; watch_count == 0 || tick < watch_count; ++tick) {
+         waitForNextTick(deadline, watch_interval);
+         
+         std::swap(prev, cur);
+         if (cgroup_mode) {
+             sampler.cgroupIoStat(cur);
+         } else {
+             sampler.diskStats(cur);
+         }
+         recordSample(cur);
+         
+         struct timespec now;
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         double elapsed = (now.tv_sec - prev_time.tv_sec) + (now.tv_nsec - prev_time.tv_nsec) / 1e9;
+         prev_time = now;
+         
+         if (history) {
+             printHistoryTick(*history, prev, cur, elapsed, tick);
+         } else {
+             printWatchTick(prev, cur, elapsed);
+         }
+         std::cout.flush();
+     }
+ }
+ 
+ // Naming a section leaves out every section that isn't named,
+ // along with the files only those sections read
+ bool DiskLsUtil::selectSection(const std::string& name) {
+     if (!sections_named) {
+         sections_named = true;
+         show_disks = false;
+     }
+     
+     if (name == "disks") show_disks = true;
+     else if (name == "graph") show_graph = true;
+     else if (name == "usage") show_usage = true;
+     else if (name == "mounts") show_mounts = true;
+     else if (name == "types") show_types = true;
+     else if (name == "cgroup") cgroup_mode = true;
+     else if (name == "processes") show_processes = true;
+     else return false;
+     return true;
+ }
+ 
+ DiskLsUtil::DiskLsUtil() {
+     // Check if output is terminal for color support
+     use_colors = stdoutIsTerminal();
+ }
+ 
+ void DiskLsUtil::parseArgs(int argc, char* argv[]) {
+     for (int i = 1; i < argc; ++i) {
+         std::string arg = argv[i];
          
-         if (show_types) {
-             printTypeInfo();
+         if (arg == "--help" || arg == "-h") {
+             printHelp();
+             exit(0);
+         } else if (arg == "--version" || arg == "-V") {
+             printVersion();
+             exit(0);
+         } else if (arg == "--detailed" || arg == "-d") {
+             show_detailed = true;
+         } else if (arg == "--usage" || arg == "-u") {
+             show_usage = true;
+         } else if (arg == "--mounts" || arg == "-m") {
+             show_mounts = true;
+         } else if (arg == "--types" || arg == "-t") {
+             show_types = true;
+         } else if (arg == "--graph" || arg == "-g") {
+             show_graph = true;
+         } else if (arg == "--smart" || arg == "-s") {
+             show_smart = true;
+         } else if (arg == "--all" || arg == "-a") {
+             show_detailed = show_usage = show_mounts = show_types = show_graph = true;
+         } else if (arg == "--processes" || arg == "-p") {
+             show_processes = true;
+         } else if (arg == "--events") {
+             process_events = show_processes = true;
+         } else if (arg == "--sort" || arg == "-S" || arg.rfind("--sort=", 0) == 0) {
+             std::string value = optionValue("diskls", argc, argv, i, arg, "sort", use_colors);
+             if (value == "io") process_sort = PROCESS_IO;
+             else if (value == "read") process_sort = PROCESS_READ;
+             else if (value == "write") process_sort = PROCESS_WRITE;
+             else invalidValue("diskls", "sort key", value, use_colors);
+             show_processes = true;
+         } else if (arg == "--jobs" || arg == "-j" || arg.rfind("--jobs=", 0) == 0) {
+             std::string value = optionValue("diskls", argc, argv, i, arg, "jobs", use_colors);
+             char* end = nullptr;
+             long jobs = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || jobs < 1 || jobs > 64) {
+                 invalidValue("diskls", "jobs", value, use_colors);
+             }
+             statvfs_jobs = jobs;
+         } else if (arg == "--fs-type" || arg == "-F" || arg.rfind("--fs-type=", 0) == 0) {
+             mount_filter.include(optionValue("diskls", argc, argv, i, arg, "fs-type", use_colors));
+         } else if (arg == "--exclude-type" || arg == "-x" || arg.rfind("--exclude-type=", 0) == 0) {
+             mount_filter.exclude(optionValue("diskls", argc, argv, i, arg, "exclude-type", use_colors));
+         } else if (arg == "--timeout" || arg == "-T" || arg.rfind("--timeout=", 0) == 0) {
+             std::string value = optionValue("diskls", argc, argv, i, arg, "timeout", use_colors);
+             char* end = nullptr;
+             statvfs_timeout = std::strtod(value.c_str(), &end);
+             if (value.empty() || *end != '\0' || !(statvfs_timeout > 0.0)) {
+                 invalidValue("diskls", "timeout", value, use_colors);
+             }
+         } else if (arg == "--watch" || arg == "-w") {
+             watch_mode = true;
+         } else if (arg == "--interval" || arg == "-i" || arg.rfind("--interval=", 0) == 0) {
+             std::string value = optionValue("diskls", argc, argv, i, arg, "interval", use_colors);
+             char* end = nullptr;
+             watch_interval = std::strtod(value.c_str(), &end);
+             if (value.empty() || *end != '\0' || !(watch_interval >= 0.01)) {
+                 invalidValue("diskls", "interval", value, use_colors);
+             }
+             watch_mode = true;
+         } else if (arg == "--count" || arg == "-c" || arg.rfind("--count=", 0) == 0) {
+             std::string value = optionValue("diskls", argc, argv, i, arg, "count", use_colors);
+             char* end = nullptr;
+             watch_count = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || watch_count <= 0) {
+                 invalidValue("diskls", "count", value, use_colors);
+             }
+             watch_mode = true;
+         } else if (arg == "--cgroup" || arg == "-C" || arg.rfind("--cgroup=", 0) == 0) {
+             // The path is optional, so it is only taken from --cgroup=PATH
+             cgroup_mode = true;
+             if (arg.find('=') != std::string::npos) cgroup_spec = arg.substr(arg.find('=') + 1);
+         } else if (arg == "--cgroup-top" || arg == "-G" || arg.rfind("--cgroup-top=", 0) == 0) {
+             std::string value = optionValue("diskls", argc, argv, i, arg, "cgroup-top", use_colors);
+             char* end = nullptr;
+             long top = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || top < 1 || top > 10000) {
+                 invalidValue("diskls", "cgroup count", value, use_colors);
+             }
+             cgroup_top = top;
+         } else if (arg == "--history" || arg.rfind("--history=", 0) == 0) {
+             // The sample count is optional, so it is only taken from --history=N
+             history_size = 600;
+             if (arg.find('=') != std::string::npos) {
+                 std::string value = arg.substr(arg.find('=') + 1);
+                 char* end = nullptr;
+                 long size = std::strtol(value.c_str(), &end, 10);
+                 if (value.empty() || *end != '\0' || size < 2 || size > 1000000) {
+                     invalidValue("diskls", "history size", value, use_colors);
+                 }
+                 history_size = size;
+             }
+             watch_mode = true;
+         } else if (arg == "--record" || arg.rfind("--record=", 0) == 0) {
+             record_path = optionValue("diskls", argc, argv, i, arg, "record", use_colors);
+             watch_mode = true;
+         } else if (arg == "--replay" || arg.rfind("--replay=", 0) == 0) {
+             replay_path = optionValue("diskls", argc, argv, i, arg, "replay", use_colors);
+         } else if (arg == "--format" || arg.rfind("--format=", 0) == 0) {
+             std::string value = optionValue("diskls", argc, argv, i, arg, "format", use_colors);
+             OutputFormat format;
+             if (!parseOutputFormat(value, format)) {
+                 invalidValue("diskls", "format", value, use_colors);
+             }
+             writer.setFormat(format);
+         } else if (arg == "--stats") {
+             enableStats();
+         } else if (arg == "--root" || arg.rfind("--root=", 0) == 0) {
+             std::string value = optionValue("diskls", argc, argv, i, arg, "root", use_colors);
+             if (value.empty() || !setSystemRoot(value)) {
+                 invalidValue("diskls", "root directory", value, use_colors);
+             }
+         } else if (arg == "--no-color") {
+             use_colors = false;
+         } else if (!arg.empty() && arg[0] != '-') {
+             if (!selectSection(arg)) invalidValue("diskls", "section", arg, use_colors);
+         } else {
+             std::cerr << colorize("diskls: invalid option -- '" + arg + "'", Colors::RED) << '\n';
+             std::cerr << "Try 'diskls --help' for more information." << '\n';
+             exit(1);
          }
      }
- };
+ }
+ 
+ void DiskLsUtil::printVersion() {
+     std::cout << "diskls (QCO InfoUtils) 1.0" << '\n';
+     std::cout << "Copyright (C) 2025 AnmiTaliDev" << '\n';
+     std::cout << "License Apache 2.0: Apache License version 2.0" << '\n';
+     std::cout << "This is free software: you are free to change and redistribute it." << '\n';
+     std::cout << "There is NO WARRANTY, to the extent permitted by law." << '\n';
+ }
+ 
+ void DiskLsUtil::printHelp() {
+     std::cout << "Usage: diskls [OPTION]... [SECTION]..." << '\n';
+     std::cout << "Display information about system disks and storage." << '\n';
+     std::cout << '\n';
+     std::cout << "  -a, --all         display all available information" << '\n';
+     std::cout << "  -c, --count N     stop watch mode after N samples" << '\n';
+     std::cout << "  -C, --cgroup[=P]  show I/O of cgroup v2 P (default: own cgroup); with -w," << '\n';
+     std::cout << "                    report its per-device rates instead of the host's" << '\n';
+     std::cout << "  -d, --detailed    show detailed disk information" << '\n';
+     std::cout << "      --events      follow processes with the kernel's fork and exec events" << '\n';
+     std::cout << "                    rather than listing /proc for each sample (needs" << '\n';
+     std::cout << "                    CAP_NET_ADMIN; implies -p)" << '\n';
+     std::cout << "  -F, --fs-type T   only list filesystems of the comma-separated types T" << '\n';
+     std::cout << "      --format=FMT  print text (default), json, prom or tsv records" << '\n';
+     std::cout << "  -g, --graph       show how dm, md and multipath devices stack on disks" << '\n';
+     std::cout << "  -G, --cgroup-top N" << '\n';
+     std::cout << "                    rank the N cgroups that transferred the most bytes" << '\n';
+     std::cout << "  -h, --help        display this help and exit" << '\n';
+     std::cout << "      --history[=N] keep the last N samples (default: 600) of each device's" << '\n';
+     std::cout << "                    await and utilization and redraw them as sparklines" << '\n';
+     std::cout << "  -i, --interval N  sample every N seconds (implies --watch)" << '\n';
+     std::cout << "  -j, --jobs N      query devices and filesystem usage with N threads" << '\n';
+     std::cout << "  -m, --mounts      show mount point information" << '\n';
+     std::cout << "      --no-color    disable colored output" << '\n';
+     std::cout << "  -p, --processes   show the processes that read and wrote the most in one" << '\n';
+     std::cout << "                    second (needs root for other users'); with -w, redraw" << '\n';
+     std::cout << "                    them every interval" << '\n';
+     std::cout << "      --record FILE append the raw counters of every watch sample to FILE" << '\n';
+     std::cout << "      --replay FILE print the watch output of a recording made with --record" << '\n';
+     std::cout << "      --root DIR    read /proc, /sys and /etc under DIR, such as the host's /" << '\n';
+     std::cout << "                    mounted into a container" << '\n';
+     std::cout << "  -s, --smart       read the NVMe SMART health log (needs root)" << '\n';
+     std::cout << "  -S, --sort KEY    rank processes by io, read or write bytes (implies -p)" << '\n';
+     std::cout << "      --stats       print the time and system calls of each collector on exit" << '\n';
+     std::cout << "  -t, --types       show disk types and filesystems" << '\n';
+     std::cout << "  -T, --timeout N   report mounts as stale after N seconds" << '\n';
+     std::cout << "  -u, --usage       show disk space usage" << '\n';
+     std::cout << "  -V, --version     output version information and exit" << '\n';
+     std::cout << "  -w, --watch       report per-device IOPS, throughput and latency" << '\n';
+     std::cout << "  -x, --exclude-type T" << '\n';
+     std::cout << "                    skip filesystems of the comma-separated types T" << '\n';
+     std::cout << '\n';
+     std::cout << "Naming SECTIONs (disks, graph, usage, mounts, types, cgroup, processes)" << '\n';
+     std::cout << "shows only those, and reads only the files they need." << '\n';
+     std::cout << '\n';
+     std::cout << "Examples:" << '\n';
+     std::cout << "  diskls            Show basic disk information" << '\n';
+     std::cout << "  diskls -a         Show comprehensive disk report" << '\n';
+     std::cout << "  diskls -u         Show disk usage information" << '\n';
+     std::cout << "  diskls usage      Show only the disk usage" << '\n';
+     std::cout << "  diskls -i 0.5     Show disk activity every half second" << '\n';
+     std::cout << "  diskls --history  Chart the last 10 minutes of disk latency and load" << '\n';
+     std::cout << "  diskls -w -S write" << '\n';
+     std::cout << "                    Show which processes write the most, like iotop" << '\n';
+     std::cout << "  diskls -i 1 --record disk.rec" << '\n';
+     std::cout << "                    Record disk counters every second for later replay" << '\n';
+     std::cout << "  diskls -u --format=prom" << '\n';
+     std::cout << "                    Print filesystem usage as Prometheus metrics" << '\n';
+     std::cout << '\n';
+     std::cout << "QCO InfoUtils home page: <https://github.com/Qainar-Projects/infoutils>" << '\n';
+ }
+ 
+ void DiskLsUtil::run() {
+     if (!replay_path.empty()) {
+         printReplay();
+         return;
+     }
+     
+     if (watch_mode) {
+         printWatch();
+         return;
+     }
+     
+     if (machineOutput()) {
+         writeReport();
+         return;
+     }
+     
+     if (show_disks) {
+         printDiskInfo();
+     }
+     
+     if (show_graph) {
+         printGraphInfo();
+     }
+     
+     if (show_usage) {
+         printUsageInfo();
+     }
+     
+     if (show_mounts) {
+         printMountInfo();
+     }
+     
+     if (show_types) {
+         printTypeInfo();
+     }
+     
+     if (cgroup_mode) {
+         printCgroupInfo();
+     }
+     
+     if (cgroup_top > 0) {
+         printCgroupTop();
+     }
+     
+     if (show_processes) {
+         printProcesses();
+     }
+ }
  
- int main(int argc, char* argv[]) {
+ INFOUTILS_MAIN(diskls) {
      try {
          DiskLsUtil util;
          util.parseArgs(argc, argv);
          util.run();
+         if (statsEnabled()) printStats("diskls");
          return 0;
      } catch (const std::exception& e) {
-         std::cerr << "diskls: " << e.what() << std::endl;
+         std::cerr << "diskls: " << e.what() << '\n';
          return 1;
      }
  }
\ No newline at end of file
@@ -10,82 +10,39 @@
  
  #include <string>
  #include <vector>
- #include <map>
+ #include <utility>
  
- // Forward declarations
- struct DiskInfo;
- struct PartitionInfo;
- struct DiskStats;
- 
- // ANSI Color codes namespace
- namespace Colors {
-     extern const std::string RESET;
-     extern const std::string BOLD;
-     extern const std::string RED;
-     extern const std::string GREEN;
-     extern const std::string YELLOW;
-     extern const std::string BLUE;
-     extern const std::string MAGENTA;
-     extern const std::string CYAN;
-     extern const std::string WHITE;
-     extern const std::string DIM;
- }
+ #include "format.hpp"
+ #include "disk.hpp"
+ #include "sysfs.hpp"
+ #include "history.hpp"
+ #include "record.hpp"
+ #include "process.hpp"
  
  /**
-  * Structure to hold disk information from /sys/block/
+  * Top-level stacked device reported with --graph in watch mode, with the
+  * whole disks it is built on so their counters can be summed each tick
   */
- struct DiskInfo {
-     std::string device;
-     std::string model;
-     std::string vendor;
-     std::string type; // HDD/SSD/NVMe
-     unsigned long long size_bytes;
-     std::string size_human;
-     bool removable;
-     bool rotational;
-     std::string scheduler;
-     unsigned int queue_depth;
-     std::vector<std::string> partitions;
- 
-     DiskInfo() : size_bytes(0), removable(false), rotational(true), queue_depth(0) {}
+ struct WatchStack {
+     std::string label;
+     std::vector<std::pair<unsigned int, unsigned int>> disks;   // major:minor
  };
  
  /**
-  * Structure to hold partition information from /proc/mounts
+  * iostat-style rates of one device between two diskstats samples
   */
- struct PartitionInfo {
-     std::string device;
-     std::string mountpoint;
-     std::string filesystem;
-     unsigned long long total_bytes;
-     unsigned long long used_bytes;
-     unsigned long long available_bytes;
-     double usage_percent;
-     std::string mount_options;
- 
-     PartitionInfo() : total_bytes(0), used_bytes(0), available_bytes(0), usage_percent(0.0) {}
- };
- 
- /**
-  * Structure to hold disk statistics from /proc/diskstats
-  */
- struct DiskStats {
-     std::string device;
-     unsigned long long reads_completed;
-     unsigned long long reads_merged;
-     unsigned long long sectors_read;
-     unsigned long long time_reading;
-     unsigned long long writes_completed;
-     unsigned long long writes_merged;
-     unsigned long long sectors_written;
-     unsigned long long time_writing;
-     unsigned long long io_in_progress;
-     unsigned long long time_io;
-     unsigned long long weighted_time_io;
- 
-     DiskStats() : reads_completed(0), reads_merged(0), sectors_read(0), time_reading(0),
-                   writes_completed(0), writes_merged(0), sectors_written(0), time_writing(0),
-                   io_in_progress(0), time_io(0), weighted_time_io(0) {}
+ struct IoRates {
+     double reads;            // Per second
+     double writes;
+     double read_mb;          // MiB per second
+     double write_mb;
+     double read_await;       // Milliseconds per request
+     double write_await;
+     double queue_size;       // Average requests in flight
+     double util;             // Percent of time busy
+     
+     IoRates() : reads(0.0), writes(0.0), read_mb(0.0), write_mb(0.0), read_await(0.0),
+                 write_await(0.0), queue_size(0.0), util(0.0) {}
  };
  
  /**
@@ -93,12 +50,58 @@
   */
  class DiskLsUtil {
  private:
-     // Configuration flags
-     bool show_detailed;
-     bool show_usage;
-     bool show_mounts;
-     bool show_types;
-     bool use_colors;
+     bool show_disks = true;       // The /sys/block table
+     bool sections_named = false;  // A SECTION argument was given
+     bool show_detailed = false;
+     bool show_usage = false;
+     bool show_mounts = false;
+     bool show_types = false;
+     bool use_colors = true;
+     bool watch_mode = false;
+     bool show_graph = false;
+     bool show_smart = false;      // Read NVMe health logs with an admin ioctl
+     double watch_interval = 1.0;  // Seconds between watch samples
+     long watch_count = 0;         // Samples to print, 0 for unlimited
+     int statvfs_jobs = 4;         // Worker threads for device probing and filesystem usage
+     double statvfs_timeout = 2.0;  // Seconds before a mount is reported stale
+     MountFilter mount_filter;     // --fs-type and --exclude-type
+     
+     // /proc/diskstats, /proc/self/mountinfo and io.stat, kept open between samples
+     DiskSampler sampler;
+     
+     // --format=json|prom|tsv output, reused for every sample
+     RecordWriter writer{"diskls"};
+     std::vector<WatchStack> watch_stacks;  // Filled from the device graph with --graph
+     bool cgroup_mode = false;     // Report a cgroup v2 cgroup instead of the host
+     std::string cgroup_spec;      // --cgroup=PATH, empty for our own cgroup
+     size_t cgroup_top = 0;        // Cgroups ranked with --cgroup-top, 0 for none
+     size_t history_size = 0;      // Samples kept for --history, 0 without it
+     std::vector<std::pair<unsigned, unsigned>> history_devices;  // major:minor of each column pair
+     std::vector<HistorySeries> history_await, history_util;
+     std::vector<float> history_record;
+     SysfsDir cgroup_dir;
+     
+     // --processes: the processes that read and wrote most between two samples
+     bool show_processes = false;
+     ProcessMetric process_sort = PROCESS_IO;
+     ProcessSampler process_sampler{PROCESS_FILE_IO};
+     std::vector<ProcessActivity> top_processes;
+     bool process_events = false;  // --events
+     
+     // --record FILE and --replay FILE
+     std::string record_path;
+     std::string replay_path;
+     SampleRecorder recorder;
+     double replay_time = 0.0;     // Time of the replayed sample, 0 when sampling live
+     
+     // Sources shared by several sections, each read on first use
+     std::vector<DiskInfo> disk_cache;
+     std::vector<PartitionInfo> partition_cache;
+     BlockGraph graph_cache;
+     bool disks_read = false;
+     bool partitions_read = false;
+     bool partition_usage_read = false;
+     bool graph_read = false;
  
      /**
       * Apply color formatting to text if colors are enabled
@@ -109,30 +112,40 @@
      std::string colorize(const std::string& text, const std::string& color);
  
      /**
-      * Format bytes with human-readable units (B, KB, MB, GB, TB, PB)
-      * @param bytes Size in bytes
-      * @return Formatted string with appropriate unit
-      */
-     std::string formatBytes(unsigned long long bytes);
- 
-     /**
-      * Read disk information from /sys/block/
+      * Read disk information from /sys/block/, statvfs_jobs devices at a time
       * @return Vector of DiskInfo structures with disk details
       */
      std::vector<DiskInfo> getDiskInfo();
- 
+     
      /**
-      * Read partition information from /proc/mounts
-      * @return Vector of PartitionInfo structures with mount information
+      * Read the mounts of /proc/self/mountinfo that pass mount_filter
+      * @param with_usage Also query space usage with statvfs
+      * @return Mounts in mount order
       */
-     std::vector<PartitionInfo> getPartitionInfo();
- 
+     std::vector<PartitionInfo> getPartitionInfo(bool with_usage = false);
+     
+     /**
+      * Disks of getDiskInfo(), read on first use
+      */
+     const std::vector<DiskInfo>& disks();
+     
+     /**
+      * Partitions of getPartitionInfo(), read on first use; partitions
+      * read with usage also serve callers that need none
+      * @param with_usage Whether usage is needed
+      */
+     const std::vector<PartitionInfo>& partitions(bool with_usage = false);
+     
      /**
-      * Read disk statistics from /proc/diskstats
-      * @return Map of device names to DiskStats structures
+      * The block device graph, read on first use
       */
-     std::map<std::string, DiskStats> getDiskStats();
+     const BlockGraph& blockGraph();
  
+     /**
+      * Open the cgroup selected by --cgroup and keep its io.stat open
+      */
+     void openCgroup();
+     
      /**
       * Print section separator with optional title
       * @param title Optional section title
@@ -144,6 +157,72 @@
       */
      void printDiskInfo();
  
+     /**
+      * Print the NVMe health log of a disk
+      * @param health Log read with --smart
+      */
+     void printHealthInfo(const NvmeHealth& health);
+     
+     /**
+      * Print comma-separated node names followed by a newline
+      * @param graph Device graph
+      * @param nodes Node indices
+      */
+     static void printNodeList(const BlockGraph& graph, const std::vector<int>& nodes);
+     
+     /**
+      * Print slaves, backing disks and holders of a device in the -d listing
+      * @param graph Device graph
+      * @param index Device node
+      */
+     void printStackInfo(const BlockGraph& graph, int index);
+     
+     /**
+      * Print a node and, indented below it, its partitions and holders
+      * @param graph Device graph
+      * @param index Node to print
+      * @param depth Indentation level
+      */
+     void printGraphNode(const BlockGraph& graph, int index, int depth);
+     
+     /**
+      * Display the device stack from the physical disks up
+      */
+     void printGraphInfo();
+ 
+     /**
+      * Display per-device I/O of the --cgroup cgroup and its I/O pressure
+      */
+     void printCgroupInfo();
+     
+     /**
+      * Display the cgroups that transferred the most bytes
+      */
+     void printCgroupTop();
+     
+     /**
+      * With --events, switch process_sampler to the kernel's process
+      * events, or warn that it keeps scanning /proc
+      */
+     void startProcessSampler();
+     
+     /**
+      * Rank the processes by the bytes they read and wrote over one
+      * interval into top_processes
+      * @throws std::runtime_error if /proc cannot be listed
+      */
+     void sampleProcesses();
+     
+     /**
+      * Print top_processes with their read and write rates
+      */
+     void printProcessTable();
+     
+     /**
+      * Display the processes that read and wrote the most in one interval
+      */
+     void printProcesses();
+ 
      /**
       * Display disk usage information (similar to df command)
       */
@@ -159,122 +238,178 @@
       */
      void printTypeInfo();
  
- public:
      /**
-      * Constructor - initializes utility state
+      * Check whether --format selected a machine-readable format
       */
-     DiskLsUtil();
- 
+     bool machineOutput() const;
+     
      /**
-      * Destructor
+      * Add one "disk" row per disk, and "nvme_health" rows with --smart
       */
-     ~DiskLsUtil() = default;
- 
-     // Disable copy constructor and assignment operator
-     DiskLsUtil(const DiskLsUtil&) = delete;
-     DiskLsUtil& operator=(const DiskLsUtil&) = delete;
- 
+     void writeDiskInfo();
+     
      /**
-      * Parse command line arguments
-      * @param argc Argument count
-      * @param argv Argument values
+      * Add one "block" row per device of the block device graph
       */
-     void parseArgs(int argc, char* argv[]);
- 
+     void writeGraphInfo();
+     
      /**
-      * Print version information
+      * Add one "filesystem" row per mount, with usage when -u is given
       */
-     void printVersion();
- 
+     void writePartitionInfo();
+     
      /**
-      * Print help message
+      * Add one "process" row per entry of top_processes
       */
-     void printHelp();
- 
+     void writeProcesses();
+     
      /**
-      * Run the main program logic
+      * Add the "cgroup" group and its per-device "cgroup_io" rows
       */
-     void run();
- 
-     // Accessor methods for configuration flags
-     bool isShowDetailed() const { return show_detailed; }
-     bool isShowUsage() const { return show_usage; }
-     bool isShowMounts() const { return show_mounts; }
-     bool isShowTypes() const { return show_types; }
-     bool isUseColors() const { return use_colors; }
- 
-     // Setter methods for testing purposes
-     void setShowDetailed(bool value) { show_detailed = value; }
-     void setShowUsage(bool value) { show_usage = value; }
-     void setShowMounts(bool value) { show_mounts = value; }
-     void setShowTypes(bool value) { show_types = value; }
-     void setUseColors(bool value) { use_colors = value; }
- };
- 
- /**
-  * Utility functions namespace
-  */
- namespace DiskLsUtils {
+     void writeCgroupInfo();
+     
      /**
-      * Check if output terminal supports colors
-      * @return true if colors are supported, false otherwise
+      * Write the selected sections as one --format sample
       */
-     bool supportsColors();
- 
+     void writeReport();
+     
      /**
-      * Read a single line from a file
-      * @param filepath Path to the file
-      * @param line Reference to store the read line
-      * @return true if successful, false otherwise
+      * Format the current local time as HH:MM:SS
+      * @param buf Output buffer
+      * @param size Size of buf
       */
-     bool readFileLine(const std::string& filepath, std::string& line);
- 
+     void formatTimestamp(char* buf, size_t size);
+     
+     /**
+      * Check whether a device is reported in watch mode
+      * @param stat Device statistics
+      * @return false for loop devices, ram disks and removed devices
+      */
+     static bool watchedDevice(const DiskStats& stat);
+     
+     /**
+      * Print the column header of watch mode
+      */
+     void printWatchHeader();
+     
+     /**
+      * Compute the rates of a device between two samples
+      * @param before Earlier sample
+      * @param stat Later sample
+      * @param elapsed Seconds between the samples
+      * @return Rates per second and latencies
+      */
+     static IoRates ioRates(const DiskStats& before, const DiskStats& stat, double elapsed);
+     
+     /**
+      * Print one watch line from two samples of a device, or add it as an
+      * "io" row with --format
+      * @param timestamp Time column
+      * @param device Device column
+      * @param before Earlier sample
+      * @param stat Later sample
+      * @param elapsed Seconds between the samples
+      */
+     void printWatchRow(const char* timestamp, const std::string& device, const DiskStats& before,
+                        const DiskStats& stat, double elapsed);
+     
+     /**
+      * Add the counters of one device to a sum
+      * @param sum Accumulated counters
+      * @param stat Counters to add
+      */
+     static void addStats(DiskStats& sum, const DiskStats& stat);
+     
+     /**
+      * Fill watch_stacks with the top-level stacked devices and their disks
+      */
+     void buildWatchStacks();
+     
+     /**
+      * Print r/s, w/s, MB/s, await, queue size and utilization per device
+      * @param prev Previous sample
+      * @param cur Current sample
+      * @param elapsed Seconds between the samples
+      */
+     void printWatchTick(const DiskStatsTable& prev, const DiskStatsTable& cur, double elapsed);
+     
      /**
-      * Parse device information from /sys/block/ path
-      * @param device_path Path to device in /sys/block/
-      * @param disk_info Reference to DiskInfo structure to fill
-      * @return true if parsing successful, false otherwise
+      * Record the await and utilization of every --history device and
+      * redraw them as sparklines
+      * @param history Ring with two columns per device
+      * @param prev Counters of the previous tick
+      * @param cur Counters of this tick
+      * @param elapsed Seconds between the two
+      * @param tick Tick number, 0 for the first
       */
-     bool parseDeviceInfo(const std::string& device_path, DiskInfo& disk_info);
+     void printHistoryTick(SampleHistory& history, const DiskStatsTable& prev, const DiskStatsTable& cur,
+                           double elapsed, long tick);
+     
+     /**
+      * Append a diskstats table to the --record file, if any
+      * @param table Counters of this tick
+      * @throws std::runtime_error if the write fails
+      */
+     void recordSample(const DiskStatsTable& table);
+     
+     /**
+      * Print the watch output of a --replay file with its recorded times
+      * @throws std::runtime_error if the file cannot be read
+      */
+     void printReplay();
+     
+     /**
+      * Redraw the busiest processes of every interval, or write them as
+      * one --format sample per interval
+      * @throws std::runtime_error with --record, or if /proc cannot be listed
+      */
+     void printProcessWatch();
+     
+     /**
+      * Report disk activity every watch_interval seconds
+      */
+     void printWatch();
+     
+     /**
+      * Select a section named on the command line; the first one named
+      * turns off the sections shown by default
+      * @param name Section name
+      * @return false if there is no such section
+      */
+     bool selectSection(const std::string& name);
  
+ public:
      /**
-      * Convert bytes to human-readable format
-      * @param bytes Size in bytes
-      * @param binary Use binary (1024) or decimal (1000) base
-      * @return Formatted size string
+      * Constructor - initializes utility state
       */
-     std::string bytesToHuman(unsigned long long bytes, bool binary = true);
+     DiskLsUtil();
+ 
+     // Disable copy constructor and assignment operator
+     DiskLsUtil(const DiskLsUtil&) = delete;
+     DiskLsUtil& operator=(const DiskLsUtil&) = delete;
  
      /**
-      * Determine disk type from device name and characteristics
-      * @param device_name Device name (e.g., "sda", "nvme0n1")
-      * @param rotational Whether disk is rotational
-      * @return Disk type string (HDD/SSD/NVMe)
+      * Parse command line arguments
+      * @param argc Argument count
+      * @param argv Argument values
       */
-     std::string determineDiskType(const std::string& device_name, bool rotational);
+     void parseArgs(int argc, char* argv[]);
  
      /**
-      * Check if device is a physical disk (not partition or virtual device)
-      * @param device_name Device name
-      * @return true if it's a physical disk, false otherwise
+      * Print version information
       */
-     bool isPhysicalDisk(const std::string& device_name);
+     void printVersion();
  
      /**
-      * Get disk usage percentage with color coding
-      * @param usage_percent Usage percentage
-      * @param use_colors Whether to apply colors
-      * @return Formatted usage string with optional colors
+      * Print help message
       */
-     std::string formatUsagePercent(double usage_percent, bool use_colors = true);
+     void printHelp();
  
      /**
-      * Parse mount options string into readable format
-      * @param options Mount options string
-      * @return Formatted options string
+      * Run the main program logic
       */
-     std::string formatMountOptions(const std::string& options);
- }
+     void run();
+ };
  
  // Version information
  namespace Version {
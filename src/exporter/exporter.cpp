@@ -0,0 +1,612 @@
+/*
+ * infoutils-exporter - Prometheus exporter for the InfoUtils collectors
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include <iostream>
+ #include <string>
+ #include <string_view>
+ #include <vector>
+ #include <atomic>
+ #include <mutex>
+ #include <thread>
+ #include <cstring>
+ #include <cerrno>
+ #include <cstdlib>
+ #include <ctime>
+ #include <stdexcept>
+ #include <system_error>
+ #include <unistd.h>
+ #include <netdb.h>
+ #include <sys/socket.h>
+ #include <sys/uio.h>
+ #include <sys/sysinfo.h>
+ #include <poll.h>
+ 
+ #include "exporter.hpp"
+ #include "output.hpp"
+ #include "cli.hpp"
+ #include "format.hpp"
+ #include "procfs.hpp"
+ #include "stats.hpp"
+ #include "cpu.hpp"
+ #include "mem.hpp"
+ #include "disk.hpp"
+ #include "os.hpp"
+ #include "multicall.hpp"
+ 
+ std::string ExporterUtil::colorize(const std::string& text, const std::string& color) {
+     return ::colorize(text, color, use_colors);
+ }
+ 
+ double ExporterUtil::elapsedSince(const struct timespec& start) {
+     struct timespec now;
+     clock_gettime(CLOCK_MONOTONIC, &now);
+     return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+ }
+ 
+ // Static information, formatted once at startup
+ void ExporterUtil::collectStatic() {
+     CpuInfo cpu = readCpuInfo();
+     DistroInfo distro = readDistroInfo();
+     SystemInfo system = readSystemInfo();
+     
+     writer.begin();
+     writer.group("processor");
+     writer.field("model_name", cpu.model_name);
+     writer.field("vendor_id", cpu.vendor_id);
+     writer.field("architecture", cpu.architecture);
+     writer.field("microcode", cpu.microcode);
+     writer.field("flags", cpu.flags);
+     writer.field("logical_cores", cpu.logical_cores);
+     writer.field("physical_cores", cpu.physical_cores);
+     
+     writer.group("os");
+     writer.field("kernel_name", system.kernel_name);
+     writer.field("kernel_release", system.kernel_release);
+     writer.field("kernel_version", system.kernel_version);
+     writer.field("hostname", system.hostname);
+     writer.field("container", system.container);
+     writer.field("distro_id", distro.id);
+     writer.field("distro_version_id", distro.version_id);
+     writer.field("distro_pretty_name", distro.pretty_name);
+     static_text.assign(writer.finish());
+ }
+ 
+ void ExporterUtil::writeCpu() {
+     ProcStatCounters counters;
+     CpuLoad load = cpu_sampler.load(&per_cpu, &counters);
+     
+     writer.group("load");
+     writer.field("load1", load.load1);
+     writer.field("load5", load.load5);
+     writer.field("load15", load.load15);
+     
+     writer.group("system");
+     writer.field("boot_time_seconds", counters.boot_time);
+     writer.counter("context_switches_total", counters.context_switches);
+     writer.counter("forks_total", counters.processes);
+     writer.field("procs_running", counters.procs_running);
+     writer.field("procs_blocked", counters.procs_blocked);
+     struct sysinfo si;
+     if (sysinfo(&si) == 0) {
+         writer.field("uptime_seconds", static_cast<long long>(si.uptime));
+     }
+     
+     // /proc/stat counts in clock ticks; Prometheus wants seconds
+     static const struct {
+         const char* key;
+         CpuCounter counter;
+     } fields[] = {
+         {"user_seconds_total", CPU_USER},
+         {"nice_seconds_total", CPU_NICE},
+         {"system_seconds_total", CPU_SYSTEM},
+         {"idle_seconds_total", CPU_IDLE},
+         {"iowait_seconds_total", CPU_IOWAIT},
+         {"irq_seconds_total", CPU_IRQ},
+         {"softirq_seconds_total", CPU_SOFTIRQ},
+         {"steal_seconds_total", CPU_STEAL},
+     };
+     
+     for (size_t i = 0; i < per_cpu.size(); ++i) {
+         writer.group("cpu", "cpu", per_cpu.cpu[i]);
+         for (const auto& entry : fields) {
+             writer.counter(entry.key, per_cpu.counters[entry.counter][i] / tick_seconds);
+         }
+     }
+ }
+ 
+ void ExporterUtil::writeMemory() {
+     static const struct {
+         const char* key;
+         MemField field;
+     } fields[] = {
+         {"total_bytes", MEM_TOTAL},
+         {"available_bytes", MEM_AVAILABLE},
+         {"free_bytes", MEM_FREE},
+         {"buffers_bytes", MEM_BUFFERS},
+         {"cached_bytes", MEM_CACHED},
+         {"active_bytes", MEM_ACTIVE},
+         {"inactive_bytes", MEM_INACTIVE},
+         {"anon_bytes", MEM_ANON_PAGES},
+         {"mapped_bytes", MEM_MAPPED},
+         {"shmem_bytes", MEM_SHMEM},
+         {"slab_reclaimable_bytes", MEM_SRECLAIMABLE},
+         {"slab_unreclaimable_bytes", MEM_SUNRECLAIM},
+         {"dirty_bytes", MEM_DIRTY},
+         {"writeback_bytes", MEM_WRITEBACK},
+         {"committed_as_bytes", MEM_COMMITTED_AS},
+         {"commit_limit_bytes", MEM_COMMIT_LIMIT},
+         {"swap_total_bytes", MEM_SWAP_TOTAL},
+         {"swap_free_bytes", MEM_SWAP_FREE},
+         {"swap_cached_bytes", MEM_SWAP_CACHED},
+     };
+     
+     MemoryInfo info = mem_sampler.memoryInfo();
+     writer.group("memory");
+     for (const auto& entry : fields) {
+         writer.field(entry.key, info[entry.field] * 1024ULL);
+     }
+     
+     // Raw counters; rates are left to the query side
+     VmStatCounters vm = mem_sampler.vmStat();
+     writer.group("vmstat");
+     writer.counter("pgscan_total", vm.pgscan);
+     writer.counter("pgsteal_total", vm.pgsteal);
+     writer.counter("pswpin_total", vm.pswpin);
+     writer.counter("pswpout_total", vm.pswpout);
+     writer.counter("pgmajfault_total", vm.pgmajfault);
+     
+     MemoryPressure pressure = mem_sampler.pressure();
+     if (pressure.available) {
+         writer.group("memory_pressure");
+         writer.field("some_avg10", pressure.some_avg10);
+         writer.field("full_avg10", pressure.full_avg10);
+     }
+ }
+ 
+ void ExporterUtil::writeDisks() {
+     if (!disk_sampler.diskStats(disk_stats)) return;
+     
+     // Sectors are always 512 bytes in diskstats, times are milliseconds
+     for (const auto& stat : disk_stats.rows) {
+         if (!stat.present || stat.device.compare(0, 4, "loop") == 0 ||
+             stat.device.compare(0, 3, "ram") == 0) {
+             continue;
+         }
+         writer.group("disk", "device", stat.device);
+         writer.counter("reads_total", stat.reads_completed);
+         writer.counter("reads_merged_total", stat.reads_merged);
+         writer.counter("read_bytes_total", stat.sectors_read * 512ULL);
+         writer.counter("read_time_seconds_total", stat.time_reading / 1000.0, 3);
+         writer.counter("writes_total", stat.writes_completed);
+         writer.counter("writes_merged_total", stat.writes_merged);
+         writer.counter("written_bytes_total", stat.sectors_written * 512ULL);
+         writer.counter("write_time_seconds_total", stat.time_writing / 1000.0, 3);
+         writer.field("io_in_progress", stat.io_in_progress);
+         writer.counter("io_time_seconds_total", stat.time_io / 1000.0, 3);
+         writer.counter("weighted_io_time_seconds_total", stat.weighted_time_io / 1000.0, 3);
+     }
+ }
+ 
+ // Space usage of block-device mounts; mountinfo is re-read every time
+ // since mounts come and go
+ void ExporterUtil::writeFilesystems() {
+     const char* text = disk_sampler.mountInfo();
+     if (!text) return;
+     
+     mount_paths.clear();
+     mount_labels.clear();
+     stuck_mounts.prune();
+     MountEntry entry;
+     for (const char* p = text; nextMountEntry(p, entry);) {
+         if (entry.source.substr(0, 5) != "/dev/" || entry.filesystem == "squashfs") continue;
+         
+         std::string mountpoint = unescapeMountField(entry.mountpoint);
+         bool seen = stuck_mounts.contains(mountpoint);
+         for (const auto& path : mount_paths) {
+             if (path == mountpoint) seen = true;
+         }
+         if (seen) continue;
+         
+         mount_paths.push_back(mountpoint);
+         mount_labels.push_back(unescapeMountField(entry.source));
+         mount_labels.emplace_back(entry.filesystem);
+     }
+     if (mount_paths.empty()) return;
+     
+     // Mounts that do not answer in time are left out of this sample, and
+     // of later ones until the blocked worker returns
+     auto batch = statvfsAll(mount_paths, statvfs_jobs, statvfs_timeout);
+     stuck_mounts.add(batch);
+     std::lock_guard<std::mutex> guard(batch->lock);
+     for (size_t i = 0; i < mount_paths.size(); ++i) {
+         const StatvfsJob& job = batch->jobs[i];
+         if (job.state == StatvfsJob::STALE || !job.ok) continue;
+         
+         const struct statvfs& stat = job.result;
+         writer.group("filesystem", "mountpoint", mount_paths[i]);
+         writer.field("device", mount_labels[2 * i]);
+         writer.field("fstype", mount_labels[2 * i + 1]);
+         writer.field("size_bytes", static_cast<unsigned long long>(stat.f_blocks) * stat.f_frsize);
+         writer.field("free_bytes", static_cast<unsigned long long>(stat.f_bfree) * stat.f_frsize);
+         writer.field("available_bytes", static_cast<unsigned long long>(stat.f_bavail) * stat.f_frsize);
+         writer.field("files", static_cast<unsigned long long>(stat.f_files));
+         writer.field("files_free", static_cast<unsigned long long>(stat.f_ffree));
+     }
+ }
+ 
+ // Take one sample and publish it as the current snapshot
+ void ExporterUtil::collect() {
+     struct timespec start;
+     clock_gettime(CLOCK_MONOTONIC, &start);
+     
+     writer.begin();
+     writeCpu();
+     writeMemory();
+     writeDisks();
+     writeFilesystems();
+     
+     collections++;
+     writer.group("exporter");
+     writer.counter("collections_total", collections);
+     writer.counter("scrapes_total", scrapes.load(std::memory_order_relaxed));
+     writer.field("stuck_mounts", stuck_mounts.size());
+     writer.field("last_collection_timestamp_seconds", wallClock(), 3);
+     writer.field("collection_duration_seconds", elapsedSince(start), 6);
+     for (int i = 0; i < STAT_COUNTER_COUNT; ++i) {
+         StatCounter counter = static_cast<StatCounter>(i);
+         writer.counter(statCounterName(counter), statCounter(counter));
+     }
+     
+     // Self-instrumentation, as cpuinfo --stats prints it
+     for (const StatSection* section = firstStatSection(); section; section = section->next()) {
+         if (section->calls() == 0) continue;
+         writer.group("collector", "collector", section->name());
+         writer.counter("calls_total", section->calls());
+         writer.counter("seconds_total", section->nanoseconds() / 1e9, 6);
+     }
+     
+     back_snapshot.assign(static_text);
+     back_snapshot.append(writer.finish());
+     
+     std::lock_guard<std::mutex> guard(snapshot_lock);
+     snapshot.swap(back_snapshot);
+ }
+ 
+ void ExporterUtil::collectLoop() {
+     struct timespec deadline;
+     clock_gettime(CLOCK_MONOTONIC, &deadline);
+     for (;;) {
+         waitForNextTick(deadline, collect_interval);
+         collect();
+     }
+ }
+ 
+ void ExporterUtil::openListener() {
+     struct addrinfo hints;
+     std::memset(&hints, 0, sizeof(hints));
+     hints.ai_family = AF_UNSPEC;
+     hints.ai_socktype = SOCK_STREAM;
+     hints.ai_flags = AI_PASSIVE;
+     
+     struct addrinfo* addresses = nullptr;
+     int status = getaddrinfo(listen_host.empty() ? nullptr : listen_host.c_str(),
+                              listen_port.c_str(), &hints, &addresses);
+     if (status != 0) {
+         throw std::runtime_error("cannot resolve " + listen_host + ": " + gai_strerror(status));
+     }
+     
+     int error = 0;
+     for (struct addrinfo* addr = addresses; addr && listen_fd < 0; addr = addr->ai_next) {
+         int fd = socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC, addr->ai_protocol);
+         if (fd < 0) {
+             error = errno;
+             continue;
+         }
+         int one = 1;
+         setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+         if (bind(fd, addr->ai_addr, addr->ai_addrlen) != 0 || listen(fd, 64) != 0) {
+             error = errno;
+             close(fd);
+             continue;
+         }
+         listen_fd = fd;
+     }
+     freeaddrinfo(addresses);
+     
+     if (listen_fd < 0) {
+         throw std::runtime_error("cannot listen on port " + listen_port + ": " + std::strerror(error));
+     }
+ }
+ 
+ // Send every buffer, retrying short writes; MSG_NOSIGNAL keeps a client
+ // that hung up from killing us with SIGPIPE
+ bool ExporterUtil::sendAll(int fd, struct iovec* iov, int count) {
+     while (count > 0) {
+         struct msghdr msg;
+         std::memset(&msg, 0, sizeof(msg));
+         msg.msg_iov = iov;
+         msg.msg_iovlen = count;
+         ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+         if (n < 0) {
+             if (errno == EINTR) continue;
+             return false;
+         }
+         size_t sent = n;
+         while (count > 0 && sent >= iov->iov_len) {
+             sent -= iov->iov_len;
+             ++iov;
+             --count;
+         }
+         if (count > 0) {
+             iov->iov_base = static_cast<char*>(iov->iov_base) + sent;
+             iov->iov_len -= sent;
+         }
+     }
+     return true;
+ }
+ 
+ void ExporterUtil::sendResponse(int fd, const char* status, const char* type, std::string_view body, bool head) {
+     std::string header = "HTTP/1.1 ";
+     header += status;
+     header += "\r\nContent-Type: ";
+     header += type;
+     header += "\r\nContent-Length: ";
+     header += std::to_string(body.size());
+     header += "\r\nConnection: close\r\n\r\n";
+     
+     struct iovec iov[2];
+     iov[0].iov_base = header.data();
+     iov[0].iov_len = header.size();
+     iov[1].iov_base = const_cast<char*>(body.data());
+     iov[1].iov_len = head ? 0 : body.size();
+     sendAll(fd, iov, 2);
+ }
+ 
+ // Read the request head until the blank line, giving up once the
+ // whole head has taken longer than REQUEST_TIMEOUT_MS
+ size_t ExporterUtil::readRequest(int fd, char* request, size_t size) {
+     struct timespec start;
+     clock_gettime(CLOCK_MONOTONIC, &start);
+     
+     size_t len = 0;
+     request[0] = '\0';
+     while (len < size - 1) {
+         int remaining = REQUEST_TIMEOUT_MS - static_cast<int>(elapsedSince(start) * 1000);
+         if (remaining <= 0) break;
+         struct pollfd pfd = {fd, POLLIN, 0};
+         int ready = poll(&pfd, 1, remaining);
+         if (ready < 0 && errno == EINTR) continue;
+         if (ready <= 0) break;
+         
+         ssize_t n = recv(fd, request + len, size - 1 - len, 0);
+         if (n < 0 && errno == EINTR) continue;
+         if (n <= 0) break;
+         len += n;
+         request[len] = '\0';
+         if (std::strstr(request, "\r\n\r\n") || std::strstr(request, "\n\n")) break;
+     }
+     return len;
+ }
+ 
+ // One request per connection; the body is copied out of the snapshot
+ // so the lock is never held while a client reads
+ void ExporterUtil::serveClient(int fd) {
+     struct timeval timeout = {5, 0};
+     setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+     
+     // Only the request line matters; headers are read and ignored
+     char request[8192];
+     if (readRequest(fd, request, sizeof(request)) == 0) return;
+     
+     std::string_view line(request, std::strcspn(request, "\r\n"));
+     size_t space = line.find(' ');
+     std::string_view method = line.substr(0, space);
+     std::string_view path = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+     path = path.substr(0, path.find_first_of(" ?"));
+     
+     bool head = method == "HEAD";
+     if (method != "GET" && !head) {
+         sendResponse(fd, "405 Method Not Allowed", "text/plain", "Method not allowed\n", false);
+     } else if (path == "/metrics") {
+         scrapes.fetch_add(1, std::memory_order_relaxed);
+         std::string body;
+         {
+             std::lock_guard<std::mutex> guard(snapshot_lock);
+             body.assign(snapshot);
+         }
+         sendResponse(fd, "200 OK", "text/plain; version=0.0.4; charset=utf-8", body, head);
+     } else if (path == "/") {
+         sendResponse(fd, "200 OK", "text/html",
+                      "<html><head><title>infoutils-exporter</title></head><body>"
+                      "<h1>infoutils-exporter</h1><p><a href=\"/metrics\">Metrics</a></p>"
+                      "</body></html>\n", head);
+     } else {
+         sendResponse(fd, "404 Not Found", "text/plain", "Not found\n", head);
+     }
+ }
+ 
+ void ExporterUtil::clientThread(int fd) {
+     serveClient(fd);
+     close(fd);
+     clients.fetch_sub(1);
+ }
+ 
+ // Split [HOST]:PORT, HOST:PORT or PORT
+ void ExporterUtil::parseListen(const std::string& value) {
+     std::string host, port;
+     if (!value.empty() && value[0] == '[') {
+         size_t close = value.find("]:");
+         if (close == std::string::npos) invalidValue("infoutils-exporter", "listen address", value, use_colors);
+         host = value.substr(1, close - 1);
+         port = value.substr(close + 2);
+     } else if (value.rfind(':') != std::string::npos) {
+         host = value.substr(0, value.rfind(':'));
+         port = value.substr(value.rfind(':') + 1);
+     } else {
+         port = value;
+     }
+     
+     char* end = nullptr;
+     long number = std::strtol(port.c_str(), &end, 10);
+     if (port.empty() || *end != '\0' || number < 1 || number > 65535) {
+         invalidValue("infoutils-exporter", "listen address", value, use_colors);
+     }
+     listen_host = host;
+     listen_port = port;
+ }
+ 
+ ExporterUtil::ExporterUtil() {
+     // Errors are the only thing we print, so color follows stderr
+     use_colors = isatty(STDERR_FILENO);
+     writer.setFormat(OutputFormat::PROMETHEUS);
+     
+     long ticks = sysconf(_SC_CLK_TCK);
+     if (ticks > 0) tick_seconds = ticks;
+ }
+ 
+ ExporterUtil::~ExporterUtil() {
+     if (listen_fd >= 0) close(listen_fd);
+ }
+ 
+ void ExporterUtil::parseArgs(int argc, char* argv[]) {
+     for (int i = 1; i < argc; ++i) {
+         std::string arg = argv[i];
+         
+         if (arg == "--help" || arg == "-h") {
+             printHelp();
+             exit(0);
+         } else if (arg == "--version" || arg == "-V") {
+             printVersion();
+             exit(0);
+         } else if (arg == "--listen" || arg == "-l" || arg.rfind("--listen=", 0) == 0) {
+             parseListen(optionValue("infoutils-exporter", argc, argv, i, arg, "listen", use_colors));
+         } else if (arg == "--interval" || arg == "-i" || arg.rfind("--interval=", 0) == 0) {
+             std::string value = optionValue("infoutils-exporter", argc, argv, i, arg, "interval", use_colors);
+             char* end = nullptr;
+             collect_interval = std::strtod(value.c_str(), &end);
+             if (value.empty() || *end != '\0' || !(collect_interval >= 0.1)) {
+                 invalidValue("infoutils-exporter", "interval", value, use_colors);
+             }
+         } else if (arg == "--jobs" || arg == "-j" || arg.rfind("--jobs=", 0) == 0) {
+             std::string value = optionValue("infoutils-exporter", argc, argv, i, arg, "jobs", use_colors);
+             char* end = nullptr;
+             long jobs = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || jobs < 1 || jobs > 64) {
+                 invalidValue("infoutils-exporter", "jobs", value, use_colors);
+             }
+             statvfs_jobs = jobs;
+         } else if (arg == "--timeout" || arg == "-T" || arg.rfind("--timeout=", 0) == 0) {
+             std::string value = optionValue("infoutils-exporter", argc, argv, i, arg, "timeout", use_colors);
+             char* end = nullptr;
+             statvfs_timeout = std::strtod(value.c_str(), &end);
+             if (value.empty() || *end != '\0' || !(statvfs_timeout > 0)) {
+                 invalidValue("infoutils-exporter", "timeout", value, use_colors);
+             }
+         } else if (arg == "--root" || arg.rfind("--root=", 0) == 0) {
+             std::string value = optionValue("infoutils-exporter", argc, argv, i, arg, "root", use_colors);
+             if (value.empty() || !setSystemRoot(value)) {
+                 invalidValue("infoutils-exporter", "root directory", value, use_colors);
+             }
+         } else if (arg == "--no-color") {
+             use_colors = false;
+         } else {
+             std::cerr << colorize("infoutils-exporter: invalid option -- '" + arg + "'", Colors::RED) << '\n';
+             std::cerr << "Try 'infoutils-exporter --help' for more information." << '\n';
+             exit(1);
+         }
+     }
+ }
+ 
+ void ExporterUtil::printVersion() {
+     std::cout << "infoutils-exporter (QCO InfoUtils) 1.0" << '\n';
+     std::cout << "Copyright (C) 2025 AnmiTaliDev" << '\n';
+     std::cout << "License Apache 2.0: Apache License version 2.0" << '\n';
+     std::cout << "This is free software: you are free to change and redistribute it." << '\n';
+     std::cout << "There is NO WARRANTY, to the extent permitted by law." << '\n';
+ }
+ 
+ void ExporterUtil::printHelp() {
+     std::cout << "Usage: infoutils-exporter [OPTION]..." << '\n';
+     std::cout << "Serve CPU, memory, disk and OS metrics in the Prometheus text format." << '\n';
+     std::cout << "The time and system calls of every collector are exported as well." << '\n';
+     std::cout << '\n';
+     std::cout << "  -h, --help        display this help and exit" << '\n';
+     std::cout << "  -i, --interval N  collect every N seconds (default: 15)" << '\n';
+     std::cout << "  -j, --jobs N      run statvfs() on N mounts at a time (default: 4)" << '\n';
+     std::cout << "  -l, --listen ADDR listen on [HOST:]PORT or [IPV6]:PORT (default: 9110)" << '\n';
+     std::cout << "      --no-color    disable colored error messages" << '\n';
+     std::cout << "      --root DIR    read /proc, /sys and /etc under DIR, such as the host's /" << '\n';
+     std::cout << "                    mounted into a container" << '\n';
+     std::cout << "  -T, --timeout N   leave out mounts whose statvfs() takes more than" << '\n';
+     std::cout << "                    N seconds (default: 2)" << '\n';
+     std::cout << "  -V, --version     output version information and exit" << '\n';
+     std::cout << '\n';
+     std::cout << "Metrics are collected on their own schedule and GET /metrics returns the" << '\n';
+     std::cout << "latest sample, so scrapes never wait for /proc or a slow filesystem." << '\n';
+     std::cout << '\n';
+     std::cout << "Examples:" << '\n';
+     std::cout << "  infoutils-exporter                 serve on port 9110 of every address" << '\n';
+     std::cout << "  infoutils-exporter -l 127.0.0.1:9110 -i 5" << '\n';
+     std::cout << "                                     collect every 5 seconds, local only" << '\n';
+     std::cout << '\n';
+     std::cout << "Report bugs to: https://github.com/Qainar-Projects/infoutils/issues" << '\n';
+ }
+ 
+ void ExporterUtil::run() {
+     // Fail on a port in use before doing any work
+     openListener();
+     
+     // The exporter always reports its own collectors
+     enableStats();
+     cpu_sampler.openStat();
+     mem_sampler.openCounters();
+     collectStatic();
+     
+     // The first sample is taken before serving, so no scrape sees an
+     // empty snapshot
+     collect();
+     std::thread(&ExporterUtil::collectLoop, this).detach();
+     
+     for (;;) {
+         int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+         if (fd < 0) {
+             if (errno == EINTR || errno == ECONNABORTED) continue;
+             if (errno == EMFILE || errno == ENFILE) {
+                 // Out of descriptors; back off instead of spinning
+                 usleep(100000);
+                 continue;
+             }
+             throw std::runtime_error(std::string("accept failed: ") + std::strerror(errno));
+         }
+         
+         // Past the limit, the connection is refused rather than queued
+         // behind the clients being served
+         if (clients.fetch_add(1) >= MAX_CLIENTS) {
+             clients.fetch_sub(1);
+             close(fd);
+             continue;
+         }
+         try {
+             std::thread(&ExporterUtil::clientThread, this, fd).detach();
+         } catch (const std::system_error&) {
+             clients.fetch_sub(1);
+             close(fd);
+         }
+     }
+ }
+ 
+ INFOUTILS_MAIN(exporter) {
+     try {
+         ExporterUtil util;
+         util.parseArgs(argc, argv);
+         util.run();
+         return 0;
+     } catch (const std::exception& e) {
+         std::cerr << "infoutils-exporter: " << e.what() << '\n';
+         return 1;
+     }
+ }
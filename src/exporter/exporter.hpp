@@ -0,0 +1,232 @@
+/*
+ * infoutils-exporter - Prometheus exporter for the InfoUtils collectors
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #ifndef EXPORTER_HPP
+ #define EXPORTER_HPP
+ 
+ #include <string>
+ #include <string_view>
+ #include <vector>
+ #include <atomic>
+ #include <mutex>
+ #include <ctime>
+ #include <sys/uio.h>
+ 
+ #include "format.hpp"
+ #include "cpu.hpp"
+ #include "mem.hpp"
+ #include "disk.hpp"
+ 
+ /**
+  * HTTP daemon serving the collectors as Prometheus metrics. A collector
+  * thread samples on its own schedule into a double-buffered snapshot and
+  * a short-lived thread per connection answers GET /metrics from the
+  * latest one.
+  */
+ class ExporterUtil {
+ private:
+     std::string listen_host;              // Empty for every address
+     std::string listen_port = "9110";
+     double collect_interval = 15.0;
+     int statvfs_jobs = 4;
+     double statvfs_timeout = 2.0;
+     bool use_colors = true;
+     int listen_fd = -1;
+     
+     // Every connection is served by its own short-lived thread, so an idle
+     // client cannot hold up a scrape; MAX_CLIENTS bounds the threads
+     static constexpr int MAX_CLIENTS = 64;
+     static constexpr int REQUEST_TIMEOUT_MS = 1000;
+     std::atomic<int> clients{0};
+     
+     // /proc and /sys files, kept open for the life of the exporter
+     CpuSampler cpu_sampler;
+     MemSampler mem_sampler;
+     DiskSampler disk_sampler;
+     CpuStatTable per_cpu;
+     DiskStatsTable disk_stats;
+     std::vector<std::string> mount_paths;
+     std::vector<std::string> mount_labels;  // device, fstype pairs of mount_paths
+     StuckMounts stuck_mounts;               // Hung mounts skipped until they answer
+     double tick_seconds = 100.0;
+     
+     // Samples are formatted here by the collector thread only
+     RecordWriter writer{"infoutils"};
+     
+     // CPU model, distribution and kernel do not change while we run; they
+     // are read and formatted once and appended to every snapshot
+     std::string static_text;
+     
+     // Double-buffered snapshot: the collector fills back_snapshot without
+     // holding the lock and swaps it with snapshot. Each side holds the lock
+     // only for a swap or a copy, so collection never waits for a slow client.
+     std::mutex snapshot_lock;
+     std::string snapshot;
+     std::string back_snapshot;
+     
+     unsigned long long collections = 0;
+     std::atomic<unsigned long long> scrapes{0};
+     
+     /**
+      * Apply color formatting to text if colors are enabled
+      * @param text Text to colorize
+      * @param color ANSI color code
+      * @return Colorized text or plain text if colors disabled
+      */
+     std::string colorize(const std::string& text, const std::string& color);
+     
+     /**
+      * Seconds elapsed on the monotonic clock
+      * @param start Start time
+      * @return Elapsed seconds
+      */
+     static double elapsedSince(const struct timespec& start);
+     
+     /**
+      * Read and format the CPU, kernel and distribution information once
+      */
+     void collectStatic();
+     
+     /**
+      * Add load averages, /proc/stat counters and per-CPU times
+      */
+     void writeCpu();
+     
+     /**
+      * Add /proc/meminfo, /proc/vmstat and memory pressure
+      */
+     void writeMemory();
+     
+     /**
+      * Add /proc/diskstats counters of every disk but loop and ram devices
+      */
+     void writeDisks();
+     
+     /**
+      * Add space usage of every block-device mount
+      */
+     void writeFilesystems();
+     
+     /**
+      * Take one sample and publish it as the current snapshot
+      */
+     void collect();
+     
+     /**
+      * Collector thread body
+      */
+     void collectLoop();
+     
+     /**
+      * Bind and listen on the --listen address
+      */
+     void openListener();
+     
+     /**
+      * Send buffers completely
+      * @param fd Connected socket
+      * @param iov Buffers, modified as they are sent
+      * @param count Number of buffers
+      * @return false if the client went away
+      */
+     static bool sendAll(int fd, struct iovec* iov, int count);
+     
+     /**
+      * Send an HTTP response and close the exchange
+      * @param fd Connected socket
+      * @param status Status line text, such as "200 OK"
+      * @param type Content-Type
+      * @param body Response body
+      * @param head Leave the body out for a HEAD request
+      */
+     static void sendResponse(int fd, const char* status, const char* type, std::string_view body, bool head);
+     
+     /**
+      * Read an HTTP request head within REQUEST_TIMEOUT_MS
+      * @param fd Connected socket
+      * @param request Buffer, NUL-terminated on return
+      * @param size Size of the buffer
+      * @return Bytes read, 0 if the client sent nothing in time
+      */
+     static size_t readRequest(int fd, char* request, size_t size);
+     
+     /**
+      * Answer one request
+      * @param fd Connected socket
+      */
+     void serveClient(int fd);
+     
+     /**
+      * Connection thread body: serve the client and close its socket
+      * @param fd Connected socket
+      */
+     void clientThread(int fd);
+     
+     /**
+      * Parse a --listen value
+      * @param value [HOST:]PORT or [IPV6]:PORT
+      */
+     void parseListen(const std::string& value);
+     
+ public:
+     /**
+      * Constructor - initializes exporter state
+      */
+     ExporterUtil();
+     
+     /**
+      * Destructor - closes the listening socket
+      */
+     ~ExporterUtil();
+ 
+     // Disable copy constructor and assignment operator
+     ExporterUtil(const ExporterUtil&) = delete;
+     ExporterUtil& operator=(const ExporterUtil&) = delete;
+     
+     /**
+      * Parse command line arguments
+      * @param argc Argument count
+      * @param argv Argument values
+      */
+     void parseArgs(int argc, char* argv[]);
+     
+     /**
+      * Print version information
+      */
+     void printVersion();
+     
+     /**
+      * Print help message
+      */
+     void printHelp();
+     
+     /**
+      * Start collecting and serve requests until killed
+      */
+     void run();
+ };
+ 
+ // Version information
+ namespace Version {
+     constexpr const char* PROGRAM_NAME = "infoutils-exporter";
+     constexpr const char* VERSION = "1.0";
+     constexpr const char* AUTHOR = "AnmiTaliDev";
+     constexpr const char* LICENSE = "Apache 2.0";
+     constexpr const char* ORGANIZATION = "QCO InfoUtils";
+     constexpr const char* HOMEPAGE = "https://github.com/Qainar-Projects/infoutils";
+ }
+ 
+ // Program exit codes
+ namespace ExitCodes {
+     constexpr int SUCCESS = 0;
+     constexpr int INVALID_OPTION = 1;
+     constexpr int PERMISSION_DENIED = 2;
+     constexpr int FILE_NOT_FOUND = 3;
+     constexpr int RUNTIME_ERROR = 4;
+ }
+ 
+ #endif // EXPORTER_HPP
@@ -0,0 +1,258 @@
+/*
+ * infoutils - Every tool in one binary, run by name
+ * Part of QCO InfoUtils (Qainrat Code Organization InfoUtils)
+ * Author: AnmiTaliDev
+ * License: Apache 2.0
+ */
+
+ #include <iostream>
+ #include <string>
+ #include <string_view>
+ #include <vector>
+ #include <cstring>
+ #include <cerrno>
+ #include <cstdlib>
+ #include <stdexcept>
+ #include <unistd.h>
+ #include <fcntl.h>
+ #include <poll.h>
+ #include <sys/wait.h>
+ 
+ #include "output.hpp"
+ #include "multicall.hpp"
+ 
+ namespace {
+ 
+ struct Tool {
+     const char* name;
+     const char* alias;      // Short name for infoutils TOOL
+     int (*main)(int argc, char* argv[]);
+ };
+ 
+ // The first four make up --all, in the order they are printed
+ const Tool tools[] = {
+     {"cpuinfo", "cpu", cpuinfoMain},
+     {"meminfo", "mem", meminfoMain},
+     {"diskls", "disk", disklsMain},
+     {"osinfo", "os", osinfoMain},
+     {"infoutils-exporter", "exporter", exporterMain}
+ };
+ const size_t report_tools = 4;
+ 
+ const Tool* findTool(const std::string& name) {
+     for (const Tool& tool : tools) {
+         if (name == tool.name || name == tool.alias) return &tool;
+     }
+     return nullptr;
+ }
+ 
+ // --all holds each report until its tool exits, so options that keep a
+ // tool sampling until interrupted, or point all four at one recording,
+ // are refused
+ const char* const watch_options[] = {
+     "-w", "--watch", "-i", "--interval", "-c", "--count", "--history", "--record", "--replay"
+ };
+ 
+ const char* findWatchOption(int argc, char* argv[]) {
+     for (int i = 0; i < argc; ++i) {
+         std::string_view arg = argv[i];
+         std::string_view name = arg.substr(0, arg.find('='));
+         for (const char* option : watch_options) {
+             if (name == option) return argv[i];
+         }
+     }
+     return nullptr;
+ }
+ 
+ struct Report {
+     pid_t pid;
+     int fd;                 // Read end of the child's stdout, -1 at EOF
+     std::string output;
+ };
+ 
+ // Run a tool in a child whose stdout is the write end of a pipe
+ Report startReport(const Tool& tool, int argc, char* argv[], const std::vector<Report>& started) {
+     int fds[2];
+     if (pipe2(fds, O_CLOEXEC) < 0) {
+         throw std::runtime_error(std::string("cannot create pipe: ") + std::strerror(errno));
+     }
+     
+     bool terminal = stdoutIsTerminal();
+     pid_t pid = fork();
+     if (pid < 0) {
+         throw std::runtime_error(std::string("cannot fork: ") + std::strerror(errno));
+     }
+     
+     if (pid == 0) {
+         dup2(fds[1], STDOUT_FILENO);
+         close(fds[0]);
+         close(fds[1]);
+         for (const Report& report : started) close(report.fd);
+         
+         // Keep the colors of the terminal the report ends up on
+         setStdoutTerminal(terminal);
+         
+         std::vector<char*> args;
+         args.push_back(const_cast<char*>(tool.name));
+         for (int i = 0; i < argc; ++i) args.push_back(argv[i]);
+         args.push_back(nullptr);
+         exit(tool.main(static_cast<int>(args.size()) - 1, args.data()));
+     }
+     
+     close(fds[1]);
+     return Report{pid, fds[0], std::string()};
+ }
+ 
+ // --all: the reports are collected at once, one process each, and
+ // printed in order. The pipes are drained together, so no report waits
+ // on a full pipe while an earlier one is still running.
+ int runAll(int argc, char* argv[]) {
+     std::cout.flush();
+     
+     std::vector<Report> reports;
+     for (size_t i = 0; i < report_tools; ++i) {
+         reports.push_back(startReport(tools[i], argc, argv, reports));
+     }
+     
+     std::vector<struct pollfd> fds;
+     std::vector<size_t> owners;
+     char buf[65536];
+     for (;;) {
+         fds.clear();
+         owners.clear();
+         for (size_t i = 0; i < reports.size(); ++i) {
+             if (reports[i].fd < 0) continue;
+             fds.push_back({reports[i].fd, POLLIN, 0});
+             owners.push_back(i);
+         }
+         if (fds.empty()) break;
+         
+         if (poll(fds.data(), fds.size(), -1) < 0) {
+             if (errno == EINTR) continue;
+             throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+         }
+         
+         for (size_t i = 0; i < fds.size(); ++i) {
+             if (fds[i].revents == 0) continue;
+             Report& report = reports[owners[i]];
+             ssize_t n = read(report.fd, buf, sizeof(buf));
+             if (n > 0) {
+                 report.output.append(buf, n);
+             } else if (n == 0 || errno != EINTR) {
+                 close(report.fd);
+                 report.fd = -1;
+             }
+         }
+     }
+     
+     // Text reports are set apart by a blank line; records are not
+     bool text = true;
+     for (int i = 0; i < argc; ++i) {
+         if (std::strncmp(argv[i], "--format", 8) == 0) text = false;
+     }
+     
+     int status = 0;
+     bool printed = false;
+     for (const Report& report : reports) {
+         int child_status;
+         while (waitpid(report.pid, &child_status, 0) < 0 && errno == EINTR) {}
+         if (!WIFEXITED(child_status) || WEXITSTATUS(child_status) != 0) status = 1;
+         if (report.output.empty()) continue;
+         
+         if (text && printed) std::cout << '\n';
+         std::cout << report.output;
+         printed = true;
+     }
+     std::cout.flush();
+     return status;
+ }
+ 
+ void printVersion() {
+     std::cout << "infoutils (QCO InfoUtils) 1.0" << '\n';
+     std::cout << "Copyright (C) 2025 AnmiTaliDev" << '\n';
+     std::cout << "License Apache 2.0: Apache License version 2.0" << '\n';
+     std::cout << "This is free software: you are free to change and redistribute it." << '\n';
+     std::cout << "There is NO WARRANTY, to the extent permitted by law." << '\n';
+ }
+ 
+ void printHelp() {
+     std::cout << "Usage: infoutils TOOL [OPTION]... [SECTION]..." << '\n';
+     std::cout << "  or:  infoutils --all [OPTION]..." << '\n';
+     std::cout << "Run one of the InfoUtils tools, all built into this binary. Linked or" << '\n';
+     std::cout << "copied under a tool's name, infoutils runs that tool." << '\n';
+     std::cout << '\n';
+     std::cout << "Tools:" << '\n';
+     std::cout << "  cpuinfo, cpu      CPU information" << '\n';
+     std::cout << "  meminfo, mem      memory usage" << '\n';
+     std::cout << "  diskls, disk      disks and storage" << '\n';
+     std::cout << "  osinfo, os        operating system information" << '\n';
+     std::cout << "  infoutils-exporter, exporter" << '\n';
+     std::cout << "                    serve the metrics of all four over HTTP" << '\n';
+     std::cout << '\n';
+     std::cout << "  -a, --all         run cpuinfo, meminfo, diskls and osinfo at once, each with" << '\n';
+     std::cout << "                    the OPTIONs, and print their reports in that order;" << '\n';
+     std::cout << "                    watch, --history, --record and --replay options are" << '\n';
+     std::cout << "                    not allowed with it" << '\n';
+     std::cout << "  -h, --help        display this help and exit" << '\n';
+     std::cout << "  -V, --version     output version information and exit" << '\n';
+     std::cout << '\n';
+     std::cout << "Examples:" << '\n';
+     std::cout << "  infoutils cpu topology" << '\n';
+     std::cout << "                    Show only the CPU topology" << '\n';
+     std::cout << "  infoutils --all --format=json" << '\n';
+     std::cout << "                    Print one JSON object from each tool" << '\n';
+     std::cout << "  ln -s infoutils cpuinfo" << '\n';
+     std::cout << "                    Run cpuinfo as its own command" << '\n';
+     std::cout << '\n';
+     std::cout << "QCO InfoUtils home page: <https://github.com/Qainar-Projects/infoutils>" << '\n';
+ }
+ 
+ void invalidTool(const std::string& name) {
+     std::cerr << colorize("infoutils: invalid tool -- '" + name + "'", Colors::RED, stdoutIsTerminal()) << '\n';
+     std::cerr << "Try 'infoutils --help' for more information." << '\n';
+ }
+ 
+ }
+ 
+ int main(int argc, char* argv[]) {
+     // Run as the tool a link is named after
+     const char* slash = std::strrchr(argv[0], '/');
+     const Tool* tool = findTool(slash ? slash + 1 : argv[0]);
+     if (tool) return tool->main(argc, argv);
+     
+     if (argc < 2) {
+         std::cerr << "infoutils: missing tool" << '\n';
+         std::cerr << "Try 'infoutils --help' for more information." << '\n';
+         return 1;
+     }
+     
+     std::string arg = argv[1];
+     if (arg == "--help" || arg == "-h") {
+         printHelp();
+         return 0;
+     } else if (arg == "--version" || arg == "-V") {
+         printVersion();
+         return 0;
+     } else if (arg == "--all" || arg == "-a") {
+         const char* option = findWatchOption(argc - 2, argv + 2);
+         if (option) {
+             std::cerr << colorize("infoutils: option '" + std::string(option) + "' cannot be used with --all",
+                                   Colors::RED, stdoutIsTerminal()) << '\n';
+             std::cerr << "Try 'infoutils --help' for more information." << '\n';
+             return 1;
+         }
+         try {
+             return runAll(argc - 2, argv + 2);
+         } catch (const std::exception& e) {
+             std::cerr << "infoutils: " << e.what() << '\n';
+             return 1;
+         }
+     }
+     
+     tool = findTool(arg);
+     if (!tool) {
+         invalidTool(arg);
+         return 1;
+     }
+     return tool->main(argc - 1, argv + 1);
+ }
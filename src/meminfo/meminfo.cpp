@@ -15,365 +15,963 @@
  #include <iomanip>
  #include <filesystem>
  #include <cstring>
+ #include <cerrno>
+ #include <cstdlib>
+ #include <ctime>
+ #include <stdexcept>
+ #include <memory>
  #include <unistd.h>
+ #include <fcntl.h>
  #include <sys/sysinfo.h>
  
+ #include "meminfo.hpp"
+ #include "output.hpp"
+ #include "cli.hpp"
+ #include "format.hpp"
+ #include "procfs.hpp"
+ #include "stats.hpp"
+ #include "mem.hpp"
+ #include "sysfs.hpp"
+ #include "cgroup.hpp"
+ #include "history.hpp"
+ #include "record.hpp"
+ #include "multicall.hpp"
+ 
  namespace fs = std::filesystem;
  
- // ANSI Color codes
- namespace Colors {
-     const std::string RESET = "\033[0m";
-     const std::string BOLD = "\033[1m";
-     const std::string RED = "\033[31m";
-     const std::string GREEN = "\033[32m";
-     const std::string YELLOW = "\033[33m";
-     const std::string BLUE = "\033[34m";
-     const std::string MAGENTA = "\033[35m";
-     const std::string CYAN = "\033[36m";
-     const std::string WHITE = "\033[37m";
-     const std::string DIM = "\033[2m";
+ std::string MemInfoUtil::formatBytes(unsigned long kb) {
+     if (kb == 0) return "0";
+     return ::formatBytes(kb * 1024ULL);
  }
  
- struct MemoryInfo {
-     unsigned long total_kb = 0;
-     unsigned long available_kb = 0;
-     unsigned long free_kb = 0;
-     unsigned long buffers_kb = 0;
-     unsigned long cached_kb = 0;
-     unsigned long swap_total_kb = 0;
-     unsigned long swap_free_kb = 0;
-     unsigned long swap_cached_kb = 0;
-     unsigned long shmem_kb = 0;
-     unsigned long sreclaimable_kb = 0;
-     unsigned long sunreclaim_kb = 0;
- };
- 
- struct ProcessInfo {
-     int pid;
-     std::string name;
-     unsigned long memory_kb;
-     std::string cmd;
- };
- 
- class MemInfoUtil {
- private:
-     bool show_processes = false;
-     bool show_detailed = false;
-     bool show_swap = false;
-     bool use_colors = true;
- 
-     std::string formatBytes(unsigned long kb) {
-         if (kb == 0) return "0";
-         
-         double bytes = kb * 1024.0;
-         const char* units[] = {"B", "KB", "MB", "GB", "TB"};
-         int unit = 0;
-         
-         while (bytes >= 1024.0 && unit < 4) {
-             bytes /= 1024.0;
-             unit++;
-         }
+ std::string MemInfoUtil::colorize(const std::string& text, const std::string& color) {
+     return ::colorize(text, color, use_colors);
+ }
+ 
+ // Open the cgroup selected by --cgroup once for all reads
+ void MemInfoUtil::openCgroup() {
+     if (cgroup_dir.valid()) return;
+     
+     std::string path = resolveCgroup(cgroup_spec);
+     if (!cgroup_dir.open(path.c_str())) {
+         throw std::runtime_error("cannot open cgroup " + path + ": " + std::strerror(errno));
+     }
+     if (faccessat(cgroup_dir.get(), "memory.current", R_OK, 0) != 0) {
+         throw std::runtime_error("memory controller is not enabled for " + path);
+     }
+     cgroup_spec = path;
+ }
+ 
+ // Every process's /proc/PID/statm, for --record -p
+ void MemInfoUtil::readProcessStatm(std::vector<ProcessStatm>& processes) {
+     processes.clear();
+     int proc_fd = openSystemFile("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+     if (proc_fd < 0) return;
+     
+     std::vector<int> pids;
+     listPids(proc_fd, pids);
+     char path[32];
+     char buf[128];
+     for (int pid : pids) {
+         snprintf(path, sizeof(path), "%d/statm", pid);
+         if (readFileAt(proc_fd, path, buf, sizeof(buf)) <= 0) continue;
          
-         std::ostringstream oss;
-         if (unit == 0) {
-             oss << static_cast<unsigned long>(bytes) << " " << units[unit];
-         } else {
-             oss << std::fixed << std::setprecision(1) << bytes << " " << units[unit];
-         }
-         return oss.str();
+         const char* p = buf;
+         ProcessStatm proc;
+         proc.pid = pid;
+         proc.size = parseNumber(p);
+         proc.resident = parseNumber(p);
+         proc.shared = parseNumber(p);
+         processes.push_back(proc);
      }
+     close(proc_fd);
+ }
+ 
+ bool MemInfoUtil::collectSmaps() {
+     return sort_key != MEM_SORT_RSS || show_detailed;
+ }
  
-     std::string colorize(const std::string& text, const std::string& color) {
-         if (!use_colors) return text;
-         return color + text + Colors::RESET;
+ std::vector<ProcessMemory> MemInfoUtil::getTopProcesses(size_t limit) {
+     std::vector<ProcessMemory> processes;
+     if (!readTopProcesses(sort_key, limit, scan_jobs, show_detailed, processes)) {
+         std::cerr << colorize("Warning: Could not read all process information", Colors::YELLOW) << '\n';
      }
+     return processes;
+ }
+ 
+ void MemInfoUtil::printMemoryLine(const std::string& label, unsigned long kb) {
+     std::cout << std::left << std::setw(18) << label 
+               << std::setw(12) << formatBytes(kb)
+               << colorize("(" + std::to_string(kb) + " kB)", Colors::DIM) << '\n';
+ }
+ 
+ void MemInfoUtil::printSeparator(const std::string& title) {
+     ::printSeparator(title, use_colors);
+ }
  
-     MemoryInfo getMemoryInfo() {
-         MemoryInfo info;
-         std::ifstream file("/proc/meminfo");
-         std::string line;
+ void MemInfoUtil::printGeneralInfo() {
+     MemoryInfo info = sampler.memoryInfo();
+     
+     unsigned long used_kb = info[MEM_TOTAL] - info[MEM_AVAILABLE];
+     double used_percentage = (double)used_kb / info[MEM_TOTAL] * 100.0;
+     
+     printSeparator("Memory Information");
+     
+     std::cout << std::left << std::setw(18) << "Total:" 
+               << std::setw(12) << formatBytes(info[MEM_TOTAL]) 
+               << colorize("(" + std::to_string(info[MEM_TOTAL]) + " kB)", Colors::DIM) << '\n';
+     
+     std::cout << std::left << std::setw(18) << "Available:" 
+               << std::setw(12) << formatBytes(info[MEM_AVAILABLE])
+               << colorize("(" + std::to_string(info[MEM_AVAILABLE]) + " kB)", Colors::DIM) << '\n';
+     
+     std::cout << std::left << std::setw(18) << "Used:" 
+               << std::setw(12) << formatBytes(used_kb)
+               << colorize("(" + std::to_string(used_kb) + " kB, " + 
+                          std::to_string(static_cast<int>(used_percentage)) + "%)", Colors::DIM) << '\n';
+     
+     std::cout << std::left << std::setw(18) << "Free:" 
+               << std::setw(12) << formatBytes(info[MEM_FREE])
+               << colorize("(" + std::to_string(info[MEM_FREE]) + " kB)", Colors::DIM) << '\n';
+     
+     if (show_detailed) {
+         std::cout << std::left << std::setw(18) << "Buffers:" 
+                   << std::setw(12) << formatBytes(info[MEM_BUFFERS])
+                   << colorize("(" + std::to_string(info[MEM_BUFFERS]) + " kB)", Colors::DIM) << '\n';
          
-         while (std::getline(file, line)) {
-             std::istringstream iss(line);
-             std::string key;
-             unsigned long value;
+         std::cout << std::left << std::setw(18) << "Cached:" 
+                   << std::setw(12) << formatBytes(info[MEM_CACHED])
+                   << colorize("(" + std::to_string(info[MEM_CACHED]) + " kB)", Colors::DIM) << '\n';
+         
+         if (info[MEM_SHMEM] > 0) {
+             std::cout << std::left << std::setw(18) << "Shared:" 
+                       << std::setw(12) << formatBytes(info[MEM_SHMEM])
+                       << colorize("(" + std::to_string(info[MEM_SHMEM]) + " kB)", Colors::DIM) << '\n';
+         }
+         
+         if (info[MEM_SRECLAIMABLE] > 0 || info[MEM_SUNRECLAIM] > 0) {
+             std::cout << std::left << std::setw(18) << "Slab reclaimable:" 
+                       << std::setw(12) << formatBytes(info[MEM_SRECLAIMABLE])
+                       << colorize("(" + std::to_string(info[MEM_SRECLAIMABLE]) + " kB)", Colors::DIM) << '\n';
              
-             if (iss >> key >> value) {
-                 if (key == "MemTotal:") info.total_kb = value;
-                 else if (key == "MemAvailable:") info.available_kb = value;
-                 else if (key == "MemFree:") info.free_kb = value;
-                 else if (key == "Buffers:") info.buffers_kb = value;
-                 else if (key == "Cached:") info.cached_kb = value;
-                 else if (key == "SwapTotal:") info.swap_total_kb = value;
-                 else if (key == "SwapFree:") info.swap_free_kb = value;
-                 else if (key == "SwapCached:") info.swap_cached_kb = value;
-                 else if (key == "Shmem:") info.shmem_kb = value;
-                 else if (key == "SReclaimable:") info.sreclaimable_kb = value;
-                 else if (key == "SUnreclaim:") info.sunreclaim_kb = value;
-             }
+             std::cout << std::left << std::setw(18) << "Slab unreclaimable:" 
+                       << std::setw(12) << formatBytes(info[MEM_SUNRECLAIM])
+                       << colorize("(" + std::to_string(info[MEM_SUNRECLAIM]) + " kB)", Colors::DIM) << '\n';
          }
          
-         return info;
-     }
- 
-     std::vector<ProcessInfo> getTopProcesses(int limit = 15) {
-         std::vector<ProcessInfo> processes;
+         printMemoryLine("Dirty:", info[MEM_DIRTY]);
+         printMemoryLine("Writeback:", info[MEM_WRITEBACK]);
          
-         try {
-             for (const auto& entry : fs::directory_iterator("/proc")) {
-                 if (!entry.is_directory()) continue;
-                 
-                 std::string dirname = entry.path().filename();
-                 if (!std::all_of(dirname.begin(), dirname.end(), ::isdigit)) continue;
-                 
-                 int pid = std::stoi(dirname);
-                 std::string status_path = "/proc/" + dirname + "/status";
-                 std::string cmdline_path = "/proc/" + dirname + "/cmdline";
-                 
-                 std::ifstream status_file(status_path);
-                 if (!status_file.is_open()) continue;
-                 
-                 std::string name;
-                 unsigned long memory_kb = 0;
-                 std::string line;
-                 
-                 while (std::getline(status_file, line)) {
-                     if (line.substr(0, 5) == "Name:") {
-                         name = line.substr(6);
-                     } else if (line.substr(0, 6) == "VmRSS:") {
-                         std::istringstream iss(line);
-                         std::string key;
-                         if (iss >> key >> memory_kb) {
-                             break;
-                         }
-                     }
-                 }
-                 
-                 // Get command line
-                 std::string cmd;
-                 std::ifstream cmdline_file(cmdline_path);
-                 if (cmdline_file.is_open()) {
-                     std::getline(cmdline_file, cmd);
-                     // Replace null bytes with spaces
-                     std::replace(cmd.begin(), cmd.end(), '\0', ' ');
-                     if (cmd.length() > 40) {
-                         cmd = cmd.substr(0, 37) + "...";
-                     }
-                 }
-                 
-                 if (!name.empty() && memory_kb > 0) {
-                     processes.push_back({pid, name, memory_kb, cmd});
-                 }
-             }
-         } catch (const std::exception& e) {
-             std::cerr << colorize("Warning: Could not read all process information", Colors::YELLOW) << std::endl;
+         if (info[MEM_MLOCKED] > 0) {
+             printMemoryLine("Mlocked:", info[MEM_MLOCKED]);
          }
          
-         std::sort(processes.begin(), processes.end(), 
-                   [](const ProcessInfo& a, const ProcessInfo& b) {
-                       return a.memory_kb > b.memory_kb;
-                   });
+         printMemoryLine("Kernel stack:", info[MEM_KERNEL_STACK]);
+         printMemoryLine("Page tables:", info[MEM_PAGE_TABLES]);
          
-         if (processes.size() > limit) {
-             processes.resize(limit);
+         if (info[MEM_PERCPU] > 0) {
+             printMemoryLine("Per-CPU:", info[MEM_PERCPU]);
          }
          
-         return processes;
+         printMemoryLine("Committed:", info[MEM_COMMITTED_AS]);
+         printMemoryLine("Commit limit:", info[MEM_COMMIT_LIMIT]);
+         
+         if (info[MEM_ANON_HUGE_PAGES] > 0) {
+             printMemoryLine("Anon huge pages:", info[MEM_ANON_HUGE_PAGES]);
+         }
+         
+         // HugePages_* are page counts rather than sizes
+         if (info[MEM_HUGE_PAGES_TOTAL] > 0) {
+             std::cout << std::left << std::setw(18) << "Huge pages:" 
+                       << info[MEM_HUGE_PAGES_FREE] << " of " << info[MEM_HUGE_PAGES_TOTAL] << " free "
+                       << colorize("(" + formatBytes(info[MEM_HUGE_PAGE_SIZE]) + " pages, " +
+                                  std::to_string(info[MEM_HUGE_PAGES_RSVD]) + " reserved)", Colors::DIM) << '\n';
+         }
      }
- 
-     void printSeparator(const std::string& title = "") {
-         if (title.empty()) {
-             std::cout << std::string(70, '-') << std::endl;
+     
+     if (info[MEM_SWAP_TOTAL] > 0 || show_swap) {
+         std::cout << '\n';
+         printSeparator("Swap Information");
+         
+         if (info[MEM_SWAP_TOTAL] > 0) {
+             unsigned long swap_used_kb = info[MEM_SWAP_TOTAL] - info[MEM_SWAP_FREE];
+             double swap_used_percentage = (double)swap_used_kb / info[MEM_SWAP_TOTAL] * 100.0;
+             
+             std::cout << std::left << std::setw(18) << "Total:" 
+                       << std::setw(12) << formatBytes(info[MEM_SWAP_TOTAL])
+                       << colorize("(" + std::to_string(info[MEM_SWAP_TOTAL]) + " kB)", Colors::DIM) << '\n';
+             
+             std::cout << std::left << std::setw(18) << "Free:" 
+                       << std::setw(12) << formatBytes(info[MEM_SWAP_FREE])
+                       << colorize("(" + std::to_string(info[MEM_SWAP_FREE]) + " kB)", Colors::DIM) << '\n';
+             
+             std::cout << std::left << std::setw(18) << "Used:" 
+                       << std::setw(12) << formatBytes(swap_used_kb)
+                       << colorize("(" + std::to_string(swap_used_kb) + " kB, " + 
+                                  std::to_string(static_cast<int>(swap_used_percentage)) + "%)", Colors::DIM) << '\n';
+             
+             if (info[MEM_SWAP_CACHED] > 0) {
+                 std::cout << std::left << std::setw(18) << "Cached:" 
+                           << std::setw(12) << formatBytes(info[MEM_SWAP_CACHED])
+                           << colorize("(" + std::to_string(info[MEM_SWAP_CACHED]) + " kB)", Colors::DIM) << '\n';
+             }
          } else {
-             std::cout << colorize(title, Colors::BOLD) << std::endl;
-             std::cout << std::string(title.length(), '=') << std::endl;
+             std::cout << "No swap space configured" << '\n';
          }
      }
+ }
  
-     void printGeneralInfo() {
-         MemoryInfo info = getMemoryInfo();
-         
-         unsigned long used_kb = info.total_kb - info.available_kb;
-         double used_percentage = (double)used_kb / info.total_kb * 100.0;
-         
-         printSeparator("Memory Information");
-         
-         std::cout << std::left << std::setw(18) << "Total:" 
-                   << std::setw(12) << formatBytes(info.total_kb) 
-                   << colorize("(" + std::to_string(info.total_kb) + " kB)", Colors::DIM) << std::endl;
-         
-         std::cout << std::left << std::setw(18) << "Available:" 
-                   << std::setw(12) << formatBytes(info.available_kb)
-                   << colorize("(" + std::to_string(info.available_kb) + " kB)", Colors::DIM) << std::endl;
-         
-         std::cout << std::left << std::setw(18) << "Used:" 
-                   << std::setw(12) << formatBytes(used_kb)
-                   << colorize("(" + std::to_string(used_kb) + " kB, " + 
-                              std::to_string(static_cast<int>(used_percentage)) + "%)", Colors::DIM) << std::endl;
-         
-         std::cout << std::left << std::setw(18) << "Free:" 
-                   << std::setw(12) << formatBytes(info.free_kb)
-                   << colorize("(" + std::to_string(info.free_kb) + " kB)", Colors::DIM) << std::endl;
+ void MemInfoUtil::printCgroupLimit(const std::string& label, unsigned long long bytes) {
+     if (bytes == CGROUP_UNLIMITED) {
+         std::cout << std::left << std::setw(18) << label << "unlimited" << '\n';
+     } else {
+         printMemoryLine(label, bytes / 1024);
+     }
+ }
+ 
+ // memory.stat values are in bytes, unlike the kB of /proc/meminfo
+ void MemInfoUtil::printCgroupStat(const char* stat, const char* key, const std::string& label) {
+     unsigned long long value;
+     if (cgroupStatValue(stat, key, value)) {
+         printMemoryLine(label, value / 1024);
+     }
+ }
+ 
+ // Memory of the --cgroup cgroup in place of the host-wide summary
+ void MemInfoUtil::printCgroupInfo() {
+     openCgroup();
+     
+     printSeparator("Cgroup Memory");
+     std::cout << std::left << std::setw(18) << "Cgroup:" << cgroup_spec << '\n';
+     
+     unsigned long long current = 0, limit = CGROUP_UNLIMITED, value;
+     readCgroupLimit(cgroup_dir, "memory.current", current);
+     readCgroupLimit(cgroup_dir, "memory.max", limit);
+     
+     char stat[8192] = "";
+     cgroup_dir.read("memory.stat", stat, sizeof(stat));
+     
+     printCgroupLimit("Limit:", limit);
+     
+     std::cout << std::left << std::setw(18) << "Current:" 
+               << std::setw(12) << formatBytes(current / 1024);
+     if (limit != CGROUP_UNLIMITED && limit > 0) {
+         int percent = static_cast<int>((double)current / limit * 100.0);
+         std::cout << colorize("(" + std::to_string(current / 1024) + " kB, " +
+                               std::to_string(percent) + "%)", Colors::DIM);
+     } else {
+         std::cout << colorize("(" + std::to_string(current / 1024) + " kB)", Colors::DIM);
+     }
+     std::cout << '\n';
+     
+     unsigned long long inactive = 0;
+     cgroupStatValue(stat, "inactive_file", inactive);
+     printMemoryLine("Working set:", (current - std::min(current, inactive)) / 1024);
+     
+     if (readCgroupLimit(cgroup_dir, "memory.high", value) && value != CGROUP_UNLIMITED) {
+         printMemoryLine("High:", value / 1024);
+     }
+     if (readCgroupLimit(cgroup_dir, "memory.peak", value)) {
+         printMemoryLine("Peak:", value / 1024);
+     }
+     if (readCgroupLimit(cgroup_dir, "memory.swap.current", value)) {
+         printMemoryLine("Swap:", value / 1024);
+         if (readCgroupLimit(cgroup_dir, "memory.swap.max", value)) {
+             printCgroupLimit("Swap limit:", value);
+         }
+     }
+     
+     char text[512];
+     double some, full;
+     if (cgroup_dir.read("memory.pressure", text, sizeof(text)) > 0 && parsePressure(text, some, full)) {
+         std::cout << std::left << std::setw(18) << "Pressure:" 
+                   << std::fixed << std::setprecision(2)
+                   << "some " << some << "%, full " << full << "% (avg10)" << '\n';
+     }
+     
+     if (cgroup_dir.read("memory.events", text, sizeof(text)) > 0) {
+         unsigned long long oom = 0, oom_kill = 0;
+         cgroupStatValue(text, "oom", oom);
+         cgroupStatValue(text, "oom_kill", oom_kill);
+         if (oom > 0 || oom_kill > 0 || show_detailed) {
+             std::cout << std::left << std::setw(18) << "OOM events:" 
+                       << oom << colorize(" (" + std::to_string(oom_kill) + " killed)", Colors::DIM) << '\n';
+         }
+     }
+     
+     if (show_detailed) {
+         printCgroupStat(stat, "anon", "Anonymous:");
+         printCgroupStat(stat, "file", "File:");
+         printCgroupStat(stat, "inactive_file", "Inactive file:");
+         printCgroupStat(stat, "shmem", "Shared:");
+         printCgroupStat(stat, "kernel", "Kernel:");
+         printCgroupStat(stat, "slab", "Slab:");
+         printCgroupStat(stat, "kernel_stack", "Kernel stack:");
+         printCgroupStat(stat, "pagetables", "Page tables:");
+         printCgroupStat(stat, "sock", "Sockets:");
+         printCgroupStat(stat, "file_dirty", "Dirty:");
+         printCgroupStat(stat, "file_writeback", "Writeback:");
+         printCgroupStat(stat, "anon_thp", "Anon huge pages:");
+     }
+ }
+ 
+ // Rank the cgroups below --cgroup, or below the hierarchy root, by
+ // memory.current. Only the listed cgroups have their limit read.
+ void MemInfoUtil::printCgroupTop() {
+     std::string root = resolveCgroup(cgroup_mode ? cgroup_spec : "/");
+     auto top = topCgroups(root, cgroup_top, cgroupMemoryMetric);
+     
+     std::cout << '\n';
+     printSeparator("Top Memory Cgroups");
+     
+     std::cout << std::left 
+               << std::setw(12) << "MEMORY"
+               << std::setw(12) << "LIMIT"
+               << "CGROUP" << '\n';
+     printSeparator();
+     
+     SysfsDir root_dir, dir;
+     root_dir.open(root.c_str());
+     for (const auto& usage : top) {
+         unsigned long long limit = CGROUP_UNLIMITED;
+         if (dir.open(root_dir, usage.path.c_str())) {
+             readCgroupLimit(dir, "memory.max", limit);
+         }
          
-         if (show_detailed) {
-             std::cout << std::left << std::setw(18) << "Buffers:" 
-                       << std::setw(12) << formatBytes(info.buffers_kb)
-                       << colorize("(" + std::to_string(info.buffers_kb) + " kB)", Colors::DIM) << std::endl;
-             
-             std::cout << std::left << std::setw(18) << "Cached:" 
-                       << std::setw(12) << formatBytes(info.cached_kb)
-                       << colorize("(" + std::to_string(info.cached_kb) + " kB)", Colors::DIM) << std::endl;
-             
-             if (info.shmem_kb > 0) {
-                 std::cout << std::left << std::setw(18) << "Shared:" 
-                           << std::setw(12) << formatBytes(info.shmem_kb)
-                           << colorize("(" + std::to_string(info.shmem_kb) + " kB)", Colors::DIM) << std::endl;
+         std::cout << std::left 
+                   << std::setw(12) << formatBytes(usage.value / 1024)
+                   << std::setw(12) << (limit == CGROUP_UNLIMITED ? "-" : formatBytes(limit / 1024))
+                   << usage.path << '\n';
+     }
+ }
+ 
+ void MemInfoUtil::printProcesses() {
+     std::cout << '\n';
+     printSeparator("Top Memory Consumers");
+     
+     auto processes = getTopProcesses(15);
+     
+     bool smaps = collectSmaps();
+     
+     std::cout << std::left 
+               << std::setw(8) << "PID"
+               << std::setw(16) << "COMMAND"
+               << std::setw(12) << (smaps ? "RSS" : "MEMORY");
+     if (smaps) {
+         std::cout << std::setw(10) << "PSS"
+                   << std::setw(10) << "USS"
+                   << std::setw(10) << "SWAP";
+     }
+     std::cout << "CMDLINE" << '\n';
+     printSeparator();
+     
+     // Ranking by swap only finds processes with pages swapped out
+     if (processes.empty() && sort_key == MEM_SORT_SWAP) {
+         std::cout << "No process has memory swapped out" << '\n';
+     }
+     
+     for (const auto& proc : processes) {
+         std::cout << std::left 
+                   << std::setw(8) << proc.pid
+                   << std::setw(16) << proc.name.substr(0, 15)
+                   << std::setw(12) << formatBytes(proc.rss_kb);
+         if (smaps) {
+             // smaps_rollup needs ptrace access, other users' processes show "-"
+             std::cout << std::setw(10) << (proc.has_smaps ? formatBytes(proc.pss_kb) : "-")
+                       << std::setw(10) << (proc.has_smaps ? formatBytes(proc.uss_kb) : "-")
+                       << std::setw(10) << (proc.has_smaps ? formatBytes(proc.swap_kb) : "-");
+         }
+         std::cout << proc.cmd << '\n';
+     }
+ }
+ 
+ bool MemInfoUtil::machineOutput() const {
+     return writer.format() != OutputFormat::TEXT;
+ }
+ 
+ // /proc/meminfo fields of the "memory" group, converted from kB to bytes
+ void MemInfoUtil::writeMemoryInfo(const MemoryInfo& info) {
+     static const struct {
+         const char* key;
+         MemField field;
+     } fields[] = {
+         {"total_bytes", MEM_TOTAL},
+         {"available_bytes", MEM_AVAILABLE},
+         {"free_bytes", MEM_FREE},
+         {"buffers_bytes", MEM_BUFFERS},
+         {"cached_bytes", MEM_CACHED},
+         {"active_bytes", MEM_ACTIVE},
+         {"inactive_bytes", MEM_INACTIVE},
+         {"anon_bytes", MEM_ANON_PAGES},
+         {"mapped_bytes", MEM_MAPPED},
+         {"shmem_bytes", MEM_SHMEM},
+         {"slab_reclaimable_bytes", MEM_SRECLAIMABLE},
+         {"slab_unreclaimable_bytes", MEM_SUNRECLAIM},
+         {"dirty_bytes", MEM_DIRTY},
+         {"writeback_bytes", MEM_WRITEBACK},
+         {"mlocked_bytes", MEM_MLOCKED},
+         {"kernel_stack_bytes", MEM_KERNEL_STACK},
+         {"page_tables_bytes", MEM_PAGE_TABLES},
+         {"percpu_bytes", MEM_PERCPU},
+         {"committed_as_bytes", MEM_COMMITTED_AS},
+         {"commit_limit_bytes", MEM_COMMIT_LIMIT},
+         {"anon_huge_pages_bytes", MEM_ANON_HUGE_PAGES},
+         {"swap_total_bytes", MEM_SWAP_TOTAL},
+         {"swap_free_bytes", MEM_SWAP_FREE},
+         {"swap_cached_bytes", MEM_SWAP_CACHED},
+     };
+     
+     writer.group("memory");
+     for (const auto& entry : fields) {
+         writer.field(entry.key, info[entry.field] * 1024ULL);
+     }
+     writer.field("used_bytes", (info[MEM_TOTAL] - info[MEM_AVAILABLE]) * 1024ULL);
+     
+     // HugePages_* are page counts rather than sizes
+     writer.field("huge_pages", info[MEM_HUGE_PAGES_TOTAL]);
+     writer.field("huge_pages_free", info[MEM_HUGE_PAGES_FREE]);
+     writer.field("huge_pages_reserved", info[MEM_HUGE_PAGES_RSVD]);
+     writer.field("huge_page_size_bytes", info[MEM_HUGE_PAGE_SIZE] * 1024ULL);
+ }
+ 
+ // memory.* files of the --cgroup cgroup; memory.stat is in bytes already
+ void MemInfoUtil::writeCgroupInfo() {
+     openCgroup();
+     
+     unsigned long long current = 0, value;
+     char stat[8192] = "";
+     readCgroupLimit(cgroup_dir, "memory.current", current);
+     cgroup_dir.read("memory.stat", stat, sizeof(stat));
+     
+     writer.group("cgroup");
+     writer.field("path", cgroup_spec);
+     writer.field("current_bytes", current);
+     if (readCgroupLimit(cgroup_dir, "memory.max", value) && value != CGROUP_UNLIMITED) {
+         writer.field("max_bytes", value);
+     }
+     if (readCgroupLimit(cgroup_dir, "memory.high", value) && value != CGROUP_UNLIMITED) {
+         writer.field("high_bytes", value);
+     }
+     if (readCgroupLimit(cgroup_dir, "memory.peak", value)) writer.field("peak_bytes", value);
+     if (readCgroupLimit(cgroup_dir, "memory.swap.current", value)) writer.field("swap_bytes", value);
+     if (readCgroupLimit(cgroup_dir, "memory.swap.max", value) && value != CGROUP_UNLIMITED) {
+         writer.field("swap_max_bytes", value);
+     }
+     
+     unsigned long long inactive = 0;
+     cgroupStatValue(stat, "inactive_file", inactive);
+     writer.field("working_set_bytes", current - std::min(current, inactive));
+     
+     const char* stat_keys[] = {
+         "anon", "file", "inactive_file", "shmem", "kernel", "slab", "kernel_stack",
+         "pagetables", "sock", "file_dirty", "file_writeback", "anon_thp"
+     };
+     char key[32];
+     for (const char* name : stat_keys) {
+         if (cgroupStatValue(stat, name, value)) {
+             snprintf(key, sizeof(key), "%s_bytes", name);
+             writer.field(key, value);
+         }
+     }
+     
+     char text[512];
+     double some, full;
+     if (cgroup_dir.read("memory.pressure", text, sizeof(text)) > 0 && parsePressure(text, some, full)) {
+         writer.field("pressure_some", some);
+         writer.field("pressure_full", full);
+     }
+     if (cgroup_dir.read("memory.events", text, sizeof(text)) > 0) {
+         if (cgroupStatValue(text, "oom", value)) writer.counter("oom_total", value);
+         if (cgroupStatValue(text, "oom_kill", value)) writer.counter("oom_kill_total", value);
+     }
+ }
+ 
+ void MemInfoUtil::writeReport() {
+     writer.begin(wallClock());
+     
+     if (cgroup_mode) {
+         writeCgroupInfo();
+     } else if (show_general) {
+         writeMemoryInfo(sampler.memoryInfo());
+     }
+     
+     if (cgroup_top > 0) {
+         std::string root = resolveCgroup(cgroup_mode ? cgroup_spec : "/");
+         SysfsDir root_dir, dir;
+         root_dir.open(root.c_str());
+         for (const auto& usage : topCgroups(root, cgroup_top, cgroupMemoryMetric)) {
+             writer.group("cgroup_top", "cgroup", usage.path);
+             writer.field("current_bytes", usage.value);
+             unsigned long long limit;
+             if (dir.open(root_dir, usage.path.c_str()) && readCgroupLimit(dir, "memory.max", limit) &&
+                 limit != CGROUP_UNLIMITED) {
+                 writer.field("max_bytes", limit);
              }
-             
-             if (info.sreclaimable_kb > 0 || info.sunreclaim_kb > 0) {
-                 std::cout << std::left << std::setw(18) << "Slab reclaimable:" 
-                           << std::setw(12) << formatBytes(info.sreclaimable_kb)
-                           << colorize("(" + std::to_string(info.sreclaimable_kb) + " kB)", Colors::DIM) << std::endl;
-                 
-                 std::cout << std::left << std::setw(18) << "Slab unreclaimable:" 
-                           << std::setw(12) << formatBytes(info.sunreclaim_kb)
-                           << colorize("(" + std::to_string(info.sunreclaim_kb) + " kB)", Colors::DIM) << std::endl;
+         }
+     }
+     
+     if (show_processes) {
+         for (const auto& proc : getTopProcesses(15)) {
+             writer.group("process", "pid", proc.pid);
+             writer.field("name", proc.name);
+             writer.field("rss_bytes", proc.rss_kb * 1024ULL);
+             if (proc.has_smaps) {
+                 writer.field("pss_bytes", proc.pss_kb * 1024ULL);
+                 writer.field("uss_bytes", proc.uss_kb * 1024ULL);
+                 writer.field("swap_bytes", proc.swap_kb * 1024ULL);
              }
+             writer.field("cmdline", proc.cmd);
+         }
+     }
+     
+     writer.end();
+ }
+ 
+ // --format output of one watch tick, with vmstat counters as rates
+ void MemInfoUtil::writeWatchSample(const MemoryInfo& info, const VmStatCounters& prev, const VmStatCounters& cur,
+                                    const MemoryPressure& pressure, double elapsed,
+                                    const std::vector<ProcessStatm>* processes, unsigned long page_size) {
+     auto rate = [elapsed](unsigned long long before, unsigned long long after) {
+         return after >= before && elapsed > 0 ? (after - before) / elapsed : 0.0;
+     };
+     
+     writer.begin(replay_time > 0.0 ? replay_time : wallClock());
+     writeMemoryInfo(info);
+     
+     writer.group("vmstat");
+     writer.field("pgscan_per_s", rate(prev.pgscan, cur.pgscan), 1);
+     writer.field("pgsteal_per_s", rate(prev.pgsteal, cur.pgsteal), 1);
+     writer.field("pswpin_per_s", rate(prev.pswpin, cur.pswpin), 1);
+     writer.field("pswpout_per_s", rate(prev.pswpout, cur.pswpout), 1);
+     writer.field("pgmajfault_per_s", rate(prev.pgmajfault, cur.pgmajfault), 1);
+     
+     if (pressure.available) {
+         writer.group("pressure");
+         writer.field("some_avg10", pressure.some_avg10);
+         writer.field("full_avg10", pressure.full_avg10);
+     }
+     
+     // Recorded statm sizes, only available when replaying
+     if (processes) {
+         for (const auto& proc : *processes) {
+             writer.group("process", "pid", proc.pid);
+             writer.field("size_bytes", proc.size * page_size);
+             writer.field("rss_bytes", proc.resident * page_size);
+             writer.field("shared_bytes", proc.shared * page_size);
          }
+     }
+     writer.end();
+ }
+ 
+ void MemInfoUtil::formatTimestamp(char* buf, size_t size) {
+     time_t now = replay_time > 0.0 ? static_cast<time_t>(replay_time) : time(nullptr);
+     struct tm local;
+     localtime_r(&now, &local);
+     strftime(buf, size, "%H:%M:%S", &local);
+ }
+ 
+ void MemInfoUtil::printWatchHeader() {
+     std::cout << colorize("TIME      AVAIL_MB  SWAP_MB PGSCAN/s PGSTEAL/s PSWPIN/s PSWPOUT/s MAJFLT/s SOME10 FULL10",
+                           Colors::BOLD) << '\n';
+ }
+ 
+ void MemInfoUtil::printWatchLine(const MemoryInfo& info, const VmStatCounters& prev, const VmStatCounters& cur,
+                                  const MemoryPressure& pressure, double elapsed) {
+     char timestamp[16];
+     formatTimestamp(timestamp, sizeof(timestamp));
+     
+     auto rate = [elapsed](unsigned long long before, unsigned long long after) {
+         return after >= before && elapsed > 0 ? (after - before) / elapsed : 0.0;
+     };
+     
+     std::cout << std::left << std::setw(8) << timestamp << std::right
+               << std::fixed << std::setprecision(0)
+               << std::setw(10) << info[MEM_AVAILABLE] / 1024
+               << std::setw(9) << (info[MEM_SWAP_TOTAL] - info[MEM_SWAP_FREE]) / 1024
+               << std::setw(9) << rate(prev.pgscan, cur.pgscan)
+               << std::setw(10) << rate(prev.pgsteal, cur.pgsteal)
+               << std::setw(9) << rate(prev.pswpin, cur.pswpin)
+               << std::setw(10) << rate(prev.pswpout, cur.pswpout)
+               << std::setw(9) << rate(prev.pgmajfault, cur.pgmajfault)
+               << std::setprecision(2);
+     if (pressure.available) {
+         std::cout << std::setw(7) << pressure.some_avg10
+                   << std::setw(7) << pressure.full_avg10;
+     } else {
+         std::cout << std::setw(7) << "-" << std::setw(7) << "-";
+     }
+     std::cout << '\n';
+ }
+ 
+ // Append one sample of meminfo, vmstat and pressure to --record
+ void MemInfoUtil::recordSample(const MemoryInfo& info, const VmStatCounters& vmstat, const MemoryPressure& pressure) {
+     if (!recorder.isOpen()) return;
+     recorder.beginSample(wallClock());
+     recorder.addMemory(info, vmstat, pressure);
+     if (show_processes) {
+         readProcessStatm(statm);
+         recorder.addProcesses(statm, page_kb * 1024);
+     }
+     if (!recorder.endSample()) {
+         throw std::runtime_error("cannot write " + record_path + ": " + std::strerror(errno));
+     }
+ }
+ 
+ // --replay: render a --record file like a live watch, with the
+ // recorded times and without waiting between samples
+ void MemInfoUtil::printReplay() {
+     SampleReader reader;
+     if (!reader.open(replay_path.c_str())) {
+         throw std::runtime_error("cannot replay " + replay_path + ": " +
+                                  (errno == EINVAL ? "not a recording" : std::strerror(errno)));
+     }
+     if (!machineOutput()) printWatchHeader();
+     
+     RecordedSample sample;
+     VmStatCounters prev;
+     double prev_time = 0.0;
+     bool have_prev = false;
+     long shown = 0;
+     while ((watch_count == 0 || shown < watch_count) && reader.next(sample)) {
+         if (!sample.has_memory) continue;
          
-         if (info.swap_total_kb > 0 || show_swap) {
-             std::cout << std::endl;
-             printSeparator("Swap Information");
-             
-             if (info.swap_total_kb > 0) {
-                 unsigned long swap_used_kb = info.swap_total_kb - info.swap_free_kb;
-                 double swap_used_percentage = (double)swap_used_kb / info.swap_total_kb * 100.0;
-                 
-                 std::cout << std::left << std::setw(18) << "Total:" 
-                           << std::setw(12) << formatBytes(info.swap_total_kb)
-                           << colorize("(" + std::to_string(info.swap_total_kb) + " kB)", Colors::DIM) << std::endl;
-                 
-                 std::cout << std::left << std::setw(18) << "Free:" 
-                           << std::setw(12) << formatBytes(info.swap_free_kb)
-                           << colorize("(" + std::to_string(info.swap_free_kb) + " kB)", Colors::DIM) << std::endl;
-                 
-                 std::cout << std::left << std::setw(18) << "Used:" 
-                           << std::setw(12) << formatBytes(swap_used_kb)
-                           << colorize("(" + std::to_string(swap_used_kb) + " kB, " + 
-                                      std::to_string(static_cast<int>(swap_used_percentage)) + "%)", Colors::DIM) << std::endl;
-                 
-                 if (info.swap_cached_kb > 0) {
-                     std::cout << std::left << std::setw(18) << "Cached:" 
-                               << std::setw(12) << formatBytes(info.swap_cached_kb)
-                               << colorize("(" + std::to_string(info.swap_cached_kb) + " kB)", Colors::DIM) << std::endl;
-                 }
+         // Samples from different recording sessions are not compared
+         if (have_prev && !sample.restarted) {
+             replay_time = sample.timestamp;
+             double elapsed = sample.timestamp - prev_time;
+             if (machineOutput()) {
+                 writeWatchSample(sample.memory, prev, sample.vmstat, sample.pressure, elapsed,
+                                  show_processes && sample.has_processes ? &sample.processes : nullptr,
+                                  sample.page_size);
              } else {
-                 std::cout << "No swap space configured" << std::endl;
+                 printWatchLine(sample.memory, prev, sample.vmstat, sample.pressure, elapsed);
              }
+             shown++;
          }
+         prev = sample.vmstat;
+         prev_time = sample.timestamp;
+         have_prev = true;
+     }
+     std::cout.flush();
+     replay_time = 0.0;
+     
+     if (reader.truncated()) {
+         std::cerr << colorize("meminfo: " + replay_path + " ends in an incomplete sample", Colors::YELLOW) << '\n';
      }
+ }
  
-     void printProcesses() {
-         std::cout << std::endl;
-         printSeparator("Top Memory Consumers");
+ // Sample meminfo, vmstat and memory pressure every watch_interval seconds,
+ // one line per tick with vmstat counters turned into per-second rates
+ void MemInfoUtil::printWatch() {
+     if (cgroup_mode) {
+         openCgroup();
+         sampler.useCgroup(cgroup_dir);
+     }
+     if (!sampler.openCounters()) {
+         throw std::runtime_error(std::string("cannot open /proc/vmstat: ") + std::strerror(errno));
+     }
+     
+     VmStatCounters prev = sampler.vmStat();
+     struct timespec prev_time;
+     clock_gettime(CLOCK_MONOTONIC, &prev_time);
+     
+     // A recording starts with a full sample to take deltas from
+     if (!record_path.empty()) {
+         if (!recorder.open(record_path.c_str())) {
+             throw std::runtime_error("cannot record to " + record_path + ": " +
+                                      (errno == EINVAL ? "not a recording" : std::strerror(errno)));
+         }
+         MemoryInfo info = cgroup_mode ? readCgroupMemoryInfo(cgroup_dir, sampler.memoryInfo()) : sampler.memoryInfo();
+         recordSample(info, prev, sampler.pressure());
+     }
+     
+     // --history keeps available memory, swap use, pressure and the
+     // scan rate of every tick and redraws them as sparklines
+     std::unique_ptr<SampleHistory> history;
+     std::vector<HistorySeries> series;
+     float values[5];
+     bool redraw = stdoutIsTerminal();
+     if (history_size > 0 && !machineOutput()) {
+         MemoryInfo info = cgroup_mode ? readCgroupMemoryInfo(cgroup_dir, sampler.memoryInfo()) : sampler.memoryInfo();
+         history.reset(new SampleHistory(history_size, 5));
+         series.emplace_back("avail_mb", 0, info[MEM_TOTAL] / 1024.0, 0);
+         series.emplace_back("swap_mb", 1, info[MEM_SWAP_TOTAL] / 1024.0, 0);
+         series.emplace_back("some10", 2, 100.0, 2);
+         series.emplace_back("full10", 3, 100.0, 2);
+         series.emplace_back("pgscan/s", 4, 0.0, 0);
+     } else if (!machineOutput()) {
+         printWatchHeader();
+         std::cout.flush();
+     }
+     
+     struct timespec deadline = prev_time;
+     for (long tick = 0; watch_count == 0 || tick < watch_count; ++tick) {
+         waitForNextTick(deadline, watch_interval);
          
-         auto processes = getTopProcesses(15);
+         MemoryInfo info = cgroup_mode ? readCgroupMemoryInfo(cgroup_dir, sampler.memoryInfo()) : sampler.memoryInfo();
+         VmStatCounters cur = sampler.vmStat();
+         MemoryPressure pressure = sampler.pressure();
+         recordSample(info, cur, pressure);
          
-         std::cout << std::left 
-                   << std::setw(8) << "PID"
-                   << std::setw(16) << "COMMAND"
-                   << std::setw(12) << "MEMORY"
-                   << "CMDLINE" << std::endl;
-         printSeparator();
+         struct timespec now;
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         double elapsed = (now.tv_sec - prev_time.tv_sec) + (now.tv_nsec - prev_time.tv_nsec) / 1e9;
          
-         for (const auto& proc : processes) {
-             std::cout << std::left 
-                       << std::setw(8) << proc.pid
-                       << std::setw(16) << proc.name.substr(0, 15)
-                       << std::setw(12) << formatBytes(proc.memory_kb)
-                       << proc.cmd << std::endl;
+         if (machineOutput()) {
+             writeWatchSample(info, prev, cur, pressure, elapsed);
+         } else if (history) {
+             values[0] = info[MEM_AVAILABLE] / 1024.0f;
+             values[1] = (info[MEM_SWAP_TOTAL] - info[MEM_SWAP_FREE]) / 1024.0f;
+             values[2] = pressure.some_avg10;
+             values[3] = pressure.full_avg10;
+             values[4] = cur.pgscan >= prev.pgscan && elapsed > 0 ? (cur.pgscan - prev.pgscan) / elapsed : 0.0;
+             history->push(values);
+             
+             if (redraw) {
+                 std::cout << "\033[H\033[J";
+             } else if (tick > 0) {
+                 std::cout << '\n';
+             }
+             printHistory(*history, series, "MEMORY (" + std::to_string(history->size()) + " of " +
+                          std::to_string(history->capacity()) + " samples)", 60, use_colors);
+             std::cout.flush();
+         } else {
+             printWatchLine(info, prev, cur, pressure, elapsed);
+             std::cout.flush();
          }
+         
+         prev = cur;
+         prev_time = now;
      }
+ }
  
- public:
-     MemInfoUtil() {
-         // Check if output is terminal for color support
-         use_colors = isatty(STDOUT_FILENO);
+ // Naming a section leaves out every section that isn't named,
+ // along with the files only those sections read
+ bool MemInfoUtil::selectSection(const std::string& name) {
+     if (!sections_named) {
+         sections_named = true;
+         show_general = false;
      }
+     
+     if (name == "general") show_general = true;
+     else if (name == "cgroup") cgroup_mode = true;
+     else if (name == "processes") show_processes = true;
+     else return false;
+     return true;
+ }
  
-     void parseArgs(int argc, char* argv[]) {
-         for (int i = 1; i < argc; ++i) {
-             std::string arg = argv[i];
-             
-             if (arg == "--help" || arg == "-h") {
-                 printHelp();
-                 exit(0);
-             } else if (arg == "--version" || arg == "-V") {
-                 printVersion();
-                 exit(0);
-             } else if (arg == "--processes" || arg == "-p") {
-                 show_processes = true;
-             } else if (arg == "--detailed" || arg == "-d") {
-                 show_detailed = true;
-             } else if (arg == "--swap" || arg == "-s") {
-                 show_swap = true;
-             } else if (arg == "--all" || arg == "-a") {
-                 show_processes = show_detailed = show_swap = true;
-             } else if (arg == "--no-color") {
-                 use_colors = false;
-             } else {
-                 std::cerr << colorize("meminfo: invalid option -- '" + arg + "'", Colors::RED) << std::endl;
-                 std::cerr << "Try 'meminfo --help' for more information." << std::endl;
-                 exit(1);
+ MemInfoUtil::MemInfoUtil() {
+     // Check if output is terminal for color support
+     use_colors = stdoutIsTerminal();
+     
+     long page_size = sysconf(_SC_PAGESIZE);
+     if (page_size > 0) page_kb = page_size / 1024;
+ }
+ 
+ void MemInfoUtil::parseArgs(int argc, char* argv[]) {
+     for (int i = 1; i < argc; ++i) {
+         std::string arg = argv[i];
+         
+         if (arg == "--help" || arg == "-h") {
+             printHelp();
+             exit(0);
+         } else if (arg == "--version" || arg == "-V") {
+             printVersion();
+             exit(0);
+         } else if (arg == "--processes" || arg == "-p") {
+             show_processes = true;
+         } else if (arg == "--detailed" || arg == "-d") {
+             show_detailed = true;
+         } else if (arg == "--swap" || arg == "-s") {
+             show_swap = true;
+         } else if (arg == "--all" || arg == "-a") {
+             show_processes = show_detailed = show_swap = true;
+         } else if (arg == "--watch" || arg == "-w") {
+             watch_mode = true;
+         } else if (arg == "--interval" || arg == "-i" || arg.rfind("--interval=", 0) == 0) {
+             std::string value = optionValue("meminfo", argc, argv, i, arg, "interval", use_colors);
+             char* end = nullptr;
+             watch_interval = std::strtod(value.c_str(), &end);
+             if (value.empty() || *end != '\0' || !(watch_interval >= 0.01)) {
+                 invalidValue("meminfo", "interval", value, use_colors);
+             }
+             watch_mode = true;
+         } else if (arg == "--count" || arg == "-c" || arg.rfind("--count=", 0) == 0) {
+             std::string value = optionValue("meminfo", argc, argv, i, arg, "count", use_colors);
+             char* end = nullptr;
+             watch_count = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || watch_count <= 0) {
+                 invalidValue("meminfo", "count", value, use_colors);
+             }
+             watch_mode = true;
+         } else if (arg == "--jobs" || arg == "-j" || arg.rfind("--jobs=", 0) == 0) {
+             std::string value = optionValue("meminfo", argc, argv, i, arg, "jobs", use_colors);
+             char* end = nullptr;
+             long jobs = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || jobs < 1 || jobs > 64) {
+                 invalidValue("meminfo", "jobs", value, use_colors);
              }
+             scan_jobs = jobs;
+         } else if (arg == "--sort" || arg == "-S" || arg.rfind("--sort=", 0) == 0) {
+             std::string value = optionValue("meminfo", argc, argv, i, arg, "sort", use_colors);
+             if (value == "rss") sort_key = MEM_SORT_RSS;
+             else if (value == "pss") sort_key = MEM_SORT_PSS;
+             else if (value == "uss") sort_key = MEM_SORT_USS;
+             else if (value == "swap") sort_key = MEM_SORT_SWAP;
+             else invalidValue("meminfo", "sort key", value, use_colors);
+             show_processes = true;
+         } else if (arg == "--cgroup" || arg == "-C" || arg.rfind("--cgroup=", 0) == 0) {
+             // The path is optional, so it is only taken from --cgroup=PATH
+             cgroup_mode = true;
+             if (arg.find('=') != std::string::npos) cgroup_spec = arg.substr(arg.find('=') + 1);
+         } else if (arg == "--cgroup-top" || arg == "-G" || arg.rfind("--cgroup-top=", 0) == 0) {
+             std::string value = optionValue("meminfo", argc, argv, i, arg, "cgroup-top", use_colors);
+             char* end = nullptr;
+             long top = std::strtol(value.c_str(), &end, 10);
+             if (value.empty() || *end != '\0' || top < 1 || top > 10000) {
+                 invalidValue("meminfo", "cgroup count", value, use_colors);
+             }
+             cgroup_top = top;
+         } else if (arg == "--history" || arg.rfind("--history=", 0) == 0) {
+             // The sample count is optional, so it is only taken from --history=N
+             history_size = 600;
+             if (arg.find('=') != std::string::npos) {
+                 std::string value = arg.substr(arg.find('=') + 1);
+                 char* end = nullptr;
+                 long size = std::strtol(value.c_str(), &end, 10);
+                 if (value.empty() || *end != '\0' || size < 2 || size > 1000000) {
+                     invalidValue("meminfo", "history size", value, use_colors);
+                 }
+                 history_size = size;
+             }
+             watch_mode = true;
+         } else if (arg == "--record" || arg.rfind("--record=", 0) == 0) {
+             record_path = optionValue("meminfo", argc, argv, i, arg, "record", use_colors);
+             watch_mode = true;
+         } else if (arg == "--replay" || arg.rfind("--replay=", 0) == 0) {
+             replay_path = optionValue("meminfo", argc, argv, i, arg, "replay", use_colors);
+         } else if (arg == "--format" || arg.rfind("--format=", 0) == 0) {
+             std::string value = optionValue("meminfo", argc, argv, i, arg, "format", use_colors);
+             OutputFormat format;
+             if (!parseOutputFormat(value, format)) {
+                 invalidValue("meminfo", "format", value, use_colors);
+             }
+             writer.setFormat(format);
+         } else if (arg == "--stats") {
+             enableStats();
+         } else if (arg == "--root" || arg.rfind("--root=", 0) == 0) {
+             std::string value = optionValue("meminfo", argc, argv, i, arg, "root", use_colors);
+             if (value.empty() || !setSystemRoot(value)) {
+                 invalidValue("meminfo", "root directory", value, use_colors);
+             }
+         } else if (arg == "--no-color") {
+             use_colors = false;
+         } else if (!arg.empty() && arg[0] != '-') {
+             if (!selectSection(arg)) invalidValue("meminfo", "section", arg, use_colors);
+         } else {
+             std::cerr << colorize("meminfo: invalid option -- '" + arg + "'", Colors::RED) << '\n';
+             std::cerr << "Try 'meminfo --help' for more information." << '\n';
+             exit(1);
          }
      }
+ }
  
-     void printVersion() {
-         std::cout << "meminfo (QCO InfoUtils) 1.0" << std::endl;
-         std::cout << "Copyright (C) 2025 AnmiTaliDev" << std::endl;
-         std::cout << "License Apache 2.0: Apache License version 2.0" << std::endl;
-         std::cout << "This is free software: you are free to change and redistribute it." << std::endl;
-         std::cout << "There is NO WARRANTY, to the extent permitted by law." << std::endl;
-     }
- 
-     void printHelp() {
-         std::cout << "Usage: meminfo [OPTION]..." << std::endl;
-         std::cout << "Display information about system memory usage." << std::endl;
-         std::cout << std::endl;
-         std::cout << "  -a, --all         display all available information" << std::endl;
-         std::cout << "  -d, --detailed    show detailed memory breakdown" << std::endl;
-         std::cout << "  -h, --help        display this help and exit" << std::endl;
-         std::cout << "      --no-color    disable colored output" << std::endl;
-         std::cout << "  -p, --processes   show top memory consuming processes" << std::endl;
-         std::cout << "  -s, --swap        show swap space information" << std::endl;
-         std::cout << "  -V, --version     output version information and exit" << std::endl;
-         std::cout << std::endl;
-         std::cout << "Examples:" << std::endl;
-         std::cout << "  meminfo           Show basic memory information" << std::endl;
-         std::cout << "  meminfo -a        Show comprehensive memory report" << std::endl;
-         std::cout << "  meminfo -p        Show memory usage with top processes" << std::endl;
-         std::cout << std::endl;
-         std::cout << "QCO InfoUtils home page: <https://github.com/Qainar-Projects/infoutils>" << std::endl;
-     }
- 
-     void run() {
+ void MemInfoUtil::printVersion() {
+     std::cout << "meminfo (QCO InfoUtils) 1.0" << '\n';
+     std::cout << "Copyright (C) 2025 AnmiTaliDev" << '\n';
+     std::cout << "License Apache 2.0: Apache License version 2.0" << '\n';
+     std::cout << "This is free software: you are free to change and redistribute it." << '\n';
+     std::cout << "There is NO WARRANTY, to the extent permitted by law." << '\n';
+ }
+ 
+ void MemInfoUtil::printHelp() {
+     std::cout << "Usage: meminfo [OPTION]... [SECTION]..." << '\n';
+     std::cout << "Display information about system memory usage." << '\n';
+     std::cout << '\n';
+     std::cout << "  -a, --all         display all available information" << '\n';
+     std::cout << "  -c, --count N     stop watch mode after N samples" << '\n';
+     std::cout << "  -C, --cgroup[=P]  report cgroup v2 P instead of the host (default: own cgroup)" << '\n';
+     std::cout << "  -d, --detailed    show detailed memory breakdown" << '\n';
+     std::cout << "      --format=FMT  print text (default), json, prom or tsv records" << '\n';
+     std::cout << "  -G, --cgroup-top N" << '\n';
+     std::cout << "                    rank the N cgroups using the most memory" << '\n';
+     std::cout << "  -h, --help        display this help and exit" << '\n';
+     std::cout << "      --history[=N] keep the last N samples (default: 600) and redraw them" << '\n';
+     std::cout << "                    as sparklines with percentiles (implies -w)" << '\n';
+     std::cout << "  -i, --interval N  sample every N seconds (implies --watch)" << '\n';
+     std::cout << "  -j, --jobs N      scan processes with N threads" << '\n';
+     std::cout << "      --no-color    disable colored output" << '\n';
+     std::cout << "  -p, --processes   show top memory consuming processes; with --record, also" << '\n';
+     std::cout << "                    record every process's statm sizes" << '\n';
+     std::cout << "      --record FILE append the raw counters of every watch sample to FILE" << '\n';
+     std::cout << "      --replay FILE print the watch output of a recording made with --record" << '\n';
+     std::cout << "      --root DIR    read /proc, /sys and /etc under DIR, such as the host's /" << '\n';
+     std::cout << "                    mounted into a container" << '\n';
+     std::cout << "  -s, --swap        show swap space information" << '\n';
+     std::cout << "  -S, --sort KEY    rank processes by rss, pss, uss or swap (implies -p)" << '\n';
+     std::cout << "      --stats       print the time and system calls of each collector on exit" << '\n';
+     std::cout << "  -V, --version     output version information and exit" << '\n';
+     std::cout << "  -w, --watch       report memory, reclaim rates and pressure per interval" << '\n';
+     std::cout << '\n';
+     std::cout << "Naming SECTIONs (general, cgroup, processes) shows only those, and reads" << '\n';
+     std::cout << "only the files they need; cgroup takes the place of general." << '\n';
+     std::cout << '\n';
+     std::cout << "Examples:" << '\n';
+     std::cout << "  meminfo           Show basic memory information" << '\n';
+     std::cout << "  meminfo -a        Show comprehensive memory report" << '\n';
+     std::cout << "  meminfo -p        Show memory usage with top processes" << '\n';
+     std::cout << "  meminfo processes Show only the top processes" << '\n';
+     std::cout << "  meminfo -S pss    Show top processes by proportional set size" << '\n';
+     std::cout << "  meminfo -G 20     Show the 20 cgroups using the most memory" << '\n';
+     std::cout << "  meminfo --history Chart the last 10 minutes of memory and pressure" << '\n';
+     std::cout << "  meminfo -i 0.1 -p --record mem.rec" << '\n';
+     std::cout << "                    Record memory and process sizes every 100 ms" << '\n';
+     std::cout << "  meminfo -w --format=json" << '\n';
+     std::cout << "                    Print one JSON object per second" << '\n';
+     std::cout << '\n';
+     std::cout << "QCO InfoUtils home page: <https://github.com/Qainar-Projects/infoutils>" << '\n';
+ }
+ 
+ void MemInfoUtil::run() {
+     if (!replay_path.empty()) {
+         printReplay();
+         return;
+     }
+     
+     if (watch_mode) {
+         printWatch();
+         return;
+     }
+     
+     if (machineOutput()) {
+         writeReport();
+         return;
+     }
+     
+     if (cgroup_mode) {
+         printCgroupInfo();
+     } else if (show_general) {
          printGeneralInfo();
-         
-         if (show_processes) {
-             printProcesses();
-         }
      }
- };
+     
+     if (cgroup_top > 0) {
+         printCgroupTop();
+     }
+     
+     if (show_processes) {
+         printProcesses();
+     }
+ }
  
- int main(int argc, char* argv[]) {
+ INFOUTILS_MAIN(meminfo) {
      try {
          MemInfoUtil util;
          util.parseArgs(argc, argv);
          util.run();
+         if (statsEnabled()) printStats("meminfo");
          return 0;
      } catch (const std::exception& e) {
-         std::cerr << "meminfo: " << e.what() << std::endl;
+         std::cerr << "meminfo: " << e.what() << '\n';
          return 1;
      }
  }
\ No newline at end of file
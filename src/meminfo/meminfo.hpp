@@ -11,70 +11,47 @@
  #include <string>
  #include <vector>
  
- // Forward declarations
- struct MemoryInfo;
- struct ProcessInfo;
- 
- // ANSI Color codes namespace
- namespace Colors {
-     extern const std::string RESET;
-     extern const std::string BOLD;
-     extern const std::string RED;
-     extern const std::string GREEN;
-     extern const std::string YELLOW;
-     extern const std::string BLUE;
-     extern const std::string MAGENTA;
-     extern const std::string CYAN;
-     extern const std::string WHITE;
-     extern const std::string DIM;
- }
- 
- /**
-  * Structure to hold memory information from /proc/meminfo
-  */
- struct MemoryInfo {
-     unsigned long total_kb;
-     unsigned long available_kb;
-     unsigned long free_kb;
-     unsigned long buffers_kb;
-     unsigned long cached_kb;
-     unsigned long swap_total_kb;
-     unsigned long swap_free_kb;
-     unsigned long swap_cached_kb;
-     unsigned long shmem_kb;
-     unsigned long sreclaimable_kb;
-     unsigned long sunreclaim_kb;
- 
-     MemoryInfo() : total_kb(0), available_kb(0), free_kb(0), buffers_kb(0),
-                    cached_kb(0), swap_total_kb(0), swap_free_kb(0), 
-                    swap_cached_kb(0), shmem_kb(0), sreclaimable_kb(0),
-                    sunreclaim_kb(0) {}
- };
- 
- /**
-  * Structure to hold process memory information
-  */
- struct ProcessInfo {
-     int pid;
-     std::string name;
-     unsigned long memory_kb;
-     std::string cmd;
- 
-     ProcessInfo(int p, const std::string& n, unsigned long m, const std::string& c)
-         : pid(p), name(n), memory_kb(m), cmd(c) {}
- };
+ #include "format.hpp"
+ #include "mem.hpp"
+ #include "sysfs.hpp"
+ #include "record.hpp"
  
  /**
   * Main utility class for memory information display
   */
  class MemInfoUtil {
  private:
-     // Configuration flags
-     bool show_processes;
-     bool show_detailed;
-     bool show_swap;
-     bool use_colors;
- 
+     bool show_general = true;     // Totals from /proc/meminfo
+     bool sections_named = false;  // A SECTION argument was given
+     bool show_processes = false;
+     bool show_detailed = false;
+     bool show_swap = false;
+     bool use_colors = true;
+     unsigned long page_kb = 4;
+     unsigned scan_jobs = 1;
+     MemSortKey sort_key = MEM_SORT_RSS;
+     bool watch_mode = false;
+     double watch_interval = 1.0;  // Seconds between watch samples
+     long watch_count = 0;         // Samples to print, 0 for unlimited
+     bool cgroup_mode = false;     // Report a cgroup v2 cgroup instead of the host
+     std::string cgroup_spec;      // --cgroup=PATH, empty for our own cgroup
+     size_t cgroup_top = 0;        // Cgroups ranked with --cgroup-top, 0 for none
+     size_t history_size = 0;      // Samples kept for --history, 0 without it
+     SysfsDir cgroup_dir;
+     
+     // /proc/meminfo, /proc/vmstat and PSI files, kept open between samples
+     MemSampler sampler;
+     
+     // --format=json|prom|tsv output, reused for every sample
+     RecordWriter writer{"meminfo"};
+     
+     // --record FILE and --replay FILE
+     std::string record_path;
+     std::string replay_path;
+     SampleRecorder recorder;
+     std::vector<ProcessStatm> statm;
+     double replay_time = 0.0;     // Time of the replayed sample, 0 when sampling live
+     
      /**
       * Format bytes with human-readable units (B, KB, MB, GB, TB)
       * @param kb Size in kilobytes
@@ -91,18 +68,38 @@
      std::string colorize(const std::string& text, const std::string& color);
  
      /**
-      * Read memory information from /proc/meminfo
-      * @return MemoryInfo structure with current memory stats
+      * Open the cgroup selected by --cgroup
+      * @throws std::runtime_error if it has no memory controller
       */
-     MemoryInfo getMemoryInfo();
- 
+     void openCgroup();
+     
+     /**
+      * Read /proc/PID/statm of every process
+      * @param processes Replaced by the sizes of each process
+      */
+     void readProcessStatm(std::vector<ProcessStatm>& processes);
+     
+     /**
+      * Check whether smaps_rollup accounting is needed
+      * @return true when sorting by PSS/USS/swap or in detailed mode
+      */
+     bool collectSmaps();
+     
      /**
-      * Get list of processes sorted by memory usage
+      * Get the processes using the most memory from readTopProcesses,
+      * warning if /proc could not be read in full
       * @param limit Maximum number of processes to return
-      * @return Vector of ProcessInfo structures
+      * @return Processes sorted by the sort key
       */
-     std::vector<ProcessInfo> getTopProcesses(int limit = 15);
- 
+     std::vector<ProcessMemory> getTopProcesses(size_t limit = 15);
+     
+     /**
+      * Print a labelled size as human-readable value followed by kB
+      * @param label Line label
+      * @param kb Size in kilobytes
+      */
+     void printMemoryLine(const std::string& label, unsigned long kb);
+     
      /**
       * Print section separator with optional title
       * @param title Optional section title
@@ -114,10 +111,121 @@
       */
      void printGeneralInfo();
  
+     /**
+      * Print a cgroup limit, "unlimited" for max
+      * @param label Line label
+      * @param bytes Limit in bytes or CGROUP_UNLIMITED
+      */
+     void printCgroupLimit(const std::string& label, unsigned long long bytes);
+     
+     /**
+      * Print one memory.stat value if present
+      * @param stat memory.stat content
+      * @param key Key to print
+      * @param label Line label
+      */
+     void printCgroupStat(const char* stat, const char* key, const std::string& label);
+     
+     /**
+      * Display memory usage, limits, pressure and OOM events of a cgroup
+      */
+     void printCgroupInfo();
+     
+     /**
+      * Display the cgroups using the most memory
+      */
+     void printCgroupTop();
+ 
      /**
       * Display top memory consuming processes
       */
      void printProcesses();
+     
+     /**
+      * Check whether --format selected a machine-readable format
+      */
+     bool machineOutput() const;
+     
+     /**
+      * Add the "memory" group, with /proc/meminfo sizes in bytes
+      * @param info Memory information
+      */
+     void writeMemoryInfo(const MemoryInfo& info);
+     
+     /**
+      * Add the "cgroup" group for the --cgroup cgroup
+      */
+     void writeCgroupInfo();
+     
+     /**
+      * Write the selected sections as one --format sample
+      */
+     void writeReport();
+     
+     /**
+      * Write one --format sample of watch mode
+      * @param info Current memory information
+      * @param prev vmstat counters of the previous sample
+      * @param cur vmstat counters of this sample
+      * @param pressure Current memory pressure
+      * @param elapsed Seconds between the two samples
+      * @param processes Recorded statm sizes to add, or nullptr
+      * @param page_size Bytes per page of processes
+      */
+     void writeWatchSample(const MemoryInfo& info, const VmStatCounters& prev, const VmStatCounters& cur,
+                           const MemoryPressure& pressure, double elapsed,
+                           const std::vector<ProcessStatm>* processes = nullptr, unsigned long page_size = 0);
+     
+     /**
+      * Format the current local time as HH:MM:SS
+      * @param buf Output buffer
+      * @param size Size of buf
+      */
+     void formatTimestamp(char* buf, size_t size);
+     
+     /**
+      * Print the column header of watch mode
+      */
+     void printWatchHeader();
+     
+     /**
+      * Print one watch sample
+      * @param info Current memory information
+      * @param prev vmstat counters of the previous sample
+      * @param cur vmstat counters of this sample
+      * @param pressure Current memory pressure
+      * @param elapsed Seconds between the two samples
+      */
+     void printWatchLine(const MemoryInfo& info, const VmStatCounters& prev, const VmStatCounters& cur,
+                         const MemoryPressure& pressure, double elapsed);
+     
+     /**
+      * Append a sample to the --record file, with statm sizes under -p
+      * @param info Memory information
+      * @param vmstat vmstat counters
+      * @param pressure Memory pressure
+      * @throws std::runtime_error if the write fails
+      */
+     void recordSample(const MemoryInfo& info, const VmStatCounters& vmstat, const MemoryPressure& pressure);
+     
+     /**
+      * Print the watch output of a --replay file with its recorded times
+      * @throws std::runtime_error if the file cannot be read
+      */
+     void printReplay();
+     
+     /**
+      * Report memory, reclaim rates and pressure every watch_interval seconds
+      */
+     void printWatch();
+     
+     /**
+      * Select a section named on the command line; the first one named
+      * turns off the sections shown by default
+      * @param name Section name
+      * @return false if there is no such section
+      */
+     bool selectSection(const std::string& name);
  
  public:
      /**
@@ -125,11 +233,6 @@
       */
      MemInfoUtil();
  
-     /**
-      * Destructor
-      */
-     ~MemInfoUtil() = default;
- 
      // Disable copy constructor and assignment operator
      MemInfoUtil(const MemInfoUtil&) = delete;
      MemInfoUtil& operator=(const MemInfoUtil&) = delete;
@@ -155,61 +258,8 @@
       * Run the main program logic
       */
      void run();
- 
-     // Accessor methods for configuration flags
-     bool isShowProcesses() const { return show_processes; }
-     bool isShowDetailed() const { return show_detailed; }
-     bool isShowSwap() const { return show_swap; }
-     bool isUseColors() const { return use_colors; }
- 
-     // Setter methods for testing purposes
-     void setShowProcesses(bool value) { show_processes = value; }
-     void setShowDetailed(bool value) { show_detailed = value; }
-     void setShowSwap(bool value) { show_swap = value; }
-     void setUseColors(bool value) { use_colors = value; }
  };
  
- /**
-  * Utility functions namespace
-  */
- namespace MemInfoUtils {
-     /**
-      * Check if output terminal supports colors
-      * @return true if colors are supported, false otherwise
-      */
-     bool supportsColors();
- 
-     /**
-      * Read a single line from a file
-      * @param filepath Path to the file
-      * @param line Reference to store the read line
-      * @return true if successful, false otherwise
-      */
-     bool readFileLine(const std::string& filepath, std::string& line);
- 
-     /**
-      * Parse a key-value pair from /proc/meminfo format
-      * @param line Line to parse
-      * @param key Reference to store the key
-      * @param value Reference to store the value
-      * @return true if parsing successful, false otherwise
-      */
-     bool parseMemInfoLine(const std::string& line, std::string& key, unsigned long& value);
- 
-     /**
-      * Get system page size in bytes
-      * @return Page size in bytes
-      */
-     long getPageSize();
- 
-     /**
-      * Convert pages to kilobytes
-      * @param pages Number of pages
-      * @return Size in kilobytes
-      */
-     unsigned long pagesToKilobytes(unsigned long pages);
- }
- 
  // Version information
  namespace Version {
      constexpr const char* PROGRAM_NAME = "meminfo";
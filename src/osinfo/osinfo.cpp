@@ -16,554 +16,544 @@
  #include <filesystem>
  #include <cstring>
  #include <unistd.h>
- #include <sys/utsname.h>
- #include <sys/sysinfo.h>
- #include <pwd.h>
- #include <grp.h>
+ 
+ #include "osinfo.hpp"
+ #include "output.hpp"
+ #include "cli.hpp"
+ #include "format.hpp"
+ #include "procfs.hpp"
+ #include "stats.hpp"
+ #include "os.hpp"
+ #include "multicall.hpp"
  
  namespace fs = std::filesystem;
  
- // ANSI Color codes
- namespace Colors {
-     const std::string RESET = "\033[0m";
-     const std::string BOLD = "\033[1m";
-     const std::string RED = "\033[31m";
-     const std::string GREEN = "\033[32m";
-     const std::string YELLOW = "\033[33m";
-     const std::string BLUE = "\033[34m";
-     const std::string MAGENTA = "\033[35m";
-     const std::string CYAN = "\033[36m";
-     const std::string WHITE = "\033[37m";
-     const std::string DIM = "\033[2m";
+ std::string OsInfoUtil::colorize(const std::string& text, const std::string& color) {
+     return ::colorize(text, color, use_colors);
  }
  
- struct SystemInfo {
-     std::string os_name;
-     std::string os_version;
-     std::string os_id;
-     std::string os_codename;
-     std::string kernel_name;
-     std::string kernel_release;
-     std::string kernel_version;
-     std::string architecture;
-     std::string hostname;
-     std::string domain_name;
-     unsigned long uptime_seconds = 0;
-     std::string boot_time;
-     std::string timezone;
- };
- 
- struct DistroInfo {
-     std::string name;
-     std::string version;
-     std::string id;
-     std::string id_like;
-     std::string version_codename;
-     std::string version_id;
-     std::string pretty_name;
-     std::string home_url;
-     std::string support_url;
-     std::string bug_report_url;
- };
- 
- struct UserInfo {
-     std::string current_user;
-     std::string current_group;
-     std::string home_directory;
-     std::string shell;
-     int user_count = 0;
-     int group_count = 0;
-     std::vector<std::string> logged_users;
- };
- 
- struct EnvironmentInfo {
-     std::string path;
-     std::string lang;
-     std::string editor;
-     std::string pager;
-     std::string browser;
-     std::string desktop_session;
-     std::string display_manager;
-     std::string window_manager;
- };
+ std::string OsInfoUtil::formatUptime(unsigned long seconds) {
+     unsigned long days = seconds / 86400;
+     unsigned long hours = (seconds % 86400) / 3600;
+     unsigned long minutes = (seconds % 3600) / 60;
+     unsigned long secs = seconds % 60;
+     
+     std::ostringstream oss;
+     if (days > 0) {
+         oss << days << " day" << (days != 1 ? "s" : "") << ", ";
+     }
+     if (hours > 0 || days > 0) {
+         oss << hours << " hour" << (hours != 1 ? "s" : "") << ", ";
+     }
+     if (minutes > 0 || hours > 0 || days > 0) {
+         oss << minutes << " minute" << (minutes != 1 ? "s" : "") << ", ";
+     }
+     oss << secs << " second" << (secs != 1 ? "s" : "");
+     
+     return oss.str();
+ }
  
- class OsInfoUtil {
- private:
-     bool show_detailed = false;
-     bool show_distro = false;
-     bool show_users = false;
-     bool show_environment = false;
-     bool use_colors = true;
+ void OsInfoUtil::printSeparator(const std::string& title) {
+     ::printSeparator(title, use_colors);
+ }
  
-     std::string colorize(const std::string& text, const std::string& color) {
-         if (!use_colors) return text;
-         return color + text + Colors::RESET;
+ const DistroInfo& OsInfoUtil::distroInfo() {
+     if (!distro_read) {
+         distro_cache = readDistroInfo();
+         distro_read = true;
      }
+     return distro_cache;
+ }
  
-     std::string formatUptime(unsigned long seconds) {
-         unsigned long days = seconds / 86400;
-         unsigned long hours = (seconds % 86400) / 3600;
-         unsigned long minutes = (seconds % 3600) / 60;
-         unsigned long secs = seconds % 60;
-         
-         std::ostringstream oss;
-         if (days > 0) {
-             oss << days << " day" << (days != 1 ? "s" : "") << ", ";
-         }
-         if (hours > 0 || days > 0) {
-             oss << hours << " hour" << (hours != 1 ? "s" : "") << ", ";
-         }
-         if (minutes > 0 || hours > 0 || days > 0) {
-             oss << minutes << " minute" << (minutes != 1 ? "s" : "") << ", ";
-         }
-         oss << secs << " second" << (secs != 1 ? "s" : "");
-         
-         return oss.str();
+ void OsInfoUtil::printSystemInfo() {
+     SystemInfo sys_info = readSystemInfo();
+     const DistroInfo& distro_info = distroInfo();
+     
+     printSeparator("System Information");
+     
+     if (!distro_info.pretty_name.empty()) {
+         std::cout << std::left << std::setw(18) << "Operating System:" 
+                   << distro_info.pretty_name << '\n';
+     } else if (!distro_info.name.empty()) {
+         std::cout << std::left << std::setw(18) << "Operating System:" 
+                   << distro_info.name;
+         if (!distro_info.version.empty()) {
+             std::cout << " " << distro_info.version;
+         }
+         std::cout << '\n';
      }
- 
-     SystemInfo getSystemInfo() {
-         SystemInfo info;
-         
-         // Get uname information
-         struct utsname uts;
-         if (uname(&uts) == 0) {
-             info.kernel_name = uts.sysname;
-             info.kernel_release = uts.release;
-             info.kernel_version = uts.version;
-             info.architecture = uts.machine;
-             info.hostname = uts.nodename;
-         }
-         
-         // Get domain name
-         char domainname[256];
-         if (getdomainname(domainname, sizeof(domainname)) == 0) {
-             info.domain_name = domainname;
+     
+     if (!sys_info.kernel_name.empty() && !sys_info.kernel_release.empty()) {
+         std::cout << std::left << std::setw(18) << "Kernel:" 
+                   << sys_info.kernel_name << " " << sys_info.kernel_release << '\n';
+     }
+     
+     if (!sys_info.architecture.empty()) {
+         std::cout << std::left << std::setw(18) << "Architecture:" 
+                   << sys_info.architecture << '\n';
+     }
+     
+     if (!sys_info.hostname.empty()) {
+         std::cout << std::left << std::setw(18) << "Hostname:" 
+                   << sys_info.hostname;
+         if (!sys_info.domain_name.empty() && sys_info.domain_name != "(none)") {
+             std::cout << "." << sys_info.domain_name;
+         }
+         std::cout << '\n';
+     }
+     
+     if (sys_info.uptime_seconds > 0) {
+         std::cout << std::left << std::setw(18) << "Uptime:" 
+                   << formatUptime(sys_info.uptime_seconds) << '\n';
+     }
+     
+     if (!sys_info.boot_time.empty()) {
+         std::cout << std::left << std::setw(18) << "Boot time:" 
+                   << sys_info.boot_time << '\n';
+     }
+     
+     if (sys_info.have_load) {
+         std::cout << std::left << std::setw(18) << "Load average:" 
+                   << std::fixed << std::setprecision(2)
+                   << sys_info.load1 << ", " << sys_info.load5 << ", " << sys_info.load15 << '\n';
+     }
+     
+     if (!sys_info.container.empty()) {
+         std::cout << std::left << std::setw(18) << "Container:" 
+                   << sys_info.container << '\n';
+     }
+     
+     if (show_detailed) {
+         if (!sys_info.kernel_version.empty()) {
+             std::cout << std::left << std::setw(18) << "Kernel version:" 
+                       << sys_info.kernel_version << '\n';
          }
          
-         // Get uptime
-         struct sysinfo si;
-         if (sysinfo(&si) == 0) {
-             info.uptime_seconds = si.uptime;
+         if (!sys_info.timezone.empty()) {
+             std::cout << std::left << std::setw(18) << "Timezone:" 
+                       << sys_info.timezone << '\n';
          }
          
-         // Try to get timezone
-         std::ifstream timezone_file("/etc/timezone");
-         if (timezone_file.is_open()) {
-             std::getline(timezone_file, info.timezone);
-         } else {
-             // Fallback to TZ environment variable
-             const char* tz = getenv("TZ");
-             if (tz) {
-                 info.timezone = tz;
+         // Read additional kernel information
+         std::ifstream version_file(systemPath("/proc/version"));
+         if (version_file.is_open()) {
+             std::string version_line;
+             std::getline(version_file, version_line);
+             if (version_line.length() > 80) {
+                 version_line = version_line.substr(0, 77) + "...";
              }
+             std::cout << std::left << std::setw(18) << "Kernel info:" 
+                       << version_line << '\n';
          }
-         
-         return info;
      }
+ }
  
-     DistroInfo getDistroInfo() {
-         DistroInfo info;
-         
-         // Read /etc/os-release
-         std::ifstream os_release("/etc/os-release");
-         std::string line;
-         
-         while (std::getline(os_release, line)) {
-             size_t equals = line.find('=');
-             if (equals == std::string::npos) continue;
-             
-             std::string key = line.substr(0, equals);
-             std::string value = line.substr(equals + 1);
-             
-             // Remove quotes
-             if (value.front() == '"' && value.back() == '"') {
-                 value = value.substr(1, value.length() - 2);
-             }
-             
-             if (key == "NAME") info.name = value;
-             else if (key == "VERSION") info.version = value;
-             else if (key == "ID") info.id = value;
-             else if (key == "ID_LIKE") info.id_like = value;
-             else if (key == "VERSION_CODENAME") info.version_codename = value;
-             else if (key == "VERSION_ID") info.version_id = value;
-             else if (key == "PRETTY_NAME") info.pretty_name = value;
-             else if (key == "HOME_URL") info.home_url = value;
-             else if (key == "SUPPORT_URL") info.support_url = value;
-             else if (key == "BUG_REPORT_URL") info.bug_report_url = value;
-         }
-         
-         return info;
+ void OsInfoUtil::printDistroInfo() {
+     const DistroInfo& info = distroInfo();
+     
+     std::cout << '\n';
+     printSeparator("Distribution Information");
+     
+     if (!info.name.empty()) {
+         std::cout << std::left << std::setw(18) << "Name:" 
+                   << info.name << '\n';
      }
- 
-     UserInfo getUserInfo() {
-         UserInfo info;
-         
-         // Current user information
-         uid_t uid = getuid();
-         gid_t gid = getgid();
-         
-         struct passwd* pw = getpwuid(uid);
-         if (pw) {
-             info.current_user = pw->pw_name;
-             info.home_directory = pw->pw_dir;
-             info.shell = pw->pw_shell;
+     
+     if (!info.version.empty()) {
+         std::cout << std::left << std::setw(18) << "Version:" 
+                   << info.version << '\n';
+     }
+     
+     if (!info.id.empty()) {
+         std::cout << std::left << std::setw(18) << "ID:" 
+                   << info.id << '\n';
+     }
+     
+     if (!info.version_codename.empty()) {
+         std::cout << std::left << std::setw(18) << "Codename:" 
+                   << info.version_codename << '\n';
+     }
+     
+     if (show_detailed) {
+         if (!info.id_like.empty()) {
+             std::cout << std::left << std::setw(18) << "Based on:" 
+                       << info.id_like << '\n';
          }
          
-         struct group* gr = getgrgid(gid);
-         if (gr) {
-             info.current_group = gr->gr_name;
+         if (!info.version_id.empty()) {
+             std::cout << std::left << std::setw(18) << "Version ID:" 
+                       << info.version_id << '\n';
          }
          
-         // Count users and groups
-         setpwent();
-         while (getpwent() != nullptr) {
-             info.user_count++;
+         if (!info.home_url.empty()) {
+             std::cout << std::left << std::setw(18) << "Home URL:" 
+                       << info.home_url << '\n';
          }
-         endpwent();
          
-         setgrent();
-         while (getgrent() != nullptr) {
-             info.group_count++;
+         if (!info.support_url.empty()) {
+             std::cout << std::left << std::setw(18) << "Support URL:" 
+                       << info.support_url << '\n';
          }
-         endgrent();
-         
-         return info;
      }
+ }
  
-     EnvironmentInfo getEnvironmentInfo() {
-         EnvironmentInfo info;
-         
-         const char* env_vars[] = {
-             "PATH", "LANG", "EDITOR", "PAGER", "BROWSER",
-             "DESKTOP_SESSION", "XDG_CURRENT_DESKTOP", "WINDOWMANAGER"
-         };
-         
-         for (const char* var : env_vars) {
-             const char* value = getenv(var);
-             if (value) {
-                 std::string var_name = var;
-                 if (var_name == "PATH") info.path = value;
-                 else if (var_name == "LANG") info.lang = value;
-                 else if (var_name == "EDITOR") info.editor = value;
-                 else if (var_name == "PAGER") info.pager = value;
-                 else if (var_name == "BROWSER") info.browser = value;
-                 else if (var_name == "DESKTOP_SESSION") info.desktop_session = value;
-                 else if (var_name == "XDG_CURRENT_DESKTOP") info.window_manager = value;
-                 else if (var_name == "WINDOWMANAGER") {
-                     if (info.window_manager.empty()) info.window_manager = value;
-                 }
+ void OsInfoUtil::printUserInfo() {
+     UserInfo info = readUserInfo(show_nss, nss_timeout);
+     
+     std::cout << '\n';
+     printSeparator("User Information");
+     
+     if (!info.current_user.empty()) {
+         std::cout << std::left << std::setw(18) << "Current user:" 
+                   << info.current_user << '\n';
+     }
+     
+     if (!info.current_group.empty()) {
+         std::cout << std::left << std::setw(18) << "Primary group:" 
+                   << info.current_group << '\n';
+     }
+     
+     if (!info.home_directory.empty()) {
+         std::cout << std::left << std::setw(18) << "Home directory:" 
+                   << info.home_directory << '\n';
+     }
+     
+     if (!info.shell.empty()) {
+         std::cout << std::left << std::setw(18) << "Shell:" 
+                   << info.shell << '\n';
+     }
+     
+     if (info.session_count >= 0) {
+         std::cout << std::left << std::setw(18) << "Logged in:" 
+                   << info.session_count << " session" << (info.session_count != 1 ? "s" : "");
+         if (!info.logged_users.empty()) {
+             std::cout << " (";
+             for (size_t i = 0; i < info.logged_users.size(); ++i) {
+                 if (i > 0) std::cout << ", ";
+                 std::cout << info.logged_users[i];
              }
+             std::cout << ")";
          }
-         
-         return info;
+         std::cout << '\n';
      }
- 
-     void printSeparator(const std::string& title = "") {
-         if (title.empty()) {
-             std::cout << std::string(70, '-') << std::endl;
-         } else {
-             std::cout << colorize(title, Colors::BOLD) << std::endl;
-             std::cout << std::string(title.length(), '=') << std::endl;
-         }
+     
+     if (info.local_user_count >= 0) {
+         std::cout << std::left << std::setw(18) << "Local users:" 
+                   << info.local_user_count << '\n';
+     }
+     
+     if (info.local_group_count >= 0) {
+         std::cout << std::left << std::setw(18) << "Local groups:" 
+                   << info.local_group_count << '\n';
      }
+     
+     if (info.nss_counted) {
+         std::cout << std::left << std::setw(18) << "Total users:" 
+                   << info.user_count << '\n';
+         std::cout << std::left << std::setw(18) << "Total groups:" 
+                   << info.group_count << '\n';
+     } else if (info.nss_timed_out) {
+         std::ostringstream note;
+         note << "NSS lookup did not finish within " << nss_timeout << " s";
+         std::cout << std::left << std::setw(18) << "Total users:" 
+                   << colorize(note.str(), Colors::YELLOW) << '\n';
+     }
+ }
  
-     void printSystemInfo() {
-         SystemInfo sys_info = getSystemInfo();
-         DistroInfo distro_info = getDistroInfo();
-         
-         printSeparator("System Information");
-         
-         if (!distro_info.pretty_name.empty()) {
-             std::cout << std::left << std::setw(18) << "Operating System:" 
-                       << distro_info.pretty_name << std::endl;
-         } else if (!distro_info.name.empty()) {
-             std::cout << std::left << std::setw(18) << "Operating System:" 
-                       << distro_info.name;
-             if (!distro_info.version.empty()) {
-                 std::cout << " " << distro_info.version;
-             }
-             std::cout << std::endl;
-         }
-         
-         if (!sys_info.kernel_name.empty() && !sys_info.kernel_release.empty()) {
-             std::cout << std::left << std::setw(18) << "Kernel:" 
-                       << sys_info.kernel_name << " " << sys_info.kernel_release << std::endl;
+ void OsInfoUtil::printEnvironmentInfo() {
+     EnvironmentInfo info = readEnvironmentInfo();
+     
+     std::cout << '\n';
+     printSeparator("Environment Information");
+     
+     if (!info.lang.empty()) {
+         std::cout << std::left << std::setw(18) << "Language:" 
+                   << info.lang << '\n';
+     }
+     
+     if (!info.desktop_session.empty()) {
+         std::cout << std::left << std::setw(18) << "Desktop session:" 
+                   << info.desktop_session << '\n';
+     }
+     
+     if (!info.window_manager.empty()) {
+         std::cout << std::left << std::setw(18) << "Desktop environment:" 
+                   << info.window_manager << '\n';
+     }
+     
+     if (!info.editor.empty()) {
+         std::cout << std::left << std::setw(18) << "Default editor:" 
+                   << info.editor << '\n';
+     }
+     
+     const char* shell_env = getenv("SHELL");
+     if (shell_env) {
+         std::cout << std::left << std::setw(18) << "Default shell:" 
+                   << shell_env << '\n';
+     }
+     
+     if (show_detailed) {
+         if (!info.pager.empty()) {
+             std::cout << std::left << std::setw(18) << "Pager:" 
+                       << info.pager << '\n';
          }
          
-         if (!sys_info.architecture.empty()) {
-             std::cout << std::left << std::setw(18) << "Architecture:" 
-                       << sys_info.architecture << std::endl;
+         if (!info.browser.empty()) {
+             std::cout << std::left << std::setw(18) << "Browser:" 
+                       << info.browser << '\n';
          }
          
-         if (!sys_info.hostname.empty()) {
-             std::cout << std::left << std::setw(18) << "Hostname:" 
-                       << sys_info.hostname;
-             if (!sys_info.domain_name.empty() && sys_info.domain_name != "(none)") {
-                 std::cout << "." << sys_info.domain_name;
-             }
-             std::cout << std::endl;
-         }
-         
-         if (sys_info.uptime_seconds > 0) {
-             std::cout << std::left << std::setw(18) << "Uptime:" 
-                       << formatUptime(sys_info.uptime_seconds) << std::endl;
-         }
-         
-         if (show_detailed) {
-             if (!sys_info.kernel_version.empty()) {
-                 std::cout << std::left << std::setw(18) << "Kernel version:" 
-                           << sys_info.kernel_version << std::endl;
-             }
-             
-             if (!sys_info.timezone.empty()) {
-                 std::cout << std::left << std::setw(18) << "Timezone:" 
-                           << sys_info.timezone << std::endl;
-             }
-             
-             // Read additional kernel information
-             std::ifstream version_file("/proc/version");
-             if (version_file.is_open()) {
-                 std::string version_line;
-                 std::getline(version_file, version_line);
-                 if (version_line.length() > 80) {
-                     version_line = version_line.substr(0, 77) + "...";
-                 }
-                 std::cout << std::left << std::setw(18) << "Kernel info:" 
-                           << version_line << std::endl;
+         if (!info.path.empty()) {
+             std::cout << std::left << std::setw(18) << "PATH:" << '\n';
+             std::istringstream path_stream(info.path);
+             std::string path_component;
+             while (std::getline(path_stream, path_component, ':')) {
+                 std::cout << "  " << path_component << '\n';
              }
          }
      }
+ }
  
-     void printDistroInfo() {
-         DistroInfo info = getDistroInfo();
-         
-         std::cout << std::endl;
-         printSeparator("Distribution Information");
-         
-         if (!info.name.empty()) {
-             std::cout << std::left << std::setw(18) << "Name:" 
-                       << info.name << std::endl;
-         }
-         
-         if (!info.version.empty()) {
-             std::cout << std::left << std::setw(18) << "Version:" 
-                       << info.version << std::endl;
-         }
-         
-         if (!info.id.empty()) {
-             std::cout << std::left << std::setw(18) << "ID:" 
-                       << info.id << std::endl;
+ void OsInfoUtil::writeReport() {
+     writer.begin(wallClock());
+     
+     if (show_system) {
+         SystemInfo sys_info = readSystemInfo();
+         const DistroInfo& distro_info = distroInfo();
+         
+         writer.group("system");
+         writer.field("os", distro_info.pretty_name.empty() ? distro_info.name : distro_info.pretty_name);
+         writer.field("kernel_name", sys_info.kernel_name);
+         writer.field("kernel_release", sys_info.kernel_release);
+         writer.field("architecture", sys_info.architecture);
+         writer.field("hostname", sys_info.hostname);
+         if (!sys_info.domain_name.empty() && sys_info.domain_name != "(none)") {
+             writer.field("domain", sys_info.domain_name);
+         }
+         writer.field("boot_time", sys_info.boot_time);
+         writer.field("container", sys_info.container);
+         if (show_detailed) {
+             writer.field("kernel_version", sys_info.kernel_version);
+             writer.field("timezone", sys_info.timezone);
          }
-         
-         if (!info.version_codename.empty()) {
-             std::cout << std::left << std::setw(18) << "Codename:" 
-                       << info.version_codename << std::endl;
+         writer.field("uptime_seconds", sys_info.uptime_seconds);
+         if (sys_info.have_load) {
+             writer.field("load1", sys_info.load1);
+             writer.field("load5", sys_info.load5);
+             writer.field("load15", sys_info.load15);
          }
-         
+     }
+     
+     if (show_distro) {
+         const DistroInfo& distro_info = distroInfo();
+         writer.group("distro");
+         writer.field("name", distro_info.name);
+         writer.field("version", distro_info.version);
+         writer.field("id", distro_info.id);
+         writer.field("codename", distro_info.version_codename);
          if (show_detailed) {
-             if (!info.id_like.empty()) {
-                 std::cout << std::left << std::setw(18) << "Based on:" 
-                           << info.id_like << std::endl;
-             }
-             
-             if (!info.version_id.empty()) {
-                 std::cout << std::left << std::setw(18) << "Version ID:" 
-                           << info.version_id << std::endl;
-             }
-             
-             if (!info.home_url.empty()) {
-                 std::cout << std::left << std::setw(18) << "Home URL:" 
-                           << info.home_url << std::endl;
-             }
-             
-             if (!info.support_url.empty()) {
-                 std::cout << std::left << std::setw(18) << "Support URL:" 
-                           << info.support_url << std::endl;
-             }
+             writer.field("id_like", distro_info.id_like);
+             writer.field("version_id", distro_info.version_id);
+             writer.field("home_url", distro_info.home_url);
+             writer.field("support_url", distro_info.support_url);
          }
      }
- 
-     void printUserInfo() {
-         UserInfo info = getUserInfo();
-         
-         std::cout << std::endl;
-         printSeparator("User Information");
-         
-         if (!info.current_user.empty()) {
-             std::cout << std::left << std::setw(18) << "Current user:" 
-                       << info.current_user << std::endl;
-         }
-         
-         if (!info.current_group.empty()) {
-             std::cout << std::left << std::setw(18) << "Primary group:" 
-                       << info.current_group << std::endl;
-         }
-         
-         if (!info.home_directory.empty()) {
-             std::cout << std::left << std::setw(18) << "Home directory:" 
-                       << info.home_directory << std::endl;
-         }
-         
-         if (!info.shell.empty()) {
-             std::cout << std::left << std::setw(18) << "Shell:" 
-                       << info.shell << std::endl;
-         }
-         
-         if (info.user_count > 0) {
-             std::cout << std::left << std::setw(18) << "Total users:" 
-                       << info.user_count << std::endl;
-         }
-         
-         if (info.group_count > 0) {
-             std::cout << std::left << std::setw(18) << "Total groups:" 
-                       << info.group_count << std::endl;
+     
+     if (show_users) {
+         UserInfo info = readUserInfo(show_nss, nss_timeout);
+         std::string logged;
+         for (const auto& user : info.logged_users) {
+             if (!logged.empty()) logged += ',';
+             logged += user;
+         }
+         
+         writer.group("users");
+         writer.field("current_user", info.current_user);
+         writer.field("primary_group", info.current_group);
+         writer.field("home", info.home_directory);
+         writer.field("shell", info.shell);
+         writer.field("logged_users", logged);
+         if (info.session_count >= 0) writer.field("sessions", info.session_count);
+         if (info.local_user_count >= 0) writer.field("local_users", info.local_user_count);
+         if (info.local_group_count >= 0) writer.field("local_groups", info.local_group_count);
+         if (info.nss_counted) {
+             writer.field("total_users", info.user_count);
+             writer.field("total_groups", info.group_count);
+         } else if (show_nss) {
+             writer.field("nss_timed_out", info.nss_timed_out);
          }
      }
- 
-     void printEnvironmentInfo() {
-         EnvironmentInfo info = getEnvironmentInfo();
-         
-         std::cout << std::endl;
-         printSeparator("Environment Information");
-         
-         if (!info.lang.empty()) {
-             std::cout << std::left << std::setw(18) << "Language:" 
-                       << info.lang << std::endl;
-         }
-         
-         if (!info.desktop_session.empty()) {
-             std::cout << std::left << std::setw(18) << "Desktop session:" 
-                       << info.desktop_session << std::endl;
-         }
-         
-         if (!info.window_manager.empty()) {
-             std::cout << std::left << std::setw(18) << "Desktop environment:" 
-                       << info.window_manager << std::endl;
-         }
-         
-         if (!info.editor.empty()) {
-             std::cout << std::left << std::setw(18) << "Default editor:" 
-                       << info.editor << std::endl;
-         }
-         
+     
+     if (show_environment) {
+         EnvironmentInfo info = readEnvironmentInfo();
          const char* shell_env = getenv("SHELL");
-         if (shell_env) {
-             std::cout << std::left << std::setw(18) << "Default shell:" 
-                       << shell_env << std::endl;
-         }
          
+         writer.group("environment");
+         writer.field("lang", info.lang);
+         writer.field("desktop_session", info.desktop_session);
+         writer.field("desktop", info.window_manager);
+         writer.field("editor", info.editor);
+         writer.field("shell", shell_env ? shell_env : "");
          if (show_detailed) {
-             if (!info.pager.empty()) {
-                 std::cout << std::left << std::setw(18) << "Pager:" 
-                           << info.pager << std::endl;
-             }
-             
-             if (!info.browser.empty()) {
-                 std::cout << std::left << std::setw(18) << "Browser:" 
-                           << info.browser << std::endl;
-             }
-             
-             if (!info.path.empty()) {
-                 std::cout << std::left << std::setw(18) << "PATH:" << std::endl;
-                 std::istringstream path_stream(info.path);
-                 std::string path_component;
-                 while (std::getline(path_stream, path_component, ':')) {
-                     std::cout << "  " << path_component << std::endl;
-                 }
-             }
+             writer.field("pager", info.pager);
+             writer.field("browser", info.browser);
+             writer.field("path", info.path);
          }
      }
+     
+     writer.end();
+ }
  
- public:
-     OsInfoUtil() {
-         // Check if output is terminal for color support
-         use_colors = isatty(STDOUT_FILENO);
+ // Naming a section leaves out every section that isn't named,
+ // along with the files only those sections read
+ bool OsInfoUtil::selectSection(const std::string& name) {
+     if (!sections_named) {
+         sections_named = true;
+         show_system = false;
      }
+     
+     if (name == "system") show_system = true;
+     else if (name == "distro") show_distro = true;
+     else if (name == "users") show_users = true;
+     else if (name == "environment") show_environment = true;
+     else return false;
+     return true;
+ }
  
-     void parseArgs(int argc, char* argv[]) {
-         for (int i = 1; i < argc; ++i) {
-             std::string arg = argv[i];
-             
-             if (arg == "--help" || arg == "-h") {
-                 printHelp();
-                 exit(0);
-             } else if (arg == "--version" || arg == "-V") {
-                 printVersion();
-                 exit(0);
-             } else if (arg == "--detailed" || arg == "-d") {
-                 show_detailed = true;
-             } else if (arg == "--distro" || arg == "-r") {
-                 show_distro = true;
-             } else if (arg == "--users" || arg == "-u") {
-                 show_users = true;
-             } else if (arg == "--environment" || arg == "-e") {
-                 show_environment = true;
-             } else if (arg == "--all" || arg == "-a") {
-                 show_detailed = show_distro = show_users = show_environment = true;
-             } else if (arg == "--no-color") {
-                 use_colors = false;
-             } else {
-                 std::cerr << colorize("osinfo: invalid option -- '" + arg + "'", Colors::RED) << std::endl;
-                 std::cerr << "Try 'osinfo --help' for more information." << std::endl;
-                 exit(1);
+ OsInfoUtil::OsInfoUtil() {
+     // Check if output is terminal for color support
+     use_colors = stdoutIsTerminal();
+ }
+ 
+ void OsInfoUtil::parseArgs(int argc, char* argv[]) {
+     for (int i = 1; i < argc; ++i) {
+         std::string arg = argv[i];
+         
+         if (arg == "--help" || arg == "-h") {
+             printHelp();
+             exit(0);
+         } else if (arg == "--version" || arg == "-V") {
+             printVersion();
+             exit(0);
+         } else if (arg == "--detailed" || arg == "-d") {
+             show_detailed = true;
+         } else if (arg == "--distro" || arg == "-r") {
+             show_distro = true;
+         } else if (arg == "--users" || arg == "-u") {
+             show_users = true;
+         } else if (arg == "--environment" || arg == "-e") {
+             show_environment = true;
+         } else if (arg == "--nss" || arg == "-n") {
+             show_users = show_nss = true;
+         } else if (arg == "--timeout" || arg == "-T" || arg.rfind("--timeout=", 0) == 0) {
+             std::string value = optionValue("osinfo", argc, argv, i, arg, "timeout", use_colors);
+             char* end = nullptr;
+             nss_timeout = std::strtod(value.c_str(), &end);
+             if (value.empty() || *end != '\0' || !(nss_timeout > 0.0)) {
+                 invalidValue("osinfo", "timeout", value, use_colors);
+             }
+         } else if (arg == "--all" || arg == "-a") {
+             show_detailed = show_distro = show_users = show_environment = true;
+         } else if (arg == "--format" || arg.rfind("--format=", 0) == 0) {
+             std::string value = optionValue("osinfo", argc, argv, i, arg, "format", use_colors);
+             OutputFormat format;
+             if (!parseOutputFormat(value, format)) {
+                 invalidValue("osinfo", "format", value, use_colors);
+             }
+             writer.setFormat(format);
+         } else if (arg == "--stats") {
+             enableStats();
+         } else if (arg == "--root" || arg.rfind("--root=", 0) == 0) {
+             std::string value = optionValue("osinfo", argc, argv, i, arg, "root", use_colors);
+             if (value.empty() || !setSystemRoot(value)) {
+                 invalidValue("osinfo", "root directory", value, use_colors);
              }
+         } else if (arg == "--no-color") {
+             use_colors = false;
+         } else if (!arg.empty() && arg[0] != '-') {
+             if (!selectSection(arg)) invalidValue("osinfo", "section", arg, use_colors);
+         } else {
+             std::cerr << colorize("osinfo: invalid option -- '" + arg + "'", Colors::RED) << '\n';
+             std::cerr << "Try 'osinfo --help' for more information." << '\n';
+             exit(1);
          }
      }
+ }
  
-     void printVersion() {
-         std::cout << "osinfo (QCO InfoUtils) 1.0" << std::endl;
-         std::cout << "Copyright (C) 2025 AnmiTaliDev" << std::endl;
-         std::cout << "License Apache 2.0: Apache License version 2.0" << std::endl;
-         std::cout << "This is free software: you are free to change and redistribute it." << std::endl;
-         std::cout << "There is NO WARRANTY, to the extent permitted by law." << std::endl;
-     }
+ void OsInfoUtil::printVersion() {
+     std::cout << "osinfo (QCO InfoUtils) 1.0" << '\n';
+     std::cout << "Copyright (C) 2025 AnmiTaliDev" << '\n';
+     std::cout << "License Apache 2.0: Apache License version 2.0" << '\n';
+     std::cout << "This is free software: you are free to change and redistribute it." << '\n';
+     std::cout << "There is NO WARRANTY, to the extent permitted by law." << '\n';
+ }
  
-     void printHelp() {
-         std::cout << "Usage: osinfo [OPTION]..." << std::endl;
-         std::cout << "Display information about the operating system." << std::endl;
-         std::cout << std::endl;
-         std::cout << "  -a, --all         display all available information" << std::endl;
-         std::cout << "  -d, --detailed    show detailed system information" << std::endl;
-         std::cout << "  -e, --environment show environment information" << std::endl;
-         std::cout << "  -h, --help        display this help and exit" << std::endl;
-         std::cout << "      --no-color    disable colored output" << std::endl;
-         std::cout << "  -r, --distro      show distribution information" << std::endl;
-         std::cout << "  -u, --users       show user information" << std::endl;
-         std::cout << "  -V, --version     output version information and exit" << std::endl;
-         std::cout << std::endl;
-         std::cout << "Examples:" << std::endl;
-         std::cout << "  osinfo            Show basic system information" << std::endl;
-         std::cout << "  osinfo -a         Show comprehensive system report" << std::endl;
-         std::cout << "  osinfo -r         Show distribution information" << std::endl;
-         std::cout << std::endl;
-         std::cout << "QCO InfoUtils home page: <https://github.com/Qainar-Projects/infoutils>" << std::endl;
-     }
+ void OsInfoUtil::printHelp() {
+     std::cout << "Usage: osinfo [OPTION]... [SECTION]..." << '\n';
+     std::cout << "Display information about the operating system." << '\n';
+     std::cout << '\n';
+     std::cout << "  -a, --all         display all available information" << '\n';
+     std::cout << "  -d, --detailed    show detailed system information" << '\n';
+     std::cout << "  -e, --environment show environment information" << '\n';
+     std::cout << "      --format=FMT  print text (default), json, prom or tsv records" << '\n';
+     std::cout << "  -h, --help        display this help and exit" << '\n';
+     std::cout << "  -n, --nss         also count users and groups from LDAP, SSSD and other" << '\n';
+     std::cout << "                    NSS sources (implies -u)" << '\n';
+     std::cout << "      --no-color    disable colored output" << '\n';
+     std::cout << "  -r, --distro      show distribution information" << '\n';
+     std::cout << "      --root DIR    read /proc, /sys and /etc under DIR, such as the host's /" << '\n';
+     std::cout << "                    mounted into a container" << '\n';
+     std::cout << "      --stats       print the time and system calls of each collector on exit" << '\n';
+     std::cout << "  -T, --timeout N   give up on the NSS counts after N seconds (default: 2)" << '\n';
+     std::cout << "  -u, --users       show user information" << '\n';
+     std::cout << "  -V, --version     output version information and exit" << '\n';
+     std::cout << '\n';
+     std::cout << "Naming SECTIONs (system, distro, users, environment) shows only those, and" << '\n';
+     std::cout << "reads only the files they need." << '\n';
+     std::cout << '\n';
+     std::cout << "Examples:" << '\n';
+     std::cout << "  osinfo            Show basic system information" << '\n';
+     std::cout << "  osinfo -a         Show comprehensive system report" << '\n';
+     std::cout << "  osinfo -r         Show distribution information" << '\n';
+     std::cout << "  osinfo users      Show only user information" << '\n';
+     std::cout << "  osinfo -a --format=json" << '\n';
+     std::cout << "                    Print the comprehensive report as one JSON object" << '\n';
+     std::cout << '\n';
+     std::cout << "QCO InfoUtils home page: <https://github.com/Qainar-Projects/infoutils>" << '\n';
+ }
  
-     void run() {
+ void OsInfoUtil::run() {
+     if (writer.format() != OutputFormat::TEXT) {
+         writeReport();
+         return;
+     }
+     
+     if (show_system) {
          printSystemInfo();
-         
-         if (show_distro) {
-             printDistroInfo();
-         }
-         
-         if (show_users) {
-             printUserInfo();
-         }
-         
-         if (show_environment) {
-             printEnvironmentInfo();
-         }
      }
- };
+     
+     if (show_distro) {
+         printDistroInfo();
+     }
+     
+     if (show_users) {
+         printUserInfo();
+     }
+     
+     if (show_environment) {
+         printEnvironmentInfo();
+     }
+ }
  
- int main(int argc, char* argv[]) {
+ INFOUTILS_MAIN(osinfo) {
      try {
          OsInfoUtil util;
          util.parseArgs(argc, argv);
          util.run();
+         if (statsEnabled()) printStats("osinfo");
          return 0;
      } catch (const std::exception& e) {
-         std::cerr << "osinfo: " << e.what() << std::endl;
+         std::cerr << "osinfo: " << e.what() << '\n';
          return 1;
      }
  }
\ No newline at end of file